@@ -0,0 +1,375 @@
+#include "memtrack.h"
+#include "../include/raylib.h"
+#include "../include/raymath.h"
+#include "actors.h"
+#include "arena.h"
+#include "broadphase.h"
+#include "controller.h"
+#include "drawstream.h"
+#include "jobs.h"
+#include "stats.h"
+static const float JUMP_POWER = 8.0f;
+static const float SLOPE_LIMIT = 50.0f;
+static const float TURN_SPEED = 8.0f;
+#define ANIMATION_BATCH_SIZE 256
+#define CULL_BATCH_SIZE 256
+#define CULL_NEAR_PLANE 0.01
+#define CULL_FAR_PLANE 1000.0
+#define MAX_POSE_BONES 256
+// Kept across ticks so the sweep order only needs repairing as characters move
+static CapsuleBroadphase characterBroadphase = { 0 };
+static CollisionHeatmap* collisionHeatmap = NULL;
+static float WrapAngle(float a) {
+    while (a > PI) a -= PI*2.0f;
+    while (a < -PI) a += PI*2.0f;
+    return a;
+}
+static float LerpAngle(float a, float b, float t) {
+    float diff = WrapAngle(b - a);
+    return a + diff * t;
+}
+Entity SpawnCharacter(EntityStore* store, Vector3 position, float radius, float height, float moveSpeed) {
+    Entity entity = CreateEntity(store);
+    if (!IsEntityAlive(store, entity)) return entity;
+    Transform* transform = AddComponent(store, entity, COMPONENT_TRANSFORM);
+    Vector3* velocity = AddComponent(store, entity, COMPONENT_VELOCITY);
+    CollisionCapsule* capsule = AddComponent(store, entity, COMPONENT_CAPSULE);
+    CharacterController* controller = AddComponent(store, entity, COMPONENT_CONTROLLER);
+    if (!transform || !velocity || !capsule || !controller) {
+        DestroyEntity(store, entity);
+        return (Entity){ 0 };
+    }
+    *transform = (Transform){ .translation = position, .rotation = QuaternionIdentity(), .scale = {1.0f, 1.0f, 1.0f} };
+    *capsule = (CollisionCapsule){
+        .lastSafePosition = position,
+        .radius = radius,
+        .halfHeight = height / 2.0f,
+        .isOnGround = false
+    };
+    controller->moveSpeed = moveSpeed;
+    controller->jumpPower = JUMP_POWER;
+    controller->slopeLimit = SLOPE_LIMIT;
+    // Optional: without one the character queries the world directly
+    AddComponent(store, entity, COMPONENT_COLLISION_CACHE);
+    return entity;
+}
+// Gathers the resident characters into flat arrays, moves them all with MoveCharacters, pushes
+// overlapping characters apart and scatters the results back into their components
+void UpdateCharacterControllers(EntityStore* store, const World* world, float delta) {
+    int controllerCount = COMPONENT_COUNT_OF(store, COMPONENT_CONTROLLER);
+    if (controllerCount == 0) return;
+    CharacterController* controllers = COMPONENT_DATA(store, COMPONENT_CONTROLLER, CharacterController);
+    const int* owners = COMPONENT_OWNERS(store, COMPONENT_CONTROLLER);
+    // Gathered arrays live in the simulation's frame arena, pushed around every tick
+    CollisionQueryCost* costs = collisionHeatmap ? FRAME_ALLOC_ARRAY(CollisionQueryCost, controllerCount) : NULL;
+    CollisionCache** caches = FRAME_ALLOC_ARRAY(CollisionCache*, controllerCount);
+    CollisionCapsule* capsules = FRAME_ALLOC_ARRAY(CollisionCapsule, controllerCount);
+    Vector3* positions = FRAME_ALLOC_ARRAY(Vector3, controllerCount);
+    Vector3* velocities = FRAME_ALLOC_ARRAY(Vector3, controllerCount);
+    Vector3* wishDirections = FRAME_ALLOC_ARRAY(Vector3, controllerCount);
+    float* moveSpeeds = FRAME_ALLOC_ARRAY(float, controllerCount);
+    float* jumpSpeeds = FRAME_ALLOC_ARRAY(float, controllerCount);
+    float* slopeLimits = FRAME_ALLOC_ARRAY(float, controllerCount);
+    int* controllerIndices = FRAME_ALLOC_ARRAY(int, controllerCount);
+    bool* grounded = FRAME_ALLOC_ARRAY(bool, controllerCount);
+    if (!caches || !capsules || !positions || !velocities || !wishDirections || !moveSpeeds || !jumpSpeeds ||
+        !slopeLimits || !controllerIndices || !grounded) return;
+    int count = 0;
+    for (int i = 0; i < controllerCount; i++) {
+        CharacterController* controller = &controllers[i];
+        Transform* transform = GetComponentByIndex(store, owners[i], COMPONENT_TRANSFORM);
+        Vector3* velocity = GetComponentByIndex(store, owners[i], COMPONENT_VELOCITY);
+        CollisionCapsule* capsule = GetComponentByIndex(store, owners[i], COMPONENT_CAPSULE);
+        if (!transform || !velocity || !capsule) continue;
+        if (Vector3LengthSqr(controller->wishDirection) > 0.0001f) {
+            Vector3 facing = Vector3Normalize(controller->wishDirection);
+            controller->targetYaw = atan2f(-facing.x, -facing.z);
+        }
+        controller->yaw = LerpAngle(controller->yaw, controller->targetYaw, TURN_SPEED * delta);
+        transform->rotation = QuaternionFromAxisAngle((Vector3){0.0f, 1.0f, 0.0f}, controller->yaw);
+        // Actors over a cell that is still streaming in stay frozen instead of falling through it
+        if (!IsWorldResidentAt(world, transform->translation)) continue;
+        controllerIndices[count] = i;
+        caches[count] = GetComponentByIndex(store, owners[i], COMPONENT_COLLISION_CACHE);
+        capsules[count] = *capsule;
+        positions[count] = transform->translation;
+        velocities[count] = *velocity;
+        wishDirections[count] = controller->wishDirection;
+        moveSpeeds[count] = controller->moveSpeed;
+        jumpSpeeds[count] = controller->wantsJump ? controller->jumpPower : 0.0f;
+        slopeLimits[count] = controller->slopeLimit;
+        count++;
+    }
+    CharacterMoveBatch batch = { count, capsules, positions, velocities, wishDirections, moveSpeeds, jumpSpeeds, slopeLimits, caches };
+    CharacterMoveResults results = { positions, velocities, grounded, costs };
+    MoveCharacters(&world->collision, &batch, &results, delta);
+    if (costs) {
+        for (int i = 0; i < count; i++) RecordCollisionHeat(collisionHeatmap, positions[i], costs[i]);
+    }
+    UpdateCapsuleBroadphase(&characterBroadphase, positions, capsules, count);
+    SeparateCapsulePairs(&characterBroadphase, positions, capsules);
+    for (int i = 0; i < count; i++) {
+        int owner = owners[controllerIndices[i]];
+        ((Transform*)GetComponentByIndex(store, owner, COMPONENT_TRANSFORM))->translation = positions[i];
+        *(Vector3*)GetComponentByIndex(store, owner, COMPONENT_VELOCITY) = velocities[i];
+        ((CollisionCapsule*)GetComponentByIndex(store, owner, COMPONENT_CAPSULE))->isOnGround = grounded[i];
+    }
+}
+void SetCollisionHeatmap(CollisionHeatmap* heatmap) {
+    collisionHeatmap = heatmap;
+}
+void ShutdownCharacterControllers(void) {
+    FreeCapsuleBroadphase(&characterBroadphase);
+}
+// Free bodies such as projectiles: anything with a velocity that no controller is driving
+void IntegrateVelocities(EntityStore* store, float delta) {
+    const Vector3* velocities = COMPONENT_DATA(store, COMPONENT_VELOCITY, Vector3);
+    const int* owners = COMPONENT_OWNERS(store, COMPONENT_VELOCITY);
+    for (int i = 0; i < COMPONENT_COUNT_OF(store, COMPONENT_VELOCITY); i++) {
+        if (GetComponentByIndex(store, owners[i], COMPONENT_CONTROLLER)) continue;
+        Transform* transform = GetComponentByIndex(store, owners[i], COMPONENT_TRANSFORM);
+        if (transform) transform->translation = Vector3Add(transform->translation, Vector3Scale(velocities[i], delta));
+    }
+}
+typedef struct {
+    EntityStore* store;
+    float delta;
+} AnimationBatch;
+static void UpdateAnimationRange(void* data, int start, int end) {
+    AnimationBatch* batch = data;
+    float delta = batch->delta;
+    AnimationState* animations = COMPONENT_DATA(batch->store, COMPONENT_ANIMATION, AnimationState);
+    for (int i = start; i < end; i++) {
+        AnimationState* state = &animations[i];
+        if (!state->animations || state->current >= state->animationCount) continue;
+        int frameCount = state->animations[state->current].frameCount;
+        if (frameCount <= 0) continue;
+        state->frame = fmodf(state->frame + state->framesPerSecond * delta, (float)frameCount);
+    }
+}
+void UpdateAnimations(EntityStore* store, float delta) {
+    AnimationBatch batch = { store, delta };
+    JobParallelFor(COMPONENT_COUNT_OF(store, COMPONENT_ANIMATION), ANIMATION_BATCH_SIZE, UpdateAnimationRange, &batch);
+}
+typedef struct {
+    Vector4 planes[6];
+} Frustum;
+typedef struct {
+    const FrameSnapshot* frame;
+    Frustum frustum;
+    bool* visible;
+    int visibleCount;
+} CullBatch;
+// Planes point inward and come straight from the rows of the view-projection matrix
+static Frustum GetCameraFrustum(Camera3D camera, float aspect) {
+    Matrix view = GetCameraMatrix(camera);
+    Matrix projection = MatrixPerspective(camera.fovy * DEG2RAD, aspect, CULL_NEAR_PLANE, CULL_FAR_PLANE);
+    Matrix m = MatrixMultiply(view, projection);
+    Vector4 row0 = { m.m0, m.m4, m.m8, m.m12 };
+    Vector4 row1 = { m.m1, m.m5, m.m9, m.m13 };
+    Vector4 row2 = { m.m2, m.m6, m.m10, m.m14 };
+    Vector4 row3 = { m.m3, m.m7, m.m11, m.m15 };
+    Frustum frustum = { {
+        Vector4Add(row3, row0), Vector4Subtract(row3, row0),
+        Vector4Add(row3, row1), Vector4Subtract(row3, row1),
+        Vector4Add(row3, row2), Vector4Subtract(row3, row2)
+    } };
+    for (int i = 0; i < 6; i++) {
+        float length = sqrtf(frustum.planes[i].x*frustum.planes[i].x + frustum.planes[i].y*frustum.planes[i].y + frustum.planes[i].z*frustum.planes[i].z);
+        frustum.planes[i] = Vector4Scale(frustum.planes[i], 1.0f / length);
+    }
+    return frustum;
+}
+static bool IsSphereInFrustum(const Frustum* frustum, Vector3 center, float radius) {
+    for (int i = 0; i < 6; i++) {
+        Vector4 plane = frustum->planes[i];
+        if (plane.x*center.x + plane.y*center.y + plane.z*center.z + plane.w < -radius) return false;
+    }
+    return true;
+}
+static void CullRange(void* data, int start, int end) {
+    CullBatch* batch = data;
+    int visibleCount = 0;
+    for (int i = start; i < end; i++) {
+        const RenderInstance* instance = &batch->frame->instances[i];
+        Vector3 scale = instance->transform.scale;
+        float radius = instance->boundsRadius * fmaxf(scale.x, fmaxf(scale.y, scale.z));
+        batch->visible[i] = IsSphereInFrustum(&batch->frustum, instance->transform.translation, radius);
+        visibleCount += batch->visible[i];
+    }
+    __atomic_add_fetch(&batch->visibleCount, visibleCount, __ATOMIC_RELAXED);
+}
+static bool IsMeshSkinned(const Mesh* mesh) {
+    return mesh->boneIds && mesh->boneWeights && mesh->vertices;
+}
+static int GetPoseFloatCount(Model model) {
+    int count = 0;
+    for (int m = 0; m < model.meshCount; m++) {
+        const Mesh* mesh = &model.meshes[m];
+        if (IsMeshSkinned(mesh)) count += mesh->vertexCount * (mesh->normals ? 6 : 3);
+    }
+    return count;
+}
+static Matrix GetBoneTransformMatrix(Transform transform) {
+    Matrix matrix = MatrixMultiply(MatrixScale(transform.scale.x, transform.scale.y, transform.scale.z), QuaternionToMatrix(transform.rotation));
+    return MatrixMultiply(matrix, MatrixTranslate(transform.translation.x, transform.translation.y, transform.translation.z));
+}
+// The skinning UpdateModelAnimation does, written to the pose instead of into the shared model
+static void SkinAnimationPose(const AnimationPose* pose, float* out) {
+    Model model = GetModelFromHandle(pose->model);
+    int boneCount = pose->animation->boneCount < model.boneCount ? pose->animation->boneCount : model.boneCount;
+    if (boneCount > MAX_POSE_BONES) boneCount = MAX_POSE_BONES;
+    Matrix bones[MAX_POSE_BONES];
+    Matrix normalBones[MAX_POSE_BONES];
+    for (int b = 0; b < boneCount; b++) {
+        bones[b] = MatrixMultiply(MatrixInvert(GetBoneTransformMatrix(model.bindPose[b])),
+            GetBoneTransformMatrix(pose->animation->framePoses[pose->frame][b]));
+        normalBones[b] = MatrixTranspose(MatrixInvert(bones[b]));
+    }
+    for (int m = 0; m < model.meshCount; m++) {
+        const Mesh* mesh = &model.meshes[m];
+        if (!IsMeshSkinned(mesh)) continue;
+        float* normals = mesh->normals ? out + mesh->vertexCount * 3 : NULL;
+        for (int v = 0; v < mesh->vertexCount; v++) {
+            Vector3 vertex = { mesh->vertices[v*3], mesh->vertices[v*3 + 1], mesh->vertices[v*3 + 2] };
+            Vector3 normal = mesh->normals ? (Vector3){ mesh->normals[v*3], mesh->normals[v*3 + 1], mesh->normals[v*3 + 2] } : Vector3Zero();
+            Vector3 skinnedVertex = Vector3Zero();
+            Vector3 skinnedNormal = Vector3Zero();
+            for (int j = 0; j < 4; j++) {
+                float weight = mesh->boneWeights[v*4 + j];
+                int bone = mesh->boneIds[v*4 + j];
+                if (weight == 0.0f || bone >= boneCount) continue;
+                skinnedVertex = Vector3Add(skinnedVertex, Vector3Scale(Vector3Transform(vertex, bones[bone]), weight));
+                if (normals) skinnedNormal = Vector3Add(skinnedNormal, Vector3Scale(Vector3Transform(normal, normalBones[bone]), weight));
+            }
+            out[v*3] = skinnedVertex.x;
+            out[v*3 + 1] = skinnedVertex.y;
+            out[v*3 + 2] = skinnedVertex.z;
+            if (!normals) continue;
+            normals[v*3] = skinnedNormal.x;
+            normals[v*3 + 1] = skinnedNormal.y;
+            normals[v*3 + 2] = skinnedNormal.z;
+        }
+        out += mesh->vertexCount * (mesh->normals ? 6 : 3);
+    }
+}
+static void SkinAnimationPoseRange(void* data, int start, int end) {
+    FrameSnapshot* frame = data;
+    for (int i = start; i < end; i++) SkinAnimationPose(&frame->poses[i], frame->poseData + frame->poses[i].firstFloat);
+}
+// Grows a snapshot-owned array; it is left as it was when that fails
+static bool GrowPoseArray(void** items, int* capacity, int needed, size_t itemSize) {
+    if (needed <= *capacity) return true;
+    int grown = *capacity ? *capacity : 16;
+    while (grown < needed) grown *= 2;
+    MemoryTag previousTag = PushMemoryTag(MEMORY_TAG_RENDER);
+    void* resized = RL_REALLOC(*items, grown * itemSize);
+    PopMemoryTag(previousTag);
+    if (!resized) return false;
+    *items = resized;
+    *capacity = grown;
+    return true;
+}
+// Instances that share a model, animation and frame share one pose, so each distinct pose is skinned
+// once, across the workers, and the renderer only uploads it
+static void SampleAnimationPoses(FrameSnapshot* frame) {
+    frame->poseCount = 0;
+    int floatCount = 0;
+    for (int i = 0; i < frame->instanceCount; i++) {
+        RenderInstance* instance = &frame->instances[i];
+        instance->pose = -1;
+        if (!instance->animation || instance->animation->frameCount <= 0 || !IsModelHandleReady(instance->model)) continue;
+        int poseFrame = instance->animationFrame % instance->animation->frameCount;
+        for (int p = 0; p < frame->poseCount && instance->pose < 0; p++) {
+            const AnimationPose* pose = &frame->poses[p];
+            if (pose->model.id == instance->model.id && pose->model.generation == instance->model.generation &&
+                pose->animation == instance->animation && pose->frame == poseFrame) instance->pose = p;
+        }
+        if (instance->pose >= 0) continue;
+        if (!GrowPoseArray((void**)&frame->poses, &frame->poseCapacity, frame->poseCount + 1, sizeof(AnimationPose))) continue;
+        frame->poses[frame->poseCount] = (AnimationPose){ instance->model, instance->animation, poseFrame, floatCount };
+        floatCount += GetPoseFloatCount(GetModelFromHandle(instance->model));
+        instance->pose = frame->poseCount++;
+    }
+    if (!GrowPoseArray((void**)&frame->poseData, &frame->poseDataCapacity, floatCount, sizeof(float))) {
+        for (int i = 0; i < frame->instanceCount; i++) frame->instances[i].pose = -1;
+        frame->poseCount = 0;
+        return;
+    }
+    JobParallelFor(frame->poseCount, 1, SkinAnimationPoseRange, frame);
+}
+// Uploads a sampled pose into the shared model's vertex buffers, what UpdateModelAnimation does
+// after skinning; main thread only
+static void UploadAnimationPose(const FrameSnapshot* frame, int poseIndex) {
+    const AnimationPose* pose = &frame->poses[poseIndex];
+    Model model = GetModelFromHandle(pose->model);
+    const float* data = frame->poseData + pose->firstFloat;
+    for (int m = 0; m < model.meshCount; m++) {
+        Mesh mesh = model.meshes[m];
+        if (!IsMeshSkinned(&mesh)) continue;
+        int bytes = mesh.vertexCount * 3 * (int)sizeof(float);
+        UpdateMeshBuffer(mesh, 0, data, bytes, 0);
+        data += mesh.vertexCount * 3;
+        if (!mesh.normals) continue;
+        UpdateMeshBuffer(mesh, 2, data, bytes, 0);
+        data += mesh.vertexCount * 3;
+    }
+}
+// Copies what the renderer needs out of the store so drawing never touches live simulation state
+void CaptureRenderInstances(const EntityStore* store, FrameSnapshot* frame) {
+    const RenderMesh* meshes = COMPONENT_DATA(store, COMPONENT_RENDER_MESH, RenderMesh);
+    const int* owners = COMPONENT_OWNERS(store, COMPONENT_RENDER_MESH);
+    frame->instanceCount = 0;
+    for (int i = 0; i < COMPONENT_COUNT_OF(store, COMPONENT_RENDER_MESH) && frame->instanceCount < frame->instanceCapacity; i++) {
+        const Transform* transform = GetComponentByIndex(store, owners[i], COMPONENT_TRANSFORM);
+        if (!transform) continue;
+        RenderInstance* instance = &frame->instances[frame->instanceCount++];
+        *instance = (RenderInstance){
+            .transform = *transform,
+            .model = meshes[i].model,
+            .tint = meshes[i].tint,
+            .boundsRadius = meshes[i].boundsRadius
+        };
+        const CollisionCapsule* capsule = GetComponentByIndex(store, owners[i], COMPONENT_CAPSULE);
+        if (capsule) {
+            instance->capsuleRadius = capsule->radius;
+            instance->capsuleHalfHeight = capsule->halfHeight;
+        }
+        const AnimationState* state = GetComponentByIndex(store, owners[i], COMPONENT_ANIMATION);
+        if (state && state->animations && state->current < state->animationCount) {
+            instance->animation = &state->animations[state->current];
+            instance->animationFrame = (int)state->frame;
+        }
+    }
+    SampleAnimationPoses(frame);
+}
+// Frustum culling runs on the workers; the draws themselves stay on the main thread with GL
+int DrawRenderInstances(const FrameSnapshot* frame, float aspect, bool drawCapsules) {
+    CullBatch cull = { frame, GetCameraFrustum(frame->camera, aspect), FRAME_ALLOC_ARRAY(bool, frame->instanceCount), 0 };
+    if (!cull.visible) return 0;
+    JobParallelFor(frame->instanceCount, CULL_BATCH_SIZE, CullRange, &cull);
+    int uploadedPose = -1;
+    for (int i = 0; i < frame->instanceCount; i++) {
+        if (!cull.visible[i]) continue;
+        const RenderInstance* instance = &frame->instances[i];
+        Model model = GetModelFromHandle(instance->model);
+        // Instances share one model, so the pose is uploaded right before each draw that needs another
+        if (instance->pose >= 0 && instance->pose != uploadedPose) {
+            UploadAnimationPose(frame, instance->pose);
+            uploadedPose = instance->pose;
+        }
+        Vector3 axis;
+        float angle;
+        QuaternionToAxisAngle(instance->transform.rotation, &axis, &angle);
+        DrawModelEx(model, instance->transform.translation, axis, angle * RAD2DEG, instance->transform.scale, instance->tint);
+        AddModelDrawStats(model);
+        CaptureModelDraw(instance->model, NULL, instance->transform.translation, axis, angle * RAD2DEG, instance->transform.scale, instance->tint);
+        if (!drawCapsules || instance->capsuleRadius <= 0.0f) continue;
+        Vector3 bottom = Vector3Add(instance->transform.translation, (Vector3){0, instance->capsuleRadius, 0});
+        Vector3 top = Vector3Add(bottom, (Vector3){0, instance->capsuleHalfHeight * 2.0f - instance->capsuleRadius*2.0f, 0});
+        DrawCapsuleWires(bottom, top, instance->capsuleRadius, 6, 4, WHITE);
+        CaptureCapsuleWiresDraw(bottom, top, instance->capsuleRadius, 6, 4, WHITE);
+    }
+    AddStat(STAT_MESHES_CULLED, frame->instanceCount - cull.visibleCount);
+    return cull.visibleCount;
+}
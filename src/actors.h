@@ -0,0 +1,20 @@
+#ifndef ACTORS_H
+#define ACTORS_H
+#include "../include/raylib.h"
+#include "entity.h"
+#include "heatmap.h"
+#include "pipeline.h"
+#include "world.h"
+Entity SpawnCharacter(EntityStore* store, Vector3 position, float radius, float height, float moveSpeed);
+// Systems walk one dense component array front to back and look the rest up through the sparse maps
+void UpdateCharacterControllers(EntityStore* store, const World* world, float delta);
+// While set, every character move's collision work is recorded into heatmap at the character's
+// position. Recording happens under the world lock, so set it, and read the heatmap, holding it too.
+void SetCollisionHeatmap(CollisionHeatmap* heatmap);
+void ShutdownCharacterControllers(void);
+void IntegrateVelocities(EntityStore* store, float delta);
+void UpdateAnimations(EntityStore* store, float delta);
+void CaptureRenderInstances(const EntityStore* store, FrameSnapshot* frame);
+// Returns how many instances survived frustum culling and were drawn
+int DrawRenderInstances(const FrameSnapshot* frame, float aspect, bool drawCapsules);
+#endif
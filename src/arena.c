@@ -0,0 +1,117 @@
+#include "memtrack.h"
+#include <stdlib.h>
+#include "../include/raylib.h"
+#include "arena.h"
+#define ARENA_ALIGNMENT 16
+struct ArenaOverflowBlock {
+    ArenaOverflowBlock* next;
+    size_t size;
+};
+// The payload starts this far into its block, which keeps it at ARENA_ALIGNMENT
+#define ARENA_OVERFLOW_HEADER ((sizeof(ArenaOverflowBlock) + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1))
+typedef struct {
+    Arena arenas[2];
+    int current;
+    long long totalOverflows;
+} FrameArenas;
+static FrameArenas frameArenas[FRAME_ARENA_COUNT];
+static __thread FrameArenaKind currentFrameArena = FRAME_ARENA_RENDER;
+static const char* FRAME_ARENA_NAMES[FRAME_ARENA_COUNT] = { "render", "sim" };
+void ArenaInit(Arena* arena, size_t capacity) {
+    MemoryTag previousTag = PushMemoryTag(MEMORY_TAG_FRAME_TEMP);
+    *arena = (Arena){ 0 };
+    arena->base = RL_MALLOC(capacity);
+    arena->capacity = arena->base ? capacity : 0;
+    PopMemoryTag(previousTag);
+}
+void ArenaDestroy(Arena* arena) {
+    ArenaReset(arena);
+    RL_FREE(arena->base);
+    *arena = (Arena){ 0 };
+}
+void* ArenaAlloc(Arena* arena, size_t size) {
+    size_t alignedSize = (size + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1);
+    size_t start = __atomic_fetch_add(&arena->offset, alignedSize, __ATOMIC_RELAXED);
+    if (start + alignedSize <= arena->capacity) return arena->base + start;
+    MemoryTag previousTag = PushMemoryTag(MEMORY_TAG_FRAME_TEMP);
+    ArenaOverflowBlock* block = RL_MALLOC(ARENA_OVERFLOW_HEADER + size);
+    PopMemoryTag(previousTag);
+    if (!block) return NULL;
+    block->size = size;
+    block->next = __atomic_load_n(&arena->overflowBlocks, __ATOMIC_RELAXED);
+    while (!__atomic_compare_exchange_n(&arena->overflowBlocks, &block->next, block, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {}
+    __atomic_fetch_add(&arena->overflowCount, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&arena->overflowBytes, size, __ATOMIC_RELAXED);
+    return (unsigned char*)block + ARENA_OVERFLOW_HEADER;
+}
+void ArenaReset(Arena* arena) {
+    size_t used = arena->offset < arena->capacity ? arena->offset : arena->capacity;
+    if (used + arena->overflowBytes > arena->highWater) arena->highWater = used + arena->overflowBytes;
+    ArenaOverflowBlock* block = arena->overflowBlocks;
+    while (block) {
+        ArenaOverflowBlock* next = block->next;
+        RL_FREE(block);
+        block = next;
+    }
+    arena->overflowBlocks = NULL;
+    arena->overflowBytes = 0;
+    arena->overflowCount = 0;
+    arena->offset = 0;
+}
+void FrameArenaInit(FrameArenaKind kind, size_t capacity) {
+    FrameArenas* pair = &frameArenas[kind];
+    ArenaInit(&pair->arenas[0], capacity);
+    ArenaInit(&pair->arenas[1], capacity);
+    pair->current = 0;
+    pair->totalOverflows = 0;
+}
+void FrameArenaShutdown(void) {
+    for (int kind = 0; kind < FRAME_ARENA_COUNT; kind++) {
+        ArenaDestroy(&frameArenas[kind].arenas[0]);
+        ArenaDestroy(&frameArenas[kind].arenas[1]);
+    }
+}
+void FrameArenaBeginFrame(FrameArenaKind kind) {
+    FrameArenas* pair = &frameArenas[kind];
+    Arena* finished = &pair->arenas[pair->current];
+    if (finished->overflowCount > 0) {
+        TraceLog(LOG_WARNING, "ARENA: %s frame arena overflowed by %d allocation(s), %zu bytes past %zu byte capacity",
+            FRAME_ARENA_NAMES[kind], finished->overflowCount, finished->overflowBytes, finished->capacity);
+        pair->totalOverflows += finished->overflowCount;
+    }
+    ArenaReset(&pair->arenas[pair->current ^ 1]);
+    __atomic_store_n(&pair->current, pair->current ^ 1, __ATOMIC_RELAXED);
+}
+FrameArenaKind PushFrameArena(FrameArenaKind kind) {
+    FrameArenaKind previous = currentFrameArena;
+    currentFrameArena = kind;
+    return previous;
+}
+void PopFrameArena(FrameArenaKind previous) {
+    currentFrameArena = previous;
+}
+void* FrameAlloc(size_t size) {
+    FrameArenas* pair = &frameArenas[currentFrameArena];
+    return ArenaAlloc(&pair->arenas[pair->current], size);
+}
+FrameArenaStats GetFrameArenaStats(FrameArenaKind kind) {
+    // Read from the render thread while the simulation may be swapping its pair, so only roughly current
+    FrameArenas* pair = &frameArenas[kind];
+    int current = __atomic_load_n(&pair->current, __ATOMIC_RELAXED);
+    Arena* arena = &pair->arenas[current];
+    Arena* other = &pair->arenas[current ^ 1];
+    size_t offset = __atomic_load_n(&arena->offset, __ATOMIC_RELAXED);
+    size_t used = offset < arena->capacity ? offset : arena->capacity;
+    FrameArenaStats stats = {
+        .capacity = arena->capacity,
+        .usedBytes = used + __atomic_load_n(&arena->overflowBytes, __ATOMIC_RELAXED),
+        .highWaterBytes = arena->highWater > other->highWater ? arena->highWater : other->highWater,
+        .overflowCount = __atomic_load_n(&arena->overflowCount, __ATOMIC_RELAXED),
+        .totalOverflows = pair->totalOverflows
+    };
+    if (stats.usedBytes > stats.highWaterBytes) stats.highWaterBytes = stats.usedBytes;
+    return stats;
+}
+const char* GetFrameArenaName(FrameArenaKind kind) {
+    return FRAME_ARENA_NAMES[kind];
+}
@@ -0,0 +1,46 @@
+#ifndef ARENA_H
+#define ARENA_H
+#include <stddef.h>
+typedef struct ArenaOverflowBlock ArenaOverflowBlock;
+typedef struct {
+    unsigned char* base;
+    size_t capacity;
+    size_t offset;
+    size_t highWater;
+    size_t overflowBytes;
+    int overflowCount;
+    ArenaOverflowBlock* overflowBlocks;
+} Arena;
+typedef struct {
+    size_t capacity;
+    size_t usedBytes;
+    size_t highWaterBytes;
+    int overflowCount;
+    long long totalOverflows;
+} FrameArenaStats;
+// Bump allocator; safe to allocate from several threads at once, but reset only from one.
+// Requests past capacity fall back to the heap until the next reset and are counted as overflow.
+void ArenaInit(Arena* arena, size_t capacity);
+void ArenaDestroy(Arena* arena);
+void* ArenaAlloc(Arena* arena, size_t size);
+void ArenaReset(Arena* arena);
+// The render thread and the simulation each own a pair of frame arenas
+typedef enum {
+    FRAME_ARENA_RENDER,
+    FRAME_ARENA_SIMULATION,
+    FRAME_ARENA_COUNT
+} FrameArenaKind;
+// Two arenas swapped at the top of every frame: scratch from FrameAlloc stays valid until the end
+// of the following frame, so results can be handed from one frame to the next without copying.
+// FrameAlloc serves the pair pushed on the calling thread, the render pair unless another was
+// pushed; the simulation pushes its own around every tick and swaps it once per tick.
+void FrameArenaInit(FrameArenaKind kind, size_t capacity);
+void FrameArenaShutdown(void);
+void FrameArenaBeginFrame(FrameArenaKind kind);
+FrameArenaKind PushFrameArena(FrameArenaKind kind);
+void PopFrameArena(FrameArenaKind previous);
+void* FrameAlloc(size_t size);
+FrameArenaStats GetFrameArenaStats(FrameArenaKind kind);
+const char* GetFrameArenaName(FrameArenaKind kind);
+#define FRAME_ALLOC_ARRAY(type, count) ((type*)FrameAlloc(sizeof(type) * (size_t)(count)))
+#endif
@@ -0,0 +1,831 @@
+#include "memtrack.h"
+#include <ctype.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "assets.h"
+#include "jobs.h"
+#include "json.h"
+#include "platform.h"
+#include "stats.h"
+#define MAX_BATCH_IMAGES 128
+#define MAX_BATCH_TEXTURE_BINDINGS 256
+#define MAX_PRELOADED_FILES 16
+#define MAX_STREAMED_MODELS 64
+#define MAX_MODEL_CACHED_TEXTURES 64
+#define MAX_CACHED_TEXTURES 256
+#define ASSET_PATH_LENGTH 512
+#define MATERIAL_MAP_SLOTS 12 // raylib's MAX_MATERIAL_MAPS, which lives in its private config.h
+typedef struct {
+    char path[ASSET_PATH_LENGTH];
+    Image image;
+    bool decodeSkipped;
+    double decodeSeconds;
+    double finishTime;
+} ImageDecode;
+typedef struct {
+    int modelIndex;
+    int materialIndex;
+    int mapIndex;
+    int imageIndex;
+    int channel;
+} TextureBinding;
+typedef struct {
+    ImageDecode images[MAX_BATCH_IMAGES];
+    int imageCount;
+    TextureBinding bindings[MAX_BATCH_TEXTURE_BINDINGS];
+    int bindingCount;
+} TextureBatch;
+typedef struct {
+    char path[ASSET_PATH_LENGTH];
+    unsigned char* data;
+    int size;
+} PreloadedFile;
+typedef struct {
+    PreloadedFile entries[MAX_PRELOADED_FILES];
+    int count;
+} PreloadedFiles;
+typedef enum {
+    STREAM_EMPTY,
+    STREAM_QUEUED,
+    STREAM_PREFETCHING,
+    STREAM_UPLOADING,
+    STREAM_READY,
+    STREAM_FAILED
+} StreamState;
+typedef struct {
+    char fileName[ASSET_PATH_LENGTH];
+    StreamState state;
+    unsigned int generation;
+    int refCount;
+    unsigned long long lastUsed;
+    Model model;
+    bool meshLoaded;
+    TextureBatch* textures;
+    PreloadedFiles files;
+    JobCounter decodes;
+    int nextBinding;
+    int cachedTextures[MAX_MODEL_CACHED_TEXTURES];
+    int cachedTextureCount;
+    size_t meshCpuBytes;
+    size_t meshGpuBytes;
+    size_t materialBytes;
+    double requestTime;
+    double meshSeconds;
+    double uploadSeconds;
+} StreamedModel;
+// Textures are shared between models by canonical path; a model holds one reference per binding.
+// Materials get no cache of their own: raylib loads them as part of their model, which is already
+// shared by canonical path, so a cache keyed by that path and the material index would only hold
+// what the model cache does. Their textures are what is worth sharing across models.
+typedef struct {
+    char key[ASSET_PATH_LENGTH];
+    Texture2D texture;
+    int refCount;
+    unsigned long long lastUsed;
+    size_t gpuBytes;
+} CachedTexture;
+typedef struct {
+    StreamedModel models[MAX_STREAMED_MODELS];
+    CachedTexture textures[MAX_CACHED_TEXTURES];
+    AssetTypeStats stats[ASSET_TYPE_COUNT];
+    size_t cpuBudgetBytes;
+    size_t gpuBudgetBytes;
+    unsigned long long useCounter;
+    Model placeholder;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t requestAvailable;
+    bool running;
+} AssetManager;
+static AssetManager assetManager = {
+    .cpuBudgetBytes = 256u * 1024u * 1024u,
+    .gpuBudgetBytes = 512u * 1024u * 1024u
+};
+static PreloadedFiles* activePreloadedFiles = NULL;
+// raylib's OBJ loader chdir()s into the model's directory on the main thread, so every path handed
+// to the streaming thread or a worker is made absolute against the directory the game started in
+static char assetRoot[ASSET_PATH_LENGTH] = { 0 };
+static const char* DEFERRED_IMAGE_EXTENSIONS = ".png;.jpg;.jpeg;.bmp;.tga;.gif;.psd;.hdr;.pic;.qoi;.dds;.pkm;.ktx;.pvr;.astc;.webp";
+static unsigned char* ReadWholeFile(const char* fileName, int* outSize) {
+    *outSize = 0;
+    FILE* file = fopen(fileName, "rb");
+    if (!file) return NULL;
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    unsigned char* data = (size > 0) ? RL_MALLOC(size + 1) : NULL;
+    if (data) {
+        *outSize = (int)fread(data, 1, size, file);
+        data[*outSize] = 0;
+    }
+    fclose(file);
+    return data;
+}
+static unsigned char* TakePreloadedFile(const char* fileName, int* dataSize) {
+    if (!activePreloadedFiles) return NULL;
+    for (int i = 0; i < activePreloadedFiles->count; i++) {
+        PreloadedFile* file = &activePreloadedFiles->entries[i];
+        if (file->data && strcmp(file->path, fileName) == 0) {
+            unsigned char* data = file->data;
+            *dataSize = file->size;
+            file->data = NULL;
+            return data;
+        }
+    }
+    return NULL;
+}
+// Installed only while LoadModel runs so raylib parses meshes but leaves image files to the workers.
+// Files the streaming thread already read are handed over instead of touching the disk again.
+static unsigned char* LoadFileDataDeferringImages(const char* fileName, int* dataSize) {
+    *dataSize = 0;
+    if (IsFileExtension(fileName, DEFERRED_IMAGE_EXTENSIONS)) return NULL;
+    unsigned char* data = TakePreloadedFile(fileName, dataSize);
+    return data ? data : ReadWholeFile(fileName, dataSize);
+}
+static char* LoadFileTextPreloaded(const char* fileName) {
+    int size = 0;
+    unsigned char* data = TakePreloadedFile(fileName, &size);
+    return (char*)(data ? data : ReadWholeFile(fileName, &size));
+}
+static Model LoadModelDeferringImages(const char* fileName, PreloadedFiles* files) {
+    MemoryTag previousTag = PushMemoryTag(MEMORY_TAG_ASSETS);
+    activePreloadedFiles = files;
+    SetLoadFileDataCallback(LoadFileDataDeferringImages);
+    SetLoadFileTextCallback(LoadFileTextPreloaded);
+    Model model = LoadModel(fileName);
+    SetLoadFileTextCallback(NULL);
+    SetLoadFileDataCallback(NULL);
+    activePreloadedFiles = NULL;
+    PopMemoryTag(previousTag);
+    return model;
+}
+static void FreePreloadedFiles(PreloadedFiles* files) {
+    for (int i = 0; i < files->count; i++) {
+        RL_FREE(files->entries[i].data);
+        files->entries[i].data = NULL;
+    }
+    files->count = 0;
+}
+static void DecodeImageJob(void* data) {
+    ImageDecode* decode = data;
+    MemoryTag previousTag = PushMemoryTag(MEMORY_TAG_ASSETS);
+    double start = PlatformTime();
+    int size = 0;
+    unsigned char* fileData = ReadWholeFile(decode->path, &size);
+    if (fileData) {
+        decode->image = LoadImageFromMemory(GetFileExtension(decode->path), fileData, size);
+        RL_FREE(fileData);
+    } else {
+        TraceLog(LOG_WARNING, "ASSETS: [%s] Failed to open image file", decode->path);
+    }
+    decode->finishTime = PlatformTime();
+    decode->decodeSeconds = decode->finishTime - start;
+    PopMemoryTag(previousTag);
+}
+static void ResolveAssetPath(const char* directory, const char* uri, char* outPath) {
+    size_t length = strlen(directory);
+    if (length > ASSET_PATH_LENGTH - 2) length = ASSET_PATH_LENGTH - 2;
+    memcpy(outPath, directory, length);
+    outPath[length++] = '/';
+    for (const char* c = uri; *c && length + 1 < ASSET_PATH_LENGTH; c++) {
+        if (c[0] == '%' && isxdigit((unsigned char)c[1]) && isxdigit((unsigned char)c[2])) {
+            char hex[3] = { c[1], c[2], 0 };
+            outPath[length++] = (char)strtol(hex, NULL, 16);
+            c += 2;
+        } else {
+            outPath[length++] = *c;
+        }
+    }
+    outPath[length] = '\0';
+}
+static void AddTextureBinding(TextureBatch* batch, int modelIndex, int materialIndex, int mapIndex, const char* path, int channel) {
+    if (batch->bindingCount == MAX_BATCH_TEXTURE_BINDINGS) return;
+    int imageIndex = 0;
+    while (imageIndex < batch->imageCount && strcmp(batch->images[imageIndex].path, path) != 0) imageIndex++;
+    if (imageIndex == batch->imageCount) {
+        if (batch->imageCount == MAX_BATCH_IMAGES) return;
+        snprintf(batch->images[imageIndex].path, ASSET_PATH_LENGTH, "%s", path);
+        batch->imageCount++;
+    }
+    batch->bindings[batch->bindingCount++] = (TextureBinding){ modelIndex, materialIndex, mapIndex, imageIndex, channel };
+}
+static char* TrimLine(char* line) {
+    while (isspace((unsigned char)*line)) line++;
+    char* end = line + strlen(line);
+    while (end > line && isspace((unsigned char)end[-1])) *--end = '\0';
+    return line;
+}
+static const char* NextLine(const char* text, char* line, int lineSize) {
+    if (!text || *text == '\0') return NULL;
+    int length = 0;
+    while (text[length] && text[length] != '\n') length++;
+    int copy = length < lineSize - 1 ? length : lineSize - 1;
+    memcpy(line, text, copy);
+    line[copy] = '\0';
+    return text[length] ? text + length + 1 : text + length;
+}
+static void AddPreloadedFile(PreloadedFiles* files, const char* path) {
+    if (!files || files->count == MAX_PRELOADED_FILES) return;
+    snprintf(files->entries[files->count++].path, ASSET_PATH_LENGTH, "%s", path);
+}
+// raylib keeps OBJ materials in .mtl order, so the Nth newmtl is model.materials[N]
+static void ScanObj(TextureBatch* batch, PreloadedFiles* files, int modelIndex, const char* fileName, const char* text) {
+    char directory[ASSET_PATH_LENGTH];
+    snprintf(directory, sizeof(directory), "%s", GetDirectoryPath(fileName));
+    char line[1024];
+    char mtlPath[ASSET_PATH_LENGTH] = { 0 };
+    while ((text = NextLine(text, line, sizeof(line)))) {
+        if (strncmp(line, "mtllib", 6) == 0 && isspace((unsigned char)line[6])) {
+            ResolveAssetPath(directory, TrimLine(line + 6), mtlPath);
+            break;
+        }
+    }
+    if (mtlPath[0] == '\0') return;
+    AddPreloadedFile(files, mtlPath);
+    int mtlSize = 0;
+    char* mtlText = (char*)ReadWholeFile(mtlPath, &mtlSize);
+    const char* cursor = mtlText;
+    int materialIndex = -1;
+    while ((cursor = NextLine(cursor, line, sizeof(line)))) {
+        char* lineText = TrimLine(line);
+        int mapIndex = -1;
+        if (strncmp(lineText, "newmtl", 6) == 0) materialIndex++;
+        else if (strncmp(lineText, "map_Kd", 6) == 0) mapIndex = MATERIAL_MAP_DIFFUSE;
+        else if (strncmp(lineText, "map_Ks", 6) == 0) mapIndex = MATERIAL_MAP_SPECULAR;
+        else if (strncmp(lineText, "map_bump", 8) == 0 || strncmp(lineText, "map_Bump", 8) == 0 || strncmp(lineText, "bump", 4) == 0) mapIndex = MATERIAL_MAP_NORMAL;
+        else if (strncmp(lineText, "disp", 4) == 0) mapIndex = MATERIAL_MAP_HEIGHT;
+        if (mapIndex < 0 || materialIndex < 0) continue;
+        // Texture options (-bm 0.5 ...) come first; the file name is the last token
+        char* name = strrchr(lineText, ' ');
+        name = name ? name + 1 : lineText;
+        char path[ASSET_PATH_LENGTH];
+        ResolveAssetPath(directory, name, path);
+        AddTextureBinding(batch, modelIndex, materialIndex, mapIndex, path, -1);
+    }
+    RL_FREE(mtlText);
+}
+static void AddGltfTexture(TextureBatch* batch, const JsonDocument* document, int textureInfo, const char* directory, int modelIndex, int materialIndex, int mapIndex, int channel) {
+    int textures = JsonObjectGet(document, 0, "textures");
+    int images = JsonObjectGet(document, 0, "images");
+    int textureIndex = JsonGetInt(document, JsonObjectGet(document, textureInfo, "index"), -1);
+    int source = JsonGetInt(document, JsonObjectGet(document, JsonArrayGet(document, textures, textureIndex), "source"), -1);
+    char uri[ASSET_PATH_LENGTH];
+    // Embedded images (bufferView or data: URIs) are left to raylib
+    if (!JsonGetString(document, JsonObjectGet(document, JsonArrayGet(document, images, source), "uri"), uri, sizeof(uri))) return;
+    if (strncmp(uri, "data:", 5) == 0) return;
+    char path[ASSET_PATH_LENGTH];
+    ResolveAssetPath(directory, uri, path);
+    AddTextureBinding(batch, modelIndex, materialIndex, mapIndex, path, channel);
+}
+// raylib puts a default material at index 0, so glTF material N is model.materials[N + 1]
+static void ScanGltf(TextureBatch* batch, PreloadedFiles* files, int modelIndex, const char* fileName, const char* text) {
+    char directory[ASSET_PATH_LENGTH];
+    snprintf(directory, sizeof(directory), "%s", GetDirectoryPath(fileName));
+    JsonDocument document;
+    if (!JsonParse(text, (int)strlen(text), &document)) return;
+    int buffers = JsonObjectGet(&document, 0, "buffers");
+    int bufferCount = buffers >= 0 ? document.tokens[buffers].childCount : 0;
+    for (int i = 0; i < bufferCount; i++) {
+        char uri[ASSET_PATH_LENGTH];
+        char path[ASSET_PATH_LENGTH];
+        if (!JsonGetString(&document, JsonObjectGet(&document, JsonArrayGet(&document, buffers, i), "uri"), uri, sizeof(uri))) continue;
+        if (strncmp(uri, "data:", 5) == 0) continue;
+        ResolveAssetPath(directory, uri, path);
+        AddPreloadedFile(files, path);
+    }
+    int materials = JsonObjectGet(&document, 0, "materials");
+    int materialCount = materials >= 0 ? document.tokens[materials].childCount : 0;
+    for (int i = 0; i < materialCount; i++) {
+        int material = JsonArrayGet(&document, materials, i);
+        int pbr = JsonObjectGet(&document, material, "pbrMetallicRoughness");
+        int metallicRoughness = JsonObjectGet(&document, pbr, "metallicRoughnessTexture");
+        AddGltfTexture(batch, &document, JsonObjectGet(&document, pbr, "baseColorTexture"), directory, modelIndex, i + 1, MATERIAL_MAP_ALBEDO, -1);
+        AddGltfTexture(batch, &document, metallicRoughness, directory, modelIndex, i + 1, MATERIAL_MAP_METALNESS, 2);
+        AddGltfTexture(batch, &document, metallicRoughness, directory, modelIndex, i + 1, MATERIAL_MAP_ROUGHNESS, 1);
+        AddGltfTexture(batch, &document, JsonObjectGet(&document, material, "normalTexture"), directory, modelIndex, i + 1, MATERIAL_MAP_NORMAL, -1);
+        AddGltfTexture(batch, &document, JsonObjectGet(&document, material, "occlusionTexture"), directory, modelIndex, i + 1, MATERIAL_MAP_OCCLUSION, -1);
+        AddGltfTexture(batch, &document, JsonObjectGet(&document, material, "emissiveTexture"), directory, modelIndex, i + 1, MATERIAL_MAP_EMISSION, -1);
+    }
+    JsonFree(&document);
+}
+static void ScanModel(TextureBatch* batch, PreloadedFiles* files, int modelIndex, const char* fileName, const char* text) {
+    if (!text) return;
+    if (IsFileExtension(fileName, ".obj")) ScanObj(batch, files, modelIndex, fileName, text);
+    if (IsFileExtension(fileName, ".gltf")) ScanGltf(batch, files, modelIndex, fileName, text);
+}
+static size_t TextureGpuBytes(Texture2D texture) {
+    size_t bytes = 0;
+    int width = texture.width;
+    int height = texture.height;
+    for (int level = 0; level < texture.mipmaps; level++) {
+        bytes += (size_t)GetPixelDataSize(width, height, texture.format);
+        width = width > 1 ? width / 2 : 1;
+        height = height > 1 ? height / 2 : 1;
+    }
+    return bytes;
+}
+static unsigned int GetDefaultTextureId(void) {
+    static unsigned int defaultTextureId = 0;
+    if (defaultTextureId == 0) {
+        Material material = LoadMaterialDefault();
+        defaultTextureId = material.maps[MATERIAL_MAP_DIFFUSE].texture.id;
+        UnloadMaterial(material);
+    }
+    return defaultTextureId;
+}
+static void UnloadBatchImages(TextureBatch* batch) {
+    for (int i = 0; i < batch->imageCount; i++) {
+        UnloadImage(batch->images[i].image);
+        batch->images[i].image = (Image){ 0 };
+    }
+}
+// Collapses "./", "../" and backslashes and roots relative paths at assetRoot, so every spelling
+// of a path shares one cache entry and opens the same file from any thread
+static void CanonicalizeAssetPath(const char* path, char* outPath) {
+    char buffer[ASSET_PATH_LENGTH * 2];
+    bool relative = path[0] != '/' && path[0] != '\\' && !(path[0] != '\0' && path[1] == ':');
+    if (relative && assetRoot[0] != '\0') snprintf(buffer, sizeof(buffer), "%s/%s", assetRoot, path);
+    else snprintf(buffer, sizeof(buffer), "%s", path);
+    for (char* c = buffer; *c; c++) if (*c == '\\') *c = '/';
+    const char* parts[64];
+    int partCount = 0;
+    bool absolute = buffer[0] == '/';
+    // Split by hand: strtok's hidden state is not safe while the streaming thread also canonicalizes
+    for (char* part = buffer; *part; ) {
+        char* separator = strchr(part, '/');
+        char* next = separator ? separator + 1 : part + strlen(part);
+        if (separator) *separator = '\0';
+        if (*part == '\0' || strcmp(part, ".") == 0) {
+            part = next;
+            continue;
+        }
+        if (strcmp(part, "..") == 0 && partCount > 0 && strcmp(parts[partCount - 1], "..") != 0) partCount--;
+        else if (partCount < 64) parts[partCount++] = part;
+        part = next;
+    }
+    size_t length = 0;
+    outPath[0] = '\0';
+    if (absolute) outPath[length++] = '/';
+    for (int i = 0; i < partCount; i++) {
+        int written = snprintf(outPath + length, ASSET_PATH_LENGTH - length, i ? "/%s" : "%s", parts[i]);
+        if (written < 0 || length + written >= ASSET_PATH_LENGTH) break;
+        length += written;
+    }
+    outPath[length] = '\0';
+}
+static void MakeTextureKey(const char* path, int channel, char* outKey) {
+    char canonical[ASSET_PATH_LENGTH];
+    CanonicalizeAssetPath(path, canonical);
+    if (channel < 0) snprintf(outKey, ASSET_PATH_LENGTH, "%s", canonical);
+    else snprintf(outKey, ASSET_PATH_LENGTH, "%.500s#%d", canonical, channel);
+}
+// Caller holds assetManager.lock
+static int FindCachedTexture(const char* key) {
+    for (int i = 0; i < MAX_CACHED_TEXTURES; i++) {
+        if (assetManager.textures[i].texture.id != 0 && strcmp(assetManager.textures[i].key, key) == 0) return i;
+    }
+    return -1;
+}
+// Caller holds assetManager.lock. True when every texture made from the image, one per channel
+// it is bound with, is already shared through the cache.
+static bool AreImageTexturesCached(const TextureBatch* batch, int imageIndex) {
+    bool referenced = false;
+    for (int i = 0; i < batch->bindingCount; i++) {
+        if (batch->bindings[i].imageIndex != imageIndex) continue;
+        char key[ASSET_PATH_LENGTH];
+        MakeTextureKey(batch->images[imageIndex].path, batch->bindings[i].channel, key);
+        if (FindCachedTexture(key) < 0) return false;
+        referenced = true;
+    }
+    return referenced;
+}
+// Atomic so stamps taken outside assetManager.lock never lose an increment
+static unsigned long long NextUseStamp(void) {
+    return __atomic_add_fetch(&assetManager.useCounter, 1, __ATOMIC_RELAXED);
+}
+static size_t MeshCpuBytes(Mesh mesh) {
+    size_t vertices = (size_t)mesh.vertexCount;
+    size_t bytes = 0;
+    if (mesh.vertices) bytes += vertices * 3 * sizeof(float);
+    if (mesh.texcoords) bytes += vertices * 2 * sizeof(float);
+    if (mesh.texcoords2) bytes += vertices * 2 * sizeof(float);
+    if (mesh.normals) bytes += vertices * 3 * sizeof(float);
+    if (mesh.tangents) bytes += vertices * 4 * sizeof(float);
+    if (mesh.colors) bytes += vertices * 4;
+    if (mesh.indices) bytes += (size_t)mesh.triangleCount * 3 * sizeof(unsigned short);
+    if (mesh.animVertices) bytes += vertices * 3 * sizeof(float);
+    if (mesh.animNormals) bytes += vertices * 3 * sizeof(float);
+    if (mesh.boneIds) bytes += vertices * 4;
+    if (mesh.boneWeights) bytes += vertices * 4 * sizeof(float);
+    if (mesh.boneMatrices) bytes += (size_t)mesh.boneCount * sizeof(Matrix);
+    return bytes;
+}
+static size_t MeshGpuBytes(Mesh mesh) {
+    size_t bytes = MeshCpuBytes(mesh);
+    size_t vertices = (size_t)mesh.vertexCount;
+    if (mesh.animVertices) bytes -= vertices * 3 * sizeof(float);
+    if (mesh.animNormals) bytes -= vertices * 3 * sizeof(float);
+    if (mesh.boneMatrices) bytes -= (size_t)mesh.boneCount * sizeof(Matrix);
+    return bytes;
+}
+// Runs on the streaming thread: every file read happens here and the image decodes are started
+// from here, without waiting for them, so the mesh load on the main thread overlaps them
+static bool PrefetchStreamedModel(StreamedModel* stream) {
+    stream->textures = RL_CALLOC(1, sizeof(TextureBatch));
+    stream->files.count = 0;
+    AddPreloadedFile(&stream->files, stream->fileName);
+    PreloadedFile* modelFile = &stream->files.entries[0];
+    modelFile->data = ReadWholeFile(stream->fileName, &modelFile->size);
+    if (!modelFile->data) return false;
+    ScanModel(stream->textures, &stream->files, 0, stream->fileName, (const char*)modelFile->data);
+    for (int i = 1; i < stream->files.count; i++) {
+        PreloadedFile* file = &stream->files.entries[i];
+        file->data = ReadWholeFile(file->path, &file->size);
+    }
+    for (int i = 0; i < stream->textures->imageCount; i++) {
+        ImageDecode* decode = &stream->textures->images[i];
+        pthread_mutex_lock(&assetManager.lock);
+        decode->decodeSkipped = AreImageTexturesCached(stream->textures, i);
+        pthread_mutex_unlock(&assetManager.lock);
+        if (!decode->decodeSkipped) JobSubmit(DecodeImageJob, decode, &stream->decodes);
+    }
+    return true;
+}
+static void* StreamingThreadMain(void* arg) {
+    (void)arg;
+    PushMemoryTag(MEMORY_TAG_ASSETS);
+    pthread_mutex_lock(&assetManager.lock);
+    while (assetManager.running) {
+        StreamedModel* stream = NULL;
+        for (int i = 0; i < MAX_STREAMED_MODELS && !stream; i++) {
+            if (assetManager.models[i].state == STREAM_QUEUED) stream = &assetManager.models[i];
+        }
+        if (!stream) {
+            pthread_cond_wait(&assetManager.requestAvailable, &assetManager.lock);
+            continue;
+        }
+        stream->state = STREAM_PREFETCHING;
+        pthread_mutex_unlock(&assetManager.lock);
+        bool prefetched = PrefetchStreamedModel(stream);
+        pthread_mutex_lock(&assetManager.lock);
+        stream->state = prefetched ? STREAM_UPLOADING : STREAM_FAILED;
+        if (!prefetched) TraceLog(LOG_WARNING, "ASSETS: [%s] Failed to stream model", stream->fileName);
+    }
+    pthread_mutex_unlock(&assetManager.lock);
+    return NULL;
+}
+static StreamState GetStreamState(StreamedModel* stream) {
+    pthread_mutex_lock(&assetManager.lock);
+    StreamState state = stream->state;
+    pthread_mutex_unlock(&assetManager.lock);
+    return state;
+}
+// Main thread only: returns a texture shared through the cache, uploading it on first use
+static void ApplyCachedTextureBinding(StreamedModel* stream, TextureBinding binding) {
+    if (binding.materialIndex >= stream->model.materialCount || stream->cachedTextureCount == MAX_MODEL_CACHED_TEXTURES) return;
+    ImageDecode* decode = &stream->textures->images[binding.imageIndex];
+    char key[ASSET_PATH_LENGTH];
+    MakeTextureKey(decode->path, binding.channel, key);
+    pthread_mutex_lock(&assetManager.lock);
+    int index = FindCachedTexture(key);
+    pthread_mutex_unlock(&assetManager.lock);
+    if (index < 0) {
+        MemoryTag previousTag = PushMemoryTag(MEMORY_TAG_ASSETS);
+        // Skipped decodes whose shared texture was evicted in the meantime fall back to a blocking load
+        if (decode->decodeSkipped && !IsImageValid(decode->image)) decode->image = LoadImage(decode->path);
+        decode->decodeSkipped = false;
+        if (!IsImageValid(decode->image)) {
+            PopMemoryTag(previousTag);
+            return;
+        }
+        Texture2D texture;
+        if (binding.channel >= 0) {
+            Image channelImage = ImageFromChannel(decode->image, binding.channel);
+            texture = LoadTextureFromImage(channelImage);
+            UnloadImage(channelImage);
+        } else {
+            texture = LoadTextureFromImage(decode->image);
+        }
+        PopMemoryTag(previousTag);
+        pthread_mutex_lock(&assetManager.lock);
+        for (int i = 0; i < MAX_CACHED_TEXTURES && index < 0; i++) {
+            if (assetManager.textures[i].texture.id == 0) index = i;
+        }
+        if (index >= 0) {
+            assetManager.textures[index] = (CachedTexture){ .texture = texture, .gpuBytes = TextureGpuBytes(texture) };
+            AddStat(STAT_BYTES_UPLOADED, (long long)assetManager.textures[index].gpuBytes);
+            snprintf(assetManager.textures[index].key, ASSET_PATH_LENGTH, "%s", key);
+        }
+        pthread_mutex_unlock(&assetManager.lock);
+        if (index < 0) {
+            TraceLog(LOG_WARNING, "ASSETS: [%s] Texture cache full", key);
+            UnloadTexture(texture);
+            return;
+        }
+    }
+    CachedTexture* cached = &assetManager.textures[index];
+    cached->refCount++;
+    cached->lastUsed = NextUseStamp();
+    stream->cachedTextures[stream->cachedTextureCount++] = index;
+    MaterialMap* map = &stream->model.materials[binding.materialIndex].maps[binding.mapIndex];
+    if (map->texture.id != 0 && map->texture.id != GetDefaultTextureId()) UnloadTexture(map->texture);
+    map->texture = cached->texture;
+}
+// Decode times are worker CPU time plus when the last decode finished, since decodes overlap the
+// mesh load; mesh and upload times are main-thread time spent on this model
+static void LogStreamedModelTiming(const StreamedModel* stream) {
+    double finish = PlatformTime();
+    double lastDecode = stream->requestTime;
+    double decodeSeconds = 0.0;
+    int decodeCount = 0;
+    for (int i = 0; i < stream->textures->imageCount; i++) {
+        const ImageDecode* decode = &stream->textures->images[i];
+        if (decode->finishTime == 0.0) continue;
+        decodeSeconds += decode->decodeSeconds;
+        if (decode->finishTime > lastDecode) lastDecode = decode->finishTime;
+        decodeCount++;
+    }
+    TraceLog(LOG_INFO, "ASSETS: [%s] Streamed in %.2f ms | %d image(s) decoded in %.2f ms cpu, last done at %.2f ms | mesh %.2f ms | upload %.2f ms",
+        stream->fileName, (finish - stream->requestTime) * 1000.0, decodeCount, decodeSeconds * 1000.0,
+        (lastDecode - stream->requestTime) * 1000.0, stream->meshSeconds * 1000.0, stream->uploadSeconds * 1000.0);
+}
+static void FinishStreamedModel(StreamedModel* stream) {
+    LogStreamedModelTiming(stream);
+    UnloadBatchImages(stream->textures);
+    RL_FREE(stream->textures);
+    stream->textures = NULL;
+    FreePreloadedFiles(&stream->files);
+    stream->meshCpuBytes = 0;
+    stream->meshGpuBytes = 0;
+    for (int i = 0; i < stream->model.meshCount; i++) {
+        stream->meshCpuBytes += MeshCpuBytes(stream->model.meshes[i]);
+        stream->meshGpuBytes += MeshGpuBytes(stream->model.meshes[i]);
+    }
+    stream->materialBytes = (size_t)stream->model.materialCount * (sizeof(Material) + MATERIAL_MAP_SLOTS * sizeof(MaterialMap));
+    stream->lastUsed = NextUseStamp();
+    pthread_mutex_lock(&assetManager.lock);
+    stream->state = STREAM_READY;
+    pthread_mutex_unlock(&assetManager.lock);
+}
+// One unit of GPU work: the mesh load first, then one texture upload per call once the decodes
+// are done. Returns false when the model is waiting on its decodes.
+static bool UploadStreamedModelStep(StreamedModel* stream) {
+    double start = PlatformTime();
+    if (!stream->meshLoaded) {
+        stream->model = LoadModelDeferringImages(stream->fileName, &stream->files);
+        stream->meshSeconds = PlatformTime() - start;
+        stream->meshLoaded = true;
+        for (int i = 0; i < stream->model.meshCount; i++) AddStat(STAT_BYTES_UPLOADED, (long long)MeshGpuBytes(stream->model.meshes[i]));
+        return true;
+    }
+    if (!IsJobCounterDone(&stream->decodes)) return false;
+    if (stream->nextBinding < stream->textures->bindingCount) {
+        ApplyCachedTextureBinding(stream, stream->textures->bindings[stream->nextBinding++]);
+        stream->uploadSeconds += PlatformTime() - start;
+    }
+    if (stream->nextBinding == stream->textures->bindingCount) FinishStreamedModel(stream);
+    return true;
+}
+static void ReleaseCachedTexture(int index) {
+    CachedTexture* cached = &assetManager.textures[index];
+    if (cached->refCount > 0 && --cached->refCount == 0) cached->lastUsed = NextUseStamp();
+}
+// Shared textures belong to the cache, so they are detached before raylib frees the rest of the model
+static void UnloadStreamedModel(StreamedModel* stream) {
+    for (int i = 0; i < stream->cachedTextureCount; i++) {
+        unsigned int id = assetManager.textures[stream->cachedTextures[i]].texture.id;
+        for (int m = 0; m < stream->model.materialCount; m++) {
+            for (int map = 0; map < MATERIAL_MAP_SLOTS; map++) {
+                if (stream->model.materials[m].maps[map].texture.id == id) stream->model.materials[m].maps[map].texture.id = 0;
+            }
+        }
+        ReleaseCachedTexture(stream->cachedTextures[i]);
+    }
+    stream->cachedTextureCount = 0;
+    UnloadModel(stream->model);
+}
+void GetAssetCacheStats(AssetTypeStats outStats[ASSET_TYPE_COUNT]) {
+    for (int type = 0; type < ASSET_TYPE_COUNT; type++) {
+        outStats[type] = (AssetTypeStats){
+            .evictedCount = assetManager.stats[type].evictedCount,
+            .evictedBytes = assetManager.stats[type].evictedBytes
+        };
+    }
+    for (int i = 0; i < MAX_STREAMED_MODELS; i++) {
+        StreamedModel* stream = &assetManager.models[i];
+        if (stream->state != STREAM_READY) continue;
+        AssetTypeStats* meshes = &outStats[ASSET_TYPE_MESH];
+        AssetTypeStats* materials = &outStats[ASSET_TYPE_MATERIAL];
+        meshes->liveCount += stream->model.meshCount;
+        meshes->liveCpuBytes += stream->meshCpuBytes;
+        meshes->liveGpuBytes += stream->meshGpuBytes;
+        materials->liveCount += stream->model.materialCount;
+        materials->liveCpuBytes += stream->materialBytes;
+        if (stream->refCount == 0) {
+            meshes->unreferencedBytes += stream->meshCpuBytes + stream->meshGpuBytes;
+            materials->unreferencedBytes += stream->materialBytes;
+        }
+    }
+    for (int i = 0; i < MAX_CACHED_TEXTURES; i++) {
+        CachedTexture* cached = &assetManager.textures[i];
+        if (cached->texture.id == 0) continue;
+        AssetTypeStats* textures = &outStats[ASSET_TYPE_TEXTURE];
+        textures->liveCount++;
+        textures->liveGpuBytes += cached->gpuBytes;
+        if (cached->refCount == 0) textures->unreferencedBytes += cached->gpuBytes;
+    }
+}
+void LogAssetCacheStats(void) {
+    static const char* typeNames[ASSET_TYPE_COUNT] = { "meshes", "materials", "textures" };
+    AssetTypeStats stats[ASSET_TYPE_COUNT];
+    GetAssetCacheStats(stats);
+    for (int type = 0; type < ASSET_TYPE_COUNT; type++) {
+        TraceLog(LOG_INFO, "ASSETS: %-9s live %4d (%8.2f KB cpu, %8.2f KB gpu, %8.2f KB unreferenced) | evicted %4d (%8.2f KB)",
+            typeNames[type], stats[type].liveCount, stats[type].liveCpuBytes / 1024.0, stats[type].liveGpuBytes / 1024.0,
+            stats[type].unreferencedBytes / 1024.0, stats[type].evictedCount, stats[type].evictedBytes / 1024.0);
+    }
+}
+void AssetCacheSetBudget(size_t cpuBudgetBytes, size_t gpuBudgetBytes) {
+    assetManager.cpuBudgetBytes = cpuBudgetBytes;
+    assetManager.gpuBudgetBytes = gpuBudgetBytes;
+}
+static void EvictStreamedModel(StreamedModel* stream) {
+    AssetTypeStats* meshes = &assetManager.stats[ASSET_TYPE_MESH];
+    AssetTypeStats* materials = &assetManager.stats[ASSET_TYPE_MATERIAL];
+    meshes->evictedCount += stream->model.meshCount;
+    meshes->evictedBytes += stream->meshCpuBytes + stream->meshGpuBytes;
+    materials->evictedCount += stream->model.materialCount;
+    materials->evictedBytes += stream->materialBytes;
+    UnloadStreamedModel(stream);
+    pthread_mutex_lock(&assetManager.lock);
+    unsigned int generation = stream->generation + 1;
+    *stream = (StreamedModel){ .state = STREAM_EMPTY, .generation = generation };
+    pthread_mutex_unlock(&assetManager.lock);
+}
+static void EvictCachedTexture(CachedTexture* cached) {
+    AssetTypeStats* textures = &assetManager.stats[ASSET_TYPE_TEXTURE];
+    textures->evictedCount++;
+    textures->evictedBytes += cached->gpuBytes;
+    Texture2D texture = cached->texture;
+    pthread_mutex_lock(&assetManager.lock);
+    *cached = (CachedTexture){ 0 };
+    pthread_mutex_unlock(&assetManager.lock);
+    UnloadTexture(texture);
+}
+// Evicts unreferenced models and textures, least recently used first, until both budgets are met
+static void EnforceAssetBudget(void) {
+    for (;;) {
+        AssetTypeStats stats[ASSET_TYPE_COUNT];
+        GetAssetCacheStats(stats);
+        size_t cpuBytes = 0;
+        size_t gpuBytes = 0;
+        for (int type = 0; type < ASSET_TYPE_COUNT; type++) {
+            cpuBytes += stats[type].liveCpuBytes;
+            gpuBytes += stats[type].liveGpuBytes;
+        }
+        if (cpuBytes <= assetManager.cpuBudgetBytes && gpuBytes <= assetManager.gpuBudgetBytes) return;
+        StreamedModel* oldestModel = NULL;
+        CachedTexture* oldestTexture = NULL;
+        unsigned long long oldest = ~0ull;
+        for (int i = 0; i < MAX_STREAMED_MODELS; i++) {
+            StreamedModel* stream = &assetManager.models[i];
+            unsigned long long lastUsed = __atomic_load_n(&stream->lastUsed, __ATOMIC_RELAXED);
+            if (stream->state == STREAM_READY && stream->refCount == 0 && lastUsed < oldest) {
+                oldest = lastUsed;
+                oldestModel = stream;
+            }
+        }
+        for (int i = 0; i < MAX_CACHED_TEXTURES; i++) {
+            CachedTexture* cached = &assetManager.textures[i];
+            if (cached->texture.id != 0 && cached->refCount == 0 && cached->lastUsed < oldest) {
+                oldest = cached->lastUsed;
+                oldestTexture = cached;
+                oldestModel = NULL;
+            }
+        }
+        if (oldestTexture) EvictCachedTexture(oldestTexture);
+        else if (oldestModel) EvictStreamedModel(oldestModel);
+        else return;
+    }
+}
+void AssetManagerInit(void) {
+    MemoryTag previousTag = PushMemoryTag(MEMORY_TAG_ASSETS);
+    if (!PlatformWorkingDirectory(assetRoot, ASSET_PATH_LENGTH)) {
+        TraceLog(LOG_WARNING, "ASSETS: Working directory path too long, streaming with relative paths");
+    }
+    Image checker = GenImageChecked(16, 16, 4, 4, MAGENTA, BLACK);
+    assetManager.placeholder = LoadModelFromMesh(GenMeshCube(1.0f, 1.0f, 1.0f));
+    assetManager.placeholder.materials[0].maps[MATERIAL_MAP_DIFFUSE].texture = LoadTextureFromImage(checker);
+    UnloadImage(checker);
+    pthread_mutex_init(&assetManager.lock, NULL);
+    pthread_cond_init(&assetManager.requestAvailable, NULL);
+    assetManager.running = true;
+    if (pthread_create(&assetManager.thread, NULL, StreamingThreadMain, NULL) != 0) {
+        TraceLog(LOG_ERROR, "ASSETS: Failed to start streaming thread");
+        assetManager.running = false;
+    }
+    PopMemoryTag(previousTag);
+}
+void AssetManagerShutdown(void) {
+    pthread_mutex_lock(&assetManager.lock);
+    bool wasRunning = assetManager.running;
+    assetManager.running = false;
+    pthread_cond_broadcast(&assetManager.requestAvailable);
+    pthread_mutex_unlock(&assetManager.lock);
+    if (wasRunning) pthread_join(assetManager.thread, NULL);
+    // Decodes still in flight write into the batches freed below
+    for (int i = 0; i < MAX_STREAMED_MODELS; i++) JobWait(&assetManager.models[i].decodes);
+    LogAssetCacheStats();
+    for (int i = 0; i < MAX_STREAMED_MODELS; i++) {
+        StreamedModel* stream = &assetManager.models[i];
+        if (stream->textures) {
+            UnloadBatchImages(stream->textures);
+            RL_FREE(stream->textures);
+            stream->textures = NULL;
+        }
+        FreePreloadedFiles(&stream->files);
+        if (stream->meshLoaded) UnloadStreamedModel(stream);
+        stream->state = STREAM_EMPTY;
+    }
+    for (int i = 0; i < MAX_CACHED_TEXTURES; i++) {
+        if (assetManager.textures[i].texture.id != 0) UnloadTexture(assetManager.textures[i].texture);
+        assetManager.textures[i] = (CachedTexture){ 0 };
+    }
+    pthread_cond_destroy(&assetManager.requestAvailable);
+    pthread_mutex_destroy(&assetManager.lock);
+    UnloadModel(assetManager.placeholder);
+}
+ModelHandle LoadModelAsync(const char* fileName) {
+    char canonical[ASSET_PATH_LENGTH];
+    CanonicalizeAssetPath(fileName, canonical);
+    ModelHandle handle = { 0 };
+    pthread_mutex_lock(&assetManager.lock);
+    for (int i = 0; i < MAX_STREAMED_MODELS && handle.id == 0; i++) {
+        StreamedModel* stream = &assetManager.models[i];
+        if (stream->state != STREAM_EMPTY && stream->state != STREAM_FAILED && strcmp(stream->fileName, canonical) == 0) {
+            stream->refCount++;
+            stream->lastUsed = NextUseStamp();
+            handle = (ModelHandle){ i + 1, stream->generation };
+        }
+    }
+    for (int i = 0; i < MAX_STREAMED_MODELS && handle.id == 0; i++) {
+        StreamedModel* stream = &assetManager.models[i];
+        if (stream->state != STREAM_EMPTY) continue;
+        *stream = (StreamedModel){ .state = STREAM_QUEUED, .generation = stream->generation, .refCount = 1, .requestTime = PlatformTime() };
+        snprintf(stream->fileName, ASSET_PATH_LENGTH, "%s", canonical);
+        handle = (ModelHandle){ i + 1, stream->generation };
+        pthread_cond_signal(&assetManager.requestAvailable);
+    }
+    pthread_mutex_unlock(&assetManager.lock);
+    if (handle.id == 0) TraceLog(LOG_WARNING, "ASSETS: [%s] No free streaming slot", fileName);
+    return handle;
+}
+static StreamedModel* GetStreamedModel(ModelHandle handle) {
+    if (handle.id <= 0 || handle.id > MAX_STREAMED_MODELS) return NULL;
+    StreamedModel* stream = &assetManager.models[handle.id - 1];
+    return stream->generation == handle.generation ? stream : NULL;
+}
+// Released models stay resident until the budget needs their memory back
+void ReleaseModelHandle(ModelHandle handle) {
+    pthread_mutex_lock(&assetManager.lock);
+    StreamedModel* stream = GetStreamedModel(handle);
+    bool released = stream && stream->refCount > 0;
+    if (released && --stream->refCount == 0) stream->lastUsed = NextUseStamp();
+    pthread_mutex_unlock(&assetManager.lock);
+    if (released) EnforceAssetBudget();
+}
+void AssetManagerUpdate(double budgetMilliseconds) {
+    double start = PlatformTime();
+    bool didWork = false;
+    for (int i = 0; i < MAX_STREAMED_MODELS; i++) {
+        StreamedModel* stream = &assetManager.models[i];
+        while (GetStreamState(stream) == STREAM_UPLOADING) {
+            // The first step always runs so a single oversized upload cannot stall streaming forever
+            if (didWork && (PlatformTime() - start) * 1000.0 >= budgetMilliseconds) return;
+            if (!UploadStreamedModelStep(stream)) break;
+            didWork = true;
+        }
+        if (stream->state == STREAM_FAILED && stream->refCount == 0) {
+            pthread_mutex_lock(&assetManager.lock);
+            *stream = (StreamedModel){ .state = STREAM_EMPTY, .generation = stream->generation + 1 };
+            pthread_mutex_unlock(&assetManager.lock);
+        }
+    }
+    if (didWork) EnforceAssetBudget();
+}
+bool IsModelHandleReady(ModelHandle handle) {
+    StreamedModel* stream = GetStreamedModel(handle);
+    return stream && GetStreamState(stream) == STREAM_READY;
+}
+Model GetModelFromHandle(ModelHandle handle) {
+    StreamedModel* stream = GetStreamedModel(handle);
+    if (!stream || GetStreamState(stream) != STREAM_READY) return assetManager.placeholder;
+    __atomic_store_n(&stream->lastUsed, NextUseStamp(), __ATOMIC_RELAXED);
+    return stream->model;
+}
+const char* GetModelHandlePath(ModelHandle handle) {
+    StreamedModel* stream = GetStreamedModel(handle);
+    return stream ? stream->fileName : NULL;
+}
@@ -0,0 +1,39 @@
+#ifndef ASSETS_H
+#define ASSETS_H
+#include <stddef.h>
+#include "../include/raylib.h"
+typedef struct {
+    int id;
+    unsigned int generation;
+} ModelHandle;
+typedef enum {
+    ASSET_TYPE_MESH,
+    ASSET_TYPE_MATERIAL,
+    ASSET_TYPE_TEXTURE,
+    ASSET_TYPE_COUNT
+} AssetType;
+typedef struct {
+    int liveCount;
+    size_t liveCpuBytes;
+    size_t liveGpuBytes;
+    size_t unreferencedBytes;
+    int evictedCount;
+    size_t evictedBytes;
+} AssetTypeStats;
+// Models are deduplicated by canonical path and refcounted: every LoadModelAsync needs a matching
+// ReleaseModelHandle. Streamed models are read and decoded on a background thread and drawn as a
+// placeholder cube until AssetManagerUpdate has finished their GPU uploads within the frame budget.
+// Unreferenced models and textures stay cached until the CPU or GPU budget evicts them, oldest first.
+void AssetManagerInit(void);
+void AssetManagerShutdown(void);
+void AssetManagerUpdate(double budgetMilliseconds);
+void AssetCacheSetBudget(size_t cpuBudgetBytes, size_t gpuBudgetBytes);
+ModelHandle LoadModelAsync(const char* fileName);
+void ReleaseModelHandle(ModelHandle handle);
+bool IsModelHandleReady(ModelHandle handle);
+Model GetModelFromHandle(ModelHandle handle);
+// The canonical path the model was loaded from, absolute, or NULL for a stale handle
+const char* GetModelHandlePath(ModelHandle handle);
+void GetAssetCacheStats(AssetTypeStats outStats[ASSET_TYPE_COUNT]);
+void LogAssetCacheStats(void);
+#endif
@@ -0,0 +1,1661 @@
+#include "memtrack.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../include/raylib.h"
+#include "../include/raymath.h"
+#include "arena.h"
+#include "bench.h"
+#include "broadphase.h"
+#include "collision.h"
+#include "collisionbuild.h"
+#include "controller.h"
+#include "heatmap.h"
+#include "jobs.h"
+#include "platform.h"
+#include "query.h"
+#include "raypacket.h"
+#include "stresslevel.h"
+#include "world.h"
+#define BENCH_SEED 1337u
+#define BENCH_REPEATS 3
+static const int JOB_BENCH_TRIANGLES = 20000;
+static const float JOB_BENCH_LEVEL_SIZE = 200.0f;
+static const int JOB_BENCH_QUERIES = 4096;
+static const float JOB_BENCH_RADIUS = 1.5f;
+static const float JOB_BENCH_HEIGHT = 1.0f;
+static const int JOB_CHAIN_WORK = 20000;
+#define JOB_CHAIN_STAGES 64
+static const int CROWD_BENCH_DEFAULT_COUNT = 2000;
+static const int CROWD_BENCH_TICKS = 300;
+static const float CROWD_BENCH_STEP = 1.0f / 60.0f;
+static const int CROWD_BENCH_TRIANGLES = 20000;
+static const int CROWD_BENCH_IDLE_EVERY = 4;
+static const int RAY_BENCH_TRIANGLES = 20000;
+static const int RAY_BENCH_RAYS = 4096;
+static const float RAY_BENCH_DISTANCE = 100.0f;
+static const float RAY_BENCH_TOLERANCE = 0.001f;
+static const float RAY_BENCH_SPHERE_RADIUS = 0.3f;
+static const int PACKET_BENCH_SIZES[] = { 4, 8, 16 };
+static const int PACKET_BENCH_VIEWS = 16;
+static const int PACKET_BENCH_RESOLUTION = 256;
+static const float PACKET_BENCH_FOV = 90.0f;
+static const float PACKET_BENCH_DISTANCE = 50.0f;
+// Room for the stream's sort keys over every view's rays
+static const size_t PACKET_BENCH_ARENA_BYTES = 24u * 1024u * 1024u;
+static const int PROP_BENCH_DEFAULT_COUNT = 2000;
+static const int PROP_BENCH_MESH_TRIANGLES = 200;
+static const float PROP_BENCH_MESH_SIZE = 2.0f;
+static const float PROP_BENCH_SPACING = 4.0f;
+static const int PROP_BENCH_ROOM_TRIANGLES = 2000;
+static const int PROP_BENCH_QUERIES = 4096;
+static const int PROP_BENCH_REFITS = 120;
+#define PROP_BENCH_UNIQUE_MESHES 4
+static const float SIMPLIFY_BENCH_RADIUS = 0.8f;
+static const int SIMPLIFY_BENCH_QUERIES = 4096;
+static const int SCALING_BENCH_MIN_TRIANGLES = 10000;
+static const int SCALING_BENCH_DEFAULT_MAX_TRIANGLES = 1000000;
+static const float SCALING_BENCH_AREA_PER_TRIANGLE = 0.5f;
+static const int SCALING_BENCH_CHARACTERS = 256;
+static const int SCALING_BENCH_TICKS = 240;
+static const float SCALING_BENCH_RADIUS = 0.4f;
+static const float SCALING_BENCH_HEIGHT = 1.0f;
+static const float SCALING_BENCH_SPEED = 3.0f;
+static const float SCALING_BENCH_PATH_RADIUS = 3.0f;
+static const float SCALING_BENCH_WAYPOINT_REACH = 0.5f;
+static const int SCALING_BENCH_QUERIES = 4096;
+static const int SCALING_BENCH_PLOT_WIDTH = 40;
+#define SCALING_BENCH_PATH_POINTS 8
+#define SCALING_BENCH_MAX_STEPS 8
+static const int VERIFY_QUERIES = 2048;
+static const int VERIFY_STRESS_TRIANGLES = 20000;
+static const int VERIFY_PROP_COUNT = 256;
+static const float VERIFY_TOLERANCE = 0.001f;
+static const float VERIFY_MIN_RADIUS = 0.2f;
+static const float VERIFY_MAX_RADIUS = 1.0f;
+static const float VERIFY_MIN_HEIGHT = 0.5f;
+static const float VERIFY_MAX_HEIGHT = 2.0f;
+static const float VERIFY_CACHE_MARGIN = 0.75f;
+static const float VERIFY_SLOPE_LIMITS[] = { 0.0f, 35.0f, 50.0f };
+static const int VERIFY_MAX_REPORTED = 8;
+static const int VERIFY_CHARACTERS = 8;
+static const int VERIFY_CHARACTER_TICKS = 240;
+static const float VERIFY_CHARACTER_STEP = 1.0f / 60.0f;
+static const float VERIFY_CHARACTER_RADIUS = 0.4f;
+static const float VERIFY_CHARACTER_HEIGHT = 1.0f;
+static const float VERIFY_CHARACTER_SPEED = 2.0f;
+static const float VERIFY_LEDGE_SIZE = 10.0f;
+static const float VERIFY_LEDGE_HEIGHT = 3.0f;
+static const int HEATMAP_BENCH_CHARACTERS = 512;
+static const int HEATMAP_BENCH_TICKS = 600;
+static const int HEATMAP_BENCH_TURN_TICKS = 90;
+static const float HEATMAP_BENCH_CELL_SIZE = 1.0f;
+static const float HEATMAP_BENCH_RADIUS = 0.8f;
+static const float HEATMAP_BENCH_HEIGHT = 1.2f;
+static const int BROADPHASE_BENCH_COUNTS[] = { 1000, 2000, 5000, 10000 };
+static const int BROADPHASE_BENCH_TICKS = 120;
+static const int BROADPHASE_BENCH_CHECK_INTERVAL = 30;
+static const float BROADPHASE_BENCH_SPACING = 3.0f;
+static const float BROADPHASE_BENCH_RADIUS = 0.8f;
+static const float BROADPHASE_BENCH_HEIGHT = 1.2f;
+typedef struct {
+    const CollisionWorld* world;
+    const Vector3* positions;
+    Vector3* results;
+} CapsuleQueryBatch;
+// Same depenetrate-then-floor-snap sequence the character controller runs each tick
+static void RunCapsuleQueries(void* data, int start, int end) {
+    CapsuleQueryBatch* batch = data;
+    for (int i = start; i < end; i++) {
+        Vector3 position = batch->positions[i];
+        for (int j = 0; j < 3; j++) {
+            if (ResolveCapsuleCollision(batch->world, &position, JOB_BENCH_RADIUS, JOB_BENCH_HEIGHT, 0.0f) == 0) break;
+        }
+        Vector3 floorNormal;
+        float floorHeight = FindFloor(batch->world, position, &floorNormal);
+        if (floorHeight > -9999.0f && position.y - floorHeight <= 0.1f) position.y = floorHeight;
+        batch->results[i] = position;
+    }
+}
+// Stands in for one streamed texture: decoded on a worker, converted after that on a worker, then
+// uploaded on the main thread
+typedef struct {
+    JobCounter decoded;
+    JobCounter converted;
+    unsigned int value;
+    unsigned int expected;
+    int stage;
+    bool uploadedOnMain;
+    bool uploadedInOrder;
+} JobChainStage;
+static unsigned int HashChainValue(unsigned int value) {
+    for (int i = 0; i < JOB_CHAIN_WORK; i++) value = value * 1664525u + 1013904223u;
+    return value;
+}
+static void DecodeChainJob(void* data) {
+    JobChainStage* stage = data;
+    stage->value = HashChainValue(stage->value);
+    __atomic_store_n(&stage->stage, 1, __ATOMIC_SEQ_CST);
+}
+static void ConvertChainJob(void* data) {
+    JobChainStage* stage = data;
+    if (__atomic_load_n(&stage->stage, __ATOMIC_SEQ_CST) != 1) return;
+    stage->value = HashChainValue(stage->value);
+    __atomic_store_n(&stage->stage, 2, __ATOMIC_SEQ_CST);
+}
+static void UploadChainJob(void* data) {
+    JobChainStage* stage = data;
+    stage->uploadedOnMain = IsMainThread();
+    stage->uploadedInOrder = __atomic_load_n(&stage->stage, __ATOMIC_SEQ_CST) == 2;
+}
+// The decode-then-upload dependency the asset streamer relies on: every upload has to run on the
+// main thread after both worker steps of its own stage, whatever order the workers finish in
+static int RunJobChainCheck(int workerCount) {
+    JobChainStage* stages = RL_CALLOC(JOB_CHAIN_STAGES, sizeof(JobChainStage));
+    JobCounter uploads = { 0 };
+    for (int i = 0; i < JOB_CHAIN_STAGES; i++) {
+        stages[i].value = (unsigned int)i + 1u;
+        stages[i].expected = HashChainValue(HashChainValue(stages[i].value));
+    }
+    JobSystemInit(workerCount);
+    double start = PlatformTime();
+    for (int i = 0; i < JOB_CHAIN_STAGES; i++) {
+        JobSubmit(DecodeChainJob, &stages[i], &stages[i].decoded);
+        JobSubmitAfter(&stages[i].decoded, ConvertChainJob, &stages[i], &stages[i].converted);
+        JobSubmitMainAfter(&stages[i].converted, UploadChainJob, &stages[i], &uploads);
+    }
+    // Main-thread jobs only run when the main thread asks for them, as the game does once a frame
+    while (!IsJobCounterDone(&uploads)) {
+        JobRunMainThreadJobs();
+        PlatformYield();
+    }
+    double elapsed = PlatformTime() - start;
+    JobSystemShutdown();
+    int failures = 0;
+    for (int i = 0; i < JOB_CHAIN_STAGES; i++) {
+        bool passed = stages[i].uploadedOnMain && stages[i].uploadedInOrder && stages[i].value == stages[i].expected;
+        if (!passed) failures++;
+    }
+    TraceLog(LOG_INFO, "BENCH: Decode-upload chains: %d stages on %d worker(s) in %.2f ms, %d out of order or off the main thread",
+        JOB_CHAIN_STAGES, workerCount, elapsed * 1000.0, failures);
+    RL_FREE(stages);
+    return failures;
+}
+int RunJobScalingBenchmark(int maxThreads) {
+    if (maxThreads <= 0) maxThreads = PlatformCpuCount();
+    CollisionMesh mesh = GenerateStressLevel(JOB_BENCH_TRIANGLES, JOB_BENCH_LEVEL_SIZE, BENCH_SEED);
+    CollisionWorld world = { 0 };
+    AddCollisionMesh(&world, &mesh);
+    Vector3* positions = RL_MALLOC(sizeof(Vector3) * JOB_BENCH_QUERIES);
+    Vector3* reference = RL_MALLOC(sizeof(Vector3) * JOB_BENCH_QUERIES);
+    Vector3* results = RL_MALLOC(sizeof(Vector3) * JOB_BENCH_QUERIES);
+    unsigned int state = BENCH_SEED;
+    for (int i = 0; i < JOB_BENCH_QUERIES; i++) {
+        positions[i] = (Vector3){
+            StressRandomFloat(&state, mesh.bounds.min.x, mesh.bounds.max.x),
+            StressRandomFloat(&state, mesh.bounds.min.y, mesh.bounds.max.y),
+            StressRandomFloat(&state, mesh.bounds.min.z, mesh.bounds.max.z)
+        };
+    }
+    TraceLog(LOG_INFO, "BENCH: Capsule queries: %d triangles, %d queries, best of %d runs", mesh.triangleCount, JOB_BENCH_QUERIES, BENCH_REPEATS);
+    TraceLog(LOG_INFO, "BENCH: threads     ms  speedup  efficiency");
+    int failures = 0;
+    double singleThreadSeconds = 0.0;
+    // Doubling thread counts, always ending on maxThreads itself
+    for (int threads = 1; ; threads = threads * 2 < maxThreads ? threads * 2 : maxThreads) {
+        JobSystemInit(threads - 1);
+        CapsuleQueryBatch batch = { &world, positions, threads == 1 ? reference : results };
+        double best = 1e30;
+        for (int run = 0; run < BENCH_REPEATS; run++) {
+            double start = PlatformTime();
+            JobParallelFor(JOB_BENCH_QUERIES, 16, RunCapsuleQueries, &batch);
+            double elapsed = PlatformTime() - start;
+            if (elapsed < best) best = elapsed;
+        }
+        JobSystemShutdown();
+        if (threads == 1) singleThreadSeconds = best;
+        bool matches = threads == 1 || memcmp(results, reference, sizeof(Vector3) * JOB_BENCH_QUERIES) == 0;
+        if (!matches) failures++;
+        double speedup = singleThreadSeconds / best;
+        TraceLog(LOG_INFO, "BENCH: %7d %6.2f %7.2fx %10.0f%%%s", threads, best * 1000.0, speedup, 100.0 * speedup / threads,
+            matches ? "" : "  MISMATCH");
+        if (threads == maxThreads) break;
+    }
+    failures += RunJobChainCheck(0);
+    if (maxThreads > 1) failures += RunJobChainCheck(maxThreads - 1);
+    RL_FREE(results);
+    RL_FREE(reference);
+    RL_FREE(positions);
+    UnloadCollisionMesh(&mesh);
+    return failures;
+}
+typedef struct {
+    double averageSeconds;
+    double worstSeconds;
+    int overBudget;
+    int grounded;
+    long long idleSkips;
+    long long cacheHits;
+    long long cacheRefreshes;
+    long long cacheOverflows;
+} CrowdBenchResult;
+static CrowdBenchResult RunCrowdCase(const CollisionWorld* world, int characterCount, bool cached) {
+    const CollisionMesh* mesh = world->meshes[0];
+    CollisionCapsule* capsules = RL_CALLOC(characterCount, sizeof(CollisionCapsule));
+    Vector3* positions = RL_MALLOC(sizeof(Vector3) * characterCount);
+    Vector3* velocities = RL_CALLOC(characterCount, sizeof(Vector3));
+    Vector3* wishDirections = RL_MALLOC(sizeof(Vector3) * characterCount);
+    float* moveSpeeds = RL_MALLOC(sizeof(float) * characterCount);
+    bool* grounded = RL_CALLOC(characterCount, sizeof(bool));
+    CollisionCache* cacheStorage = cached ? RL_CALLOC(characterCount, sizeof(CollisionCache)) : NULL;
+    CollisionCache** caches = cached ? RL_MALLOC(sizeof(CollisionCache*) * characterCount) : NULL;
+    unsigned int state = BENCH_SEED;
+    for (int i = 0; i < characterCount; i++) {
+        positions[i] = (Vector3){
+            StressRandomFloat(&state, mesh->bounds.min.x, mesh->bounds.max.x),
+            mesh->bounds.max.y,
+            StressRandomFloat(&state, mesh->bounds.min.z, mesh->bounds.max.z)
+        };
+        capsules[i] = (CollisionCapsule){ positions[i], JOB_BENCH_RADIUS, JOB_BENCH_HEIGHT / 2.0f, false };
+        float heading = StressRandomFloat(&state, 0.0f, 2.0f * PI);
+        // Every fourth character stands still once it has landed
+        wishDirections[i] = i % CROWD_BENCH_IDLE_EVERY == 0 ? Vector3Zero() : (Vector3){ sinf(heading), 0.0f, cosf(heading) };
+        moveSpeeds[i] = 2.0f;
+        if (caches) caches[i] = &cacheStorage[i];
+    }
+    CharacterMoveBatch batch = { characterCount, capsules, positions, velocities, wishDirections, moveSpeeds, NULL, NULL, caches };
+    CharacterMoveResults results = { positions, velocities, grounded, NULL };
+    CrowdBenchResult result = { 0 };
+    double total = 0.0;
+    for (int tick = 0; tick < CROWD_BENCH_TICKS; tick++) {
+        double start = PlatformTime();
+        MoveCharacters(world, &batch, &results, CROWD_BENCH_STEP);
+        double elapsed = PlatformTime() - start;
+        for (int i = 0; i < characterCount; i++) capsules[i].isOnGround = grounded[i];
+        total += elapsed;
+        if (elapsed > result.worstSeconds) result.worstSeconds = elapsed;
+        if (elapsed > CROWD_BENCH_STEP) result.overBudget++;
+        CharacterQueryStats stats = GetCharacterQueryStats();
+        result.idleSkips += stats.idleSkips;
+        result.cacheHits += stats.cacheHits;
+        result.cacheRefreshes += stats.cacheRefreshes;
+        result.cacheOverflows += stats.cacheOverflows;
+    }
+    result.averageSeconds = total / CROWD_BENCH_TICKS;
+    for (int i = 0; i < characterCount; i++) result.grounded += grounded[i];
+    RL_FREE(caches);
+    RL_FREE(cacheStorage);
+    RL_FREE(grounded);
+    RL_FREE(moveSpeeds);
+    RL_FREE(wishDirections);
+    RL_FREE(velocities);
+    RL_FREE(positions);
+    RL_FREE(capsules);
+    return result;
+}
+// Thousands of characters on the stress level, stepped at a fixed 60 Hz through the batch
+// controller on all cores, once querying the world directly and once through per-character caches
+int RunCrowdBenchmark(int characterCount) {
+    if (characterCount <= 0) characterCount = CROWD_BENCH_DEFAULT_COUNT;
+    JobSystemInit(JOB_WORKERS_AUTO);
+    CollisionMesh mesh = GenerateStressLevel(CROWD_BENCH_TRIANGLES, JOB_BENCH_LEVEL_SIZE, BENCH_SEED);
+    CollisionWorld world = { 0 };
+    AddCollisionMesh(&world, &mesh);
+    TraceLog(LOG_INFO, "BENCH: Crowd: %d characters (1 in %d idle), %d triangles, %d threads", characterCount, CROWD_BENCH_IDLE_EVERY,
+        mesh.triangleCount, JobWorkerCount() + 1);
+    TraceLog(LOG_INFO, "BENCH: mode    avg ms  worst ms  over budget  grounded  idle/tick  cached/tick  refresh/tick  overflow/tick");
+    for (int cached = 0; cached < 2; cached++) {
+        CrowdBenchResult result = RunCrowdCase(&world, characterCount, cached);
+        TraceLog(LOG_INFO, "BENCH: %-6s %7.2f %9.2f %8d/%d %9d %10.0f %12.0f %13.1f %14.1f", cached ? "cache" : "world",
+            result.averageSeconds * 1000.0, result.worstSeconds * 1000.0, result.overBudget, CROWD_BENCH_TICKS, result.grounded,
+            (double)result.idleSkips / CROWD_BENCH_TICKS, (double)result.cacheHits / CROWD_BENCH_TICKS,
+            (double)result.cacheRefreshes / CROWD_BENCH_TICKS, (double)result.cacheOverflows / CROWD_BENCH_TICKS);
+    }
+    UnloadCollisionMesh(&mesh);
+    JobSystemShutdown();
+    return 0;
+}
+static int ComparePairs(const void* a, const void* b) {
+    const CapsulePair* pairA = a;
+    const CapsulePair* pairB = b;
+    if (pairA->a != pairB->a) return (pairA->a > pairB->a) - (pairA->a < pairB->a);
+    return (pairA->b > pairB->b) - (pairA->b < pairB->b);
+}
+// O(n^2) reference pair set, sorted, for checking the sweep. Returns the pair count
+static int FindPairsBruteForce(const CapsuleBroadphase* broadphase, int count, CapsulePair* pairs) {
+    int pairCount = 0;
+    for (int i = 0; i < count; i++) {
+        for (int j = i + 1; j < count; j++) {
+            if (CheckCollisionBoxes(broadphase->bounds[i], broadphase->bounds[j])) pairs[pairCount++] = (CapsulePair){ i, j };
+        }
+    }
+    qsort(pairs, pairCount, sizeof(CapsulePair), ComparePairs);
+    return pairCount;
+}
+// Actor-vs-actor pair finding for a crowd on a flat plane at constant density, each character
+// wandering a little every tick so the sweep order is mostly preserved between updates
+static int RunBroadphaseCase(int count) {
+    float extent = sqrtf((float)count) * BROADPHASE_BENCH_SPACING;
+    CollisionCapsule* capsules = RL_CALLOC(count, sizeof(CollisionCapsule));
+    Vector3* positions = RL_MALLOC(sizeof(Vector3) * count);
+    float* headings = RL_MALLOC(sizeof(float) * count);
+    unsigned int state = BENCH_SEED;
+    for (int i = 0; i < count; i++) {
+        positions[i] = (Vector3){ StressRandomFloat(&state, 0.0f, extent), 0.0f, StressRandomFloat(&state, 0.0f, extent) };
+        capsules[i] = (CollisionCapsule){ positions[i], BROADPHASE_BENCH_RADIUS, BROADPHASE_BENCH_HEIGHT / 2.0f, true };
+        headings[i] = StressRandomFloat(&state, 0.0f, 2.0f * PI);
+    }
+    CapsuleBroadphase broadphase;
+    InitCapsuleBroadphase(&broadphase);
+    CapsulePair* reference = NULL;
+    int referenceCapacity = 0;
+    double firstSeconds = 0.0, updateSeconds = 0.0, narrowSeconds = 0.0, bruteSeconds = 0.0;
+    long long totalPairs = 0, totalContacts = 0, totalSwaps = 0;
+    int bruteRuns = 0, failures = 0;
+    for (int tick = 0; tick < BROADPHASE_BENCH_TICKS; tick++) {
+        double start = PlatformTime();
+        int pairCount = UpdateCapsuleBroadphase(&broadphase, positions, capsules, count);
+        double elapsed = PlatformTime() - start;
+        if (tick == 0) firstSeconds = elapsed;
+        else {
+            updateSeconds += elapsed;
+            totalSwaps += broadphase.lastSwapCount;
+        }
+        totalPairs += pairCount;
+        if (tick % BROADPHASE_BENCH_CHECK_INTERVAL == 0) {
+            if (referenceCapacity < pairCount * 2 + count) {
+                referenceCapacity = pairCount * 2 + count;
+                RL_FREE(reference);
+                reference = RL_MALLOC(sizeof(CapsulePair) * referenceCapacity);
+            }
+            double bruteStart = PlatformTime();
+            int referenceCount = FindPairsBruteForce(&broadphase, count, reference);
+            bruteSeconds += PlatformTime() - bruteStart;
+            bruteRuns++;
+            qsort(broadphase.pairs, pairCount, sizeof(CapsulePair), ComparePairs);
+            if (referenceCount != pairCount || memcmp(reference, broadphase.pairs, sizeof(CapsulePair) * pairCount) != 0) {
+                TraceLog(LOG_WARNING, "BENCH: %d actors tick %d: sweep found %d pairs, brute force %d", count, tick, pairCount, referenceCount);
+                failures++;
+            }
+        }
+        start = PlatformTime();
+        totalContacts += SeparateCapsulePairs(&broadphase, positions, capsules);
+        narrowSeconds += PlatformTime() - start;
+        for (int i = 0; i < count; i++) {
+            headings[i] += StressRandomFloat(&state, -0.3f, 0.3f);
+            positions[i].x = Clamp(positions[i].x + sinf(headings[i]) * 2.0f * CROWD_BENCH_STEP, 0.0f, extent);
+            positions[i].z = Clamp(positions[i].z + cosf(headings[i]) * 2.0f * CROWD_BENCH_STEP, 0.0f, extent);
+        }
+    }
+    int incrementalTicks = BROADPHASE_BENCH_TICKS - 1;
+    TraceLog(LOG_INFO, "BENCH: %6d %9.3f %11.3f %9.0f %9.0f %8.3f %9.2f %10.0f%s", count, firstSeconds * 1000.0,
+        updateSeconds / incrementalTicks * 1000.0, (double)totalSwaps / incrementalTicks, (double)totalPairs / BROADPHASE_BENCH_TICKS,
+        narrowSeconds / BROADPHASE_BENCH_TICKS * 1000.0, bruteSeconds / bruteRuns * 1000.0, (double)totalContacts / BROADPHASE_BENCH_TICKS,
+        failures ? "  MISMATCH" : "");
+    RL_FREE(reference);
+    FreeCapsuleBroadphase(&broadphase);
+    RL_FREE(headings);
+    RL_FREE(positions);
+    RL_FREE(capsules);
+    return failures;
+}
+int RunBroadphaseBenchmark(int maxCount) {
+    TraceLog(LOG_INFO, "BENCH: Capsule broadphase: sweep and prune on X, %d ticks, checked against brute force every %d",
+        BROADPHASE_BENCH_TICKS, BROADPHASE_BENCH_CHECK_INTERVAL);
+    TraceLog(LOG_INFO, "BENCH: actors  first ms  update ms     swaps     pairs  pair ms  brute ms   contacts");
+    int failures = 0;
+    for (int i = 0; i < (int)(sizeof(BROADPHASE_BENCH_COUNTS) / sizeof(BROADPHASE_BENCH_COUNTS[0])); i++) {
+        if (maxCount > 0 && BROADPHASE_BENCH_COUNTS[i] > maxCount) break;
+        failures += RunBroadphaseCase(BROADPHASE_BENCH_COUNTS[i]);
+    }
+    return failures;
+}
+// Flattens the collision triangles back into a CPU-only raylib mesh so GetRayCollisionMesh can
+// serve as the brute-force reference
+static Mesh GetReferenceMesh(const CollisionMesh* collision) {
+    Mesh mesh = { 0 };
+    mesh.vertexCount = collision->triangleCount * 3;
+    mesh.triangleCount = collision->triangleCount;
+    mesh.vertices = RL_MALLOC(sizeof(float) * 9 * collision->triangleCount);
+    for (int i = 0; i < collision->triangleCount && mesh.vertices; i++) {
+        const Triangle* tri = &collision->triangles[i];
+        Vector3 corners[3] = { tri->v0, tri->v1, tri->v2 };
+        for (int j = 0; j < 3; j++) {
+            mesh.vertices[i * 9 + j * 3 + 0] = corners[j].x;
+            mesh.vertices[i * 9 + j * 3 + 1] = corners[j].y;
+            mesh.vertices[i * 9 + j * 3 + 2] = corners[j].z;
+        }
+    }
+    return mesh;
+}
+// Random rays over the stress level through the BVH casts, checked against raylib's per-triangle
+// GetRayCollisionMesh
+int RunRaycastBenchmark(int triangleCount) {
+    if (triangleCount <= 0) triangleCount = RAY_BENCH_TRIANGLES;
+    CollisionMesh collision = GenerateStressLevel(triangleCount, JOB_BENCH_LEVEL_SIZE, BENCH_SEED);
+    CollisionWorld world = { 0 };
+    AddCollisionMesh(&world, &collision);
+    Mesh reference = GetReferenceMesh(&collision);
+    Ray* rays = RL_MALLOC(sizeof(Ray) * RAY_BENCH_RAYS);
+    CollisionHit* hits = RL_MALLOC(sizeof(CollisionHit) * RAY_BENCH_RAYS);
+    unsigned int state = BENCH_SEED;
+    for (int i = 0; i < RAY_BENCH_RAYS; i++) {
+        Vector3 origin = {
+            StressRandomFloat(&state, collision.bounds.min.x, collision.bounds.max.x),
+            StressRandomFloat(&state, 0.0f, collision.bounds.max.y + 5.0f),
+            StressRandomFloat(&state, collision.bounds.min.z, collision.bounds.max.z)
+        };
+        Vector3 direction = { StressRandomFloat(&state, -1.0f, 1.0f), StressRandomFloat(&state, -1.0f, 0.2f), StressRandomFloat(&state, -1.0f, 1.0f) };
+        rays[i] = (Ray){ origin, Vector3Normalize(direction) };
+    }
+    double start = PlatformTime();
+    for (int i = 0; i < RAY_BENCH_RAYS; i++) hits[i] = RaycastWorld(&world, rays[i], RAY_BENCH_DISTANCE);
+    double bvhSeconds = PlatformTime() - start;
+    int hitCount = 0, failures = 0;
+    start = PlatformTime();
+    for (int i = 0; i < RAY_BENCH_RAYS; i++) {
+        RayCollision expected = GetRayCollisionMesh(rays[i], reference, MatrixIdentity());
+        bool expectedHit = expected.hit && expected.distance <= RAY_BENCH_DISTANCE;
+        hitCount += expectedHit;
+        if (expectedHit != hits[i].hit || (expectedHit && fabsf(expected.distance - hits[i].distance) > RAY_BENCH_TOLERANCE)) failures++;
+    }
+    double bruteSeconds = PlatformTime() - start;
+    start = PlatformTime();
+    for (int i = 0; i < RAY_BENCH_RAYS; i++) SphereCastWorld(&world, rays[i].position, RAY_BENCH_SPHERE_RADIUS, rays[i].direction, RAY_BENCH_DISTANCE);
+    double sphereSeconds = PlatformTime() - start;
+    start = PlatformTime();
+    for (int i = 0; i < RAY_BENCH_RAYS; i++) CapsuleCastWorld(&world, rays[i].position, JOB_BENCH_HEIGHT, JOB_BENCH_RADIUS, rays[i].direction, RAY_BENCH_DISTANCE);
+    double capsuleSeconds = PlatformTime() - start;
+    TraceLog(LOG_INFO, "BENCH: Casts: %d triangles, %d rays up to %.0f m, %d hit", collision.triangleCount, RAY_BENCH_RAYS, RAY_BENCH_DISTANCE, hitCount);
+    TraceLog(LOG_INFO, "BENCH: GetRayCollisionMesh %9.2f us/ray", bruteSeconds * 1e6 / RAY_BENCH_RAYS);
+    TraceLog(LOG_INFO, "BENCH: RaycastWorld        %9.2f us/ray (%.0fx) | %d mismatches", bvhSeconds * 1e6 / RAY_BENCH_RAYS, bruteSeconds / bvhSeconds, failures);
+    TraceLog(LOG_INFO, "BENCH: SphereCastWorld     %9.2f us/cast (radius %.1f)", sphereSeconds * 1e6 / RAY_BENCH_RAYS, RAY_BENCH_SPHERE_RADIUS);
+    TraceLog(LOG_INFO, "BENCH: CapsuleCastWorld    %9.2f us/cast (radius %.1f, height %.1f)", capsuleSeconds * 1e6 / RAY_BENCH_RAYS,
+        JOB_BENCH_RADIUS, JOB_BENCH_HEIGHT);
+    RL_FREE(hits);
+    RL_FREE(rays);
+    RL_FREE(reference.vertices);
+    UnloadCollisionMesh(&collision);
+    return failures;
+}
+// Just enough OBJ for a collision benchmark: positions and polygon faces, fanned into triangles in
+// file order. LoadModel would need a GL context to upload the meshes, which a headless run does not have.
+static CollisionMesh ParseObjTriangles(const char* fileName, Matrix transform) {
+    CollisionMesh mesh = { .slopes = GetCollisionSlopeSettings(COLLISION_FLOOR_SLOPE_DEGREES, COLLISION_CEILING_SLOPE_DEGREES) };
+    char* text = LoadFileText(fileName);
+    if (!text) return mesh;
+    int vertexCount = 0, vertexCapacity = 0, triangleCapacity = 0;
+    Vector3* vertices = NULL;
+    mesh.bounds = (BoundingBox){ { 1e30f, 1e30f, 1e30f }, { -1e30f, -1e30f, -1e30f } };
+    MemoryTag previousTag = PushMemoryTag(MEMORY_TAG_COLLISION);
+    for (char* line = text; line && *line; ) {
+        char* next = strchr(line, '\n');
+        if (next) *next++ = '\0';
+        Vector3 v;
+        if (line[0] == 'v' && line[1] == ' ' && sscanf(line + 2, "%f %f %f", &v.x, &v.y, &v.z) == 3) {
+            if (vertexCount == vertexCapacity) {
+                vertexCapacity = vertexCapacity ? vertexCapacity * 2 : 1024;
+                vertices = RL_REALLOC(vertices, sizeof(Vector3) * vertexCapacity);
+            }
+            vertices[vertexCount++] = Vector3Transform(v, transform);
+        } else if (line[0] == 'f' && line[1] == ' ') {
+            int corners[3], cornerCount = 0;
+            for (char* token = line + 2; *token; ) {
+                while (*token == ' ' || *token == '\t' || *token == '\r') token++;
+                if (!*token) break;
+                int index = atoi(token);
+                index = index < 0 ? vertexCount + index : index - 1;
+                while (*token && *token != ' ' && *token != '\t') token++;
+                if (index < 0 || index >= vertexCount) continue;
+                if (cornerCount < 3) corners[cornerCount++] = index;
+                else {
+                    corners[1] = corners[2];
+                    corners[2] = index;
+                }
+                if (cornerCount < 3) continue;
+                if (mesh.triangleCount == triangleCapacity) {
+                    triangleCapacity = triangleCapacity ? triangleCapacity * 2 : 1024;
+                    mesh.triangles = RL_REALLOC(mesh.triangles, sizeof(Triangle) * triangleCapacity);
+                }
+                Vector3 a = vertices[corners[0]], b = vertices[corners[1]], c = vertices[corners[2]];
+                Triangle tri = { a, b, c, Vector3Normalize(Vector3CrossProduct(Vector3Subtract(b, a), Vector3Subtract(c, a))), 0 };
+                if (Vector3LengthSqr(tri.normal) < 0.001f) continue;
+                mesh.triangles[mesh.triangleCount++] = tri;
+                mesh.bounds.min = Vector3Min(mesh.bounds.min, Vector3Min(a, Vector3Min(b, c)));
+                mesh.bounds.max = Vector3Max(mesh.bounds.max, Vector3Max(a, Vector3Max(b, c)));
+            }
+        }
+        line = next;
+    }
+    PopMemoryTag(previousTag);
+    RL_FREE(vertices);
+    UnloadFileText(text);
+    return mesh;
+}
+static CollisionMesh LoadObjCollisionMesh(const char* fileName, Matrix transform) {
+    CollisionMesh mesh = ParseObjTriangles(fileName, transform);
+    BuildCollisionBvh(&mesh);
+    return mesh;
+}
+// Pinhole camera rays for one view, laid out tile by tile so each run of tileWidth * tileHeight
+// rays is one screen-space tile, the way a packet tracer would issue them
+static void GetViewRays(Vector3 eye, Vector3 target, int tileWidth, int tileHeight, Ray* rays) {
+    Vector3 forward = Vector3Normalize(Vector3Subtract(target, eye));
+    Vector3 right = Vector3Normalize(Vector3CrossProduct(forward, (Vector3){ 0.0f, 1.0f, 0.0f }));
+    Vector3 up = Vector3CrossProduct(right, forward);
+    float halfExtent = tanf(PACKET_BENCH_FOV * 0.5f * DEG2RAD);
+    int count = 0;
+    for (int tileY = 0; tileY < PACKET_BENCH_RESOLUTION; tileY += tileHeight) {
+        for (int tileX = 0; tileX < PACKET_BENCH_RESOLUTION; tileX += tileWidth) {
+            for (int y = tileY; y < tileY + tileHeight; y++) {
+                for (int x = tileX; x < tileX + tileWidth; x++) {
+                    float u = ((float)x + 0.5f) / (float)PACKET_BENCH_RESOLUTION * 2.0f - 1.0f;
+                    float v = 1.0f - ((float)y + 0.5f) / (float)PACKET_BENCH_RESOLUTION * 2.0f;
+                    Vector3 direction = Vector3Add(forward, Vector3Add(Vector3Scale(right, u * halfExtent), Vector3Scale(up, v * halfExtent)));
+                    rays[count++] = (Ray){ eye, Vector3Normalize(direction) };
+                }
+            }
+        }
+    }
+}
+static int CountHitMismatches(const CollisionHit* hits, const CollisionHit* reference, int count) {
+    int mismatches = 0;
+    for (int i = 0; i < count; i++) {
+        if (hits[i].hit != reference[i].hit || (hits[i].hit && fabsf(hits[i].distance - reference[i].distance) > RAY_BENCH_TOLERANCE)) mismatches++;
+    }
+    return mismatches;
+}
+static double MegaraysPerSecond(int rays, double seconds) {
+    return (double)rays / seconds / 1e6;
+}
+// Coherent camera tiles traced one ray at a time and as 4, 8 and 16-ray packets, then random rays
+// one at a time and through the sorting stream, all on the first cell of the world layout
+int RunPacketRayBenchmark(const char* worldFile) {
+    static World world;
+    if (!LoadWorldLayout(&world, worldFile, (WorldStreamingSettings){ 0 })) return 1;
+    const WorldCell* cell = &world.cells[0];
+    Matrix transform = MatrixMultiply(MatrixScale(cell->scale, cell->scale, cell->scale), MatrixTranslate(cell->position.x, cell->position.y, cell->position.z));
+    CollisionMesh mesh = LoadObjCollisionMesh(cell->modelPath, transform);
+    pthread_mutex_destroy(&world.lock);
+    if (mesh.triangleCount == 0) {
+        TraceLog(LOG_WARNING, "BENCH: [%s] No triangles to trace; packet benchmark needs an OBJ cell", cell->modelPath);
+        return 1;
+    }
+    CollisionWorld collision = { 0 };
+    AddCollisionMesh(&collision, &mesh);
+    FrameArenaInit(FRAME_ARENA_RENDER, PACKET_BENCH_ARENA_BYTES);
+    int viewRays = PACKET_BENCH_RESOLUTION * PACKET_BENCH_RESOLUTION;
+    int rayCount = viewRays * PACKET_BENCH_VIEWS;
+    Ray* rays = RL_MALLOC(sizeof(Ray) * rayCount);
+    CollisionHit* reference = RL_MALLOC(sizeof(CollisionHit) * rayCount);
+    CollisionHit* hits = RL_MALLOC(sizeof(CollisionHit) * rayCount);
+    Vector3 eyes[PACKET_BENCH_VIEWS], targets[PACKET_BENCH_VIEWS];
+    unsigned int state = BENCH_SEED;
+    Vector3 center = Vector3Scale(Vector3Add(mesh.bounds.min, mesh.bounds.max), 0.5f);
+    for (int i = 0; i < PACKET_BENCH_VIEWS; i++) {
+        eyes[i] = (Vector3){
+            StressRandomFloat(&state, mesh.bounds.min.x, mesh.bounds.max.x) * 0.8f,
+            StressRandomFloat(&state, center.y, mesh.bounds.max.y),
+            StressRandomFloat(&state, mesh.bounds.min.z, mesh.bounds.max.z) * 0.8f
+        };
+        targets[i] = (Vector3){ StressRandomFloat(&state, mesh.bounds.min.x, mesh.bounds.max.x), mesh.bounds.min.y,
+            StressRandomFloat(&state, mesh.bounds.min.z, mesh.bounds.max.z) };
+    }
+    TraceLog(LOG_INFO, "BENCH: Packet rays: [%s] %d triangles, %d views of %dx%d, %d SIMD lanes", cell->modelPath,
+        mesh.triangleCount, PACKET_BENCH_VIEWS, PACKET_BENCH_RESOLUTION, PACKET_BENCH_RESOLUTION, RAY_LANES);
+    int failures = 0;
+    for (int s = -1; s < (int)(sizeof(PACKET_BENCH_SIZES) / sizeof(PACKET_BENCH_SIZES[0])); s++) {
+        int packetSize = s < 0 ? 1 : PACKET_BENCH_SIZES[s];
+        // Square tiles for 1, 4 and 16 rays, 4x2 for 8
+        int tileWidth = packetSize == 8 ? 4 : (int)sqrtf((float)packetSize);
+        int tileHeight = packetSize / tileWidth;
+        for (int view = 0; view < PACKET_BENCH_VIEWS; view++) GetViewRays(eyes[view], targets[view], tileWidth, tileHeight, &rays[view * viewRays]);
+        double best = 1e30;
+        for (int run = 0; run < BENCH_REPEATS; run++) {
+            double start = PlatformTime();
+            if (packetSize == 1) {
+                for (int i = 0; i < rayCount; i++) hits[i] = RaycastWorld(&collision, rays[i], PACKET_BENCH_DISTANCE);
+            } else {
+                for (int i = 0; i < rayCount; i += packetSize) RaycastPacket(&collision, &rays[i], packetSize, PACKET_BENCH_DISTANCE, &hits[i]);
+            }
+            double elapsed = PlatformTime() - start;
+            if (elapsed < best) best = elapsed;
+        }
+        int mismatches = 0;
+        if (packetSize > 1) {
+            for (int i = 0; i < rayCount; i++) reference[i] = RaycastWorld(&collision, rays[i], PACKET_BENCH_DISTANCE);
+            mismatches = CountHitMismatches(hits, reference, rayCount);
+            failures += mismatches;
+        }
+        TraceLog(LOG_INFO, "BENCH: coherent %-8s %7.2f Mrays/s%s", packetSize == 1 ? "single" : TextFormat("packet %d", packetSize),
+            MegaraysPerSecond(rayCount, best), mismatches ? TextFormat("  %d MISMATCHES", mismatches) : "");
+    }
+    for (int i = 0; i < rayCount; i++) {
+        Vector3 origin = {
+            StressRandomFloat(&state, mesh.bounds.min.x, mesh.bounds.max.x),
+            StressRandomFloat(&state, mesh.bounds.min.y, mesh.bounds.max.y),
+            StressRandomFloat(&state, mesh.bounds.min.z, mesh.bounds.max.z)
+        };
+        Vector3 direction = { StressRandomFloat(&state, -1.0f, 1.0f), StressRandomFloat(&state, -1.0f, 1.0f), StressRandomFloat(&state, -1.0f, 1.0f) };
+        rays[i] = (Ray){ origin, Vector3Normalize(direction) };
+    }
+    double singleBest = 1e30, streamBest = 1e30;
+    for (int run = 0; run < BENCH_REPEATS; run++) {
+        double start = PlatformTime();
+        for (int i = 0; i < rayCount; i++) reference[i] = RaycastWorld(&collision, rays[i], PACKET_BENCH_DISTANCE);
+        double elapsed = PlatformTime() - start;
+        if (elapsed < singleBest) singleBest = elapsed;
+        FrameArenaBeginFrame(FRAME_ARENA_RENDER);
+        start = PlatformTime();
+        RaycastStream(&collision, rays, rayCount, PACKET_BENCH_DISTANCE, hits);
+        elapsed = PlatformTime() - start;
+        if (elapsed < streamBest) streamBest = elapsed;
+    }
+    int mismatches = CountHitMismatches(hits, reference, rayCount);
+    failures += mismatches;
+    TraceLog(LOG_INFO, "BENCH: random   single   %7.2f Mrays/s", MegaraysPerSecond(rayCount, singleBest));
+    TraceLog(LOG_INFO, "BENCH: random   stream   %7.2f Mrays/s (sorted into %d-ray packets)%s", MegaraysPerSecond(rayCount, streamBest),
+        RAY_PACKET_MAX, mismatches ? TextFormat("  %d MISMATCHES", mismatches) : "");
+    RL_FREE(hits);
+    RL_FREE(reference);
+    RL_FREE(rays);
+    FrameArenaShutdown();
+    UnloadCollisionMesh(&mesh);
+    return failures;
+}
+static size_t GetCollisionMeshBytes(const CollisionMesh* mesh) {
+    return sizeof(Triangle) * mesh->triangleCount + sizeof(CollisionBvhNode) * mesh->nodeCount;
+}
+// Every instance's triangles carried into world space and merged into one mesh under one BVH
+static CollisionMesh BakeCollisionInstances(CollisionInstance* const* instances, int count) {
+    int triangleCount = 0;
+    for (int i = 0; i < count; i++) triangleCount += instances[i]->mesh->triangleCount;
+    CollisionMesh baked = { .slopes = GetCollisionSlopeSettings(COLLISION_FLOOR_SLOPE_DEGREES, COLLISION_CEILING_SLOPE_DEGREES) };
+    baked.triangles = RL_MALLOC(sizeof(Triangle) * triangleCount);
+    if (!baked.triangles) return baked;
+    baked.bounds = (BoundingBox){ { 1e30f, 1e30f, 1e30f }, { -1e30f, -1e30f, -1e30f } };
+    for (int i = 0; i < count; i++) {
+        Matrix transform = instances[i]->transform;
+        const CollisionMesh* mesh = instances[i]->mesh;
+        for (int j = 0; j < mesh->triangleCount; j++) {
+            Triangle tri = mesh->triangles[j];
+            tri.v0 = Vector3Transform(tri.v0, transform);
+            tri.v1 = Vector3Transform(tri.v1, transform);
+            tri.v2 = Vector3Transform(tri.v2, transform);
+            tri.normal = Vector3Normalize(Vector3CrossProduct(Vector3Subtract(tri.v1, tri.v0), Vector3Subtract(tri.v2, tri.v0)));
+            baked.triangles[baked.triangleCount++] = tri;
+            baked.bounds.min = Vector3Min(baked.bounds.min, Vector3Min(tri.v0, Vector3Min(tri.v1, tri.v2)));
+            baked.bounds.max = Vector3Max(baked.bounds.max, Vector3Max(tri.v0, Vector3Max(tri.v1, tri.v2)));
+        }
+    }
+    BuildCollisionBvh(&baked);
+    return baked;
+}
+static double TimeCapsuleQueries(const CollisionWorld* world, const Vector3* positions, Vector3* results, int count) {
+    CapsuleQueryBatch batch = { world, positions, results };
+    double best = 1e30;
+    for (int run = 0; run < BENCH_REPEATS; run++) {
+        double start = PlatformTime();
+        RunCapsuleQueries(&batch, 0, count);
+        double elapsed = PlatformTime() - start;
+        if (elapsed < best) best = elapsed;
+    }
+    return best;
+}
+// A room dense with props drawn from a handful of unique meshes, queried three ways: instances
+// under the top-level tree, the same instances walked one by one, and every prop baked into one
+// world-space mesh. Floors and rays must agree between the instanced and baked worlds.
+int RunPropBenchmark(int propCount) {
+    if (propCount <= 0) propCount = PROP_BENCH_DEFAULT_COUNT;
+    int side = (int)ceilf(sqrtf((float)propCount));
+    float roomSize = side * PROP_BENCH_SPACING;
+    CollisionMesh room = GenerateStressLevel(PROP_BENCH_ROOM_TRIANGLES, roomSize, BENCH_SEED);
+    CollisionWorld roomOnly = { 0 };
+    AddCollisionMesh(&roomOnly, &room);
+    CollisionMesh propMeshes[PROP_BENCH_UNIQUE_MESHES];
+    size_t uniqueBytes = 0;
+    for (int i = 0; i < PROP_BENCH_UNIQUE_MESHES; i++) {
+        propMeshes[i] = GenerateStressLevel(PROP_BENCH_MESH_TRIANGLES, PROP_BENCH_MESH_SIZE, BENCH_SEED + 1 + i);
+        uniqueBytes += GetCollisionMeshBytes(&propMeshes[i]);
+    }
+    CollisionInstance* instances = RL_MALLOC(sizeof(CollisionInstance) * propCount);
+    CollisionWorld world = { 0 };
+    AddCollisionMesh(&world, &room);
+    unsigned int state = BENCH_SEED;
+    for (int i = 0; i < propCount; i++) {
+        Vector3 position = {
+            room.bounds.min.x + ((i % side) + StressRandomFloat(&state, 0.25f, 0.75f)) * PROP_BENCH_SPACING,
+            0.0f,
+            room.bounds.min.z + ((i / side) + StressRandomFloat(&state, 0.25f, 0.75f)) * PROP_BENCH_SPACING
+        };
+        Vector3 floorNormal;
+        position.y = FindFloor(&roomOnly, (Vector3){ position.x, room.bounds.max.y, position.z }, &floorNormal);
+        float scale = StressRandomFloat(&state, 0.8f, 1.2f);
+        Matrix transform = MatrixMultiply(MatrixMultiply(MatrixScale(scale, scale, scale), MatrixRotateY(StressRandomFloat(&state, 0.0f, 2.0f * PI))),
+            MatrixTranslate(position.x, position.y, position.z));
+        instances[i] = (CollisionInstance){ .mesh = &propMeshes[StressRandom(&state) % PROP_BENCH_UNIQUE_MESHES] };
+        SetCollisionInstanceTransform(&instances[i], transform);
+        AddCollisionInstance(&world, &instances[i]);
+    }
+    double start = PlatformTime();
+    UpdateCollisionInstanceTree(&world);
+    double buildSeconds = PlatformTime() - start;
+    start = PlatformTime();
+    for (int i = 0; i < PROP_BENCH_REFITS; i++) UpdateCollisionInstanceTree(&world);
+    double refitSeconds = (PlatformTime() - start) / PROP_BENCH_REFITS;
+    start = PlatformTime();
+    CollisionMesh baked = BakeCollisionInstances(world.instances, propCount);
+    double bakeSeconds = PlatformTime() - start;
+    CollisionWorld bakedWorld = { 0 };
+    AddCollisionMesh(&bakedWorld, &room);
+    AddCollisionMesh(&bakedWorld, &baked);
+    size_t instancedBytes = uniqueBytes + sizeof(CollisionInstance) * propCount +
+        (sizeof(CollisionInstance*) + 2 * sizeof(CollisionBvhNode)) * world.instanceCapacity;
+    size_t bakedBytes = GetCollisionMeshBytes(&baked);
+    Vector3* positions = RL_MALLOC(sizeof(Vector3) * PROP_BENCH_QUERIES);
+    Vector3* results = RL_MALLOC(sizeof(Vector3) * PROP_BENCH_QUERIES);
+    Ray* rays = RL_MALLOC(sizeof(Ray) * PROP_BENCH_QUERIES);
+    for (int i = 0; i < PROP_BENCH_QUERIES; i++) {
+        positions[i] = (Vector3){
+            StressRandomFloat(&state, room.bounds.min.x, room.bounds.max.x),
+            StressRandomFloat(&state, room.bounds.min.y, room.bounds.max.y + PROP_BENCH_MESH_SIZE),
+            StressRandomFloat(&state, room.bounds.min.z, room.bounds.max.z)
+        };
+        Vector3 direction = { StressRandomFloat(&state, -1.0f, 1.0f), StressRandomFloat(&state, -1.0f, 0.2f), StressRandomFloat(&state, -1.0f, 1.0f) };
+        rays[i] = (Ray){ positions[i], Vector3Normalize(direction) };
+    }
+    int failures = 0;
+    for (int i = 0; i < PROP_BENCH_QUERIES; i++) {
+        Vector3 normal;
+        float instanced = FindFloor(&world, positions[i], &normal);
+        float flat = FindFloor(&bakedWorld, positions[i], &normal);
+        CollisionHit instancedHit = RaycastWorld(&world, rays[i], RAY_BENCH_DISTANCE);
+        CollisionHit bakedHit = RaycastWorld(&bakedWorld, rays[i], RAY_BENCH_DISTANCE);
+        if (fabsf(instanced - flat) > RAY_BENCH_TOLERANCE || instancedHit.hit != bakedHit.hit ||
+            (instancedHit.hit && fabsf(instancedHit.distance - bakedHit.distance) > RAY_BENCH_TOLERANCE)) failures++;
+    }
+    double treeSeconds = TimeCapsuleQueries(&world, positions, results, PROP_BENCH_QUERIES);
+    world.instanceTreeDirty = true;
+    double listSeconds = TimeCapsuleQueries(&world, positions, results, PROP_BENCH_QUERIES);
+    world.instanceTreeDirty = false;
+    double bakedSeconds = TimeCapsuleQueries(&bakedWorld, positions, results, PROP_BENCH_QUERIES);
+    start = PlatformTime();
+    for (int i = 0; i < PROP_BENCH_QUERIES; i++) RaycastWorld(&world, rays[i], RAY_BENCH_DISTANCE);
+    double treeRaySeconds = PlatformTime() - start;
+    start = PlatformTime();
+    for (int i = 0; i < PROP_BENCH_QUERIES; i++) RaycastWorld(&bakedWorld, rays[i], RAY_BENCH_DISTANCE);
+    double bakedRaySeconds = PlatformTime() - start;
+    TraceLog(LOG_INFO, "BENCH: Props: %d instances of %d unique meshes (%d triangles each) in a %.0f m room of %d triangles",
+        propCount, PROP_BENCH_UNIQUE_MESHES, propMeshes[0].triangleCount, roomSize, room.triangleCount);
+    TraceLog(LOG_INFO, "BENCH: memory   instanced %8.1f KB | baked %8.1f KB (%d triangles)", instancedBytes / 1024.0, bakedBytes / 1024.0,
+        baked.triangleCount);
+    TraceLog(LOG_INFO, "BENCH: build    tree %.3f ms, refit %.3f ms | bake %.2f ms", buildSeconds * 1000.0, refitSeconds * 1000.0,
+        bakeSeconds * 1000.0);
+    TraceLog(LOG_INFO, "BENCH: capsule  tree %6.2f us | instance list %6.2f us | baked %6.2f us per query",
+        treeSeconds * 1e6 / PROP_BENCH_QUERIES, listSeconds * 1e6 / PROP_BENCH_QUERIES, bakedSeconds * 1e6 / PROP_BENCH_QUERIES);
+    TraceLog(LOG_INFO, "BENCH: ray      tree %6.2f us | baked %6.2f us per ray | %d mismatches", treeRaySeconds * 1e6 / PROP_BENCH_QUERIES,
+        bakedRaySeconds * 1e6 / PROP_BENCH_QUERIES, failures);
+    RL_FREE(rays);
+    RL_FREE(results);
+    RL_FREE(positions);
+    FreeCollisionWorld(&world);
+    UnloadCollisionMesh(&baked);
+    RL_FREE(instances);
+    for (int i = 0; i < PROP_BENCH_UNIQUE_MESHES; i++) UnloadCollisionMesh(&propMeshes[i]);
+    UnloadCollisionMesh(&room);
+    return failures;
+}
+// Simplifies a copy of mesh and runs the same capsule queries on both. Floors may move by the
+// reported position error and no further.
+static int RunSimplifyCase(const char* name, const CollisionMesh* mesh, CollisionSimplifySettings settings) {
+    CollisionMesh simplified = *mesh;
+    simplified.triangles = RL_MALLOC(sizeof(Triangle) * mesh->triangleCount);
+    simplified.nodes = NULL;
+    if (!simplified.triangles) return 1;
+    memcpy(simplified.triangles, mesh->triangles, sizeof(Triangle) * mesh->triangleCount);
+    double start = PlatformTime();
+    CollisionSimplifyReport report = SimplifyCollisionMesh(&simplified, settings);
+    double buildSeconds = PlatformTime() - start;
+    CollisionWorld before = { 0 }, after = { 0 };
+    AddCollisionMesh(&before, (CollisionMesh*)mesh);
+    AddCollisionMesh(&after, &simplified);
+    Vector3* positions = RL_MALLOC(sizeof(Vector3) * SIMPLIFY_BENCH_QUERIES);
+    Vector3* results = RL_MALLOC(sizeof(Vector3) * SIMPLIFY_BENCH_QUERIES);
+    unsigned int state = BENCH_SEED;
+    for (int i = 0; i < SIMPLIFY_BENCH_QUERIES; i++) {
+        positions[i] = (Vector3){
+            StressRandomFloat(&state, mesh->bounds.min.x, mesh->bounds.max.x),
+            StressRandomFloat(&state, mesh->bounds.min.y, mesh->bounds.max.y),
+            StressRandomFloat(&state, mesh->bounds.min.z, mesh->bounds.max.z)
+        };
+    }
+    int floorMismatches = 0;
+    for (int i = 0; i < SIMPLIFY_BENCH_QUERIES; i++) {
+        Vector3 normal;
+        float original = FindFloor(&before, positions[i], &normal);
+        float reduced = FindFloor(&after, positions[i], &normal);
+        // A floor point may sit over a collapsed fan's new diagonal: allow the error plus a sliver
+        if (fabsf(original - reduced) > report.maxError + RAY_BENCH_TOLERANCE) floorMismatches++;
+    }
+    double beforeSeconds = TimeCapsuleQueries(&before, positions, results, SIMPLIFY_BENCH_QUERIES);
+    double afterSeconds = TimeCapsuleQueries(&after, positions, results, SIMPLIFY_BENCH_QUERIES);
+    TraceLog(LOG_INFO, "BENCH: %s: %d -> %d triangles (%.1f%% fewer) in %.1f ms", name, report.inputTriangles, report.outputTriangles,
+        report.inputTriangles ? 100.0 * (1.0 - (double)report.outputTriangles / report.inputTriangles) : 0.0, buildSeconds * 1000.0);
+    TraceLog(LOG_INFO, "BENCH:   %d welded vertices, %d degenerate, %d flat vertices collapsed, %d small wall triangles",
+        report.weldedVertices, report.degenerateTriangles, report.collapsedVertices, report.smallTriangles);
+    TraceLog(LOG_INFO, "BENCH:   position error max %.4f mean %.5f | capsule query %.2f -> %.2f us | %d floors off by more than the error",
+        report.maxError, report.meanError, beforeSeconds * 1e6 / SIMPLIFY_BENCH_QUERIES, afterSeconds * 1e6 / SIMPLIFY_BENCH_QUERIES,
+        floorMismatches);
+    RL_FREE(results);
+    RL_FREE(positions);
+    UnloadCollisionMesh(&simplified);
+    return floorMismatches;
+}
+// The collision build step on the first cell of a world layout (OBJ cells only, as there is no GL
+// context to load anything else) and on the procedural stress level
+int RunSimplifyBenchmark(const char* worldFile) {
+    CollisionSimplifySettings settings = GetCollisionSimplifySettings(SIMPLIFY_BENCH_RADIUS);
+    TraceLog(LOG_INFO, "BENCH: Collision build for a %.2f m capsule: weld %.3f, plane tolerance %.3f, min feature %.3f", SIMPLIFY_BENCH_RADIUS,
+        settings.weldDistance, settings.planeTolerance, settings.minFeatureSize);
+    int failures = 0;
+    static World world;
+    if (LoadWorldLayout(&world, worldFile, (WorldStreamingSettings){ 0 })) {
+        const WorldCell* cell = &world.cells[0];
+        Matrix transform = MatrixMultiply(MatrixScale(cell->scale, cell->scale, cell->scale), MatrixTranslate(cell->position.x, cell->position.y, cell->position.z));
+        CollisionMesh mesh = LoadObjCollisionMesh(cell->modelPath, transform);
+        if (mesh.triangleCount > 0) failures += RunSimplifyCase(cell->modelPath, &mesh, settings);
+        UnloadCollisionMesh(&mesh);
+    }
+    pthread_mutex_destroy(&world.lock);
+    CollisionMesh stress = GenerateStressLevel(RAY_BENCH_TRIANGLES, JOB_BENCH_LEVEL_SIZE, BENCH_SEED);
+    failures += RunSimplifyCase("stress level", &stress, settings);
+    UnloadCollisionMesh(&stress);
+    return failures;
+}
+typedef struct {
+    int triangles;
+    double buildSeconds;
+    size_t bytes;
+    double moveSeconds;
+    double floorSeconds;
+    double resolveSeconds;
+    int grounded;
+} ScalingBenchResult;
+// Each character walks a loop of waypoints around its spawn point, steering straight at the next
+// one, so in rooms and clutter it spends part of the loop pressed against whatever is in the way
+static void SteerAlongPaths(const Vector3* centers, const Vector3* positions, int* waypoints, Vector3* wishDirections, int count) {
+    for (int i = 0; i < count; i++) {
+        float angle = 2.0f * PI * (float)waypoints[i] / SCALING_BENCH_PATH_POINTS;
+        Vector3 target = { centers[i].x + cosf(angle) * SCALING_BENCH_PATH_RADIUS, 0.0f, centers[i].z + sinf(angle) * SCALING_BENCH_PATH_RADIUS };
+        Vector3 offset = { target.x - positions[i].x, 0.0f, target.z - positions[i].z };
+        if (Vector3Length(offset) < SCALING_BENCH_WAYPOINT_REACH) waypoints[i] = (waypoints[i] + 1) % SCALING_BENCH_PATH_POINTS;
+        wishDirections[i] = Vector3Normalize(offset);
+    }
+}
+static ScalingBenchResult RunScalingCase(StressLevelKind kind, int targetTriangles) {
+    ScalingBenchResult result = { 0 };
+    CollisionMesh mesh = GenerateStressLevelOfKind(kind, targetTriangles, sqrtf(targetTriangles * SCALING_BENCH_AREA_PER_TRIANGLE), BENCH_SEED);
+    if (!mesh.triangles) return result;
+    // Generation already built it; building again times the BVH on its own
+    double start = PlatformTime();
+    BuildCollisionBvh(&mesh);
+    result.buildSeconds = PlatformTime() - start;
+    result.triangles = mesh.triangleCount;
+    result.bytes = GetCollisionMeshBytes(&mesh);
+    CollisionWorld world = { 0 };
+    AddCollisionMesh(&world, &mesh);
+    int count = SCALING_BENCH_CHARACTERS;
+    CollisionCapsule* capsules = RL_CALLOC(count, sizeof(CollisionCapsule));
+    Vector3* centers = RL_MALLOC(sizeof(Vector3) * count);
+    Vector3* positions = RL_MALLOC(sizeof(Vector3) * count);
+    Vector3* velocities = RL_CALLOC(count, sizeof(Vector3));
+    Vector3* wishDirections = RL_CALLOC(count, sizeof(Vector3));
+    float* moveSpeeds = RL_MALLOC(sizeof(float) * count);
+    int* waypoints = RL_MALLOC(sizeof(int) * count);
+    bool* grounded = RL_CALLOC(count, sizeof(bool));
+    Vector3* queries = RL_MALLOC(sizeof(Vector3) * SCALING_BENCH_QUERIES);
+    unsigned int state = BENCH_SEED;
+    Vector3 inset = Vector3Scale(Vector3Subtract(mesh.bounds.max, mesh.bounds.min), 0.05f);
+    // Spawns and probe points stand on the floor, found from above so room ceilings are skipped
+    for (int i = 0; i < SCALING_BENCH_QUERIES; i++) {
+        Vector3 normal;
+        queries[i] = (Vector3){
+            StressRandomFloat(&state, mesh.bounds.min.x + inset.x, mesh.bounds.max.x - inset.x),
+            mesh.bounds.max.y + 1.0f,
+            StressRandomFloat(&state, mesh.bounds.min.z + inset.z, mesh.bounds.max.z - inset.z)
+        };
+        float floor = FindFloor(&world, queries[i], &normal);
+        if (floor > -9999.0f) queries[i].y = floor + SCALING_BENCH_RADIUS;
+    }
+    for (int i = 0; i < count; i++) {
+        centers[i] = positions[i] = queries[i];
+        capsules[i] = (CollisionCapsule){ positions[i], SCALING_BENCH_RADIUS, SCALING_BENCH_HEIGHT / 2.0f, false };
+        moveSpeeds[i] = SCALING_BENCH_SPEED;
+        waypoints[i] = i % SCALING_BENCH_PATH_POINTS;
+    }
+    CharacterMoveBatch batch = { count, capsules, positions, velocities, wishDirections, moveSpeeds, NULL, NULL, NULL };
+    CharacterMoveResults results = { positions, velocities, grounded, NULL };
+    for (int tick = 0; tick < SCALING_BENCH_TICKS; tick++) {
+        SteerAlongPaths(centers, positions, waypoints, wishDirections, count);
+        start = PlatformTime();
+        MoveCharacters(&world, &batch, &results, CROWD_BENCH_STEP);
+        result.moveSeconds += PlatformTime() - start;
+        for (int i = 0; i < count; i++) capsules[i].isOnGround = grounded[i];
+    }
+    result.moveSeconds /= (double)SCALING_BENCH_TICKS * count;
+    for (int i = 0; i < count; i++) result.grounded += grounded[i];
+    start = PlatformTime();
+    for (int i = 0; i < SCALING_BENCH_QUERIES; i++) {
+        Vector3 normal;
+        FindFloor(&world, queries[i], &normal);
+    }
+    result.floorSeconds = (PlatformTime() - start) / SCALING_BENCH_QUERIES;
+    start = PlatformTime();
+    for (int i = 0; i < SCALING_BENCH_QUERIES; i++) {
+        Vector3 position = queries[i];
+        ResolveCapsuleCollision(&world, &position, SCALING_BENCH_RADIUS, SCALING_BENCH_HEIGHT, 0.0f);
+    }
+    result.resolveSeconds = (PlatformTime() - start) / SCALING_BENCH_QUERIES;
+    RL_FREE(queries);
+    RL_FREE(grounded);
+    RL_FREE(waypoints);
+    RL_FREE(moveSpeeds);
+    RL_FREE(wishDirections);
+    RL_FREE(velocities);
+    RL_FREE(positions);
+    RL_FREE(centers);
+    RL_FREE(capsules);
+    UnloadCollisionMesh(&mesh);
+    return result;
+}
+// Every kind of procedural level from SCALING_BENCH_MIN_TRIANGLES up to maxTriangles in steps of
+// ten. Levels grow in area at a fixed triangle density, the way real levels get bigger, with the
+// same crowd walking the same paths in each. The bars plot move time against the slowest size.
+int RunScalingBenchmark(int maxTriangles) {
+    if (maxTriangles <= 0) maxTriangles = SCALING_BENCH_DEFAULT_MAX_TRIANGLES;
+    JobSystemInit(JOB_WORKERS_AUTO);
+    TraceLog(LOG_INFO, "BENCH: Collision scaling: %d characters for %d ticks on %d thread(s), %.1f m2 per triangle", SCALING_BENCH_CHARACTERS,
+        SCALING_BENCH_TICKS, JobWorkerCount() + 1, SCALING_BENCH_AREA_PER_TRIANGLE);
+    int failures = 0;
+    for (int kind = 0; kind < STRESS_LEVEL_KIND_COUNT; kind++) {
+        ScalingBenchResult results[SCALING_BENCH_MAX_STEPS];
+        int steps = 0;
+        double slowest = 0.0;
+        for (long long triangles = SCALING_BENCH_MIN_TRIANGLES; triangles <= maxTriangles && steps < SCALING_BENCH_MAX_STEPS; triangles *= 10) {
+            results[steps] = RunScalingCase(kind, (int)triangles);
+            if (results[steps].triangles == 0) {
+                TraceLog(LOG_WARNING, "BENCH: %s: out of memory at %lld triangles", GetStressLevelKindName(kind), triangles);
+                failures++;
+                break;
+            }
+            slowest = fmax(slowest, results[steps].moveSeconds);
+            steps++;
+        }
+        TraceLog(LOG_INFO, "BENCH: %-11s %9s %9s %9s %8s %9s %10s %8s", GetStressLevelKindName(kind), "triangles", "build ms", "MB",
+            "move us", "floor us", "resolve us", "grounded");
+        for (int i = 0; i < steps; i++) {
+            const ScalingBenchResult* result = &results[i];
+            char bar[64];
+            int length = (int)(result->moveSeconds / slowest * SCALING_BENCH_PLOT_WIDTH + 0.5);
+            memset(bar, '#', length);
+            bar[length] = '\0';
+            TraceLog(LOG_INFO, "BENCH: %-11s %9d %9.1f %9.1f %8.2f %9.2f %10.2f %4d/%-3d %s", "", result->triangles, result->buildSeconds * 1000.0,
+                result->bytes / (1024.0 * 1024.0), result->moveSeconds * 1e6, result->floorSeconds * 1e6, result->resolveSeconds * 1e6,
+                result->grounded, SCALING_BENCH_CHARACTERS, bar);
+        }
+    }
+    JobSystemShutdown();
+    return failures;
+}
+// The game's collision queries as they were before the collision module existed, copied verbatim
+// as the oracle the accelerated ones are measured against: every triangle of every mesh rebuilt by
+// GetTriangle, floors above normal.y 0.5, walls up to 0.7 and each contact pushed out as it is met.
+// Only the mesh list is new; the baseline walked one level model under one transform.
+typedef struct {
+    Mesh mesh;
+    Matrix transform;
+} BaselineSource;
+typedef struct {
+    BaselineSource* sources;
+    int sourceCount;
+} BaselineLevel;
+static Vector3 BaselineClosestPointOnLineSegment(Vector3 a, Vector3 b, Vector3 point) {
+    Vector3 ab = Vector3Subtract(b, a);
+    float t = Vector3DotProduct(Vector3Subtract(point, a), ab) / Vector3DotProduct(ab, ab);
+    t = fmaxf(0.0f, fminf(1.0f, t));
+    return Vector3Add(a, Vector3Scale(ab, t));
+}
+static bool BaselineIsPointInTriangle(Vector3 point, Triangle tri) {
+    Vector3 v0 = Vector3Subtract(tri.v2, tri.v0);
+    Vector3 v1 = Vector3Subtract(tri.v1, tri.v0);
+    Vector3 v2 = Vector3Subtract(point, tri.v0);
+    float dot00 = Vector3DotProduct(v0, v0);
+    float dot01 = Vector3DotProduct(v0, v1);
+    float dot02 = Vector3DotProduct(v0, v2);
+    float dot11 = Vector3DotProduct(v1, v1);
+    float dot12 = Vector3DotProduct(v1, v2);
+    float invDenom = 1.0f / (dot00 * dot11 - dot01 * dot01);
+    float u = (dot11 * dot02 - dot01 * dot12) * invDenom;
+    float v = (dot00 * dot12 - dot01 * dot02) * invDenom;
+    return (u >= 0) && (v >= 0) && (u + v <= 1);
+}
+static Triangle BaselineGetTriangle(Mesh mesh, Matrix transform, int triIndex) {
+    Triangle tri = {0};
+    Vector3 v0, v1, v2;
+    if (mesh.indices) {
+        if (triIndex * 3 + 2 >= mesh.triangleCount * 3) {
+            return tri;
+        }
+        int i0 = mesh.indices[triIndex * 3 + 0];
+        int i1 = mesh.indices[triIndex * 3 + 1];
+        int i2 = mesh.indices[triIndex * 3 + 2];
+        v0 = (Vector3){ mesh.vertices[i0*3], mesh.vertices[i0*3+1], mesh.vertices[i0*3+2] };
+        v1 = (Vector3){ mesh.vertices[i1*3], mesh.vertices[i1*3+1], mesh.vertices[i1*3+2] };
+        v2 = (Vector3){ mesh.vertices[i2*3], mesh.vertices[i2*3+1], mesh.vertices[i2*3+2] };
+    } else {
+        if (triIndex * 9 + 8 >= mesh.vertexCount * 3) {
+            return tri;
+        }
+        int baseIdx = triIndex * 9; // 3 vertices * 3 floats each
+        v0 = (Vector3){ mesh.vertices[baseIdx], mesh.vertices[baseIdx+1], mesh.vertices[baseIdx+2] };
+        v1 = (Vector3){ mesh.vertices[baseIdx+3], mesh.vertices[baseIdx+4], mesh.vertices[baseIdx+5] };
+        v2 = (Vector3){ mesh.vertices[baseIdx+6], mesh.vertices[baseIdx+7], mesh.vertices[baseIdx+8] };
+    }
+    tri.v0 = Vector3Transform(v0, transform);
+    tri.v1 = Vector3Transform(v1, transform);
+    tri.v2 = Vector3Transform(v2, transform);
+    Vector3 edge1 = Vector3Subtract(tri.v1, tri.v0);
+    Vector3 edge2 = Vector3Subtract(tri.v2, tri.v0);
+    tri.normal = Vector3Normalize(Vector3CrossProduct(edge1, edge2));
+    return tri;
+}
+static bool BaselineTestCapsuleTriangle(Vector3 capsuleBase, Vector3 capsuleTop, float radius, Triangle tri, Vector3* pushOut) {
+    Vector3 closestOnCapsule = BaselineClosestPointOnLineSegment(capsuleBase, capsuleTop, tri.v0);
+    float distanceToPlane = Vector3DotProduct(Vector3Subtract(closestOnCapsule, tri.v0), tri.normal);
+    if (fabsf(distanceToPlane) > radius) {
+        return false;
+    }
+    Vector3 pointOnPlane = Vector3Subtract(closestOnCapsule, Vector3Scale(tri.normal, distanceToPlane));
+    if (BaselineIsPointInTriangle(pointOnPlane, tri)) {
+        if (fabsf(distanceToPlane) < radius) {
+            float penetration = radius - fabsf(distanceToPlane);
+            float direction = distanceToPlane >= 0 ? 1.0f : -1.0f;
+            *pushOut = Vector3Scale(tri.normal, penetration * direction);
+            return true;
+        }
+    }
+    return false;
+}
+static float BaselineFindFloor(const BaselineLevel* level, Vector3 pos, Vector3* outNormal) {
+    float highestFloor = -10000.0f;
+    Vector3 floorNormal = {0, 1, 0};
+    bool foundFloor = false;
+    for (int meshIdx = 0; meshIdx < level->sourceCount; meshIdx++) {
+        Mesh mesh = level->sources[meshIdx].mesh;
+        Matrix levelTransform = level->sources[meshIdx].transform;
+        int triangleCount = mesh.triangleCount;
+        if (triangleCount == 0) {
+            triangleCount = mesh.vertexCount / 3;
+        }
+        for (int i = 0; i < triangleCount; i++) {
+            Triangle tri = BaselineGetTriangle(mesh, levelTransform, i);
+            if (Vector3LengthSqr(tri.normal) < 0.001f) continue;
+            if (tri.normal.y <= 0.5f) continue;
+            Vector3 testPoint = pos;
+            testPoint.y = tri.v0.y;
+            if (BaselineIsPointInTriangle(testPoint, tri)) {
+                float height =
+                    tri.v0.y -
+                    (tri.normal.x*(testPoint.x - tri.v0.x) +
+                    tri.normal.z*(testPoint.z - tri.v0.z)) /
+                    tri.normal.y;
+                if (height > highestFloor && height <= pos.y + 100.0f) {
+                    highestFloor = height;
+                    floorNormal = tri.normal;
+                    foundFloor = true;
+                }
+            }
+        }
+    }
+    *outNormal = floorNormal;
+    return foundFloor ? highestFloor : -10000.0f;
+}
+static int BaselineResolveCapsuleCollision(const BaselineLevel* level, Vector3* position, float radius, float height) {
+    int collisionCount = 0;
+    Vector3 capsuleBase = *position;
+    Vector3 capsuleTop = Vector3Add(*position, (Vector3){0, height, 0});
+    for (int meshIdx = 0; meshIdx < level->sourceCount; meshIdx++) {
+        Mesh mesh = level->sources[meshIdx].mesh;
+        Matrix levelTransform = level->sources[meshIdx].transform;
+        int triangleCount = mesh.triangleCount;
+        if (triangleCount == 0) { triangleCount = mesh.vertexCount / 3; }
+        for (int i = 0; i < triangleCount; i++) {
+            Triangle tri = BaselineGetTriangle(mesh, levelTransform, i);
+            if (Vector3LengthSqr(tri.normal) < 0.001f) continue;
+            if (tri.normal.y > 0.7f) continue;
+            Vector3 pushOut = {0, 0, 0};
+            if (BaselineTestCapsuleTriangle(capsuleBase, capsuleTop, radius, tri, &pushOut)) {
+                position->x += pushOut.x;
+                position->y += pushOut.y;
+                position->z += pushOut.z;
+                capsuleBase = *position;
+                capsuleTop = Vector3Add(*position, (Vector3){0, height, 0});
+                collisionCount++;
+            }
+        }
+    }
+    return collisionCount;
+}
+// A CPU-only, non-indexed raylib mesh of a collision mesh's triangles in their current order, the
+// layout raylib's OBJ loader hands back
+static Mesh GetBaselineMesh(const CollisionMesh* collision) {
+    Mesh mesh = { .vertexCount = collision->triangleCount * 3, .triangleCount = collision->triangleCount };
+    mesh.vertices = RL_MALLOC(sizeof(float) * 9 * (collision->triangleCount > 0 ? collision->triangleCount : 1));
+    for (int i = 0; i < collision->triangleCount; i++) {
+        const Triangle* tri = &collision->triangles[i];
+        Vector3 corners[3] = { tri->v0, tri->v1, tri->v2 };
+        for (int corner = 0; corner < 3; corner++) {
+            mesh.vertices[i * 9 + corner * 3 + 0] = corners[corner].x;
+            mesh.vertices[i * 9 + corner * 3 + 1] = corners[corner].y;
+            mesh.vertices[i * 9 + corner * 3 + 2] = corners[corner].z;
+        }
+    }
+    return mesh;
+}
+typedef struct {
+    int floors;
+    int missingFloors;
+    int pushes;
+    int contacts;
+    float maxFloor;
+    float maxPush;
+    unsigned int worstFloorSeed;
+    unsigned int worstPushSeed;
+} BaselineDivergence;
+typedef struct {
+    Vector3 position;
+    float radius;
+    float height;
+    float floorMinNormalY;
+} VerifyQuery;
+static BoundingBox GetCollisionWorldBounds(const CollisionWorld* world) {
+    BoundingBox bounds = { { 1e30f, 1e30f, 1e30f }, { -1e30f, -1e30f, -1e30f } };
+    for (int i = 0; i < world->meshCount; i++) {
+        bounds.min = Vector3Min(bounds.min, world->meshes[i]->bounds.min);
+        bounds.max = Vector3Max(bounds.max, world->meshes[i]->bounds.max);
+    }
+    for (int i = 0; i < world->instanceCount; i++) {
+        bounds.min = Vector3Min(bounds.min, world->instances[i]->bounds.min);
+        bounds.max = Vector3Max(bounds.max, world->instances[i]->bounds.max);
+    }
+    return bounds;
+}
+// Everything about one query comes from its own seed, so a mismatch can be replayed on its own. Half
+// are anywhere in the bounds, mostly in the air; the other half straddle a random triangle of a mesh
+// or an instance, somewhere along the capsule, where the push-outs happen.
+static VerifyQuery GetVerifyQuery(const CollisionWorld* world, BoundingBox bounds, unsigned int seed) {
+    unsigned int state = seed;
+    VerifyQuery query = {
+        .radius = StressRandomFloat(&state, VERIFY_MIN_RADIUS, VERIFY_MAX_RADIUS),
+        .height = StressRandomFloat(&state, VERIFY_MIN_HEIGHT, VERIFY_MAX_HEIGHT)
+    };
+    float slopeLimit = VERIFY_SLOPE_LIMITS[StressRandom(&state) % (sizeof(VERIFY_SLOPE_LIMITS) / sizeof(VERIFY_SLOPE_LIMITS[0]))];
+    query.floorMinNormalY = slopeLimit > 0.0f ? cosf(slopeLimit * DEG2RAD) : 0.0f;
+    if (StressRandom(&state) % 2 == 0) {
+        query.position = (Vector3){
+            StressRandomFloat(&state, bounds.min.x, bounds.max.x),
+            StressRandomFloat(&state, bounds.min.y, bounds.max.y + VERIFY_MAX_HEIGHT),
+            StressRandomFloat(&state, bounds.min.z, bounds.max.z)
+        };
+        return query;
+    }
+    const CollisionInstance* instance = NULL;
+    const CollisionMesh* mesh;
+    if (world->instanceCount > 0 && (world->meshCount == 0 || StressRandom(&state) % 2 == 0)) {
+        instance = world->instances[StressRandom(&state) % world->instanceCount];
+        mesh = instance->mesh;
+    } else {
+        mesh = world->meshes[StressRandom(&state) % world->meshCount];
+    }
+    Triangle tri = mesh->triangles[StressRandom(&state) % mesh->triangleCount];
+    float u = StressRandomFloat(&state, 0.0f, 1.0f), v = StressRandomFloat(&state, 0.0f, 1.0f);
+    if (u + v > 1.0f) {
+        u = 1.0f - u;
+        v = 1.0f - v;
+    }
+    Vector3 point = Vector3Add(tri.v0, Vector3Add(Vector3Scale(Vector3Subtract(tri.v1, tri.v0), u), Vector3Scale(Vector3Subtract(tri.v2, tri.v0), v)));
+    Vector3 normal = tri.normal;
+    if (instance) {
+        point = Vector3Transform(point, instance->transform);
+        normal = Vector3Normalize(Vector3Subtract(Vector3Transform(normal, instance->transform),
+            (Vector3){ instance->transform.m12, instance->transform.m13, instance->transform.m14 }));
+    }
+    point = Vector3Add(point, Vector3Scale(normal, StressRandomFloat(&state, -query.radius, query.radius * 1.5f)));
+    query.position = (Vector3){ point.x, point.y - StressRandomFloat(&state, 0.0f, query.height), point.z };
+    return query;
+}
+static void ReportVerifyMismatch(const char* name, unsigned int seed, int* reported, const char* what) {
+    if ((*reported)++ < VERIFY_MAX_REPORTED) TraceLog(LOG_WARNING, "BENCH: %s seed %u: %s", name, seed, what);
+}
+// Steps count characters, all starting on the ground at positions, for VERIFY_CHARACTER_TICKS fixed
+// ticks through MoveCharacters, either with a collision cache each or straight against the world
+static void MoveVerifyCharacters(const CollisionWorld* world, int count, Vector3* positions, const Vector3* wishDirections, bool* grounded,
+    bool cached) {
+    CollisionCapsule* capsules = RL_MALLOC(sizeof(CollisionCapsule) * count);
+    Vector3* velocities = RL_CALLOC(count, sizeof(Vector3));
+    float* moveSpeeds = RL_MALLOC(sizeof(float) * count);
+    CollisionCache* cacheStorage = cached ? RL_CALLOC(count, sizeof(CollisionCache)) : NULL;
+    CollisionCache** caches = cached ? RL_MALLOC(sizeof(CollisionCache*) * count) : NULL;
+    for (int i = 0; i < count; i++) {
+        capsules[i] = (CollisionCapsule){ positions[i], VERIFY_CHARACTER_RADIUS, VERIFY_CHARACTER_HEIGHT / 2.0f, true };
+        moveSpeeds[i] = VERIFY_CHARACTER_SPEED;
+        grounded[i] = true;
+        if (caches) caches[i] = &cacheStorage[i];
+    }
+    CharacterMoveBatch batch = { count, capsules, positions, velocities, wishDirections, moveSpeeds, NULL, NULL, caches };
+    CharacterMoveResults results = { positions, velocities, grounded, NULL };
+    for (int tick = 0; tick < VERIFY_CHARACTER_TICKS; tick++) {
+        MoveCharacters(world, &batch, &results, VERIFY_CHARACTER_STEP);
+        for (int i = 0; i < count; i++) capsules[i].isOnGround = grounded[i];
+    }
+    RL_FREE(caches);
+    RL_FREE(cacheStorage);
+    RL_FREE(moveSpeeds);
+    RL_FREE(velocities);
+    RL_FREE(capsules);
+}
+// Characters set down on the floor at seeded spots and walked in seeded directions, once with caches
+// and once against the world; both runs have to end in the same places with the same grounded state
+static int RunVerifyCharacters(const char* name, const CollisionWorld* world, BoundingBox bounds, unsigned int seed) {
+    Vector3* positions = RL_MALLOC(sizeof(Vector3) * VERIFY_CHARACTERS * 2);
+    Vector3* wishDirections = RL_MALLOC(sizeof(Vector3) * VERIFY_CHARACTERS);
+    bool* grounded = RL_MALLOC(sizeof(bool) * VERIFY_CHARACTERS * 2);
+    unsigned int state = seed;
+    for (int i = 0; i < VERIFY_CHARACTERS; i++) {
+        Vector3 position = { StressRandomFloat(&state, bounds.min.x, bounds.max.x), bounds.max.y, StressRandomFloat(&state, bounds.min.z, bounds.max.z) };
+        Vector3 normal;
+        float floor = FindFloor(world, position, &normal);
+        position.y = floor > -9999.0f ? floor : bounds.min.y;
+        float heading = StressRandomFloat(&state, 0.0f, 2.0f * PI);
+        positions[i] = positions[VERIFY_CHARACTERS + i] = position;
+        wishDirections[i] = (Vector3){ sinf(heading), 0.0f, cosf(heading) };
+    }
+    MoveVerifyCharacters(world, VERIFY_CHARACTERS, positions, wishDirections, grounded, false);
+    MoveVerifyCharacters(world, VERIFY_CHARACTERS, positions + VERIFY_CHARACTERS, wishDirections, grounded + VERIFY_CHARACTERS, true);
+    int mismatches = 0;
+    for (int i = 0; i < VERIFY_CHARACTERS; i++) {
+        Vector3 reference = positions[i], position = positions[VERIFY_CHARACTERS + i];
+        if (grounded[i] != grounded[VERIFY_CHARACTERS + i] || Vector3Distance(position, reference) > VERIFY_TOLERANCE) {
+            if (mismatches++ < VERIFY_MAX_REPORTED) {
+                TraceLog(LOG_WARNING, "BENCH: %s character %d: cache ended at (%.4f %.4f %.4f)%s, world at (%.4f %.4f %.4f)%s", name, i,
+                    position.x, position.y, position.z, grounded[VERIFY_CHARACTERS + i] ? " grounded" : "",
+                    reference.x, reference.y, reference.z, grounded[i] ? " grounded" : "");
+            }
+        }
+    }
+    RL_FREE(grounded);
+    RL_FREE(wishDirections);
+    RL_FREE(positions);
+    return mismatches;
+}
+// FindFloor and ResolveCapsuleCollision on world and on each query's collision cache, checked
+// against the brute-force references: floor heights and normals, push-outs and contact counts must
+// agree within VERIFY_TOLERANCE. The cache only answers for capsules that end up inside its bounds;
+// its floors are checked everywhere, through the same fallback to the world the controller takes.
+// Cached character moves are compared against uncached ones last. How far the brute-force answers
+// have drifted from the baseline oracle is added to divergence and logged, but is not a mismatch.
+static int RunVerifyCase(const char* name, const CollisionWorld* world, const BaselineLevel* baseline, unsigned int baseSeed,
+    BaselineDivergence* totalDivergence) {
+    BoundingBox bounds = GetCollisionWorldBounds(world);
+    VerifyQuery* queries = RL_MALLOC(sizeof(VerifyQuery) * VERIFY_QUERIES);
+    Vector3* positions = RL_MALLOC(sizeof(Vector3) * VERIFY_QUERIES);
+    for (int i = 0; i < VERIFY_QUERIES; i++) queries[i] = GetVerifyQuery(world, bounds, baseSeed + (unsigned int)i);
+    int mismatches = 0, reported = 0, contacts = 0, cacheChecks = 0;
+    BaselineDivergence divergence = { 0 };
+    CollisionCache* cache = RL_MALLOC(sizeof(CollisionCache));
+    for (int i = 0; i < VERIFY_QUERIES; i++) {
+        const VerifyQuery* query = &queries[i];
+        unsigned int seed = baseSeed + (unsigned int)i;
+        Vector3 referenceNormal, normal;
+        float referenceFloor = FindFloorBruteForce(world, query->position, &referenceNormal);
+        Vector3 reference = query->position;
+        int referenceCount = ResolveCapsuleCollisionBruteForce(world, &reference, query->radius, query->height, query->floorMinNormalY);
+        contacts += referenceCount;
+        Vector3 baselineNormal;
+        float baselineFloor = BaselineFindFloor(baseline, query->position, &baselineNormal);
+        Vector3 baselinePosition = query->position;
+        int baselineCount = BaselineResolveCapsuleCollision(baseline, &baselinePosition, query->radius, query->height);
+        if ((referenceFloor > -9999.0f) != (baselineFloor > -9999.0f)) {
+            divergence.floors++;
+            divergence.missingFloors++;
+        } else if (fabsf(referenceFloor - baselineFloor) > VERIFY_TOLERANCE || Vector3Distance(referenceNormal, baselineNormal) > VERIFY_TOLERANCE) {
+            divergence.floors++;
+            if (fabsf(referenceFloor - baselineFloor) > divergence.maxFloor) {
+                divergence.maxFloor = fabsf(referenceFloor - baselineFloor);
+                divergence.worstFloorSeed = seed;
+            }
+        }
+        if (Vector3Distance(reference, baselinePosition) > VERIFY_TOLERANCE) {
+            divergence.pushes++;
+            if (Vector3Distance(reference, baselinePosition) > divergence.maxPush) {
+                divergence.maxPush = Vector3Distance(reference, baselinePosition);
+                divergence.worstPushSeed = seed;
+            }
+        }
+        divergence.contacts += referenceCount != baselineCount;
+        cache->valid = false;
+        UpdateCollisionCache(world, cache, GetCapsuleBounds(query->position, query->radius, query->height), VERIFY_CACHE_MARGIN);
+        CollisionMesh cachedMesh;
+        CollisionWorld cachedWorld = GetCollisionCacheWorld(world, cache, &cachedMesh);
+        // A cache only answers for a capsule that stays inside it; a push out past the margin leaves
+        // the triangles it would meet next uncached
+        BoundingBox reach = GetCapsuleBounds(reference, query->radius, query->height);
+        bool useCache = !cache->overflowed && Vector3Equals(Vector3Max(reach.max, cache->bounds.max), cache->bounds.max) &&
+            Vector3Equals(Vector3Min(reach.min, cache->bounds.min), cache->bounds.min);
+        cacheChecks += useCache;
+        for (int pass = 0; pass < (useCache ? 2 : 1); pass++) {
+            const CollisionWorld* tested = pass == 0 ? world : &cachedWorld;
+            const char* path = pass == 0 ? "world" : "cache";
+            float floor = pass == 0 ? FindFloor(world, query->position, &normal) :
+                FindFloorInCache(world, cache, &cachedWorld, query->position, &normal);
+            if (fabsf(floor - referenceFloor) > VERIFY_TOLERANCE || Vector3Distance(normal, referenceNormal) > VERIFY_TOLERANCE) {
+                mismatches++;
+                ReportVerifyMismatch(name, seed, &reported, TextFormat("%s floor %.4f (%.3f %.3f %.3f), brute force %.4f (%.3f %.3f %.3f)", path,
+                    floor, normal.x, normal.y, normal.z, referenceFloor, referenceNormal.x, referenceNormal.y, referenceNormal.z));
+            }
+            Vector3 position = query->position;
+            int count = ResolveCapsuleCollision(tested, &position, query->radius, query->height, query->floorMinNormalY);
+            if (count != referenceCount || Vector3Distance(position, reference) > VERIFY_TOLERANCE) {
+                Vector3 push = Vector3Subtract(position, query->position), referencePush = Vector3Subtract(reference, query->position);
+                mismatches++;
+                ReportVerifyMismatch(name, seed, &reported, TextFormat("%s push (%.4f %.4f %.4f) from %d contacts, brute force (%.4f %.4f %.4f) from %d",
+                    path, push.x, push.y, push.z, count, referencePush.x, referencePush.y, referencePush.z, referenceCount));
+            }
+        }
+    }
+    RL_FREE(cache);
+    mismatches += RunVerifyCharacters(name, world, bounds, baseSeed);
+    Vector3 normal;
+    double start = PlatformTime();
+    for (int i = 0; i < VERIFY_QUERIES; i++) FindFloorBruteForce(world, queries[i].position, &normal);
+    double bruteFloorSeconds = PlatformTime() - start;
+    start = PlatformTime();
+    for (int i = 0; i < VERIFY_QUERIES; i++) FindFloor(world, queries[i].position, &normal);
+    double floorSeconds = PlatformTime() - start;
+    for (int i = 0; i < VERIFY_QUERIES; i++) positions[i] = queries[i].position;
+    start = PlatformTime();
+    for (int i = 0; i < VERIFY_QUERIES; i++) ResolveCapsuleCollisionBruteForce(world, &positions[i], queries[i].radius, queries[i].height, queries[i].floorMinNormalY);
+    double bruteResolveSeconds = PlatformTime() - start;
+    for (int i = 0; i < VERIFY_QUERIES; i++) positions[i] = queries[i].position;
+    start = PlatformTime();
+    for (int i = 0; i < VERIFY_QUERIES; i++) ResolveCapsuleCollision(world, &positions[i], queries[i].radius, queries[i].height, queries[i].floorMinNormalY);
+    double resolveSeconds = PlatformTime() - start;
+    TraceLog(LOG_INFO, "BENCH: %-22s %8.1f %8.2f %6.0fx %8.1f %8.2f %6.0fx %7d %5d  %s", name,
+        bruteFloorSeconds * 1e6 / VERIFY_QUERIES, floorSeconds * 1e6 / VERIFY_QUERIES, bruteFloorSeconds / floorSeconds,
+        bruteResolveSeconds * 1e6 / VERIFY_QUERIES, resolveSeconds * 1e6 / VERIFY_QUERIES, bruteResolveSeconds / resolveSeconds,
+        contacts, cacheChecks, mismatches ? TextFormat("%d MISMATCHES", mismatches) : "ok");
+    TraceLog(LOG_INFO, "BENCH: %-22s vs baseline: %d floors differ (%d found by one only, max %.3f at seed %u), %d pushes differ "
+        "(max %.3f at seed %u), %d contact counts", "", divergence.floors, divergence.missingFloors, divergence.maxFloor,
+        divergence.worstFloorSeed, divergence.pushes, divergence.maxPush, divergence.worstPushSeed, divergence.contacts);
+    totalDivergence->floors += divergence.floors;
+    totalDivergence->missingFloors += divergence.missingFloors;
+    totalDivergence->pushes += divergence.pushes;
+    totalDivergence->contacts += divergence.contacts;
+    totalDivergence->maxFloor = fmaxf(totalDivergence->maxFloor, divergence.maxFloor);
+    totalDivergence->maxPush = fmaxf(totalDivergence->maxPush, divergence.maxPush);
+    RL_FREE(positions);
+    RL_FREE(queries);
+    return mismatches;
+}
+static void PushVerifyQuad(CollisionMesh* mesh, Vector3 a, Vector3 b, Vector3 c, Vector3 d) {
+    Vector3 normal = Vector3Normalize(Vector3CrossProduct(Vector3Subtract(b, a), Vector3Subtract(c, a)));
+    mesh->triangles[mesh->triangleCount++] = (Triangle){ a, b, c, normal, 0 };
+    mesh->triangles[mesh->triangleCount++] = (Triangle){ a, c, d, normal, 0 };
+    mesh->bounds.min = Vector3Min(mesh->bounds.min, Vector3Min(Vector3Min(a, b), Vector3Min(c, d)));
+    mesh->bounds.max = Vector3Max(mesh->bounds.max, Vector3Max(Vector3Max(a, b), Vector3Max(c, d)));
+}
+// Characters walk off a platform onto a floor VERIFY_LEDGE_HEIGHT below, far enough down to be
+// outside every cache taken on the platform. The two are separate meshes, as neighbouring cells
+// would be, so no BVH leaf carries the floor into the platform's caches. Each character has to fall
+// and land, cached or not, and both runs have to end in the same place.
+static int RunLedgeVerification(void) {
+    float size = VERIFY_LEDGE_SIZE, height = VERIFY_LEDGE_HEIGHT;
+    CollisionMesh meshes[2];
+    CollisionWorld world = { 0 };
+    for (int i = 0; i < 2; i++) {
+        meshes[i] = (CollisionMesh){ .slopes = GetCollisionSlopeSettings(COLLISION_FLOOR_SLOPE_DEGREES, COLLISION_CEILING_SLOPE_DEGREES) };
+        meshes[i].triangles = RL_MALLOC(sizeof(Triangle) * 2);
+        if (!meshes[i].triangles) return 1;
+        meshes[i].bounds = (BoundingBox){ { 1e30f, 1e30f, 1e30f }, { -1e30f, -1e30f, -1e30f } };
+    }
+    PushVerifyQuad(&meshes[0], (Vector3){ -size, height, -size }, (Vector3){ -size, height, size }, (Vector3){ 0.0f, height, size },
+        (Vector3){ 0.0f, height, -size });
+    PushVerifyQuad(&meshes[1], (Vector3){ -size, 0.0f, -size }, (Vector3){ -size, 0.0f, size }, (Vector3){ size, 0.0f, size },
+        (Vector3){ size, 0.0f, -size });
+    for (int i = 0; i < 2; i++) {
+        BuildCollisionBvh(&meshes[i]);
+        AddCollisionMesh(&world, &meshes[i]);
+    }
+    Vector3* positions = RL_MALLOC(sizeof(Vector3) * VERIFY_CHARACTERS * 2);
+    Vector3* wishDirections = RL_MALLOC(sizeof(Vector3) * VERIFY_CHARACTERS);
+    bool* grounded = RL_MALLOC(sizeof(bool) * VERIFY_CHARACTERS * 2);
+    for (int i = 0; i < VERIFY_CHARACTERS; i++) {
+        positions[i] = (Vector3){ -2.0f, height, ((float)i + 0.5f) / VERIFY_CHARACTERS * size - size * 0.5f };
+        positions[VERIFY_CHARACTERS + i] = positions[i];
+        wishDirections[i] = (Vector3){ 1.0f, 0.0f, 0.0f };
+    }
+    MoveVerifyCharacters(&world, VERIFY_CHARACTERS, positions, wishDirections, grounded, false);
+    MoveVerifyCharacters(&world, VERIFY_CHARACTERS, positions + VERIFY_CHARACTERS, wishDirections, grounded + VERIFY_CHARACTERS, true);
+    int mismatches = 0;
+    for (int i = 0; i < VERIFY_CHARACTERS * 2; i++) {
+        const char* path = i < VERIFY_CHARACTERS ? "world" : "cache";
+        Vector3 position = positions[i];
+        if (!grounded[i] || position.x <= 0.0f || fabsf(position.y) > VERIFY_TOLERANCE) {
+            mismatches++;
+            TraceLog(LOG_WARNING, "BENCH: ledge %s character %d ended at (%.3f %.3f %.3f)%s, not on the floor below", path, i % VERIFY_CHARACTERS,
+                position.x, position.y, position.z, grounded[i] ? " grounded" : "");
+        }
+    }
+    for (int i = 0; i < VERIFY_CHARACTERS; i++) {
+        if (grounded[i] != grounded[VERIFY_CHARACTERS + i] || Vector3Distance(positions[i], positions[VERIFY_CHARACTERS + i]) > VERIFY_TOLERANCE) {
+            mismatches++;
+            TraceLog(LOG_WARNING, "BENCH: ledge character %d: cache and world moves disagree", i);
+        }
+    }
+    TraceLog(mismatches ? LOG_WARNING : LOG_INFO, "BENCH: %-22s %d characters walked off a %.1f m ledge  %s", "ledge", VERIFY_CHARACTERS,
+        height, mismatches ? TextFormat("%d MISMATCHES", mismatches) : "ok");
+    RL_FREE(grounded);
+    RL_FREE(wishDirections);
+    RL_FREE(positions);
+    for (int i = 0; i < 2; i++) UnloadCollisionMesh(&meshes[i]);
+    return mismatches;
+}
+// The differential check any change to the collision queries has to pass: the OBJ cells of the world
+// layout, every procedural stress level kind and a room full of instanced props, each queried at
+// VERIFY_QUERIES seeded random capsules. Query i of a run uses seed + i, so a reported seed replays as
+// the first query of a run started from it. Cached character moves are then checked walking off a ledge.
+// OBJ cells reach the baseline oracle in file order under the cell transform, as LoadModel gave them to
+// it; generated levels have no authored order and go in BVH order.
+int RunCollisionVerification(const char* worldFile, unsigned int seed) {
+    if (seed == 0) seed = BENCH_SEED;
+    TraceLog(LOG_INFO, "BENCH: Collision verification: %d queries per level from seed %u, tolerance %.4f", VERIFY_QUERIES, seed,
+        VERIFY_TOLERANCE);
+    TraceLog(LOG_INFO, "BENCH: level                  brute us floor us  ratio brute us  push us  ratio contacts cache  result");
+    int failures = 0;
+    BaselineDivergence divergence = { 0 };
+    static World world;
+    if (LoadWorldLayout(&world, worldFile, (WorldStreamingSettings){ 0 })) {
+        for (int i = 0; i < world.cellCount; i++) {
+            const WorldCell* cell = &world.cells[i];
+            if (!IsFileExtension(cell->modelPath, ".obj")) {
+                TraceLog(LOG_WARNING, "BENCH: [%s] Skipped; only OBJ cells load without a GL context", cell->modelPath);
+                continue;
+            }
+            Matrix transform = MatrixMultiply(MatrixScale(cell->scale, cell->scale, cell->scale), MatrixTranslate(cell->position.x, cell->position.y, cell->position.z));
+            CollisionMesh local = ParseObjTriangles(cell->modelPath, MatrixIdentity());
+            BaselineSource source = { GetBaselineMesh(&local), transform };
+            UnloadCollisionMesh(&local);
+            CollisionMesh mesh = ParseObjTriangles(cell->modelPath, transform);
+            mesh.slopes = world.slopes;
+            BuildCollisionBvh(&mesh);
+            if (mesh.triangleCount > 0) {
+                CollisionWorld collision = { 0 };
+                AddCollisionMesh(&collision, &mesh);
+                failures += RunVerifyCase(GetFileNameWithoutExt(cell->modelPath), &collision, &(BaselineLevel){ &source, 1 }, seed, &divergence);
+            }
+            RL_FREE(source.mesh.vertices);
+            UnloadCollisionMesh(&mesh);
+        }
+    }
+    pthread_mutex_destroy(&world.lock);
+    float size = sqrtf(VERIFY_STRESS_TRIANGLES * SCALING_BENCH_AREA_PER_TRIANGLE);
+    for (int kind = 0; kind < STRESS_LEVEL_KIND_COUNT; kind++) {
+        CollisionMesh mesh = GenerateStressLevelOfKind(kind, VERIFY_STRESS_TRIANGLES, size, BENCH_SEED);
+        CollisionWorld collision = { 0 };
+        AddCollisionMesh(&collision, &mesh);
+        BaselineSource source = { GetBaselineMesh(&mesh), MatrixIdentity() };
+        failures += RunVerifyCase(GetStressLevelKindName(kind), &collision, &(BaselineLevel){ &source, 1 }, seed, &divergence);
+        RL_FREE(source.mesh.vertices);
+        UnloadCollisionMesh(&mesh);
+    }
+    // Props at random turns and scales on a room, so instance transforms and the top-level tree are
+    // exercised alongside a static mesh
+    int side = (int)ceilf(sqrtf((float)VERIFY_PROP_COUNT));
+    CollisionMesh room = GenerateStressLevel(PROP_BENCH_ROOM_TRIANGLES, side * PROP_BENCH_SPACING, BENCH_SEED);
+    CollisionMesh propMeshes[PROP_BENCH_UNIQUE_MESHES];
+    for (int i = 0; i < PROP_BENCH_UNIQUE_MESHES; i++) propMeshes[i] = GenerateStressLevel(PROP_BENCH_MESH_TRIANGLES, PROP_BENCH_MESH_SIZE, BENCH_SEED + 1 + i);
+    CollisionInstance* instances = RL_MALLOC(sizeof(CollisionInstance) * VERIFY_PROP_COUNT);
+    Mesh propBaselines[PROP_BENCH_UNIQUE_MESHES];
+    for (int i = 0; i < PROP_BENCH_UNIQUE_MESHES; i++) propBaselines[i] = GetBaselineMesh(&propMeshes[i]);
+    BaselineSource* sources = RL_MALLOC(sizeof(BaselineSource) * (VERIFY_PROP_COUNT + 1));
+    sources[0] = (BaselineSource){ GetBaselineMesh(&room), MatrixIdentity() };
+    CollisionWorld collision = { 0 };
+    AddCollisionMesh(&collision, &room);
+    unsigned int state = BENCH_SEED;
+    for (int i = 0; i < VERIFY_PROP_COUNT; i++) {
+        Vector3 position = {
+            room.bounds.min.x + ((i % side) + StressRandomFloat(&state, 0.25f, 0.75f)) * PROP_BENCH_SPACING,
+            StressRandomFloat(&state, room.bounds.min.y, room.bounds.max.y),
+            room.bounds.min.z + ((i / side) + StressRandomFloat(&state, 0.25f, 0.75f)) * PROP_BENCH_SPACING
+        };
+        float scale = StressRandomFloat(&state, 0.5f, 1.5f);
+        Matrix transform = MatrixMultiply(MatrixMultiply(MatrixScale(scale, scale, scale), MatrixRotateY(StressRandomFloat(&state, 0.0f, 2.0f * PI))),
+            MatrixTranslate(position.x, position.y, position.z));
+        int meshIndex = StressRandom(&state) % PROP_BENCH_UNIQUE_MESHES;
+        instances[i] = (CollisionInstance){ .mesh = &propMeshes[meshIndex] };
+        SetCollisionInstanceTransform(&instances[i], transform);
+        AddCollisionInstance(&collision, &instances[i]);
+        sources[i + 1] = (BaselineSource){ propBaselines[meshIndex], transform };
+    }
+    UpdateCollisionInstanceTree(&collision);
+    failures += RunVerifyCase("instanced props", &collision, &(BaselineLevel){ sources, VERIFY_PROP_COUNT + 1 }, seed, &divergence);
+    FreeCollisionWorld(&collision);
+    RL_FREE(sources[0].mesh.vertices);
+    RL_FREE(sources);
+    for (int i = 0; i < PROP_BENCH_UNIQUE_MESHES; i++) RL_FREE(propBaselines[i].vertices);
+    RL_FREE(instances);
+    for (int i = 0; i < PROP_BENCH_UNIQUE_MESHES; i++) UnloadCollisionMesh(&propMeshes[i]);
+    UnloadCollisionMesh(&room);
+    failures += RunLedgeVerification();
+    TraceLog(LOG_INFO, "BENCH: Against the baseline oracle: %d floors differ (%d found by one only, max %.3f), %d pushes differ (max %.3f), "
+        "%d contact counts", divergence.floors, divergence.missingFloors, divergence.maxFloor, divergence.pushes, divergence.maxPush,
+        divergence.contacts);
+    TraceLog(failures ? LOG_WARNING : LOG_INFO, "BENCH: %s", failures ? TextFormat("%d mismatches against brute force", failures) :
+        "Accelerated queries agree with brute force on every level");
+    return failures;
+}
+// Characters wander the level, picking a new heading now and then, and every move's collision work
+// lands in the heatmap cell it ended in
+int RunHeatmapBenchmark(const char* worldFile, const char* csvFile) {
+    JobSystemInit(JOB_WORKERS_AUTO);
+    static World world;
+    if (!LoadWorldLayout(&world, worldFile, (WorldStreamingSettings){ 0 })) return 1;
+    CollisionMesh meshes[MAX_WORLD_CELLS];
+    int meshCount = 0;
+    CollisionWorld collision = { 0 };
+    for (int i = 0; i < world.cellCount; i++) {
+        const WorldCell* cell = &world.cells[i];
+        if (!IsFileExtension(cell->modelPath, ".obj")) {
+            TraceLog(LOG_WARNING, "BENCH: [%s] Skipped; only OBJ cells load without a GL context", cell->modelPath);
+            continue;
+        }
+        Matrix transform = MatrixMultiply(MatrixScale(cell->scale, cell->scale, cell->scale), MatrixTranslate(cell->position.x, cell->position.y, cell->position.z));
+        meshes[meshCount] = LoadObjCollisionMesh(cell->modelPath, transform);
+        meshes[meshCount].slopes = world.slopes;
+        BuildCollisionBvh(&meshes[meshCount]);
+        AddCollisionMesh(&collision, &meshes[meshCount++]);
+    }
+    pthread_mutex_destroy(&world.lock);
+    if (meshCount == 0) {
+        TraceLog(LOG_WARNING, "BENCH: No OBJ cells in [%s] to map", worldFile);
+        return 1;
+    }
+    BoundingBox bounds = meshes[0].bounds;
+    for (int i = 1; i < meshCount; i++) {
+        bounds.min = Vector3Min(bounds.min, meshes[i].bounds.min);
+        bounds.max = Vector3Max(bounds.max, meshes[i].bounds.max);
+    }
+    CollisionHeatmap heatmap;
+    InitCollisionHeatmap(&heatmap, bounds, HEATMAP_BENCH_CELL_SIZE);
+    int count = HEATMAP_BENCH_CHARACTERS;
+    CollisionCapsule* capsules = RL_CALLOC(count, sizeof(CollisionCapsule));
+    Vector3* positions = RL_MALLOC(sizeof(Vector3) * count);
+    Vector3* velocities = RL_CALLOC(count, sizeof(Vector3));
+    Vector3* wishDirections = RL_MALLOC(sizeof(Vector3) * count);
+    float* moveSpeeds = RL_MALLOC(sizeof(float) * count);
+    bool* grounded = RL_CALLOC(count, sizeof(bool));
+    CollisionQueryCost* costs = RL_MALLOC(sizeof(CollisionQueryCost) * count);
+    CollisionCache* cacheStorage = RL_CALLOC(count, sizeof(CollisionCache));
+    CollisionCache** caches = RL_MALLOC(sizeof(CollisionCache*) * count);
+    unsigned int state = BENCH_SEED;
+    for (int i = 0; i < count; i++) {
+        positions[i] = (Vector3){ StressRandomFloat(&state, bounds.min.x, bounds.max.x), bounds.max.y, StressRandomFloat(&state, bounds.min.z, bounds.max.z) };
+        capsules[i] = (CollisionCapsule){ positions[i], HEATMAP_BENCH_RADIUS, HEATMAP_BENCH_HEIGHT / 2.0f, false };
+        moveSpeeds[i] = 2.0f;
+        caches[i] = &cacheStorage[i];
+    }
+    CharacterMoveBatch batch = { count, capsules, positions, velocities, wishDirections, moveSpeeds, NULL, NULL, caches };
+    CharacterMoveResults results = { positions, velocities, grounded, costs };
+    CollisionQueryCost total = { 0 };
+    for (int tick = 0; tick < HEATMAP_BENCH_TICKS; tick++) {
+        if (tick % HEATMAP_BENCH_TURN_TICKS == 0) {
+            for (int i = 0; i < count; i++) {
+                float heading = StressRandomFloat(&state, 0.0f, 2.0f * PI);
+                wishDirections[i] = (Vector3){ sinf(heading), 0.0f, cosf(heading) };
+            }
+        }
+        MoveCharacters(&collision, &batch, &results, CROWD_BENCH_STEP);
+        for (int i = 0; i < count; i++) {
+            capsules[i].isOnGround = grounded[i];
+            RecordCollisionHeat(&heatmap, positions[i], costs[i]);
+            total.nodesVisited += costs[i].nodesVisited;
+            total.trianglesTested += costs[i].trianglesTested;
+        }
+    }
+    long long moves = (long long)count * HEATMAP_BENCH_TICKS;
+    TraceLog(LOG_INFO, "BENCH: Collision heatmap: [%s] %d characters for %d ticks on %.0f m cells, %.1f nodes and %.1f triangles per move",
+        worldFile, count, HEATMAP_BENCH_TICKS, HEATMAP_BENCH_CELL_SIZE, (double)total.nodesVisited / moves, (double)total.trianglesTested / moves);
+    CollisionHotspot spots[COLLISION_HEATMAP_TOP_COUNT];
+    int spotCount = GetCollisionHotspots(&heatmap, spots, COLLISION_HEATMAP_TOP_COUNT);
+    TraceLog(LOG_INFO, "BENCH: rank        x        z   height    moves   nodes/move   tris/move   total cost");
+    for (int i = 0; i < spotCount; i++) {
+        const CollisionHeatCell* cell = &spots[i].cell;
+        TraceLog(LOG_INFO, "BENCH: %4d %8.1f %8.1f %8.2f %8lld %12.1f %11.1f %12lld", i + 1, spots[i].position.x, spots[i].position.z,
+            spots[i].position.y, cell->queries, (double)cell->nodesVisited / cell->queries, (double)cell->trianglesTested / cell->queries,
+            cell->nodesVisited + cell->trianglesTested);
+    }
+    bool exported = !csvFile || ExportCollisionHeatmapCsv(&heatmap, csvFile);
+    RL_FREE(caches);
+    RL_FREE(cacheStorage);
+    RL_FREE(costs);
+    RL_FREE(grounded);
+    RL_FREE(moveSpeeds);
+    RL_FREE(wishDirections);
+    RL_FREE(velocities);
+    RL_FREE(positions);
+    RL_FREE(capsules);
+    FreeCollisionHeatmap(&heatmap);
+    FreeCollisionWorld(&collision);
+    for (int i = 0; i < meshCount; i++) UnloadCollisionMesh(&meshes[i]);
+    return exported ? 0 : 1;
+}
@@ -0,0 +1,19 @@
+#ifndef BENCH_H
+#define BENCH_H
+// Headless benchmarks run from the command line before any window exists. Each returns a process
+// exit code, non-zero when one of its checks failed.
+int RunJobScalingBenchmark(int maxThreads);
+int RunCrowdBenchmark(int characterCount);
+int RunBroadphaseBenchmark(int maxCount);
+int RunRaycastBenchmark(int triangleCount);
+int RunPacketRayBenchmark(const char* worldFile);
+int RunPropBenchmark(int propCount);
+int RunSimplifyBenchmark(const char* worldFile);
+int RunScalingBenchmark(int maxTriangles);
+// Where a crowd's collision work piles up on the world's OBJ cells: the costliest cells, and every
+// cell to csvFile unless it is NULL
+int RunHeatmapBenchmark(const char* worldFile, const char* csvFile);
+// Not a benchmark but the oracle for one: accelerated collision queries against brute force, with
+// the seeds of any mismatch and the speed-up. seed 0 uses the default.
+int RunCollisionVerification(const char* worldFile, unsigned int seed);
+#endif
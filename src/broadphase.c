@@ -0,0 +1,98 @@
+#include "memtrack.h"
+#include <stdlib.h>
+#include "../include/raylib.h"
+#include "../include/raymath.h"
+#include "broadphase.h"
+void InitCapsuleBroadphase(CapsuleBroadphase* broadphase) {
+    *broadphase = (CapsuleBroadphase){ 0 };
+}
+void FreeCapsuleBroadphase(CapsuleBroadphase* broadphase) {
+    RL_FREE(broadphase->endpoints);
+    RL_FREE(broadphase->bounds);
+    RL_FREE(broadphase->pairs);
+    *broadphase = (CapsuleBroadphase){ 0 };
+}
+static int CompareEndpoints(const void* a, const void* b) {
+    float minA = ((const SweepEndpoint*)a)->minX;
+    float minB = ((const SweepEndpoint*)b)->minX;
+    return (minA > minB) - (minA < minB);
+}
+static bool ReserveBroadphase(CapsuleBroadphase* broadphase, int count) {
+    if (count <= broadphase->capacity) return true;
+    MemoryTag previousTag = PushMemoryTag(MEMORY_TAG_COLLISION);
+    SweepEndpoint* endpoints = RL_REALLOC(broadphase->endpoints, sizeof(SweepEndpoint) * count);
+    if (endpoints) broadphase->endpoints = endpoints;
+    BoundingBox* bounds = RL_REALLOC(broadphase->bounds, sizeof(BoundingBox) * count);
+    if (bounds) broadphase->bounds = bounds;
+    PopMemoryTag(previousTag);
+    if (!endpoints || !bounds) return false;
+    broadphase->capacity = count;
+    return true;
+}
+static void AddPair(CapsuleBroadphase* broadphase, int a, int b) {
+    if (broadphase->pairCount == broadphase->pairCapacity) {
+        int capacity = broadphase->pairCapacity ? broadphase->pairCapacity * 2 : 256;
+        MemoryTag previousTag = PushMemoryTag(MEMORY_TAG_COLLISION);
+        CapsulePair* pairs = RL_REALLOC(broadphase->pairs, sizeof(CapsulePair) * capacity);
+        PopMemoryTag(previousTag);
+        if (!pairs) return;
+        broadphase->pairs = pairs;
+        broadphase->pairCapacity = capacity;
+    }
+    broadphase->pairs[broadphase->pairCount++] = a < b ? (CapsulePair){ a, b } : (CapsulePair){ b, a };
+}
+int UpdateCapsuleBroadphase(CapsuleBroadphase* broadphase, const Vector3* positions, const CollisionCapsule* capsules, int count) {
+    broadphase->pairCount = 0;
+    broadphase->lastSwapCount = 0;
+    if (!ReserveBroadphase(broadphase, count)) return 0;
+    // Same segment and radius ResolveCapsuleCollision uses: base at the position, height above it
+    for (int i = 0; i < count; i++) {
+        float radius = capsules[i].radius;
+        float height = capsules[i].halfHeight * 2.0f;
+        broadphase->bounds[i] = (BoundingBox){
+            { positions[i].x - radius, positions[i].y - radius, positions[i].z - radius },
+            { positions[i].x + radius, positions[i].y + height + radius, positions[i].z + radius }
+        };
+    }
+    SweepEndpoint* endpoints = broadphase->endpoints;
+    if (count != broadphase->count) {
+        for (int i = 0; i < count; i++) endpoints[i] = (SweepEndpoint){ broadphase->bounds[i].min.x, i };
+        qsort(endpoints, count, sizeof(SweepEndpoint), CompareEndpoints);
+        broadphase->count = count;
+    } else {
+        for (int i = 0; i < count; i++) endpoints[i].minX = broadphase->bounds[endpoints[i].proxy].min.x;
+        for (int i = 1; i < count; i++) {
+            SweepEndpoint endpoint = endpoints[i];
+            int j = i - 1;
+            for (; j >= 0 && endpoints[j].minX > endpoint.minX; j--) endpoints[j + 1] = endpoints[j];
+            broadphase->lastSwapCount += i - 1 - j;
+            endpoints[j + 1] = endpoint;
+        }
+    }
+    for (int i = 0; i < count; i++) {
+        const BoundingBox* a = &broadphase->bounds[endpoints[i].proxy];
+        for (int j = i + 1; j < count && endpoints[j].minX <= a->max.x; j++) {
+            const BoundingBox* b = &broadphase->bounds[endpoints[j].proxy];
+            if (a->max.z < b->min.z || b->max.z < a->min.z || a->max.y < b->min.y || b->max.y < a->min.y) continue;
+            AddPair(broadphase, endpoints[i].proxy, endpoints[j].proxy);
+        }
+    }
+    return broadphase->pairCount;
+}
+int SeparateCapsulePairs(const CapsuleBroadphase* broadphase, Vector3* positions, const CollisionCapsule* capsules) {
+    int contactCount = 0;
+    for (int i = 0; i < broadphase->pairCount; i++) {
+        int a = broadphase->pairs[i].a;
+        int b = broadphase->pairs[i].b;
+        Vector3 topA = Vector3Add(positions[a], (Vector3){ 0.0f, capsules[a].halfHeight * 2.0f, 0.0f });
+        Vector3 topB = Vector3Add(positions[b], (Vector3){ 0.0f, capsules[b].halfHeight * 2.0f, 0.0f });
+        Vector3 pushOut;
+        if (!TestCapsuleCapsule(positions[a], topA, capsules[a].radius, positions[b], topB, capsules[b].radius, &pushOut)) continue;
+        pushOut.y = 0.0f;
+        pushOut = Vector3Scale(pushOut, 0.5f);
+        positions[a] = Vector3Add(positions[a], pushOut);
+        positions[b] = Vector3Subtract(positions[b], pushOut);
+        contactCount++;
+    }
+    return contactCount;
+}
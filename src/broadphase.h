@@ -0,0 +1,34 @@
+#ifndef BROADPHASE_H
+#define BROADPHASE_H
+#include "../include/raylib.h"
+#include "collision.h"
+typedef struct {
+    int a;
+    int b;
+} CapsulePair;
+typedef struct {
+    float minX;
+    int proxy;
+} SweepEndpoint;
+// Sweep-and-prune along X. The endpoint order is kept between updates and repaired with an
+// insertion sort, which is close to linear while actors move a little each tick. Proxies are the
+// caller's array indices; a change in count re-sorts from scratch.
+typedef struct {
+    SweepEndpoint* endpoints;
+    BoundingBox* bounds;
+    int count;
+    int capacity;
+    CapsulePair* pairs;
+    int pairCount;
+    int pairCapacity;
+    long long lastSwapCount;
+} CapsuleBroadphase;
+void InitCapsuleBroadphase(CapsuleBroadphase* broadphase);
+void FreeCapsuleBroadphase(CapsuleBroadphase* broadphase);
+// Finds every pair of capsules whose bounds overlap; pair.a is always the lower index
+int UpdateCapsuleBroadphase(CapsuleBroadphase* broadphase, const Vector3* positions, const CollisionCapsule* capsules, int count);
+// Runs the capsule-capsule narrow phase on the current pairs and splits each push evenly between
+// the two capsules, horizontally only so neighbours never shove each other into the floor.
+// Returns the number of pairs that were actually touching.
+int SeparateCapsulePairs(const CapsuleBroadphase* broadphase, Vector3* positions, const CollisionCapsule* capsules);
+#endif
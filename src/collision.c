@@ -0,0 +1,889 @@
+#include "memtrack.h"
+#include "../include/raylib.h"
+#include "../include/raymath.h"
+#include "collision.h"
+#define COLLISION_BVH_LEAF_SIZE 4
+#define COLLISION_TLAS_LEAF_SIZE 2
+#define SWEEP_MAX_STEPS 16
+static const float SWEEP_SKIN = 0.005f;
+static const float SWEEP_TOLERANCE = 0.001f;
+static const float INSTANCE_BOX_PADDING = 0.001f;
+static const float RESOLVE_MIN_DEPTH = 0.0001f;
+static const int RESOLVE_MAX_CONTACTS = 8;
+// FindFloor takes the highest floor up to this far above the position
+static const float FLOOR_QUERY_REACH = 100.0f;
+typedef void (*TriangleVisitor)(void* data, const Triangle* tri);
+Vector3 ClosestPointOnLineSegment(Vector3 a, Vector3 b, Vector3 point) {
+    Vector3 ab = Vector3Subtract(b, a);
+    float t = Vector3DotProduct(Vector3Subtract(point, a), ab) / Vector3DotProduct(ab, ab);
+    t = fmaxf(0.0f, fminf(1.0f, t));
+    return Vector3Add(a, Vector3Scale(ab, t));
+}
+bool IsPointInTriangle(Vector3 point, Triangle tri) {
+    Vector3 v0 = Vector3Subtract(tri.v2, tri.v0);
+    Vector3 v1 = Vector3Subtract(tri.v1, tri.v0);
+    Vector3 v2 = Vector3Subtract(point, tri.v0);
+    float dot00 = Vector3DotProduct(v0, v0);
+    float dot01 = Vector3DotProduct(v0, v1);
+    float dot02 = Vector3DotProduct(v0, v2);
+    float dot11 = Vector3DotProduct(v1, v1);
+    float dot12 = Vector3DotProduct(v1, v2);
+    float invDenom = 1.0f / (dot00 * dot11 - dot01 * dot01);
+    float u = (dot11 * dot02 - dot01 * dot12) * invDenom;
+    float v = (dot00 * dot12 - dot01 * dot02) * invDenom;
+    return (u >= 0) && (v >= 0) && (u + v <= 1);
+}
+Triangle GetTriangle(Mesh mesh, Matrix transform, int triIndex) {
+    Triangle tri = {0};
+    Vector3 v0, v1, v2;
+    if (mesh.indices) {
+        if (triIndex * 3 + 2 >= mesh.triangleCount * 3) {
+            return tri;
+        }
+        int i0 = mesh.indices[triIndex * 3 + 0];
+        int i1 = mesh.indices[triIndex * 3 + 1];
+        int i2 = mesh.indices[triIndex * 3 + 2];
+        v0 = (Vector3){ mesh.vertices[i0*3], mesh.vertices[i0*3+1], mesh.vertices[i0*3+2] };
+        v1 = (Vector3){ mesh.vertices[i1*3], mesh.vertices[i1*3+1], mesh.vertices[i1*3+2] };
+        v2 = (Vector3){ mesh.vertices[i2*3], mesh.vertices[i2*3+1], mesh.vertices[i2*3+2] };
+    } else {
+        if (triIndex * 9 + 8 >= mesh.vertexCount * 3) {
+            return tri;
+        }
+        int baseIdx = triIndex * 9; // 3 vertices * 3 floats each
+        v0 = (Vector3){ mesh.vertices[baseIdx], mesh.vertices[baseIdx+1], mesh.vertices[baseIdx+2] };
+        v1 = (Vector3){ mesh.vertices[baseIdx+3], mesh.vertices[baseIdx+4], mesh.vertices[baseIdx+5] };
+        v2 = (Vector3){ mesh.vertices[baseIdx+6], mesh.vertices[baseIdx+7], mesh.vertices[baseIdx+8] };
+    }
+    tri.v0 = Vector3Transform(v0, transform);
+    tri.v1 = Vector3Transform(v1, transform);
+    tri.v2 = Vector3Transform(v2, transform);
+    Vector3 edge1 = Vector3Subtract(tri.v1, tri.v0);
+    Vector3 edge2 = Vector3Subtract(tri.v2, tri.v0);
+    tri.normal = Vector3Normalize(Vector3CrossProduct(edge1, edge2));
+    return tri;
+}
+bool TestCapsuleTriangle(Vector3 capsuleBase, Vector3 capsuleTop, float radius, Triangle tri, Vector3* pushOut) {
+    Vector3 closestOnCapsule = ClosestPointOnLineSegment(capsuleBase, capsuleTop, tri.v0);
+    float distanceToPlane = Vector3DotProduct(Vector3Subtract(closestOnCapsule, tri.v0), tri.normal);
+    if (fabsf(distanceToPlane) > radius) {
+        return false;
+    }
+    Vector3 pointOnPlane = Vector3Subtract(closestOnCapsule, Vector3Scale(tri.normal, distanceToPlane));
+    if (IsPointInTriangle(pointOnPlane, tri)) {
+        if (fabsf(distanceToPlane) < radius) {
+            float penetration = radius - fabsf(distanceToPlane);
+            float direction = distanceToPlane >= 0 ? 1.0f : -1.0f;
+            *pushOut = Vector3Scale(tri.normal, penetration * direction);
+            return true;
+        }
+    }
+    return false;
+}
+// Closest points between segments p1-q1 and p2-q2 (Ericson, Real-Time Collision Detection 5.1.9)
+void ClosestPointsBetweenSegments(Vector3 p1, Vector3 q1, Vector3 p2, Vector3 q2, Vector3* outA, Vector3* outB) {
+    Vector3 d1 = Vector3Subtract(q1, p1);
+    Vector3 d2 = Vector3Subtract(q2, p2);
+    Vector3 r = Vector3Subtract(p1, p2);
+    float a = Vector3DotProduct(d1, d1);
+    float e = Vector3DotProduct(d2, d2);
+    float f = Vector3DotProduct(d2, r);
+    float s, t;
+    if (a <= EPSILON && e <= EPSILON) {
+        s = t = 0.0f;
+    } else if (a <= EPSILON) {
+        s = 0.0f;
+        t = Clamp(f / e, 0.0f, 1.0f);
+    } else {
+        float c = Vector3DotProduct(d1, r);
+        if (e <= EPSILON) {
+            t = 0.0f;
+            s = Clamp(-c / a, 0.0f, 1.0f);
+        } else {
+            float b = Vector3DotProduct(d1, d2);
+            float denom = a * e - b * b;
+            s = denom != 0.0f ? Clamp((b * f - c * e) / denom, 0.0f, 1.0f) : 0.0f;
+            t = (b * s + f) / e;
+            if (t < 0.0f) {
+                t = 0.0f;
+                s = Clamp(-c / a, 0.0f, 1.0f);
+            } else if (t > 1.0f) {
+                t = 1.0f;
+                s = Clamp((b - c) / a, 0.0f, 1.0f);
+            }
+        }
+    }
+    *outA = Vector3Add(p1, Vector3Scale(d1, s));
+    *outB = Vector3Add(p2, Vector3Scale(d2, t));
+}
+bool TestCapsuleCapsule(Vector3 baseA, Vector3 topA, float radiusA, Vector3 baseB, Vector3 topB, float radiusB, Vector3* pushOut) {
+    Vector3 closestA, closestB;
+    ClosestPointsBetweenSegments(baseA, topA, baseB, topB, &closestA, &closestB);
+    Vector3 separation = Vector3Subtract(closestA, closestB);
+    float distanceSqr = Vector3LengthSqr(separation);
+    float radii = radiusA + radiusB;
+    if (distanceSqr >= radii * radii) return false;
+    float distance = sqrtf(distanceSqr);
+    // Coincident axes have no preferred direction; any horizontal one separates them
+    Vector3 normal = distance > EPSILON ? Vector3Scale(separation, 1.0f / distance) : (Vector3){ 1.0f, 0.0f, 0.0f };
+    *pushOut = Vector3Scale(normal, radii - distance);
+    return true;
+}
+float ClosestPointsSegmentTriangle(Vector3 p, Vector3 q, Triangle tri, Vector3* outSegment, Vector3* outTriangle) {
+    float distanceP = Vector3DotProduct(Vector3Subtract(p, tri.v0), tri.normal);
+    float distanceQ = Vector3DotProduct(Vector3Subtract(q, tri.v0), tri.normal);
+    if ((distanceP <= 0.0f) != (distanceQ <= 0.0f)) {
+        Vector3 crossing = Vector3Lerp(p, q, distanceP / (distanceP - distanceQ));
+        if (IsPointInTriangle(crossing, tri)) {
+            *outSegment = *outTriangle = crossing;
+            return 0.0f;
+        }
+    }
+    // Otherwise the closest pair is an endpoint over the face or the segment against an edge
+    float bestSqr = 1e30f;
+    Vector3 endpoints[2] = { p, q };
+    float distances[2] = { distanceP, distanceQ };
+    for (int i = 0; i < 2; i++) {
+        Vector3 projected = Vector3Subtract(endpoints[i], Vector3Scale(tri.normal, distances[i]));
+        if (distances[i] * distances[i] >= bestSqr || !IsPointInTriangle(projected, tri)) continue;
+        bestSqr = distances[i] * distances[i];
+        *outSegment = endpoints[i];
+        *outTriangle = projected;
+    }
+    Vector3 corners[3] = { tri.v0, tri.v1, tri.v2 };
+    for (int i = 0; i < 3; i++) {
+        Vector3 onSegment, onEdge;
+        ClosestPointsBetweenSegments(p, q, corners[i], corners[(i + 1) % 3], &onSegment, &onEdge);
+        float distanceSqr = Vector3DistanceSqr(onSegment, onEdge);
+        if (distanceSqr >= bestSqr) continue;
+        bestSqr = distanceSqr;
+        *outSegment = onSegment;
+        *outTriangle = onEdge;
+    }
+    return sqrtf(bestSqr);
+}
+static int GetMeshTriangleCount(Mesh mesh) {
+    return mesh.triangleCount ? mesh.triangleCount : mesh.vertexCount / 3;
+}
+CollisionSlopeSettings GetCollisionSlopeSettings(float floorDegrees, float ceilingDegrees) {
+    // Kept short of vertical so a floor's normal.y, which FindFloor divides by, never reaches zero
+    return (CollisionSlopeSettings){
+        cosf(Clamp(floorDegrees, 0.0f, 89.0f) * DEG2RAD),
+        -cosf(Clamp(ceilingDegrees, 0.0f, 89.0f) * DEG2RAD)
+    };
+}
+CollisionMesh BuildCollisionMesh(Model model, Matrix transform) {
+    return BuildCollisionMeshSubset(model, transform, NULL, GetCollisionSlopeSettings(COLLISION_FLOOR_SLOPE_DEGREES, COLLISION_CEILING_SLOPE_DEGREES));
+}
+CollisionMesh BuildCollisionMeshSubset(Model model, Matrix transform, const bool* includeMesh, CollisionSlopeSettings slopes) {
+    MemoryTag previousTag = PushMemoryTag(MEMORY_TAG_COLLISION);
+    CollisionMesh collisionMesh = { .slopes = slopes };
+    int capacity = 0;
+    for (int meshIdx = 0; meshIdx < model.meshCount; meshIdx++) {
+        if (includeMesh && !includeMesh[meshIdx]) continue;
+        capacity += GetMeshTriangleCount(model.meshes[meshIdx]);
+    }
+    collisionMesh.triangles = RL_MALLOC(capacity * sizeof(Triangle));
+    collisionMesh.bounds = (BoundingBox){ { 1e30f, 1e30f, 1e30f }, { -1e30f, -1e30f, -1e30f } };
+    for (int meshIdx = 0; meshIdx < model.meshCount && collisionMesh.triangles; meshIdx++) {
+        if (includeMesh && !includeMesh[meshIdx]) continue;
+        Mesh mesh = model.meshes[meshIdx];
+        int triangleCount = GetMeshTriangleCount(mesh);
+        for (int i = 0; i < triangleCount; i++) {
+            Triangle tri = GetTriangle(mesh, transform, i);
+            if (Vector3LengthSqr(tri.normal) < 0.001f) continue;
+            tri.materialId = model.meshMaterial ? model.meshMaterial[meshIdx] : 0;
+            collisionMesh.triangles[collisionMesh.triangleCount++] = tri;
+            collisionMesh.bounds.min = Vector3Min(collisionMesh.bounds.min, Vector3Min(tri.v0, Vector3Min(tri.v1, tri.v2)));
+            collisionMesh.bounds.max = Vector3Max(collisionMesh.bounds.max, Vector3Max(tri.v0, Vector3Max(tri.v1, tri.v2)));
+        }
+    }
+    PopMemoryTag(previousTag);
+    BuildCollisionBvh(&collisionMesh);
+    return collisionMesh;
+}
+static float GetAxis(Vector3 v, int axis) {
+    return axis == 0 ? v.x : (axis == 1 ? v.y : v.z);
+}
+typedef struct {
+    int node;
+    int depth;
+} BvhBuildTask;
+static CollisionSurface GetTriangleSurface(const Triangle* tri, CollisionSlopeSettings slopes) {
+    if (tri->normal.y > slopes.floorMinNormalY) return COLLISION_SURFACE_FLOOR;
+    return tri->normal.y < slopes.ceilingMaxNormalY ? COLLISION_SURFACE_CEILING : COLLISION_SURFACE_WALL;
+}
+// Three-way partition in place, floors first and ceilings last, so the classes stay contiguous even
+// when there is no memory for the BVH
+static void SortTrianglesBySurface(CollisionMesh* mesh) {
+    Triangle* floorEnd = mesh->triangles;
+    Triangle* wallEnd = mesh->triangles;
+    Triangle* ceilingStart = mesh->triangles + mesh->triangleCount;
+    while (wallEnd != ceilingStart) {
+        CollisionSurface surface = GetTriangleSurface(wallEnd, mesh->slopes);
+        if (surface == COLLISION_SURFACE_WALL) { wallEnd++; continue; }
+        Triangle* target = surface == COLLISION_SURFACE_FLOOR ? floorEnd++ : --ceilingStart;
+        Triangle swap = *target;
+        *target = *wallEnd;
+        *wallEnd = swap;
+        if (surface == COLLISION_SURFACE_FLOOR) wallEnd++;
+    }
+    mesh->surfaceStart[COLLISION_SURFACE_FLOOR] = 0;
+    mesh->surfaceStart[COLLISION_SURFACE_WALL] = (int)(floorEnd - mesh->triangles);
+    mesh->surfaceStart[COLLISION_SURFACE_CEILING] = (int)(ceilingStart - mesh->triangles);
+    mesh->surfaceStart[COLLISION_SURFACE_COUNT] = mesh->triangleCount;
+}
+static void JoinChildBounds(const CollisionBvhNode* nodes, CollisionBvhNode* node) {
+    node->bounds.min = Vector3Min(nodes[node->start].bounds.min, nodes[node->start + 1].bounds.min);
+    node->bounds.max = Vector3Max(nodes[node->start].bounds.max, nodes[node->start + 1].bounds.max);
+}
+// Top-down midpoint split on the longest centroid axis, one subtree per surface class. The class
+// roots hang under at most two joining nodes at the top, so node 0 still spans every triangle. Nodes
+// deeper than the traversal stack allows become leaves regardless of size.
+void BuildCollisionBvh(CollisionMesh* mesh) {
+    RL_FREE(mesh->nodes);
+    mesh->nodes = NULL;
+    mesh->nodeCount = 0;
+    for (int i = 0; i < COLLISION_SURFACE_COUNT; i++) mesh->surfaceRoot[i] = -1;
+    SortTrianglesBySurface(mesh);
+    int triangleCount = mesh->triangleCount;
+    if (triangleCount == 0) return;
+    MemoryTag previousTag = PushMemoryTag(MEMORY_TAG_COLLISION);
+    CollisionBvhNode* nodes = RL_MALLOC(sizeof(CollisionBvhNode) * (2 * triangleCount - 1));
+    Triangle* ordered = RL_MALLOC(sizeof(Triangle) * triangleCount);
+    PopMemoryTag(previousTag);
+    int* order = RL_MALLOC(sizeof(int) * triangleCount);
+    Vector3* centroids = RL_MALLOC(sizeof(Vector3) * triangleCount);
+    if (!nodes || !ordered || !order || !centroids) {
+        RL_FREE(nodes);
+        RL_FREE(ordered);
+        RL_FREE(order);
+        RL_FREE(centroids);
+        return;
+    }
+    for (int i = 0; i < triangleCount; i++) {
+        const Triangle* tri = &mesh->triangles[i];
+        order[i] = i;
+        centroids[i] = Vector3Scale(Vector3Add(tri->v0, Vector3Add(tri->v1, tri->v2)), 1.0f / 3.0f);
+    }
+    // One class: its root is node 0. Two: node 0 joins them at 1 and 2. Three: node 0 joins the first
+    // at 1 with node 2, which joins the other two at 3 and 4.
+    int surfaces[COLLISION_SURFACE_COUNT];
+    int surfaceCount = 0;
+    for (int i = 0; i < COLLISION_SURFACE_COUNT; i++) {
+        if (mesh->surfaceStart[i + 1] > mesh->surfaceStart[i]) surfaces[surfaceCount++] = i;
+    }
+    static const int SURFACE_ROOT_NODES[COLLISION_SURFACE_COUNT][COLLISION_SURFACE_COUNT] = { { 0 }, { 1, 2 }, { 1, 3, 4 } };
+    static const int SURFACE_ROOT_DEPTHS[COLLISION_SURFACE_COUNT][COLLISION_SURFACE_COUNT] = { { 0 }, { 1, 1 }, { 1, 2, 2 } };
+    int nodeCount = surfaceCount * 2 - 1;
+    if (surfaceCount > 1) nodes[0] = (CollisionBvhNode){ .start = 1, .count = 0 };
+    if (surfaceCount > 2) nodes[2] = (CollisionBvhNode){ .start = 3, .count = 0 };
+    BvhBuildTask stack[COLLISION_BVH_MAX_DEPTH + 1];
+    BvhBuildTask* top = stack;
+    for (int i = 0; i < surfaceCount; i++) {
+        int surface = surfaces[i], root = SURFACE_ROOT_NODES[surfaceCount - 1][i];
+        int start = mesh->surfaceStart[surface];
+        nodes[root] = (CollisionBvhNode){ .start = start, .count = mesh->surfaceStart[surface + 1] - start };
+        mesh->surfaceRoot[surface] = root;
+        *top++ = (BvhBuildTask){ root, SURFACE_ROOT_DEPTHS[surfaceCount - 1][i] };
+    }
+    while (top != stack) {
+        BvhBuildTask task = *--top;
+        CollisionBvhNode* node = &nodes[task.node];
+        int start = node->start, count = node->count;
+        BoundingBox bounds = { { 1e30f, 1e30f, 1e30f }, { -1e30f, -1e30f, -1e30f } };
+        BoundingBox centroidBounds = bounds;
+        for (const int* index = order + start; index != order + start + count; index++) {
+            const Triangle* tri = &mesh->triangles[*index];
+            bounds.min = Vector3Min(bounds.min, Vector3Min(tri->v0, Vector3Min(tri->v1, tri->v2)));
+            bounds.max = Vector3Max(bounds.max, Vector3Max(tri->v0, Vector3Max(tri->v1, tri->v2)));
+            centroidBounds.min = Vector3Min(centroidBounds.min, centroids[*index]);
+            centroidBounds.max = Vector3Max(centroidBounds.max, centroids[*index]);
+        }
+        node->bounds = bounds;
+        if (count <= COLLISION_BVH_LEAF_SIZE || task.depth >= COLLISION_BVH_MAX_DEPTH - 1) continue;
+        Vector3 extent = Vector3Subtract(centroidBounds.max, centroidBounds.min);
+        int axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : (extent.y >= extent.z ? 1 : 2);
+        float split = 0.5f * (GetAxis(centroidBounds.min, axis) + GetAxis(centroidBounds.max, axis));
+        int* first = order + start;
+        int* last = order + start + count;
+        while (first != last) {
+            if (GetAxis(centroids[*first], axis) < split) { first++; continue; }
+            int swap = *first;
+            *first = *--last;
+            *last = swap;
+        }
+        int leftCount = (int)(first - (order + start));
+        if (leftCount == 0 || leftCount == count) leftCount = count / 2;
+        int left = nodeCount;
+        nodeCount += 2;
+        nodes[left] = (CollisionBvhNode){ .start = start, .count = leftCount };
+        nodes[left + 1] = (CollisionBvhNode){ .start = start + leftCount, .count = count - leftCount };
+        node->start = left;
+        node->count = 0;
+        *top++ = (BvhBuildTask){ left, task.depth + 1 };
+        *top++ = (BvhBuildTask){ left + 1, task.depth + 1 };
+    }
+    if (surfaceCount > 2) JoinChildBounds(nodes, &nodes[2]);
+    if (surfaceCount > 1) JoinChildBounds(nodes, &nodes[0]);
+    for (int i = 0; i < triangleCount; i++) ordered[i] = mesh->triangles[order[i]];
+    RL_FREE(mesh->triangles);
+    RL_FREE(order);
+    RL_FREE(centroids);
+    mesh->triangles = ordered;
+    mesh->nodes = nodes;
+    mesh->nodeCount = nodeCount;
+}
+void UnloadCollisionMesh(CollisionMesh* mesh) {
+    RL_FREE(mesh->triangles);
+    RL_FREE(mesh->nodes);
+    *mesh = (CollisionMesh){ 0 };
+}
+bool AddCollisionMesh(CollisionWorld* world, CollisionMesh* mesh) {
+    if (world->meshCount == MAX_COLLISION_MESHES) return false;
+    world->meshes[world->meshCount++] = mesh;
+    world->version++;
+    return true;
+}
+void RemoveCollisionMesh(CollisionWorld* world, CollisionMesh* mesh) {
+    for (int i = 0; i < world->meshCount; i++) {
+        if (world->meshes[i] != mesh) continue;
+        world->meshes[i] = world->meshes[--world->meshCount];
+        world->version++;
+        return;
+    }
+}
+// Box around all eight corners of box carried through transform
+static BoundingBox TransformBoundingBox(BoundingBox box, Matrix transform) {
+    BoundingBox result = { { 1e30f, 1e30f, 1e30f }, { -1e30f, -1e30f, -1e30f } };
+    for (int i = 0; i < 8; i++) {
+        Vector3 corner = { (i & 1) ? box.max.x : box.min.x, (i & 2) ? box.max.y : box.min.y, (i & 4) ? box.max.z : box.min.z };
+        corner = Vector3Transform(corner, transform);
+        result.min = Vector3Min(result.min, corner);
+        result.max = Vector3Max(result.max, corner);
+    }
+    return result;
+}
+void SetCollisionInstanceTransform(CollisionInstance* instance, Matrix transform) {
+    instance->transform = transform;
+    instance->inverse = MatrixInvert(transform);
+    instance->scale = Vector3Length((Vector3){ transform.m0, transform.m1, transform.m2 });
+    instance->bounds = TransformBoundingBox(instance->mesh->bounds, transform);
+}
+bool AddCollisionInstance(CollisionWorld* world, CollisionInstance* instance) {
+    if (world->instanceCount == world->instanceCapacity) {
+        int capacity = world->instanceCapacity ? world->instanceCapacity * 2 : 64;
+        MemoryTag previousTag = PushMemoryTag(MEMORY_TAG_COLLISION);
+        CollisionInstance** instances = RL_REALLOC(world->instances, sizeof(CollisionInstance*) * capacity);
+        if (instances) world->instances = instances;
+        CollisionBvhNode* nodes = RL_REALLOC(world->instanceNodes, sizeof(CollisionBvhNode) * (2 * capacity - 1));
+        if (nodes) world->instanceNodes = nodes;
+        PopMemoryTag(previousTag);
+        if (!instances || !nodes) return false;
+        world->instanceCapacity = capacity;
+    }
+    world->instances[world->instanceCount++] = instance;
+    world->instanceTreeDirty = true;
+    return true;
+}
+void RemoveCollisionInstance(CollisionWorld* world, CollisionInstance* instance) {
+    for (int i = 0; i < world->instanceCount; i++) {
+        if (world->instances[i] != instance) continue;
+        world->instances[i] = world->instances[--world->instanceCount];
+        world->instanceTreeDirty = true;
+        return;
+    }
+}
+// Same midpoint split as the mesh BVH, over instance bounds, with the instance pointers partitioned
+// in place so each leaf owns a contiguous run of them
+static void BuildInstanceTree(CollisionWorld* world) {
+    world->instanceNodeCount = 0;
+    world->instanceTreeDirty = false;
+    if (world->instanceCount == 0) return;
+    CollisionBvhNode* nodes = world->instanceNodes;
+    CollisionInstance** instances = world->instances;
+    int nodeCount = 1;
+    nodes[0] = (CollisionBvhNode){ .start = 0, .count = world->instanceCount };
+    BvhBuildTask stack[COLLISION_BVH_MAX_DEPTH + 1];
+    BvhBuildTask* top = stack;
+    *top++ = (BvhBuildTask){ 0, 0 };
+    while (top != stack) {
+        BvhBuildTask task = *--top;
+        CollisionBvhNode* node = &nodes[task.node];
+        int start = node->start, count = node->count;
+        BoundingBox bounds = { { 1e30f, 1e30f, 1e30f }, { -1e30f, -1e30f, -1e30f } };
+        BoundingBox centroidBounds = bounds;
+        for (CollisionInstance** instance = instances + start; instance != instances + start + count; instance++) {
+            Vector3 centroid = Vector3Scale(Vector3Add((*instance)->bounds.min, (*instance)->bounds.max), 0.5f);
+            bounds.min = Vector3Min(bounds.min, (*instance)->bounds.min);
+            bounds.max = Vector3Max(bounds.max, (*instance)->bounds.max);
+            centroidBounds.min = Vector3Min(centroidBounds.min, centroid);
+            centroidBounds.max = Vector3Max(centroidBounds.max, centroid);
+        }
+        node->bounds = bounds;
+        if (count <= COLLISION_TLAS_LEAF_SIZE || task.depth >= COLLISION_BVH_MAX_DEPTH - 1) continue;
+        Vector3 extent = Vector3Subtract(centroidBounds.max, centroidBounds.min);
+        int axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : (extent.y >= extent.z ? 1 : 2);
+        float split = 0.5f * (GetAxis(centroidBounds.min, axis) + GetAxis(centroidBounds.max, axis));
+        CollisionInstance** first = instances + start;
+        CollisionInstance** last = instances + start + count;
+        while (first != last) {
+            if (GetAxis((*first)->bounds.min, axis) + GetAxis((*first)->bounds.max, axis) < 2.0f * split) { first++; continue; }
+            CollisionInstance* swap = *first;
+            *first = *--last;
+            *last = swap;
+        }
+        int leftCount = (int)(first - (instances + start));
+        if (leftCount == 0 || leftCount == count) leftCount = count / 2;
+        int left = nodeCount;
+        nodeCount += 2;
+        nodes[left] = (CollisionBvhNode){ .start = start, .count = leftCount };
+        nodes[left + 1] = (CollisionBvhNode){ .start = start + leftCount, .count = count - leftCount };
+        node->start = left;
+        node->count = 0;
+        *top++ = (BvhBuildTask){ left, task.depth + 1 };
+        *top++ = (BvhBuildTask){ left + 1, task.depth + 1 };
+    }
+    world->instanceNodeCount = nodeCount;
+}
+// Children always come after their parent, so one backwards pass refits every node
+static void RefitInstanceTree(CollisionWorld* world) {
+    CollisionBvhNode* nodes = world->instanceNodes;
+    for (CollisionBvhNode* node = nodes + world->instanceNodeCount; node != nodes;) {
+        node--;
+        if (node->count == 0) {
+            JoinChildBounds(nodes, node);
+            continue;
+        }
+        CollisionInstance** instance = world->instances + node->start;
+        node->bounds = (*instance)->bounds;
+        for (instance++; instance != world->instances + node->start + node->count; instance++) {
+            node->bounds.min = Vector3Min(node->bounds.min, (*instance)->bounds.min);
+            node->bounds.max = Vector3Max(node->bounds.max, (*instance)->bounds.max);
+        }
+    }
+}
+void UpdateCollisionInstanceTree(CollisionWorld* world) {
+    if (world->instanceTreeDirty) BuildInstanceTree(world);
+    else RefitInstanceTree(world);
+}
+void FreeCollisionWorld(CollisionWorld* world) {
+    RL_FREE(world->instances);
+    RL_FREE(world->instanceNodes);
+    world->instances = NULL;
+    world->instanceNodes = NULL;
+    world->instanceCount = world->instanceCapacity = world->instanceNodeCount = 0;
+    world->instanceTreeDirty = false;
+}
+typedef void (*InstanceVisitor)(void* data, const CollisionInstance* instance);
+// Per thread, so the job workers moving characters count their own queries without contention
+static __thread CollisionQueryCost queryCost = { 0 };
+CollisionQueryCost GetCollisionQueryCost(void) {
+    return queryCost;
+}
+// An instance bounds test on the linear walk counts as one node
+static void VisitInstancesInBox(const CollisionWorld* world, BoundingBox box, InstanceVisitor visit, void* data) {
+    if (world->instanceTreeDirty || world->instanceNodeCount == 0) {
+        queryCost.nodesVisited += world->instanceCount;
+        for (int i = 0; i < world->instanceCount; i++) {
+            if (CheckCollisionBoxes(world->instances[i]->bounds, box)) visit(data, world->instances[i]);
+        }
+        return;
+    }
+    int stack[COLLISION_BVH_MAX_DEPTH + 1];
+    int* top = stack;
+    *top++ = 0;
+    while (top != stack) {
+        const CollisionBvhNode* node = &world->instanceNodes[*--top];
+        queryCost.nodesVisited++;
+        if (!CheckCollisionBoxes(node->bounds, box)) continue;
+        if (node->count > 0) {
+            CollisionInstance* const* last = world->instances + node->start + node->count;
+            for (CollisionInstance* const* instance = world->instances + node->start; instance != last; instance++) {
+                if (CheckCollisionBoxes((*instance)->bounds, box)) visit(data, *instance);
+            }
+        } else {
+            *top++ = node->start;
+            *top++ = node->start + 1;
+        }
+    }
+}
+static void FlagInstanceOverlap(void* data, const CollisionInstance* instance) {
+    (void)instance;
+    *(bool*)data = true;
+}
+bool OverlapsCollisionInstance(const CollisionWorld* world, BoundingBox box) {
+    bool overlaps = false;
+    VisitInstancesInBox(world, box, FlagInstanceOverlap, &overlaps);
+    return overlaps;
+}
+// A floor walk with maxFloorNormalY below one only wants floors at least that steep, so meshes whose
+// own split keeps every floor flatter are skipped without opening their BVH
+static void VisitMeshTrianglesInBox(const CollisionMesh* mesh, CollisionSurface surface, float maxFloorNormalY, BoundingBox box,
+    TriangleVisitor visit, void* data) {
+    if (surface == COLLISION_SURFACE_FLOOR && mesh->slopes.floorMinNormalY >= maxFloorNormalY) return;
+    if (!CheckCollisionBoxes(mesh->bounds, box)) return;
+    if (!mesh->nodes) {
+        const Triangle* last = mesh->triangles + mesh->surfaceStart[surface + 1];
+        queryCost.trianglesTested += mesh->surfaceStart[surface + 1] - mesh->surfaceStart[surface];
+        for (const Triangle* tri = mesh->triangles + mesh->surfaceStart[surface]; tri != last; tri++) visit(data, tri);
+        return;
+    }
+    if (mesh->surfaceRoot[surface] < 0) return;
+    int stack[COLLISION_BVH_MAX_DEPTH + 1];
+    int* top = stack;
+    *top++ = mesh->surfaceRoot[surface];
+    int nodesVisited = 0, trianglesTested = 0;
+    while (top != stack) {
+        const CollisionBvhNode* node = &mesh->nodes[*--top];
+        nodesVisited++;
+        if (!CheckCollisionBoxes(node->bounds, box)) continue;
+        if (node->count > 0) {
+            const Triangle* last = mesh->triangles + node->start + node->count;
+            trianglesTested += node->count;
+            for (const Triangle* tri = mesh->triangles + node->start; tri != last; tri++) visit(data, tri);
+        } else {
+            *top++ = node->start;
+            *top++ = node->start + 1;
+        }
+    }
+    queryCost.nodesVisited += nodesVisited;
+    queryCost.trianglesTested += trianglesTested;
+}
+static void VisitStaticTrianglesInBox(const CollisionWorld* world, CollisionSurface surface, float maxFloorNormalY, BoundingBox box,
+    TriangleVisitor visit, void* data) {
+    for (int i = 0; i < world->meshCount; i++) VisitMeshTrianglesInBox(world->meshes[i], surface, maxFloorNormalY, box, visit, data);
+}
+typedef struct {
+    const CollisionInstance* instance;
+    TriangleVisitor visit;
+    void* data;
+} InstanceVisit;
+// Only the candidates the local BVH hands back are carried into world space, so the narrow phase
+// runs unchanged on them
+static Triangle TransformInstanceTriangle(const Triangle* tri, Matrix transform) {
+    Vector3 translation = { transform.m12, transform.m13, transform.m14 };
+    return (Triangle){
+        Vector3Transform(tri->v0, transform),
+        Vector3Transform(tri->v1, transform),
+        Vector3Transform(tri->v2, transform),
+        Vector3Normalize(Vector3Subtract(Vector3Transform(tri->normal, transform), translation)),
+        tri->materialId
+    };
+}
+static void VisitInstanceTriangle(void* data, const Triangle* tri) {
+    const InstanceVisit* instanceVisit = data;
+    Triangle moved = TransformInstanceTriangle(tri, instanceVisit->instance->transform);
+    instanceVisit->visit(instanceVisit->data, &moved);
+}
+typedef struct {
+    BoundingBox box;
+    CollisionSurface surface;
+    float maxFloorNormalY;
+    TriangleVisitor visit;
+    void* data;
+} InstanceTriangleQuery;
+static void VisitInstanceTrianglesInBox(void* data, const CollisionInstance* instance) {
+    const InstanceTriangleQuery* query = data;
+    // Clip first: an unbounded query box, like the floor column, would come out of a rotation
+    // covering the whole mesh
+    BoundingBox clipped = { Vector3Max(query->box.min, instance->bounds.min), Vector3Min(query->box.max, instance->bounds.max) };
+    // Padded because the round trip through the inverse rounds: a flat top lying exactly on the
+    // mesh's bounds would otherwise fall just outside a box clipped to them
+    BoundingBox local = TransformBoundingBox(clipped, instance->inverse);
+    local.min = Vector3SubtractValue(local.min, INSTANCE_BOX_PADDING);
+    local.max = Vector3AddValue(local.max, INSTANCE_BOX_PADDING);
+    InstanceVisit instanceVisit = { instance, query->visit, query->data };
+    VisitMeshTrianglesInBox(instance->mesh, query->surface, query->maxFloorNormalY, local, VisitInstanceTriangle, &instanceVisit);
+}
+static void VisitTrianglesInBox(const CollisionWorld* world, CollisionSurface surface, float maxFloorNormalY, BoundingBox box,
+    TriangleVisitor visit, void* data) {
+    VisitStaticTrianglesInBox(world, surface, maxFloorNormalY, box, visit, data);
+    InstanceTriangleQuery query = { box, surface, maxFloorNormalY, visit, data };
+    VisitInstancesInBox(world, box, VisitInstanceTrianglesInBox, &query);
+}
+// Walls, ceilings, and the floors too steep for the caller's slope limit. cutoff is the visitor's
+// normal.y filter: every wall and ceiling passes it, and for the floor walk it drops to the limit.
+static void VisitBlockingTrianglesInBox(const CollisionWorld* world, BoundingBox box, float floorMinNormalY, float* cutoff,
+    TriangleVisitor visit, void* data) {
+    *cutoff = 1.0f;
+    VisitTrianglesInBox(world, COLLISION_SURFACE_WALL, 1.0f, box, visit, data);
+    VisitTrianglesInBox(world, COLLISION_SURFACE_CEILING, 1.0f, box, visit, data);
+    if (floorMinNormalY <= 0.0f) return;
+    *cutoff = floorMinNormalY;
+    VisitTrianglesInBox(world, COLLISION_SURFACE_FLOOR, floorMinNormalY, box, visit, data);
+}
+typedef struct {
+    Vector3 position;
+    float highestFloor;
+    Vector3 floorNormal;
+    bool foundFloor;
+} FloorQuery;
+static void TestFloorTriangle(void* data, const Triangle* tri) {
+    FloorQuery* query = data;
+    // Plane equation: n·(p - p0) = 0, solved for p.y. Testing the point on the plane keeps the
+    // containment test vertical, so it agrees with the column the BVH was queried with.
+    Vector3 testPoint = query->position;
+    float height = tri->v0.y - (tri->normal.x*(testPoint.x - tri->v0.x) + tri->normal.z*(testPoint.z - tri->v0.z)) / tri->normal.y;
+    testPoint.y = height;
+    if (!IsPointInTriangle(testPoint, *tri)) return;
+    if (height > query->highestFloor && height <= query->position.y + FLOOR_QUERY_REACH) {
+        query->highestFloor = height;
+        query->floorNormal = tri->normal;
+        query->foundFloor = true;
+    }
+}
+float FindFloor(const CollisionWorld* world, Vector3 pos, Vector3* outNormal) {
+    FloorQuery query = { pos, -10000.0f, { 0, 1, 0 }, false };
+    BoundingBox column = { { pos.x, -1e30f, pos.z }, { pos.x, pos.y + FLOOR_QUERY_REACH, pos.z } };
+    long long trianglesBefore = queryCost.trianglesTested;
+    VisitTrianglesInBox(world, COLLISION_SURFACE_FLOOR, 1.0f, column, TestFloorTriangle, &query);
+    queryCost.floorCandidates += queryCost.trianglesTested - trianglesBefore;
+    *outNormal = query.floorNormal;
+    return query.foundFloor ? query.highestFloor : -10000.0f;
+}
+BoundingBox GetCapsuleBounds(Vector3 base, float radius, float height) {
+    return (BoundingBox){
+        { base.x - radius, base.y - radius, base.z - radius },
+        { base.x + radius, base.y + height + radius, base.z + radius }
+    };
+}
+// A triangle within SWEEP_TOLERANCE of the skin already counts as touching
+static BoundingBox GetCapsuleSweepBounds(Vector3 base, Vector3 motion, float radius, float height) {
+    BoundingBox start = GetCapsuleBounds(base, radius + SWEEP_SKIN + SWEEP_TOLERANCE, height);
+    BoundingBox end = GetCapsuleBounds(Vector3Add(base, motion), radius + SWEEP_SKIN + SWEEP_TOLERANCE, height);
+    return (BoundingBox){ Vector3Min(start.min, end.min), Vector3Max(start.max, end.max) };
+}
+// Each slide moves at most what is left of the motion, so no sweep ends further than its length away
+BoundingBox GetCapsuleSlideBounds(Vector3 base, Vector3 motion, float radius, float height) {
+    return GetCapsuleBounds(base, radius + SWEEP_SKIN + SWEEP_TOLERANCE + Vector3Length(motion), height);
+}
+static void CacheTriangle(void* data, const Triangle* tri) {
+    CollisionCache* cache = data;
+    if (cache->triangleCount == COLLISION_CACHE_CAPACITY) {
+        cache->overflowed = true;
+        return;
+    }
+    cache->triangles[cache->triangleCount++] = *tri;
+}
+static void FindFloorAboveCache(void* data, const Triangle* tri) {
+    CollisionCache* cache = data;
+    if (fmaxf(tri->v0.y, fmaxf(tri->v1.y, tri->v2.y)) > cache->bounds.max.y) cache->floorsAbove = true;
+}
+bool UpdateCollisionCache(const CollisionWorld* world, CollisionCache* cache, BoundingBox box, float margin) {
+    if (cache->valid && cache->worldVersion == world->version &&
+        Vector3Equals(Vector3Min(box.min, cache->bounds.min), cache->bounds.min) &&
+        Vector3Equals(Vector3Max(box.max, cache->bounds.max), cache->bounds.max)) return false;
+    Vector3 grow = { margin, margin, margin };
+    cache->bounds = (BoundingBox){ Vector3Subtract(box.min, grow), Vector3Add(box.max, grow) };
+    cache->triangleCount = 0;
+    cache->overflowed = false;
+    for (int i = 0; i < COLLISION_SURFACE_COUNT; i++) {
+        cache->surfaceStart[i] = cache->triangleCount;
+        VisitStaticTrianglesInBox(world, i, 1.0f, cache->bounds, CacheTriangle, cache);
+    }
+    cache->surfaceStart[COLLISION_SURFACE_COUNT] = cache->triangleCount;
+    // A position inside the bounds reaches at most this far up for a floor
+    BoundingBox above = { { cache->bounds.min.x, cache->bounds.max.y, cache->bounds.min.z },
+        { cache->bounds.max.x, cache->bounds.max.y + FLOOR_QUERY_REACH, cache->bounds.max.z } };
+    cache->floorsAbove = false;
+    VisitStaticTrianglesInBox(world, COLLISION_SURFACE_FLOOR, 1.0f, above, FindFloorAboveCache, cache);
+    cache->worldVersion = world->version;
+    cache->valid = true;
+    return true;
+}
+CollisionWorld GetCollisionCacheWorld(const CollisionWorld* world, CollisionCache* cache, CollisionMesh* mesh) {
+    // The cached triangles come from meshes split at different slopes; a floor below any of them
+    // keeps steep floor walks from skipping the list
+    *mesh = (CollisionMesh){
+        .triangles = cache->triangles,
+        .triangleCount = cache->triangleCount,
+        .bounds = cache->bounds,
+        .slopes = { -1.0f, -1.0f },
+        .surfaceRoot = { -1, -1, -1 }
+    };
+    for (int i = 0; i <= COLLISION_SURFACE_COUNT; i++) mesh->surfaceStart[i] = cache->surfaceStart[i];
+    CollisionWorld view;
+    view.meshes[0] = mesh;
+    view.meshCount = 1;
+    view.instances = world->instances;
+    view.instanceCount = world->instanceCount;
+    view.instanceCapacity = world->instanceCapacity;
+    view.instanceNodes = world->instanceNodes;
+    view.instanceNodeCount = world->instanceNodeCount;
+    view.instanceTreeDirty = world->instanceTreeDirty;
+    view.version = cache->worldVersion;
+    return view;
+}
+float FindFloorInCache(const CollisionWorld* world, const CollisionCache* cache, const CollisionWorld* cachedWorld, Vector3 pos, Vector3* outNormal) {
+    bool inCache = Vector3Equals(Vector3Max(pos, cache->bounds.min), pos) && Vector3Equals(Vector3Min(pos, cache->bounds.max), pos);
+    if (inCache && !cache->floorsAbove) {
+        float floorHeight = FindFloor(cachedWorld, pos, outNormal);
+        if (floorHeight >= cache->bounds.min.y) return floorHeight;
+    }
+    return FindFloor(world, pos, outNormal);
+}
+typedef struct {
+    Vector3 position;
+    float radius;
+    float height;
+    float cutoff;
+    Vector3 pushOut;
+    float depth;
+} CapsuleResolveQuery;
+// Keeps the deepest contact. Equal depths are ordered by push direction, so which one wins never
+// depends on the order the triangles were visited in.
+static void ResolveCapsuleTriangle(void* data, const Triangle* tri) {
+    CapsuleResolveQuery* query = data;
+    if (tri->normal.y > query->cutoff) return;
+    Vector3 capsuleTop = Vector3Add(query->position, (Vector3){ 0, query->height, 0 });
+    Vector3 pushOut;
+    if (!TestCapsuleTriangle(query->position, capsuleTop, query->radius, *tri, &pushOut)) return;
+    float depth = Vector3Length(pushOut);
+    if (depth < RESOLVE_MIN_DEPTH || depth < query->depth) return;
+    if (depth == query->depth && (pushOut.x < query->pushOut.x || (pushOut.x == query->pushOut.x &&
+        (pushOut.y < query->pushOut.y || (pushOut.y == query->pushOut.y && pushOut.z <= query->pushOut.z))))) return;
+    query->pushOut = pushOut;
+    query->depth = depth;
+}
+// The deepest contact is pushed out of first and the rest measured again from there, so the result
+// is the same however the triangles are stored or walked. Each pass walks the box at the capsule's
+// new position.
+int ResolveCapsuleCollision(const CollisionWorld* world, Vector3* position, float radius, float height, float floorMinNormalY) {
+    int collisionCount = 0;
+    while (collisionCount < RESOLVE_MAX_CONTACTS) {
+        CapsuleResolveQuery query = { *position, radius, height, 1.0f, { 0, 0, 0 }, 0.0f };
+        VisitBlockingTrianglesInBox(world, GetCapsuleBounds(*position, radius, height), floorMinNormalY, &query.cutoff, ResolveCapsuleTriangle, &query);
+        if (query.depth == 0.0f) break;
+        *position = Vector3Add(*position, query.pushOut);
+        collisionCount++;
+    }
+    queryCost.wallPushes += collisionCount;
+    return collisionCount;
+}
+typedef void (*SurfaceTriangleVisitor)(void* data, const Triangle* tri, CollisionSurface surface);
+// Every triangle of every mesh and instance, each classified on the spot instead of trusting the
+// BVH, the class ranges or the instance tree
+static void VisitEveryTriangle(const CollisionWorld* world, SurfaceTriangleVisitor visit, void* data) {
+    for (int i = 0; i < world->meshCount; i++) {
+        const CollisionMesh* mesh = world->meshes[i];
+        const Triangle* last = mesh->triangles + mesh->triangleCount;
+        for (const Triangle* tri = mesh->triangles; tri != last; tri++) visit(data, tri, GetTriangleSurface(tri, mesh->slopes));
+    }
+    for (int i = 0; i < world->instanceCount; i++) {
+        const CollisionInstance* instance = world->instances[i];
+        const Triangle* last = instance->mesh->triangles + instance->mesh->triangleCount;
+        for (const Triangle* tri = instance->mesh->triangles; tri != last; tri++) {
+            Triangle moved = TransformInstanceTriangle(tri, instance->transform);
+            visit(data, &moved, GetTriangleSurface(tri, instance->mesh->slopes));
+        }
+    }
+}
+static void TestEveryFloorTriangle(void* data, const Triangle* tri, CollisionSurface surface) {
+    if (surface == COLLISION_SURFACE_FLOOR) TestFloorTriangle(data, tri);
+}
+float FindFloorBruteForce(const CollisionWorld* world, Vector3 pos, Vector3* outNormal) {
+    FloorQuery query = { pos, -10000.0f, { 0, 1, 0 }, false };
+    VisitEveryTriangle(world, TestEveryFloorTriangle, &query);
+    *outNormal = query.floorNormal;
+    return query.foundFloor ? query.highestFloor : -10000.0f;
+}
+typedef struct {
+    CapsuleResolveQuery query;
+    float floorMinNormalY;
+} BruteForceResolveQuery;
+static void ResolveEveryTriangle(void* data, const Triangle* tri, CollisionSurface surface) {
+    BruteForceResolveQuery* resolve = data;
+    if (surface == COLLISION_SURFACE_FLOOR && resolve->floorMinNormalY <= 0.0f) return;
+    resolve->query.cutoff = surface == COLLISION_SURFACE_FLOOR ? resolve->floorMinNormalY : 1.0f;
+    ResolveCapsuleTriangle(&resolve->query, tri);
+}
+int ResolveCapsuleCollisionBruteForce(const CollisionWorld* world, Vector3* position, float radius, float height, float floorMinNormalY) {
+    int collisionCount = 0;
+    while (collisionCount < RESOLVE_MAX_CONTACTS) {
+        BruteForceResolveQuery resolve = { { *position, radius, height, 1.0f, { 0, 0, 0 }, 0.0f }, floorMinNormalY };
+        VisitEveryTriangle(world, ResolveEveryTriangle, &resolve);
+        if (resolve.query.depth == 0.0f) break;
+        *position = Vector3Add(*position, resolve.query.pushOut);
+        collisionCount++;
+    }
+    return collisionCount;
+}
+typedef struct {
+    Vector3 base;
+    Vector3 top;
+    Vector3 motion;
+    float radius;
+    float cutoff;
+    CapsuleSweepHit hit;
+    bool found;
+} CapsuleSweepQuery;
+// Conservative advancement. The distance between a translating capsule and a triangle is convex in
+// time, so stepping to where the tangent reaches radius never overshoots the real contact.
+float CapsuleTriangleTimeOfImpact(Vector3 base, Vector3 top, float radius, Vector3 motion, Triangle tri, float maxTime,
+    Vector3* outNormal, Vector3* outPoint) {
+    float t = 0.0f;
+    Vector3 normal = tri.normal;
+    Vector3 onSegment, onTriangle;
+    for (int step = 0; step < SWEEP_MAX_STEPS; step++) {
+        Vector3 offset = Vector3Scale(motion, t);
+        Vector3 movedBase = Vector3Add(base, offset);
+        float distance = ClosestPointsSegmentTriangle(movedBase, Vector3Add(top, offset), tri, &onSegment, &onTriangle);
+        if (distance > EPSILON) {
+            normal = Vector3Scale(Vector3Subtract(onSegment, onTriangle), 1.0f / distance);
+        } else if (Vector3DotProduct(Vector3Subtract(movedBase, tri.v0), tri.normal) < 0.0f) {
+            normal = Vector3Negate(tri.normal);
+        }
+        float approach = -Vector3DotProduct(motion, normal);
+        // Moving away or parallel: the distance can only grow from here
+        if (approach <= EPSILON) return maxTime;
+        float gap = distance - radius;
+        if (gap <= SWEEP_TOLERANCE) break;
+        t += gap / approach;
+        if (t >= maxTime) return maxTime;
+    }
+    *outNormal = normal;
+    if (outPoint) *outPoint = onTriangle;
+    return t;
+}
+static void SweepCapsuleTriangle(void* data, const Triangle* tri) {
+    CapsuleSweepQuery* query = data;
+    if (tri->normal.y > query->cutoff) return;
+    // Ties are let through and ordered by normal, so which of two triangles sharing an edge stops the
+    // capsule never depends on the order they were visited in
+    float maxTime = query->found ? nextafterf(query->hit.time, 2.0f) : query->hit.time;
+    Vector3 normal;
+    float t = CapsuleTriangleTimeOfImpact(query->base, query->top, query->radius + SWEEP_SKIN, query->motion, *tri, maxTime, &normal, NULL);
+    if (t >= maxTime) return;
+    Vector3 best = query->hit.normal;
+    if (t == query->hit.time && (normal.x < best.x || (normal.x == best.x &&
+        (normal.y < best.y || (normal.y == best.y && normal.z <= best.z))))) return;
+    query->hit = (CapsuleSweepHit){ t, normal };
+    query->found = true;
+}
+bool SweepCapsule(const CollisionWorld* world, Vector3 position, Vector3 motion, float radius, float height, float floorMinNormalY,
+    CapsuleSweepHit* hit) {
+    CapsuleSweepQuery query = {
+        position, Vector3Add(position, (Vector3){ 0, height, 0 }), motion, radius, 1.0f, { 1.0f, { 0, 0, 0 } }, false
+    };
+    VisitBlockingTrianglesInBox(world, GetCapsuleSweepBounds(position, motion, radius, height), floorMinNormalY, &query.cutoff,
+        SweepCapsuleTriangle, &query);
+    *hit = query.hit;
+    return query.found;
+}
+Vector3 SlideCapsule(const CollisionWorld* world, Vector3 position, Vector3 motion, float radius, float height, float floorMinNormalY,
+    int maxIterations) {
+    for (int i = 0; i < maxIterations && Vector3LengthSqr(motion) > EPSILON; i++) {
+        CapsuleSweepHit hit;
+        if (!SweepCapsule(world, position, motion, radius, height, floorMinNormalY, &hit)) return Vector3Add(position, motion);
+        position = Vector3Add(position, Vector3Scale(motion, hit.time));
+        motion = Vector3Scale(motion, 1.0f - hit.time);
+        // Walls count as vertical so sliding along a slanted one never lifts the capsule off the floor
+        Vector3 wallNormal = { hit.normal.x, 0.0f, hit.normal.z };
+        float lengthSqr = Vector3LengthSqr(wallNormal);
+        if (lengthSqr < EPSILON) break;
+        wallNormal = Vector3Scale(wallNormal, 1.0f / sqrtf(lengthSqr));
+        motion = Vector3Subtract(motion, Vector3Scale(wallNormal, Vector3DotProduct(motion, wallNormal)));
+    }
+    return position;
+}
@@ -0,0 +1,185 @@
+#ifndef COLLISION_H
+#define COLLISION_H
+#include "../include/raylib.h"
+#define MAX_COLLISION_MESHES 64
+#define COLLISION_BVH_MAX_DEPTH 48
+#define COLLISION_CACHE_CAPACITY 48
+#define COLLISION_FLOOR_SLOPE_DEGREES 60.0f
+#define COLLISION_CEILING_SLOPE_DEGREES 60.0f
+// Shape and ground state only; position and velocity live in the entity's transform and velocity
+typedef struct {
+    Vector3 lastSafePosition;
+    float radius;
+    float halfHeight;
+    bool isOnGround;
+} CollisionCapsule;
+typedef struct {
+    Vector3 v0, v1, v2;
+    Vector3 normal;
+    int materialId;
+} Triangle;
+// Every triangle belongs to exactly one class, fixed when its mesh's BVH is built, and each query
+// walks only the classes it tests
+typedef enum {
+    COLLISION_SURFACE_FLOOR = 0,
+    COLLISION_SURFACE_WALL,
+    COLLISION_SURFACE_CEILING,
+    COLLISION_SURFACE_COUNT
+} CollisionSurface;
+// Normal.y above floorMinNormalY is floor, below ceilingMaxNormalY ceiling, and wall in between
+typedef struct {
+    float floorMinNormalY;
+    float ceilingMaxNormalY;
+} CollisionSlopeSettings;
+// Leaves own a contiguous run of the mesh's triangles; interior nodes store their left child in
+// start and keep the right one immediately after it
+typedef struct {
+    BoundingBox bounds;
+    int start;
+    int count;
+} CollisionBvhNode;
+// World-space triangle soup baked once from a model, so queries never re-transform vertices. Building
+// the BVH sorts the triangles by surface class, surfaceStart[c] up to surfaceStart[c + 1], classified
+// by slopes, gives each class its own subtree rooted at surfaceRoot[c] (-1 when the class is empty)
+// and joins those under node 0 for queries that want every triangle. Without nodes the classes are
+// still contiguous and walked as flat lists.
+typedef struct {
+    Triangle* triangles;
+    int triangleCount;
+    BoundingBox bounds;
+    CollisionBvhNode* nodes;
+    int nodeCount;
+    CollisionSlopeSettings slopes;
+    int surfaceStart[COLLISION_SURFACE_COUNT + 1];
+    int surfaceRoot[COLLISION_SURFACE_COUNT];
+} CollisionMesh;
+// Earliest contact of a swept capsule: the fraction of the motion that is free and the contact
+// normal pointing back towards the capsule
+typedef struct {
+    float time;
+    Vector3 normal;
+} CapsuleSweepHit;
+// A collider that moves: mesh and its BVH stay in local space and queries are carried into the
+// instance's frame, so moving it only updates the transform and world bounds. The transform must be
+// rigid apart from a uniform scale, and should only turn about the vertical: surface classes are
+// decided in the mesh's frame.
+typedef struct {
+    const CollisionMesh* mesh;
+    Matrix transform;
+    Matrix inverse;
+    float scale;
+    BoundingBox bounds;
+} CollisionInstance;
+// Non-owning lists of the static meshes and instances currently resident; queries span all of them.
+// Instances sit under a top-level tree over their world bounds, instances reordered to match its
+// leaves, so a query only reaches the instances whose bounds it touches; each shares its mesh's
+// bottom-level BVH with every other instance of that mesh. version changes whenever a static mesh is
+// added or removed; instances move every tick and never touch it.
+typedef struct {
+    CollisionMesh* meshes[MAX_COLLISION_MESHES];
+    int meshCount;
+    CollisionInstance** instances;
+    int instanceCount;
+    int instanceCapacity;
+    CollisionBvhNode* instanceNodes;
+    int instanceNodeCount;
+    bool instanceTreeDirty;
+    unsigned int version;
+} CollisionWorld;
+// Every static triangle inside bounds, copied out of the world for one character so the ticks after a
+// refresh test a short list instead of walking the BVH. The copies stay grouped by surface class
+// like a mesh's. A neighbourhood with more triangles than fit is marked overflowed and its queries
+// go to the world until the next refresh. floorsAbove records a static floor over the bounds,
+// within FindFloor's reach but above the cached triangles. settled records that the last move ended
+// at rest at settledPosition.
+typedef struct {
+    Triangle triangles[COLLISION_CACHE_CAPACITY];
+    int triangleCount;
+    int surfaceStart[COLLISION_SURFACE_COUNT + 1];
+    BoundingBox bounds;
+    unsigned int worldVersion;
+    bool valid;
+    bool overflowed;
+    bool floorsAbove;
+    bool settled;
+    Vector3 settledPosition;
+} CollisionCache;
+// Work done by box queries: BVH and instance tree nodes opened, triangles handed to a narrow phase,
+// how many of those were FindFloor's candidates and the push-outs ResolveCapsuleCollision applied
+typedef struct {
+    long long nodesVisited;
+    long long trianglesTested;
+    long long floorCandidates;
+    long long wallPushes;
+} CollisionQueryCost;
+Vector3 ClosestPointOnLineSegment(Vector3 a, Vector3 b, Vector3 point);
+bool IsPointInTriangle(Vector3 point, Triangle tri);
+Triangle GetTriangle(Mesh mesh, Matrix transform, int triIndex);
+void ClosestPointsBetweenSegments(Vector3 p1, Vector3 q1, Vector3 p2, Vector3 q2, Vector3* outA, Vector3* outB);
+// pushOut moves capsule A out of capsule B; B moves by its negation
+bool TestCapsuleCapsule(Vector3 baseA, Vector3 topA, float radiusA, Vector3 baseB, Vector3 topB, float radiusB, Vector3* pushOut);
+bool TestCapsuleTriangle(Vector3 capsuleBase, Vector3 capsuleTop, float radius, Triangle tri, Vector3* pushOut);
+float ClosestPointsSegmentTriangle(Vector3 p, Vector3 q, Triangle tri, Vector3* outSegment, Vector3* outTriangle);
+// Fraction of motion before the capsule comes within radius of the triangle, or maxTime when it
+// doesn't first. outNormal points from the triangle to the capsule; outPoint may be NULL.
+float CapsuleTriangleTimeOfImpact(Vector3 base, Vector3 top, float radius, Vector3 motion, Triangle tri, float maxTime,
+    Vector3* outNormal, Vector3* outPoint);
+// Slope limits in degrees from level: floors up to floorDegrees, ceilings up to ceilingDegrees from
+// facing straight down
+CollisionSlopeSettings GetCollisionSlopeSettings(float floorDegrees, float ceilingDegrees);
+// Classified with the default COLLISION_*_SLOPE_DEGREES
+CollisionMesh BuildCollisionMesh(Model model, Matrix transform);
+// Only the model meshes whose includeMesh entry is set; NULL includes them all
+CollisionMesh BuildCollisionMeshSubset(Model model, Matrix transform, const bool* includeMesh, CollisionSlopeSettings slopes);
+// Classifies the triangles by mesh->slopes, which must be set, and builds one subtree per class
+void BuildCollisionBvh(CollisionMesh* mesh);
+void UnloadCollisionMesh(CollisionMesh* mesh);
+bool AddCollisionMesh(CollisionWorld* world, CollisionMesh* mesh);
+void RemoveCollisionMesh(CollisionWorld* world, CollisionMesh* mesh);
+// Places the instance: stores the transform and its inverse and refits the world bounds
+void SetCollisionInstanceTransform(CollisionInstance* instance, Matrix transform);
+// Adding or removing instances leaves the top-level tree to be rebuilt by the next
+// UpdateCollisionInstanceTree; until then queries walk the instances one by one
+bool AddCollisionInstance(CollisionWorld* world, CollisionInstance* instance);
+void RemoveCollisionInstance(CollisionWorld* world, CollisionInstance* instance);
+// Rebuilds the top-level tree after instances were added or removed, otherwise refits it to the
+// instances' current bounds. Call it after moving instances and before querying.
+void UpdateCollisionInstanceTree(CollisionWorld* world);
+// Frees the instance list and top-level tree; the meshes and instances themselves aren't owned
+void FreeCollisionWorld(CollisionWorld* world);
+// True when any moving instance's world bounds overlap box
+bool OverlapsCollisionInstance(const CollisionWorld* world, BoundingBox box);
+// Running totals for the calling thread's box queries; subtract two readings to cost the queries
+// between them
+CollisionQueryCost GetCollisionQueryCost(void);
+// Highest floor-class triangle under pos, -10000 when there is none
+float FindFloor(const CollisionWorld* world, Vector3 pos, Vector3* outNormal);
+// Pushes the capsule out of walls and ceilings. floorMinNormalY is the caller's own slope limit:
+// floors whose normal.y doesn't exceed it push back like walls too. Zero, or anything at or below
+// the level's split, lets every floor be walked on.
+int ResolveCapsuleCollision(const CollisionWorld* world, Vector3* position, float radius, float height, float floorMinNormalY);
+// References for checking the two above: the same narrow phase over every triangle of every mesh
+// and instance, with no BVH, class ranges or instance tree. Far too slow for a frame.
+float FindFloorBruteForce(const CollisionWorld* world, Vector3 pos, Vector3* outNormal);
+int ResolveCapsuleCollisionBruteForce(const CollisionWorld* world, Vector3* position, float radius, float height, float floorMinNormalY);
+BoundingBox GetCapsuleBounds(Vector3 base, float radius, float height);
+// Everything SlideCapsule may test for that motion, which reaches a little past the capsule's bounds
+// and, along walls, past the straight sweep's
+BoundingBox GetCapsuleSlideBounds(Vector3 base, Vector3 motion, float radius, float height);
+// Refreshes the cache around box, grown by margin, unless box is still inside the cached bounds of
+// the same world version. Returns true when it refreshed.
+bool UpdateCollisionCache(const CollisionWorld* world, CollisionCache* cache, BoundingBox box, float margin);
+// A one-mesh world over the cached triangles that shares world's instances and their tree, which
+// are never cached; mesh is the storage for that mesh's descriptor
+CollisionWorld GetCollisionCacheWorld(const CollisionWorld* world, CollisionCache* cache, CollisionMesh* mesh);
+// FindFloor through cachedWorld, the cache's world. Only a floor inside the cached bounds is sure to
+// have been cached, so a position outside them, a floor below them, no floor at all or a cache with
+// floorsAbove asks world instead.
+float FindFloorInCache(const CollisionWorld* world, const CollisionCache* cache, const CollisionWorld* cachedWorld, Vector3 pos, Vector3* outNormal);
+// Against the same triangles ResolveCapsuleCollision pushes out of; false when the whole motion is free
+bool SweepCapsule(const CollisionWorld* world, Vector3 position, Vector3 motion, float radius, float height, float floorMinNormalY,
+    CapsuleSweepHit* hit);
+// Moves to the first contact, slides the remainder along the wall and repeats up to maxIterations
+Vector3 SlideCapsule(const CollisionWorld* world, Vector3 position, Vector3 motion, float radius, float height, float floorMinNormalY,
+    int maxIterations);
+#endif
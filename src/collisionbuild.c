@@ -0,0 +1,372 @@
+#include "memtrack.h"
+#include <stdlib.h>
+#include <string.h>
+#include "../include/raylib.h"
+#include "../include/raymath.h"
+#include "collisionbuild.h"
+#include "json.h"
+#include "platform.h"
+#define SIMPLIFY_MAX_PASSES 8
+#define SIMPLIFY_MAX_FAN 32
+#define GLTF_MODE_TRIANGLES 4
+static const float SIMPLIFY_WELD_FRACTION = 0.01f;
+static const float SIMPLIFY_PLANE_FRACTION = 0.02f;
+static const float SIMPLIFY_FEATURE_FRACTION = 0.25f;
+typedef struct {
+    int x, y, z;
+    int corner;
+} WeldKey;
+// Indexed copy of a triangle soup the passes edit in place
+typedef struct {
+    Vector3* positions;
+    int vertexCount;
+    int* corners;
+    int* materials;
+    bool* alive;
+    int triangleCount;
+} SimplifyMesh;
+CollisionSimplifySettings GetCollisionSimplifySettings(float capsuleRadius) {
+    return (CollisionSimplifySettings){
+        capsuleRadius * SIMPLIFY_WELD_FRACTION,
+        capsuleRadius * SIMPLIFY_PLANE_FRACTION,
+        capsuleRadius * SIMPLIFY_FEATURE_FRACTION
+    };
+}
+static int CompareWeldKeys(const void* a, const void* b) {
+    const WeldKey* keyA = a;
+    const WeldKey* keyB = b;
+    if (keyA->x != keyB->x) return (keyA->x > keyB->x) - (keyA->x < keyB->x);
+    if (keyA->y != keyB->y) return (keyA->y > keyB->y) - (keyA->y < keyB->y);
+    if (keyA->z != keyB->z) return (keyA->z > keyB->z) - (keyA->z < keyB->z);
+    return (keyA->corner > keyB->corner) - (keyA->corner < keyB->corner);
+}
+static Vector3 GetCorner(const Triangle* tri, int corner) {
+    return corner == 0 ? tri->v0 : (corner == 1 ? tri->v1 : tri->v2);
+}
+// Snaps every corner to a grid of weldDistance cells and merges the corners sharing a cell into the
+// first of them. Returns the farthest any corner moved.
+static float WeldCorners(const CollisionMesh* mesh, float weldDistance, SimplifyMesh* out) {
+    int cornerCount = mesh->triangleCount * 3;
+    WeldKey* keys = RL_MALLOC(sizeof(WeldKey) * cornerCount);
+    if (!keys) return 0.0f;
+    float cell = weldDistance > 0.0f ? weldDistance : 1e-6f;
+    for (int i = 0; i < cornerCount; i++) {
+        Vector3 p = GetCorner(&mesh->triangles[i / 3], i % 3);
+        keys[i] = (WeldKey){ (int)floorf(p.x / cell), (int)floorf(p.y / cell), (int)floorf(p.z / cell), i };
+    }
+    qsort(keys, cornerCount, sizeof(WeldKey), CompareWeldKeys);
+    float maxShift = 0.0f;
+    out->vertexCount = 0;
+    for (int i = 0; i < cornerCount; i++) {
+        const WeldKey* key = &keys[i];
+        Vector3 p = GetCorner(&mesh->triangles[key->corner / 3], key->corner % 3);
+        bool sameCell = i > 0 && key->x == key[-1].x && key->y == key[-1].y && key->z == key[-1].z;
+        if (!sameCell) out->positions[out->vertexCount++] = p;
+        int vertex = out->vertexCount - 1;
+        out->corners[key->corner] = vertex;
+        maxShift = fmaxf(maxShift, Vector3Distance(p, out->positions[vertex]));
+    }
+    RL_FREE(keys);
+    return maxShift;
+}
+static Vector3 GetFaceNormal(const SimplifyMesh* mesh, int a, int b, int c) {
+    Vector3 pa = mesh->positions[a];
+    return Vector3CrossProduct(Vector3Subtract(mesh->positions[b], pa), Vector3Subtract(mesh->positions[c], pa));
+}
+// Largest distance from vertex to the planes its fan would have after collapsing it into target, or
+// -1 when the collapse is not allowed: it would flip or flatten a face, or the fan is not the
+// closed disc of an interior vertex
+static float GetCollapseError(const SimplifyMesh* mesh, int vertex, int target, const int* fan, int fanCount) {
+    int removed = 0;
+    float error = 0.0f;
+    Vector3 p = mesh->positions[vertex];
+    for (int i = 0; i < fanCount; i++) {
+        const int* corners = &mesh->corners[fan[i] * 3];
+        if (corners[0] == target || corners[1] == target || corners[2] == target) {
+            removed++;
+            continue;
+        }
+        int moved[3];
+        for (int j = 0; j < 3; j++) moved[j] = corners[j] == vertex ? target : corners[j];
+        Vector3 before = GetFaceNormal(mesh, corners[0], corners[1], corners[2]);
+        Vector3 after = GetFaceNormal(mesh, moved[0], moved[1], moved[2]);
+        float length = Vector3Length(after);
+        if (length < EPSILON || Vector3DotProduct(before, after) <= 0.0f) return -1.0f;
+        error = fmaxf(error, fabsf(Vector3DotProduct(Vector3Subtract(p, mesh->positions[moved[0]]), after)) / length);
+    }
+    return removed == 2 ? error : -1.0f;
+}
+// One pass of half-edge collapses over the vertices whose whole fan is flat and of one material.
+// Each collapse locks the vertices it touched so the adjacency built at the start stays valid.
+static int CollapseFlatVertices(SimplifyMesh* mesh, float planeTolerance) {
+    int* fanStart = RL_CALLOC(mesh->vertexCount + 1, sizeof(int));
+    int* fanTriangles = RL_MALLOC(sizeof(int) * mesh->triangleCount * 3);
+    bool* locked = RL_CALLOC(mesh->vertexCount, sizeof(bool));
+    if (!fanStart || !fanTriangles || !locked) {
+        RL_FREE(fanStart);
+        RL_FREE(fanTriangles);
+        RL_FREE(locked);
+        return 0;
+    }
+    for (int t = 0; t < mesh->triangleCount; t++) {
+        if (!mesh->alive[t]) continue;
+        for (int j = 0; j < 3; j++) fanStart[mesh->corners[t * 3 + j] + 1]++;
+    }
+    for (int v = 0; v < mesh->vertexCount; v++) fanStart[v + 1] += fanStart[v];
+    int* fill = RL_MALLOC(sizeof(int) * mesh->vertexCount);
+    if (fill) memcpy(fill, fanStart, sizeof(int) * mesh->vertexCount);
+    for (int t = 0; t < mesh->triangleCount && fill; t++) {
+        if (!mesh->alive[t]) continue;
+        for (int j = 0; j < 3; j++) fanTriangles[fill[mesh->corners[t * 3 + j]]++] = t;
+    }
+    RL_FREE(fill);
+    int collapsed = 0;
+    for (int v = 0; v < mesh->vertexCount; v++) {
+        const int* fan = fanTriangles + fanStart[v];
+        int fanCount = fanStart[v + 1] - fanStart[v];
+        if (locked[v] || fanCount < 3 || fanCount > SIMPLIFY_MAX_FAN) continue;
+        int ring[SIMPLIFY_MAX_FAN * 2];
+        int ringUses[SIMPLIFY_MAX_FAN * 2];
+        int ringCount = 0;
+        bool usable = true;
+        for (int i = 0; i < fanCount && usable; i++) {
+            usable = mesh->materials[fan[i]] == mesh->materials[fan[0]];
+            for (int j = 0; j < 3; j++) {
+                int neighbour = mesh->corners[fan[i] * 3 + j];
+                if (neighbour == v) continue;
+                int k = 0;
+                while (k < ringCount && ring[k] != neighbour) k++;
+                if (k == ringCount) {
+                    ring[ringCount] = neighbour;
+                    ringUses[ringCount++] = 0;
+                }
+                ringUses[k]++;
+            }
+        }
+        // Every neighbour shared by exactly two faces: a closed disc, not a border or a fin
+        for (int k = 0; k != ringCount && usable; k++) usable = ringUses[k] == 2 && !locked[ring[k]];
+        if (!usable) continue;
+        int target = -1;
+        float bestError = planeTolerance;
+        for (int k = 0; k < ringCount; k++) {
+            float error = GetCollapseError(mesh, v, ring[k], fan, fanCount);
+            if (error < 0.0f || error > bestError) continue;
+            bestError = error;
+            target = ring[k];
+        }
+        if (target < 0) continue;
+        for (int i = 0; i < fanCount; i++) {
+            int* corners = &mesh->corners[fan[i] * 3];
+            if (corners[0] == target || corners[1] == target || corners[2] == target) {
+                mesh->alive[fan[i]] = false;
+                continue;
+            }
+            for (int j = 0; j < 3; j++) if (corners[j] == v) corners[j] = target;
+        }
+        locked[v] = true;
+        for (int k = 0; k < ringCount; k++) locked[ring[k]] = true;
+        collapsed++;
+    }
+    RL_FREE(locked);
+    RL_FREE(fanTriangles);
+    RL_FREE(fanStart);
+    return collapsed;
+}
+// Distance from point to the nearest triangle of mesh within searchRadius, searchRadius if none is
+static float DistanceToMesh(const CollisionMesh* mesh, Vector3 point, float searchRadius) {
+    if (!mesh->nodes) return searchRadius;
+    BoundingBox box = { Vector3SubtractValue(point, searchRadius), Vector3AddValue(point, searchRadius) };
+    float best = searchRadius;
+    int stack[COLLISION_BVH_MAX_DEPTH + 1];
+    int* top = stack;
+    *top++ = 0;
+    while (top != stack) {
+        const CollisionBvhNode* node = &mesh->nodes[*--top];
+        if (!CheckCollisionBoxes(node->bounds, box)) continue;
+        if (node->count == 0) {
+            *top++ = node->start;
+            *top++ = node->start + 1;
+            continue;
+        }
+        const Triangle* last = mesh->triangles + node->start + node->count;
+        for (const Triangle* tri = mesh->triangles + node->start; tri != last; tri++) {
+            Vector3 onSegment, onTriangle;
+            best = fminf(best, ClosestPointsSegmentTriangle(point, point, *tri, &onSegment, &onTriangle));
+        }
+    }
+    return best;
+}
+// Whether the corners, edge midpoints and centre of tri all lie within tolerance of mesh, so taking
+// tri away leaves no gap a capsule could reach through
+static bool IsTriangleCovered(const CollisionMesh* mesh, const Triangle* tri, float tolerance) {
+    Vector3 centre = Vector3Scale(Vector3Add(tri->v0, Vector3Add(tri->v1, tri->v2)), 1.0f / 3.0f);
+    Vector3 samples[7] = {
+        tri->v0, tri->v1, tri->v2, Vector3Lerp(tri->v0, tri->v1, 0.5f), Vector3Lerp(tri->v1, tri->v2, 0.5f),
+        Vector3Lerp(tri->v2, tri->v0, 0.5f), centre
+    };
+    float searchRadius = fmaxf(tolerance, EPSILON) * 2.0f;
+    for (int i = 0; i < 7; i++) {
+        if (DistanceToMesh(mesh, samples[i], searchRadius) > tolerance) return false;
+    }
+    return true;
+}
+CollisionSimplifyReport SimplifyCollisionMesh(CollisionMesh* mesh, CollisionSimplifySettings settings) {
+    CollisionSimplifyReport report = { .inputTriangles = mesh->triangleCount, .outputTriangles = mesh->triangleCount };
+    int triangleCount = mesh->triangleCount;
+    if (triangleCount == 0) return report;
+    SimplifyMesh work = { .triangleCount = triangleCount };
+    work.positions = RL_MALLOC(sizeof(Vector3) * triangleCount * 3);
+    work.corners = RL_MALLOC(sizeof(int) * triangleCount * 3);
+    work.materials = RL_MALLOC(sizeof(int) * triangleCount);
+    work.alive = RL_MALLOC(sizeof(bool) * triangleCount);
+    MemoryTag previousTag = PushMemoryTag(MEMORY_TAG_COLLISION);
+    Triangle* triangles = RL_MALLOC(sizeof(Triangle) * triangleCount);
+    PopMemoryTag(previousTag);
+    Triangle* small = RL_MALLOC(sizeof(Triangle) * triangleCount);
+    if (!work.positions || !work.corners || !work.materials || !work.alive || !triangles || !small) {
+        RL_FREE(work.positions);
+        RL_FREE(work.corners);
+        RL_FREE(work.materials);
+        RL_FREE(work.alive);
+        RL_FREE(triangles);
+        RL_FREE(small);
+        return report;
+    }
+    float weldError = WeldCorners(mesh, settings.weldDistance, &work);
+    report.weldedVertices = triangleCount * 3 - work.vertexCount;
+    for (int t = 0; t < triangleCount; t++) {
+        const int* corners = &work.corners[t * 3];
+        work.materials[t] = mesh->triangles[t].materialId;
+        work.alive[t] = corners[0] != corners[1] && corners[1] != corners[2] && corners[2] != corners[0] &&
+            Vector3LengthSqr(GetFaceNormal(&work, corners[0], corners[1], corners[2])) > EPSILON * EPSILON;
+        report.degenerateTriangles += !work.alive[t];
+    }
+    for (int pass = 0; pass < SIMPLIFY_MAX_PASSES && settings.planeTolerance > 0.0f; pass++) {
+        int collapsed = CollapseFlatVertices(&work, settings.planeTolerance);
+        report.collapsedVertices += collapsed;
+        if (collapsed == 0) break;
+    }
+    int kept = 0, smallCount = 0;
+    for (int t = 0; t < triangleCount; t++) {
+        if (!work.alive[t]) continue;
+        const int* corners = &work.corners[t * 3];
+        Triangle tri = { work.positions[corners[0]], work.positions[corners[1]], work.positions[corners[2]], Vector3Zero(), work.materials[t] };
+        tri.normal = Vector3Normalize(GetFaceNormal(&work, corners[0], corners[1], corners[2]));
+        // Trim and bevel slivers on walls: no edge reaches minFeatureSize. They are set aside and only
+        // dropped below if the rest of the mesh covers them, so a finely tessellated wall keeps every
+        // piece. Floors keep every triangle because FindFloor probes a single point.
+        float longestSqr = fmaxf(Vector3DistanceSqr(tri.v0, tri.v1), fmaxf(Vector3DistanceSqr(tri.v1, tri.v2), Vector3DistanceSqr(tri.v2, tri.v0)));
+        if (tri.normal.y <= mesh->slopes.floorMinNormalY && longestSqr < settings.minFeatureSize * settings.minFeatureSize) {
+            small[smallCount++] = tri;
+            continue;
+        }
+        triangles[kept++] = tri;
+    }
+    RL_FREE(mesh->triangles);
+    mesh->triangles = triangles;
+    mesh->triangleCount = kept;
+    BuildCollisionBvh(mesh);
+    // Coverage is judged against the larger triangles alone, so two small ones can't each excuse the
+    // other
+    int restored = 0;
+    for (int i = 0; i < smallCount; i++) {
+        if (IsTriangleCovered(mesh, &small[i], settings.planeTolerance)) report.smallTriangles++;
+        else small[restored++] = small[i];
+    }
+    if (restored > 0) {
+        previousTag = PushMemoryTag(MEMORY_TAG_COLLISION);
+        triangles = RL_MALLOC(sizeof(Triangle) * (kept + restored));
+        PopMemoryTag(previousTag);
+        if (triangles) {
+            memcpy(triangles, mesh->triangles, sizeof(Triangle) * kept);
+            memcpy(triangles + kept, small, sizeof(Triangle) * restored);
+            RL_FREE(mesh->triangles);
+            mesh->triangles = triangles;
+            kept += restored;
+            mesh->triangleCount = kept;
+            BuildCollisionBvh(mesh);
+        } else {
+            report.smallTriangles += restored;
+        }
+    }
+    RL_FREE(small);
+    report.outputTriangles = kept;
+    float searchRadius = fmaxf(settings.minFeatureSize, settings.planeTolerance) * 2.0f + settings.weldDistance;
+    double errorSum = 0.0;
+    report.maxError = weldError;
+    for (int v = 0; v < work.vertexCount && searchRadius > 0.0f; v++) {
+        float error = DistanceToMesh(mesh, work.positions[v], searchRadius);
+        report.maxError = fmaxf(report.maxError, error);
+        errorSum += error;
+    }
+    report.meanError = work.vertexCount > 0 ? (float)(errorSum / work.vertexCount) : 0.0f;
+    RL_FREE(work.positions);
+    RL_FREE(work.corners);
+    RL_FREE(work.materials);
+    RL_FREE(work.alive);
+    return report;
+}
+static bool EndsWith(const char* text, const char* suffix) {
+    size_t textLength = strlen(text), suffixLength = strlen(suffix);
+    return textLength >= suffixLength && strcmp(text + textLength - suffixLength, suffix) == 0;
+}
+int FindAuthoredCollisionMeshes(const char* fileName, bool* outMask, int meshCount) {
+    for (int i = 0; i < meshCount; i++) outMask[i] = false;
+    if (!IsFileExtension(fileName, ".gltf")) return 0;
+    char* text = LoadFileText(fileName);
+    if (!text) return 0;
+    JsonDocument document;
+    if (!JsonParse(text, (int)strlen(text), &document)) {
+        UnloadFileText(text);
+        return 0;
+    }
+    int nodes = JsonObjectGet(&document, 0, "nodes");
+    int meshes = JsonObjectGet(&document, 0, "meshes");
+    int nodeCount = nodes >= 0 ? document.tokens[nodes].childCount : 0;
+    int modelMesh = 0, authoredCount = 0;
+    int node = nodes + 1;
+    for (int i = 0; i < nodeCount; i++, node = document.tokens[node].next) {
+        int mesh = JsonArrayGet(&document, meshes, JsonGetInt(&document, JsonObjectGet(&document, node, "mesh"), -1));
+        if (mesh < 0) continue;
+        char nodeName[128] = "", meshName[128] = "";
+        JsonGetString(&document, JsonObjectGet(&document, node, "name"), nodeName, sizeof(nodeName));
+        JsonGetString(&document, JsonObjectGet(&document, mesh, "name"), meshName, sizeof(meshName));
+        bool authored = EndsWith(nodeName, COLLISION_AUTHORED_SUFFIX) || EndsWith(meshName, COLLISION_AUTHORED_SUFFIX);
+        int primitives = JsonObjectGet(&document, mesh, "primitives");
+        int primitiveCount = primitives >= 0 ? document.tokens[primitives].childCount : 0;
+        int primitive = primitives + 1;
+        for (int j = 0; j < primitiveCount; j++, primitive = document.tokens[primitive].next) {
+            if (JsonGetInt(&document, JsonObjectGet(&document, primitive, "mode"), GLTF_MODE_TRIANGLES) != GLTF_MODE_TRIANGLES) continue;
+            if (modelMesh < meshCount) {
+                outMask[modelMesh] = authored;
+                authoredCount += authored;
+            }
+            modelMesh++;
+        }
+    }
+    JsonFree(&document);
+    UnloadFileText(text);
+    return authoredCount;
+}
+bool* LoadAuthoredCollisionMask(const char* fileName, int meshCount) {
+    bool* mask = RL_CALLOC(meshCount > 0 ? meshCount : 1, sizeof(bool));
+    if (mask && FindAuthoredCollisionMeshes(fileName, mask, meshCount) > 0) return mask;
+    RL_FREE(mask);
+    return NULL;
+}
+CollisionMesh BuildLevelCollisionMesh(Model model, const char* fileName, const bool* authoredMask, Matrix transform,
+    CollisionSlopeSettings slopes, CollisionSimplifySettings settings) {
+    int authoredCount = 0;
+    for (int i = 0; i < model.meshCount && authoredMask; i++) authoredCount += authoredMask[i];
+    CollisionMesh mesh = BuildCollisionMeshSubset(model, transform, authoredMask, slopes);
+    double start = PlatformTime();
+    CollisionSimplifyReport report = SimplifyCollisionMesh(&mesh, settings);
+    double elapsed = PlatformTime() - start;
+    float reduction = report.inputTriangles > 0 ? 100.0f * (1.0f - (float)report.outputTriangles / report.inputTriangles) : 0.0f;
+    TraceLog(LOG_INFO, "COLLISION: [%s] %s: %d -> %d triangles (%.0f%% fewer: %d welded vertices, %d degenerate, %d flat vertices collapsed, %d small) in %.1f ms",
+        fileName, authoredCount > 0 ? TextFormat("%d authored mesh(es)", authoredCount) : "render meshes", report.inputTriangles,
+        report.outputTriangles, reduction, report.weldedVertices, report.degenerateTriangles, report.collapsedVertices, report.smallTriangles,
+        elapsed * 1000.0);
+    TraceLog(LOG_INFO, "COLLISION: [%s] position error max %.4f mean %.5f", fileName, report.maxError, report.meanError);
+    return mesh;
+}
@@ -0,0 +1,42 @@
+#ifndef COLLISIONBUILD_H
+#define COLLISIONBUILD_H
+#include "../include/raylib.h"
+#include "collision.h"
+#define COLLISION_AUTHORED_SUFFIX "_col"
+// Tolerances in world units. Vertices closer than weldDistance become one; a vertex whose
+// neighbourhood is flat to within planeTolerance is collapsed into a neighbour; wall and ceiling
+// triangles with no edge as long as minFeatureSize are dropped when the larger triangles already
+// cover them to within planeTolerance. A zero field skips its step.
+typedef struct {
+    float weldDistance;
+    float planeTolerance;
+    float minFeatureSize;
+} CollisionSimplifySettings;
+typedef struct {
+    int inputTriangles;
+    int outputTriangles;
+    int weldedVertices;
+    int degenerateTriangles;
+    int collapsedVertices;
+    int smallTriangles;
+    float maxError;
+    float meanError;
+} CollisionSimplifyReport;
+// Tolerances scaled to the smallest capsule that will collide with the mesh: detail well under its
+// radius changes nothing a capsule can feel
+CollisionSimplifySettings GetCollisionSimplifySettings(float capsuleRadius);
+// Rebuilds mesh's triangles and BVH in place. maxError and meanError are the distances from the
+// original vertices to the simplified surface.
+CollisionSimplifyReport SimplifyCollisionMesh(CollisionMesh* mesh, CollisionSimplifySettings settings);
+// Flags the model meshes that a glTF file authored as collision proxies, by a node or mesh name
+// ending in COLLISION_AUTHORED_SUFFIX. Model mesh indices follow raylib's loader: nodes in order,
+// then each node's triangle primitives. Returns how many were flagged.
+int FindAuthoredCollisionMeshes(const char* fileName, bool* outMask, int meshCount);
+// The same mask in a new allocation for RL_FREE, or NULL when the file authors no proxies. Renderers
+// leave the flagged meshes out.
+bool* LoadAuthoredCollisionMask(const char* fileName, int meshCount);
+// The collision build step for level geometry: the meshes flagged in authoredMask, or the render
+// meshes when it is NULL, classified by the level's slopes, simplified with settings and logged
+CollisionMesh BuildLevelCollisionMesh(Model model, const char* fileName, const bool* authoredMask, Matrix transform,
+    CollisionSlopeSettings slopes, CollisionSimplifySettings settings);
+#endif
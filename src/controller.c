@@ -0,0 +1,135 @@
+#include "memtrack.h"
+#include "../include/raylib.h"
+#include "../include/raymath.h"
+#include "controller.h"
+#include "jobs.h"
+#include "stats.h"
+#define CHARACTER_BATCH_SIZE 32
+#define CHARACTER_SLIDE_ITERATIONS 4
+static const float GRAVITY = 9.81f;
+static const float FLOOR_SNAP_DISTANCE = 0.1f;
+static const float KILL_HEIGHT = -20.0f;
+static const float COLLISION_CACHE_MARGIN = 0.75f;
+static CharacterQueryStats lastQueryStats = { 0 };
+static CollisionQueryCost SubtractQueryCost(CollisionQueryCost after, CollisionQueryCost before) {
+    return (CollisionQueryCost){ after.nodesVisited - before.nodesVisited, after.trianglesTested - before.trianglesTested,
+        after.floorCandidates - before.floorCandidates, after.wallPushes - before.wallPushes };
+}
+typedef struct {
+    const CollisionWorld* world;
+    const CharacterMoveBatch* batch;
+    CharacterMoveResults* results;
+    float delta;
+    CharacterQueryStats stats;
+} CharacterMoveJob;
+static void MoveCharacterRange(void* data, int start, int end) {
+    CharacterMoveJob* job = data;
+    const CharacterMoveBatch* batch = job->batch;
+    float delta = job->delta;
+    CharacterQueryStats stats = { 0 };
+    CollisionQueryCost rangeBefore = GetCollisionQueryCost();
+    for (int i = start; i < end; i++) {
+        const CollisionCapsule* capsule = &batch->capsules[i];
+        CollisionCache* cache = batch->caches ? batch->caches[i] : NULL;
+        CollisionQueryCost costBefore = GetCollisionQueryCost();
+        Vector3 position = batch->positions[i];
+        Vector3 velocity = batch->velocities[i];
+        bool isOnGround = capsule->isOnGround;
+        bool jumping = batch->jumpSpeeds && batch->jumpSpeeds[i] > 0.0f;
+        float height = capsule->halfHeight * 2.0f;
+        float slopeLimit = batch->slopeLimits ? batch->slopeLimits[i] : 0.0f;
+        float floorMinNormalY = slopeLimit > 0.0f ? cosf(slopeLimit * DEG2RAD) : 0.0f;
+        // Nothing moved it since it came to rest, so every query would return what it did then,
+        // unless a moving collider is close enough to have pushed into it
+        if (cache && cache->settled && isOnGround && !jumping && Vector3LengthSqr(batch->wishDirections[i]) == 0.0f &&
+            Vector3Equals(velocity, Vector3Zero()) && Vector3Equals(position, cache->settledPosition) &&
+            cache->worldVersion == job->world->version &&
+            !OverlapsCollisionInstance(job->world, GetCapsuleBounds(position, capsule->radius, height))) {
+            job->results->positions[i] = position;
+            job->results->velocities[i] = velocity;
+            job->results->grounded[i] = isOnGround;
+            if (job->results->costs) job->results->costs[i] = (CollisionQueryCost){ 0 };
+            stats.idleSkips++;
+            continue;
+        }
+        if (!isOnGround) { velocity.y -= GRAVITY * delta; }
+        if (isOnGround && jumping) {
+            velocity.y = batch->jumpSpeeds[i];
+            isOnGround = false;
+        }
+        velocity.x = batch->wishDirections[i].x * batch->moveSpeeds[i];
+        velocity.z = batch->wishDirections[i].z * batch->moveSpeeds[i];
+        Vector3 walk = { velocity.x * delta, 0.0f, velocity.z * delta };
+        // Walking characters stay near the triangles they were near last tick; airborne ones can
+        // cover any distance and always query the world
+        const CollisionWorld* world = job->world;
+        CollisionMesh cachedMesh;
+        CollisionWorld cachedWorld;
+        if (cache && isOnGround) {
+            BoundingBox reach = GetCapsuleSlideBounds(position, walk, capsule->radius, height);
+            if (UpdateCollisionCache(job->world, cache, reach, COLLISION_CACHE_MARGIN)) {
+                stats.cacheRefreshes++;
+                if (cache->overflowed) stats.cacheOverflows++;
+            }
+            if (!cache->overflowed) {
+                cachedWorld = GetCollisionCacheWorld(job->world, cache, &cachedMesh);
+                world = &cachedWorld;
+                stats.cacheHits++;
+            }
+        }
+        // Push out of anything already overlapping (a spawn, a neighbour's shove), then sweep the walk
+        // so a long step stops at the wall instead of tunnelling through it
+        ResolveCapsuleCollision(world, &position, capsule->radius, height, floorMinNormalY);
+        position = SlideCapsule(world, position, walk, capsule->radius, height, floorMinNormalY, CHARACTER_SLIDE_ITERATIONS);
+        position.y += velocity.y * delta;
+        Vector3 floorNormal;
+        // Walking off a ledge leaves the floor below outside the cache
+        float floorHeight = world == &cachedWorld ? FindFloorInCache(job->world, cache, world, position, &floorNormal) :
+            FindFloor(world, position, &floorNormal);
+        if (floorHeight > -9999.0f) {
+            float distToFloor = position.y - floorHeight;
+            // Too steep to stand on: it falls and the resolve above slides it back down the slope
+            if (distToFloor <= FLOOR_SNAP_DISTANCE && velocity.y <= 0 && floorNormal.y > floorMinNormalY) {
+                position.y = floorHeight;
+                velocity.y = 0;
+                isOnGround = true;
+            } else {
+                isOnGround = false;
+            }
+        }
+        if (position.y < KILL_HEIGHT) { position = capsule->lastSafePosition; }
+        if (cache) {
+            cache->settled = isOnGround && Vector3Equals(velocity, Vector3Zero());
+            cache->settledPosition = position;
+        }
+        job->results->positions[i] = position;
+        job->results->velocities[i] = velocity;
+        job->results->grounded[i] = isOnGround;
+        if (job->results->costs) job->results->costs[i] = SubtractQueryCost(GetCollisionQueryCost(), costBefore);
+    }
+    __atomic_fetch_add(&job->stats.idleSkips, stats.idleSkips, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&job->stats.cacheHits, stats.cacheHits, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&job->stats.cacheRefreshes, stats.cacheRefreshes, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&job->stats.cacheOverflows, stats.cacheOverflows, __ATOMIC_RELAXED);
+    CollisionQueryCost cost = SubtractQueryCost(GetCollisionQueryCost(), rangeBefore);
+    AddStat(STAT_COLLISION_NODES, cost.nodesVisited);
+    AddStat(STAT_COLLISION_TRIANGLES, cost.trianglesTested);
+    AddStat(STAT_FLOOR_CANDIDATES, cost.floorCandidates);
+    AddStat(STAT_WALL_PUSHES, cost.wallPushes);
+}
+void MoveCharacters(const CollisionWorld* world, const CharacterMoveBatch* batch, CharacterMoveResults* results, float delta) {
+    CharacterMoveJob job = { world, batch, results, delta, { 0 } };
+    JobParallelFor(batch->count, CHARACTER_BATCH_SIZE, MoveCharacterRange, &job);
+    __atomic_store_n(&lastQueryStats.idleSkips, job.stats.idleSkips, __ATOMIC_RELAXED);
+    __atomic_store_n(&lastQueryStats.cacheHits, job.stats.cacheHits, __ATOMIC_RELAXED);
+    __atomic_store_n(&lastQueryStats.cacheRefreshes, job.stats.cacheRefreshes, __ATOMIC_RELAXED);
+    __atomic_store_n(&lastQueryStats.cacheOverflows, job.stats.cacheOverflows, __ATOMIC_RELAXED);
+}
+CharacterQueryStats GetCharacterQueryStats(void) {
+    return (CharacterQueryStats){
+        __atomic_load_n(&lastQueryStats.idleSkips, __ATOMIC_RELAXED),
+        __atomic_load_n(&lastQueryStats.cacheHits, __ATOMIC_RELAXED),
+        __atomic_load_n(&lastQueryStats.cacheRefreshes, __ATOMIC_RELAXED),
+        __atomic_load_n(&lastQueryStats.cacheOverflows, __ATOMIC_RELAXED)
+    };
+}
@@ -0,0 +1,42 @@
+#ifndef CONTROLLER_H
+#define CONTROLLER_H
+#include "../include/raylib.h"
+#include "collision.h"
+// Parallel arrays, one element per character. jumpSpeeds may be NULL; a positive entry launches a
+// grounded character upward at that speed. slopeLimits may be NULL; an entry is the steepest floor
+// in degrees the character stands on, and floors past it block like walls. Zero, or a NULL array,
+// leaves the level's own floor split. caches may be NULL, as may any entry; a character with a cache
+// queries its cached neighbourhood while grounded and skips collision entirely while idle.
+typedef struct {
+    int count;
+    const CollisionCapsule* capsules;
+    const Vector3* positions;
+    const Vector3* velocities;
+    const Vector3* wishDirections;
+    const float* moveSpeeds;
+    const float* jumpSpeeds;
+    const float* slopeLimits;
+    CollisionCache** caches;
+} CharacterMoveBatch;
+// Output arrays may be the input arrays themselves; each element is read before it is written.
+// costs may be NULL; otherwise each entry receives the collision work that character's move did.
+typedef struct {
+    Vector3* positions;
+    Vector3* velocities;
+    bool* grounded;
+    CollisionQueryCost* costs;
+} CharacterMoveResults;
+// Per call: characters skipped while idle, cached moves, cache refreshes, and refreshes that
+// overflowed the cache and fell back to the world
+typedef struct {
+    int idleSkips;
+    int cacheHits;
+    int cacheRefreshes;
+    int cacheOverflows;
+} CharacterQueryStats;
+// Gravity, swept horizontal move and floor snap for every character, split across the job workers.
+// Characters only collide with the world here; actors separates them from each other afterwards.
+void MoveCharacters(const CollisionWorld* world, const CharacterMoveBatch* batch, CharacterMoveResults* results, float delta);
+// Stats of the most recent MoveCharacters call, readable from any thread
+CharacterQueryStats GetCharacterQueryStats(void);
+#endif
@@ -0,0 +1,377 @@
+#include <stdio.h>
+#include <string.h>
+#include "memtrack.h"
+#include "../include/raylib.h"
+#include "../include/raymath.h"
+#include "drawstream.h"
+#include "gputimer.h"
+#include "platform.h"
+#include "stats.h"
+static const int DRAW_STREAM_DEFAULT_ITERATIONS = 20;
+typedef struct {
+    FILE* file;
+    int frameCount;
+    int capturedFrames;
+    bool inFrame;
+    long long drawCount;
+    char modelPaths[MAX_DRAW_STREAM_MODELS][DRAW_STREAM_PATH_LENGTH];
+    int modelCount;
+} DrawStreamCapture;
+typedef enum {
+    DRAW_COMMAND_MESH,
+    DRAW_COMMAND_GRID,
+    DRAW_COMMAND_CUBE,
+    DRAW_COMMAND_CUBE_WIRES,
+    DRAW_COMMAND_CAPSULE_WIRES,
+    DRAW_COMMAND_PLANE
+} DrawStreamCommandType;
+// Meshes use model, mesh, material and transform. Shapes keep raylib's arguments: a is the grid
+// spacing in x, the cube or plane centre, or the capsule start; b the cube or plane size or the
+// capsule end; slices the grid or capsule slices.
+typedef struct {
+    DrawStreamCommandType type;
+    int model;
+    int mesh;
+    int material;
+    Matrix transform;
+    Vector3 a;
+    Vector3 b;
+    float radius;
+    int slices;
+    int rings;
+    Color tint;
+} DrawStreamCommand;
+typedef struct {
+    Camera3D camera;
+    int width;
+    int height;
+    int firstCommand;
+    int commandCount;
+} DrawStreamFrame;
+typedef struct {
+    char modelPaths[MAX_DRAW_STREAM_MODELS][DRAW_STREAM_PATH_LENGTH];
+    Model models[MAX_DRAW_STREAM_MODELS];
+    int modelCount;
+    DrawStreamCommand* commands;
+    int commandCount;
+    int commandCapacity;
+    DrawStreamFrame* frames;
+    int frameCount;
+    int frameCapacity;
+} DrawStream;
+static DrawStreamCapture capture = { 0 };
+bool StartDrawStreamCapture(const char* fileName, int frameCount) {
+    if (capture.file) fclose(capture.file);
+    capture = (DrawStreamCapture){ 0 };
+    if (frameCount <= 0) return false;
+    capture.file = fopen(fileName, "w");
+    if (!capture.file) {
+        TraceLog(LOG_WARNING, "DRAWSTREAM: [%s] Failed to open file for writing", fileName);
+        return false;
+    }
+    fprintf(capture.file, "# model <index> <path>\n");
+    fprintf(capture.file, "# frame <width> <height> <position x y z> <target x y z> <up x y z> <fovy> <projection>\n");
+    fprintf(capture.file, "# draw <model index> <mesh index> <material index> <diffuse texture id> <transform m0 m1 ... m15> <tint r g b a>\n");
+    fprintf(capture.file, "# grid <slices> <spacing>\n");
+    fprintf(capture.file, "# cube|cubewires <position x y z> <size x y z> <color r g b a>\n");
+    fprintf(capture.file, "# capsulewires <start x y z> <end x y z> <radius> <slices> <rings> <color r g b a>\n");
+    fprintf(capture.file, "# plane <center x y z> <size x z> <color r g b a>\n");
+    capture.frameCount = frameCount;
+    TraceLog(LOG_INFO, "DRAWSTREAM: [%s] Capturing the next %d frame(s)", fileName, frameCount);
+    return true;
+}
+bool IsDrawStreamCapturing(void) {
+    return capture.file != NULL;
+}
+void BeginDrawStreamFrame(Camera3D camera, int width, int height) {
+    if (!capture.file) return;
+    fprintf(capture.file, "frame %d %d %.9g %.9g %.9g %.9g %.9g %.9g %.9g %.9g %.9g %.9g %d\n", width, height,
+        camera.position.x, camera.position.y, camera.position.z, camera.target.x, camera.target.y, camera.target.z,
+        camera.up.x, camera.up.y, camera.up.z, camera.fovy, camera.projection);
+    capture.inFrame = true;
+}
+void EndDrawStreamFrame(void) {
+    if (!capture.inFrame) return;
+    capture.inFrame = false;
+    capture.capturedFrames++;
+    if (capture.capturedFrames < capture.frameCount) return;
+    fclose(capture.file);
+    capture.file = NULL;
+    TraceLog(LOG_INFO, "DRAWSTREAM: Captured %d frame(s) with %lld draw(s) over %d model(s)",
+        capture.capturedFrames, capture.drawCount, capture.modelCount);
+}
+// Models are numbered in the order the capture first draws them
+static int GetCaptureModelIndex(const char* path) {
+    for (int i = 0; i < capture.modelCount; i++) {
+        if (strcmp(capture.modelPaths[i], path) == 0) return i;
+    }
+    if (capture.modelCount == MAX_DRAW_STREAM_MODELS) return -1;
+    snprintf(capture.modelPaths[capture.modelCount], DRAW_STREAM_PATH_LENGTH, "%s", path);
+    fprintf(capture.file, "model %d %s\n", capture.modelCount, path);
+    return capture.modelCount++;
+}
+void CaptureModelDraw(ModelHandle handle, const bool* hiddenMeshes, Vector3 position, Vector3 rotationAxis, float rotationAngle, Vector3 scale, Color tint) {
+    if (!capture.inFrame || !IsModelHandleReady(handle)) return;
+    int modelIndex = GetCaptureModelIndex(GetModelHandlePath(handle));
+    if (modelIndex < 0) return;
+    // The world matrix DrawModelEx builds from the same arguments
+    Matrix transform = MatrixMultiply(MatrixMultiply(MatrixScale(scale.x, scale.y, scale.z),
+        MatrixRotate(rotationAxis, rotationAngle * DEG2RAD)), MatrixTranslate(position.x, position.y, position.z));
+    float16 values = MatrixToFloatV(transform);
+    Model model = GetModelFromHandle(handle);
+    for (int mesh = 0; mesh < model.meshCount; mesh++) {
+        if (hiddenMeshes && hiddenMeshes[mesh]) continue;
+        int material = model.meshMaterial[mesh];
+        fprintf(capture.file, "draw %d %d %d %u", modelIndex, mesh, material, model.materials[material].maps[MATERIAL_MAP_DIFFUSE].texture.id);
+        for (int i = 0; i < 16; i++) fprintf(capture.file, " %.9g", values.v[i]);
+        fprintf(capture.file, " %d %d %d %d\n", tint.r, tint.g, tint.b, tint.a);
+        capture.drawCount++;
+    }
+}
+void CaptureGridDraw(int slices, float spacing) {
+    if (!capture.inFrame) return;
+    fprintf(capture.file, "grid %d %.9g\n", slices, spacing);
+    capture.drawCount++;
+}
+void CaptureCubeDraw(Vector3 position, Vector3 size, bool wires, Color color) {
+    if (!capture.inFrame) return;
+    fprintf(capture.file, "%s %.9g %.9g %.9g %.9g %.9g %.9g %d %d %d %d\n", wires ? "cubewires" : "cube",
+        position.x, position.y, position.z, size.x, size.y, size.z, color.r, color.g, color.b, color.a);
+    capture.drawCount++;
+}
+void CaptureCapsuleWiresDraw(Vector3 start, Vector3 end, float radius, int slices, int rings, Color color) {
+    if (!capture.inFrame) return;
+    fprintf(capture.file, "capsulewires %.9g %.9g %.9g %.9g %.9g %.9g %.9g %d %d %d %d %d %d\n", start.x, start.y, start.z,
+        end.x, end.y, end.z, radius, slices, rings, color.r, color.g, color.b, color.a);
+    capture.drawCount++;
+}
+void CapturePlaneDraw(Vector3 center, Vector2 size, Color color) {
+    if (!capture.inFrame) return;
+    fprintf(capture.file, "plane %.9g %.9g %.9g %.9g %.9g %d %d %d %d\n", center.x, center.y, center.z, size.x, size.y,
+        color.r, color.g, color.b, color.a);
+    capture.drawCount++;
+}
+static Matrix MatrixFromFloatV(const float* v) {
+    return (Matrix){
+        .m0 = v[0], .m1 = v[1], .m2 = v[2], .m3 = v[3],
+        .m4 = v[4], .m5 = v[5], .m6 = v[6], .m7 = v[7],
+        .m8 = v[8], .m9 = v[9], .m10 = v[10], .m11 = v[11],
+        .m12 = v[12], .m13 = v[13], .m14 = v[14], .m15 = v[15]
+    };
+}
+// Doubles capacity; items is left as it was when that fails
+static void* GrowDrawStreamArray(void* items, int* capacity, size_t itemSize) {
+    int grown = *capacity ? *capacity * 2 : 256;
+    void* resized = RL_REALLOC(items, grown * itemSize);
+    if (resized) *capacity = grown;
+    return resized;
+}
+static bool ParseDrawStreamFrame(DrawStream* stream, const char* line) {
+    if (stream->frameCount == stream->frameCapacity) {
+        DrawStreamFrame* frames = GrowDrawStreamArray(stream->frames, &stream->frameCapacity, sizeof(DrawStreamFrame));
+        if (!frames) return false;
+        stream->frames = frames;
+    }
+    DrawStreamFrame* frame = &stream->frames[stream->frameCount];
+    Camera3D* camera = &frame->camera;
+    int parsed = sscanf(line, "frame %d %d %f %f %f %f %f %f %f %f %f %f %d", &frame->width, &frame->height,
+        &camera->position.x, &camera->position.y, &camera->position.z, &camera->target.x, &camera->target.y, &camera->target.z,
+        &camera->up.x, &camera->up.y, &camera->up.z, &camera->fovy, &camera->projection);
+    if (parsed < 13 || frame->width <= 0 || frame->height <= 0) return true;
+    frame->firstCommand = stream->commandCount;
+    frame->commandCount = 0;
+    stream->frameCount++;
+    return true;
+}
+static Color ToColor(const int* rgba) {
+    return (Color){ (unsigned char)rgba[0], (unsigned char)rgba[1], (unsigned char)rgba[2], (unsigned char)rgba[3] };
+}
+// Lines that don't parse, or name a model or mesh the stream doesn't have, are skipped
+static bool ParseDrawStreamCommand(DrawStream* stream, const char* line) {
+    if (stream->frameCount == 0) return true;
+    if (stream->commandCount == stream->commandCapacity) {
+        DrawStreamCommand* commands = GrowDrawStreamArray(stream->commands, &stream->commandCapacity, sizeof(DrawStreamCommand));
+        if (!commands) return false;
+        stream->commands = commands;
+    }
+    DrawStreamCommand* command = &stream->commands[stream->commandCount];
+    *command = (DrawStreamCommand){ 0 };
+    float v[16];
+    int color[4];
+    unsigned int texture;
+    bool parsed = false;
+    if (strncmp(line, "draw ", 5) == 0) {
+        command->type = DRAW_COMMAND_MESH;
+        parsed = sscanf(line, "draw %d %d %d %u %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %d %d %d %d",
+            &command->model, &command->mesh, &command->material, &texture,
+            &v[0], &v[1], &v[2], &v[3], &v[4], &v[5], &v[6], &v[7], &v[8], &v[9], &v[10], &v[11], &v[12], &v[13], &v[14], &v[15],
+            &color[0], &color[1], &color[2], &color[3]) == 24 && command->model >= 0 && command->model < stream->modelCount;
+        if (parsed) command->transform = MatrixFromFloatV(v);
+    } else if (strncmp(line, "grid ", 5) == 0) {
+        command->type = DRAW_COMMAND_GRID;
+        parsed = sscanf(line, "grid %d %f", &command->slices, &command->a.x) == 2;
+        color[0] = color[1] = color[2] = color[3] = 255;
+    } else if (strncmp(line, "cube", 4) == 0) {
+        bool wires = strncmp(line, "cubewires ", 10) == 0;
+        command->type = wires ? DRAW_COMMAND_CUBE_WIRES : DRAW_COMMAND_CUBE;
+        parsed = sscanf(line + (wires ? 10 : 5), "%f %f %f %f %f %f %d %d %d %d", &command->a.x, &command->a.y, &command->a.z,
+            &command->b.x, &command->b.y, &command->b.z, &color[0], &color[1], &color[2], &color[3]) == 10;
+    } else if (strncmp(line, "capsulewires ", 13) == 0) {
+        command->type = DRAW_COMMAND_CAPSULE_WIRES;
+        parsed = sscanf(line, "capsulewires %f %f %f %f %f %f %f %d %d %d %d %d %d", &command->a.x, &command->a.y, &command->a.z,
+            &command->b.x, &command->b.y, &command->b.z, &command->radius, &command->slices, &command->rings,
+            &color[0], &color[1], &color[2], &color[3]) == 13;
+    } else if (strncmp(line, "plane ", 6) == 0) {
+        command->type = DRAW_COMMAND_PLANE;
+        parsed = sscanf(line, "plane %f %f %f %f %f %d %d %d %d", &command->a.x, &command->a.y, &command->a.z,
+            &command->b.x, &command->b.z, &color[0], &color[1], &color[2], &color[3]) == 9;
+    }
+    if (!parsed) return true;
+    command->tint = ToColor(color);
+    stream->commandCount++;
+    stream->frames[stream->frameCount - 1].commandCount++;
+    return true;
+}
+static bool LoadDrawStream(DrawStream* stream, const char* fileName) {
+    FILE* file = fopen(fileName, "r");
+    if (!file) {
+        TraceLog(LOG_WARNING, "DRAWSTREAM: [%s] Failed to open draw stream", fileName);
+        return false;
+    }
+    char line[1024];
+    bool ok = true;
+    while (ok && fgets(line, sizeof(line), file)) {
+        if (strncmp(line, "frame ", 6) == 0) ok = ParseDrawStreamFrame(stream, line);
+        else if (strncmp(line, "model ", 6) == 0) {
+            int index = -1;
+            int pathStart = 0;
+            if (sscanf(line, "model %d %n", &index, &pathStart) < 1 || pathStart == 0) continue;
+            if (index < 0 || index >= MAX_DRAW_STREAM_MODELS) continue;
+            char* path = line + pathStart;
+            path[strcspn(path, "\r\n")] = '\0';
+            snprintf(stream->modelPaths[index], DRAW_STREAM_PATH_LENGTH, "%s", path);
+            if (index >= stream->modelCount) stream->modelCount = index + 1;
+        }
+        else if (line[0] != '#') ok = ParseDrawStreamCommand(stream, line);
+    }
+    fclose(file);
+    if (!ok) TraceLog(LOG_WARNING, "DRAWSTREAM: [%s] Ran out of memory reading draw stream", fileName);
+    else if (stream->frameCount == 0) TraceLog(LOG_WARNING, "DRAWSTREAM: [%s] Draw stream has no frames", fileName);
+    return ok && stream->frameCount > 0;
+}
+static void UnloadDrawStream(DrawStream* stream) {
+    for (int i = 0; i < stream->modelCount; i++) {
+        if (stream->models[i].meshCount > 0) UnloadModel(stream->models[i]);
+    }
+    RL_FREE(stream->commands);
+    RL_FREE(stream->frames);
+    RL_FREE(stream);
+}
+// What DrawModelEx does for one mesh with the captured arguments: the model's own transform, then
+// the world matrix, and the tint multiplied into the material's diffuse colour
+static void ReplayMeshDraw(const DrawStream* stream, const DrawStreamCommand* command) {
+    Model model = stream->models[command->model];
+    if (command->mesh >= model.meshCount || command->material >= model.materialCount) return;
+    Material material = model.materials[command->material];
+    material.maps[MATERIAL_MAP_DIFFUSE].color = ColorTint(material.maps[MATERIAL_MAP_DIFFUSE].color, command->tint);
+    DrawMesh(model.meshes[command->mesh], material, MatrixMultiply(model.transform, command->transform));
+}
+static void ReplayDrawStreamFrame(const DrawStream* stream, const DrawStreamFrame* frame) {
+    BeginMode3D(frame->camera);
+    for (int i = 0; i < frame->commandCount; i++) {
+        const DrawStreamCommand* command = &stream->commands[frame->firstCommand + i];
+        switch (command->type) {
+            case DRAW_COMMAND_MESH: ReplayMeshDraw(stream, command); break;
+            case DRAW_COMMAND_GRID: DrawGrid(command->slices, command->a.x); break;
+            case DRAW_COMMAND_CUBE: DrawCubeV(command->a, command->b, command->tint); break;
+            case DRAW_COMMAND_CUBE_WIRES: DrawCubeWiresV(command->a, command->b, command->tint); break;
+            case DRAW_COMMAND_CAPSULE_WIRES: DrawCapsuleWires(command->a, command->b, command->radius, command->slices, command->rings, command->tint); break;
+            case DRAW_COMMAND_PLANE: DrawPlane(command->a, (Vector2){ command->b.x, command->b.z }, command->tint); break;
+        }
+    }
+    EndMode3D();
+}
+static void PresentDrawStreamTarget(RenderTexture2D target) {
+    BeginDrawing();
+        ClearBackground(BLACK);
+        DrawTexturePro(target.texture, (Rectangle){ 0.0f, 0.0f, (float)target.texture.width, -(float)target.texture.height },
+            (Rectangle){ 0.0f, 0.0f, (float)GetScreenWidth(), (float)GetScreenHeight() }, Vector2Zero(), 0.0f, WHITE);
+    EndDrawing();
+}
+int ReplayDrawStream(const char* fileName, int iterations) {
+    if (iterations <= 0) iterations = DRAW_STREAM_DEFAULT_ITERATIONS;
+    MemoryTag previousTag = PushMemoryTag(MEMORY_TAG_RENDER);
+    DrawStream* stream = RL_CALLOC(1, sizeof(DrawStream));
+    if (!stream || !LoadDrawStream(stream, fileName)) {
+        if (stream) UnloadDrawStream(stream);
+        PopMemoryTag(previousTag);
+        return 1;
+    }
+    // Every load happens here, before anything is timed
+    for (int i = 0; i < stream->modelCount; i++) stream->models[i] = LoadModel(stream->modelPaths[i]);
+    int meshDraws = 0;
+    int materialSwitches = 0;
+    int lastModel = -1, lastMaterial = -1;
+    for (int i = 0; i < stream->commandCount; i++) {
+        const DrawStreamCommand* command = &stream->commands[i];
+        if (command->type != DRAW_COMMAND_MESH) continue;
+        meshDraws++;
+        if (command->model != lastModel || command->material != lastMaterial) materialSwitches++;
+        lastModel = command->model;
+        lastMaterial = command->material;
+    }
+    int sampleCapacity = iterations * stream->frameCount;
+    double* submitMs = RL_MALLOC(sampleCapacity * sizeof(double));
+    double* gpuMs = RL_MALLOC(sampleCapacity * sizeof(double));
+    RenderTexture2D target = LoadRenderTexture(stream->frames[0].width, stream->frames[0].height);
+    PopMemoryTag(previousTag);
+    if (!submitMs || !gpuMs) {
+        RL_FREE(submitMs);
+        RL_FREE(gpuMs);
+        UnloadRenderTexture(target);
+        UnloadDrawStream(stream);
+        return 1;
+    }
+    InitGpuTimer();
+    int sampleCount = 0;
+    int tag;
+    double milliseconds;
+    for (int pass = 0; pass < iterations && !WindowShouldClose(); pass++) {
+        for (int i = 0; i < stream->frameCount; i++) {
+            while (PollGpuTimer(&tag, &milliseconds, false)) gpuMs[tag] = milliseconds;
+            const DrawStreamFrame* frame = &stream->frames[i];
+            if (frame->width != target.texture.width || frame->height != target.texture.height) {
+                UnloadRenderTexture(target);
+                target = LoadRenderTexture(frame->width, frame->height);
+            }
+            gpuMs[sampleCount] = -1.0;
+            double start = PlatformTime();
+            BeginGpuTimer(sampleCount);
+            BeginTextureMode(target);
+                ClearBackground(BLACK);
+                ReplayDrawStreamFrame(stream, frame);
+            EndTextureMode();
+            EndGpuTimer();
+            submitMs[sampleCount++] = (PlatformTime() - start) * 1000.0;
+            // Presenting keeps the window alive and the driver from queueing frames without bound
+            PresentDrawStreamTarget(target);
+        }
+    }
+    while (PollGpuTimer(&tag, &milliseconds, true)) gpuMs[tag] = milliseconds;
+    ShutdownGpuTimer();
+    TraceLog(LOG_INFO, "BENCH: Draw stream [%s]: %d frame(s) of %d draw(s), %d of them meshes over %d material switch(es) and %d model(s), replayed %d time(s)",
+        fileName, stream->frameCount, stream->commandCount, meshDraws, materialSwitches, stream->modelCount, sampleCount / stream->frameCount);
+    TraceLog(LOG_INFO, "BENCH: time       avg ms   p50 ms   p95 ms   p99 ms   max ms");
+    LogFrameTimeSummary("submit", SummarizeFrameTimes(submitMs, sampleCount));
+    int gpuCount = 0;
+    for (int i = 0; i < sampleCount; i++) {
+        if (gpuMs[i] >= 0.0) gpuMs[gpuCount++] = gpuMs[i];
+    }
+    if (gpuCount > 0) LogFrameTimeSummary("gpu", SummarizeFrameTimes(gpuMs, gpuCount));
+    else TraceLog(LOG_INFO, "BENCH: gpu      not timed on this context");
+    RL_FREE(submitMs);
+    RL_FREE(gpuMs);
+    UnloadRenderTexture(target);
+    UnloadDrawStream(stream);
+    return 0;
+}
@@ -0,0 +1,30 @@
+#ifndef DRAWSTREAM_H
+#define DRAWSTREAM_H
+#include "../include/raylib.h"
+#include "assets.h"
+#define MAX_DRAW_STREAM_MODELS 128
+#define DRAW_STREAM_PATH_LENGTH 256
+// Writes the 3D draws of the next frameCount frames to fileName as text, one record per line:
+// "model <index> <path>" the first time a model is drawn, "frame <width> <height> <camera>" at each
+// 3D pass, then one "draw <model index> <mesh index> <material index> <diffuse texture id>
+// <16 matrix floats, column-major> <tint r g b a>" per mesh drawn, and "grid", "cube", "cubewires",
+// "capsulewires" and "plane" records with raylib's arguments for the immediate-mode shapes. The
+// texture id is the GL id at capture time, so draws that share a texture can be told from ones
+// that switch.
+bool StartDrawStreamCapture(const char* fileName, int frameCount);
+bool IsDrawStreamCapturing(void);
+// Bracket the 3D pass; both do nothing while no capture is running
+void BeginDrawStreamFrame(Camera3D camera, int width, int height);
+void EndDrawStreamFrame(void);
+// Takes DrawModelEx's arguments and records each mesh not flagged in hiddenMeshes, which may be
+// NULL. Models still loading draw as a placeholder and are left out.
+void CaptureModelDraw(ModelHandle handle, const bool* hiddenMeshes, Vector3 position, Vector3 rotationAxis, float rotationAngle, Vector3 scale, Color tint);
+// Take the arguments of DrawGrid, DrawCubeV or DrawCubeWiresV, DrawCapsuleWires and DrawPlane
+void CaptureGridDraw(int slices, float spacing);
+void CaptureCubeDraw(Vector3 position, Vector3 size, bool wires, Color color);
+void CaptureCapsuleWiresDraw(Vector3 start, Vector3 end, float radius, int slices, int rings, Color color);
+void CapturePlaneDraw(Vector3 center, Vector2 size, Color color);
+// Needs a window. Loads every model the stream uses up front, then re-issues the whole stream
+// iterations times with nothing else running and logs the submission and GPU time per frame.
+int ReplayDrawStream(const char* fileName, int iterations);
+#endif
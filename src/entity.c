@@ -0,0 +1,118 @@
+#include "memtrack.h"
+#include <string.h>
+#include "../include/raylib.h"
+#include "entity.h"
+#define COMPONENT_POOL_MIN_CAPACITY 64
+static const int COMPONENT_SIZES[COMPONENT_COUNT] = {
+    [COMPONENT_TRANSFORM] = sizeof(Transform),
+    [COMPONENT_VELOCITY] = sizeof(Vector3),
+    [COMPONENT_CAPSULE] = sizeof(CollisionCapsule),
+    [COMPONENT_CONTROLLER] = sizeof(CharacterController),
+    [COMPONENT_RENDER_MESH] = sizeof(RenderMesh),
+    [COMPONENT_ANIMATION] = sizeof(AnimationState),
+    [COMPONENT_COLLISION_CACHE] = sizeof(CollisionCache)
+};
+bool EntityStoreInit(EntityStore* store, int capacity) {
+    *store = (EntityStore){ .capacity = capacity };
+    store->generations = RL_CALLOC(capacity, sizeof(unsigned int));
+    store->freeIndices = RL_MALLOC(sizeof(int) * capacity);
+    bool ok = store->generations && store->freeIndices;
+    for (int i = 0; i < COMPONENT_COUNT; i++) {
+        ComponentPool* pool = &store->pools[i];
+        pool->elementSize = COMPONENT_SIZES[i];
+        pool->owners = RL_MALLOC(sizeof(int) * capacity);
+        pool->sparse = RL_MALLOC(sizeof(int) * capacity);
+        if (!pool->owners || !pool->sparse) { ok = false; continue; }
+        memset(pool->sparse, 0xff, sizeof(int) * capacity);
+    }
+    if (!ok) {
+        TraceLog(LOG_WARNING, "ENTITY: Failed to allocate store for %d entities", capacity);
+        EntityStoreDestroy(store);
+        return false;
+    }
+    // Generation 0 is never handed out, so a zeroed Entity is always invalid
+    for (int i = 0; i < capacity; i++) store->generations[i] = 1;
+    return true;
+}
+void EntityStoreDestroy(EntityStore* store) {
+    for (int i = 0; i < COMPONENT_COUNT; i++) {
+        RL_FREE(store->pools[i].data);
+        RL_FREE(store->pools[i].owners);
+        RL_FREE(store->pools[i].sparse);
+    }
+    RL_FREE(store->generations);
+    RL_FREE(store->freeIndices);
+    *store = (EntityStore){ 0 };
+}
+Entity CreateEntity(EntityStore* store) {
+    int index;
+    if (store->freeCount > 0) index = store->freeIndices[--store->freeCount];
+    else if (store->highWater < store->capacity) index = store->highWater++;
+    else {
+        TraceLog(LOG_WARNING, "ENTITY: Store is full (%d entities)", store->capacity);
+        return (Entity){ 0 };
+    }
+    store->liveCount++;
+    return (Entity){ index, store->generations[index] };
+}
+bool IsEntityAlive(const EntityStore* store, Entity entity) {
+    return entity.generation != 0 && entity.index >= 0 && entity.index < store->highWater &&
+        store->generations[entity.index] == entity.generation;
+}
+static void RemoveFromPool(ComponentPool* pool, int entityIndex) {
+    int slot = pool->sparse[entityIndex];
+    if (slot < 0) return;
+    int last = --pool->count;
+    if (slot != last) {
+        memcpy(pool->data + (size_t)slot * pool->elementSize, pool->data + (size_t)last * pool->elementSize, pool->elementSize);
+        pool->owners[slot] = pool->owners[last];
+        pool->sparse[pool->owners[slot]] = slot;
+    }
+    pool->sparse[entityIndex] = -1;
+}
+void DestroyEntity(EntityStore* store, Entity entity) {
+    if (!IsEntityAlive(store, entity)) return;
+    for (int i = 0; i < COMPONENT_COUNT; i++) RemoveFromPool(&store->pools[i], entity.index);
+    // Skip 0 on wrap-around so old handles can never alias the invalid handle
+    if (++store->generations[entity.index] == 0) store->generations[entity.index] = 1;
+    store->freeIndices[store->freeCount++] = entity.index;
+    store->liveCount--;
+}
+static bool GrowComponentPool(ComponentPool* pool, int maxCapacity) {
+    int capacity = pool->dataCapacity > 0 ? pool->dataCapacity * 2 : COMPONENT_POOL_MIN_CAPACITY;
+    if (capacity > maxCapacity) capacity = maxCapacity;
+    unsigned char* data = RL_REALLOC(pool->data, (size_t)pool->elementSize * capacity);
+    if (!data) {
+        TraceLog(LOG_WARNING, "ENTITY: Failed to grow a component pool to %d elements", capacity);
+        return false;
+    }
+    pool->data = data;
+    pool->dataCapacity = capacity;
+    return true;
+}
+void* AddComponent(EntityStore* store, Entity entity, ComponentType type) {
+    if (!IsEntityAlive(store, entity)) return NULL;
+    ComponentPool* pool = &store->pools[type];
+    int slot = pool->sparse[entity.index];
+    if (slot < 0) {
+        if (pool->count == pool->dataCapacity && !GrowComponentPool(pool, store->capacity)) return NULL;
+        slot = pool->count++;
+        pool->owners[slot] = entity.index;
+        pool->sparse[entity.index] = slot;
+    }
+    void* component = pool->data + (size_t)slot * pool->elementSize;
+    memset(component, 0, pool->elementSize);
+    return component;
+}
+void RemoveComponent(EntityStore* store, Entity entity, ComponentType type) {
+    if (IsEntityAlive(store, entity)) RemoveFromPool(&store->pools[type], entity.index);
+}
+void* GetComponentByIndex(const EntityStore* store, int entityIndex, ComponentType type) {
+    const ComponentPool* pool = &store->pools[type];
+    int slot = pool->sparse[entityIndex];
+    return slot < 0 ? NULL : pool->data + (size_t)slot * pool->elementSize;
+}
+void* GetComponent(const EntityStore* store, Entity entity, ComponentType type) {
+    if (!IsEntityAlive(store, entity)) return NULL;
+    return GetComponentByIndex(store, entity.index, type);
+}
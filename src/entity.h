@@ -0,0 +1,80 @@
+#ifndef ENTITY_H
+#define ENTITY_H
+#include "../include/raylib.h"
+#include "assets.h"
+#include "collision.h"
+// Index plus generation: a handle kept after DestroyEntity stops resolving once the slot is reused
+typedef struct {
+    int index;
+    unsigned int generation;
+} Entity;
+typedef enum {
+    COMPONENT_TRANSFORM,
+    COMPONENT_VELOCITY,
+    COMPONENT_CAPSULE,
+    COMPONENT_CONTROLLER,
+    COMPONENT_RENDER_MESH,
+    COMPONENT_ANIMATION,
+    COMPONENT_COLLISION_CACHE,
+    COMPONENT_COUNT
+} ComponentType;
+typedef struct {
+    Vector3 wishDirection;
+    float moveSpeed;
+    float jumpPower;
+    // Steepest floor it can stand on, in degrees; steeper ones push it back like walls
+    float slopeLimit;
+    float yaw;
+    float targetYaw;
+    bool wantsJump;
+} CharacterController;
+// Non-owning: whoever loaded the model keeps the handle, so many actors can share one model
+typedef struct {
+    ModelHandle model;
+    Color tint;
+    float boundsRadius;
+} RenderMesh;
+typedef struct {
+    ModelAnimation* animations;
+    int animationCount;
+    int current;
+    float frame;
+    float framesPerSecond;
+} AnimationState;
+// One sparse set per component: data and owners are packed densely in insertion order, and
+// sparse maps an entity index to its dense slot (-1 when absent). Removal swaps the last element in.
+// data grows with the component count, so a large component only costs memory on the entities that
+// have it; owners and sparse are sized to the store up front.
+typedef struct {
+    unsigned char* data;
+    int* owners;
+    int* sparse;
+    int elementSize;
+    int count;
+    int dataCapacity;
+} ComponentPool;
+typedef struct {
+    unsigned int* generations;
+    int* freeIndices;
+    int freeCount;
+    int capacity;
+    int highWater;
+    int liveCount;
+    ComponentPool pools[COMPONENT_COUNT];
+} EntityStore;
+bool EntityStoreInit(EntityStore* store, int capacity);
+void EntityStoreDestroy(EntityStore* store);
+Entity CreateEntity(EntityStore* store);
+void DestroyEntity(EntityStore* store, Entity entity);
+bool IsEntityAlive(const EntityStore* store, Entity entity);
+// Zeroed; NULL when the entity is dead or its pool cannot grow. Adding may move the pool's data,
+// so pointers into the same pool don't survive it.
+void* AddComponent(EntityStore* store, Entity entity, ComponentType type);
+void RemoveComponent(EntityStore* store, Entity entity, ComponentType type);
+void* GetComponent(const EntityStore* store, Entity entity, ComponentType type);
+// Dense access for systems: owners[i] is the entity index of element i
+void* GetComponentByIndex(const EntityStore* store, int entityIndex, ComponentType type);
+#define COMPONENT_DATA(store, type, Type) ((Type*)(store)->pools[type].data)
+#define COMPONENT_COUNT_OF(store, type) ((store)->pools[type].count)
+#define COMPONENT_OWNERS(store, type) ((store)->pools[type].owners)
+#endif
@@ -0,0 +1,128 @@
+#include <stddef.h>
+#include <stdio.h>
+#include "memtrack.h"
+#include "../include/raylib.h"
+#include "../include/raymath.h"
+#include "flythrough.h"
+#include "stats.h"
+static const float FLYTHROUGH_DEFAULT_FOVY = 90.0f;
+bool LoadFlythroughPath(FlythroughPath* path, const char* fileName) {
+    *path = (FlythroughPath){ .fovy = FLYTHROUGH_DEFAULT_FOVY };
+    FILE* file = fopen(fileName, "r");
+    if (!file) {
+        TraceLog(LOG_WARNING, "FLYTHROUGH: [%s] Failed to open camera path", fileName);
+        return false;
+    }
+    char line[256];
+    while (fgets(line, sizeof(line), file)) {
+        float fovy;
+        if (sscanf(line, "fovy %f", &fovy) == 1) {
+            if (fovy > 0.0f) path->fovy = fovy;
+            continue;
+        }
+        if (path->keyCount == MAX_FLYTHROUGH_KEYS) continue;
+        FlythroughKey* key = &path->keys[path->keyCount];
+        int parsed = sscanf(line, "key %f %f %f %f %f %f %f", &key->time,
+            &key->position.x, &key->position.y, &key->position.z, &key->target.x, &key->target.y, &key->target.z);
+        if (parsed < 7) continue;
+        if (path->keyCount > 0 && key->time <= path->keys[path->keyCount - 1].time) {
+            TraceLog(LOG_WARNING, "FLYTHROUGH: [%s] Key at %.2f s does not come after the one before it", fileName, key->time);
+            fclose(file);
+            return false;
+        }
+        path->keyCount++;
+    }
+    fclose(file);
+    if (path->keyCount < 2) {
+        TraceLog(LOG_WARNING, "FLYTHROUGH: [%s] Camera path needs at least two keys", fileName);
+        return false;
+    }
+    TraceLog(LOG_INFO, "FLYTHROUGH: [%s] Loaded %d key(s) over %.2f s", fileName, path->keyCount, GetFlythroughDuration(path));
+    return true;
+}
+float GetFlythroughDuration(const FlythroughPath* path) {
+    return path->keys[path->keyCount - 1].time - path->keys[0].time;
+}
+// Catmull-Rom tangent in units per second: the neighbours' difference, one-sided at the ends
+static Vector3 GetKeyTangent(const FlythroughPath* path, int index, bool target) {
+    int before = index > 0 ? index - 1 : index;
+    int after = index < path->keyCount - 1 ? index + 1 : index;
+    const FlythroughKey* a = &path->keys[before];
+    const FlythroughKey* b = &path->keys[after];
+    Vector3 difference = target ? Vector3Subtract(b->target, a->target) : Vector3Subtract(b->position, a->position);
+    return Vector3Scale(difference, 1.0f / (b->time - a->time));
+}
+static Vector3 EvaluateSegment(const FlythroughPath* path, int index, float amount, bool target) {
+    const FlythroughKey* a = &path->keys[index];
+    const FlythroughKey* b = &path->keys[index + 1];
+    float duration = b->time - a->time;
+    Vector3 tangentA = Vector3Scale(GetKeyTangent(path, index, target), duration);
+    Vector3 tangentB = Vector3Scale(GetKeyTangent(path, index + 1, target), duration);
+    return target ? Vector3CubicHermite(a->target, tangentA, b->target, tangentB, amount) :
+        Vector3CubicHermite(a->position, tangentA, b->position, tangentB, amount);
+}
+Camera3D GetFlythroughCamera(const FlythroughPath* path, float time) {
+    time += path->keys[0].time;
+    // The segment starting at the last key at or before time; past the end, the final segment
+    int index = 0;
+    for (const FlythroughKey* key = &path->keys[1]; key < &path->keys[path->keyCount - 1] && time >= key->time; key++) index++;
+    const FlythroughKey* a = &path->keys[index];
+    float amount = Clamp((time - a->time) / (path->keys[index + 1].time - a->time), 0.0f, 1.0f);
+    return (Camera3D){
+        .position = EvaluateSegment(path, index, amount, false),
+        .target = EvaluateSegment(path, index, amount, true),
+        .up = { 0.0f, 1.0f, 0.0f },
+        .fovy = path->fovy,
+        .projection = CAMERA_PERSPECTIVE
+    };
+}
+bool InitFlythroughRecording(FlythroughRecording* recording, int frameCount) {
+    *recording = (FlythroughRecording){ 0 };
+    recording->frames = RL_MALLOC(frameCount * sizeof(FlythroughFrame));
+    if (!recording->frames) return false;
+    for (int i = 0; i < frameCount; i++) recording->frames[i] = (FlythroughFrame){ .gpuMs = -1.0 };
+    recording->frameCount = frameCount;
+    return true;
+}
+void FreeFlythroughRecording(FlythroughRecording* recording) {
+    RL_FREE(recording->frames);
+    *recording = (FlythroughRecording){ 0 };
+}
+static void LogCountRow(const char* name, const FlythroughRecording* recording, size_t offset) {
+    long long total = 0;
+    int min = 0, max = 0;
+    for (int i = 0; i < recording->recordedCount; i++) {
+        int value = *(const int*)((const char*)&recording->frames[i] + offset);
+        total += value;
+        if (i == 0 || value < min) min = value;
+        if (i == 0 || value > max) max = value;
+    }
+    TraceLog(LOG_INFO, "BENCH: %-15s %9.1f %7d %7d", name, (double)total / recording->recordedCount, min, max);
+}
+void LogFlythroughSummary(const FlythroughRecording* recording, const char* pathFile, float step) {
+    int count = recording->recordedCount;
+    if (count == 0) {
+        TraceLog(LOG_WARNING, "BENCH: Flythrough [%s] recorded no frames", pathFile);
+        return;
+    }
+    double* times = RL_MALLOC(count * sizeof(double));
+    if (!times) return;
+    TraceLog(LOG_INFO, "BENCH: Flythrough [%s]: %d of %d frame(s) at a %.2f ms step", pathFile, count, recording->frameCount, step * 1000.0f);
+    TraceLog(LOG_INFO, "BENCH: time       avg ms   p50 ms   p95 ms   p99 ms   max ms");
+    for (int i = 0; i < count; i++) times[i] = recording->frames[i].frameMs;
+    LogFrameTimeSummary("frame", SummarizeFrameTimes(times, count));
+    for (int i = 0; i < count; i++) times[i] = recording->frames[i].cpuMs;
+    LogFrameTimeSummary("cpu", SummarizeFrameTimes(times, count));
+    int gpuCount = 0;
+    for (int i = 0; i < count; i++) {
+        if (recording->frames[i].gpuMs >= 0.0) times[gpuCount++] = recording->frames[i].gpuMs;
+    }
+    if (gpuCount > 0) LogFrameTimeSummary("gpu", SummarizeFrameTimes(times, gpuCount));
+    else TraceLog(LOG_INFO, "BENCH: gpu      not timed on this context");
+    RL_FREE(times);
+    TraceLog(LOG_INFO, "BENCH: per frame             avg     min     max");
+    LogCountRow("draw calls", recording, offsetof(FlythroughFrame, drawCalls));
+    LogCountRow("texture binds", recording, offsetof(FlythroughFrame, textureBinds));
+    LogCountRow("instances", recording, offsetof(FlythroughFrame, instances));
+    LogCountRow("culled", recording, offsetof(FlythroughFrame, culledInstances));
+}
@@ -0,0 +1,41 @@
+#ifndef FLYTHROUGH_H
+#define FLYTHROUGH_H
+#include "../include/raylib.h"
+#define MAX_FLYTHROUGH_KEYS 64
+typedef struct {
+    float time;
+    Vector3 position;
+    Vector3 target;
+} FlythroughKey;
+// A camera path for render benchmarks: position and target each follow a Catmull-Rom spline through
+// the keys, timed by the keys' own times so uneven spacing still moves smoothly
+typedef struct {
+    FlythroughKey keys[MAX_FLYTHROUGH_KEYS];
+    int keyCount;
+    float fovy;
+} FlythroughPath;
+typedef struct {
+    double frameMs;
+    double cpuMs;
+    double gpuMs;
+    int drawCalls;
+    int textureBinds;
+    int instances;
+    int culledInstances;
+} FlythroughFrame;
+// One entry per frame of the run; gpuMs stays negative for frames whose GPU time never came back
+typedef struct {
+    FlythroughFrame* frames;
+    int frameCount;
+    int recordedCount;
+} FlythroughRecording;
+// Needs at least two keys with increasing times
+bool LoadFlythroughPath(FlythroughPath* path, const char* fileName);
+float GetFlythroughDuration(const FlythroughPath* path);
+// Holds the first and last keys outside the path's time range
+Camera3D GetFlythroughCamera(const FlythroughPath* path, float time);
+bool InitFlythroughRecording(FlythroughRecording* recording, int frameCount);
+void FreeFlythroughRecording(FlythroughRecording* recording);
+// Logs frame, CPU and GPU time percentiles and the per-frame draw and culling counts
+void LogFlythroughSummary(const FlythroughRecording* recording, const char* pathFile, float step);
+#endif
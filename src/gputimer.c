@@ -0,0 +1,77 @@
+#include "../include/raylib.h"
+#include "gputimer.h"
+#define GPU_TIMER_QUERIES 8
+#define GL_TIME_ELAPSED 0x88BF
+#define GL_QUERY_RESULT 0x8866
+#define GL_QUERY_RESULT_AVAILABLE 0x8867
+#if defined(_WIN32)
+    #define GPU_TIMER_APIENTRY __stdcall
+#else
+    #define GPU_TIMER_APIENTRY
+#endif
+// raylib links glad in and loads these with the rest of the context. rlgl.h is not vendored, so the
+// few entry points used here are declared by hand; each stays NULL on a context that lacks it.
+extern void (GPU_TIMER_APIENTRY *glad_glGenQueries)(int count, unsigned int* ids);
+extern void (GPU_TIMER_APIENTRY *glad_glDeleteQueries)(int count, const unsigned int* ids);
+extern void (GPU_TIMER_APIENTRY *glad_glBeginQuery)(unsigned int target, unsigned int id);
+extern void (GPU_TIMER_APIENTRY *glad_glEndQuery)(unsigned int target);
+extern void (GPU_TIMER_APIENTRY *glad_glGetQueryObjectiv)(unsigned int id, unsigned int name, int* value);
+extern void (GPU_TIMER_APIENTRY *glad_glGetQueryObjectui64v)(unsigned int id, unsigned int name, unsigned long long* value);
+// A ring of queries: spans are issued at oldest + pendingCount and read back from oldest
+typedef struct {
+    bool available;
+    bool running;
+    unsigned int queries[GPU_TIMER_QUERIES];
+    int tags[GPU_TIMER_QUERIES];
+    int oldest;
+    int pendingCount;
+} GpuTimer;
+static GpuTimer gpuTimer = { 0 };
+bool InitGpuTimer(void) {
+    gpuTimer = (GpuTimer){ 0 };
+    if (!glad_glGenQueries || !glad_glDeleteQueries || !glad_glBeginQuery || !glad_glEndQuery ||
+        !glad_glGetQueryObjectiv || !glad_glGetQueryObjectui64v) {
+        TraceLog(LOG_WARNING, "GPUTIMER: Context has no timer queries, GPU time will not be recorded");
+        return false;
+    }
+    glad_glGenQueries(GPU_TIMER_QUERIES, gpuTimer.queries);
+    gpuTimer.available = true;
+    return true;
+}
+void ShutdownGpuTimer(void) {
+    if (gpuTimer.available) {
+        if (gpuTimer.running) glad_glEndQuery(GL_TIME_ELAPSED);
+        glad_glDeleteQueries(GPU_TIMER_QUERIES, gpuTimer.queries);
+    }
+    gpuTimer = (GpuTimer){ 0 };
+}
+bool BeginGpuTimer(int tag) {
+    if (!gpuTimer.available || gpuTimer.running || gpuTimer.pendingCount == GPU_TIMER_QUERIES) return false;
+    int slot = (gpuTimer.oldest + gpuTimer.pendingCount) % GPU_TIMER_QUERIES;
+    glad_glBeginQuery(GL_TIME_ELAPSED, gpuTimer.queries[slot]);
+    gpuTimer.tags[slot] = tag;
+    gpuTimer.running = true;
+    return true;
+}
+void EndGpuTimer(void) {
+    if (!gpuTimer.running) return;
+    glad_glEndQuery(GL_TIME_ELAPSED);
+    gpuTimer.running = false;
+    gpuTimer.pendingCount++;
+}
+bool PollGpuTimer(int* outTag, double* outMs, bool wait) {
+    if (gpuTimer.pendingCount == 0) return false;
+    unsigned int query = gpuTimer.queries[gpuTimer.oldest];
+    if (!wait) {
+        int ready = 0;
+        glad_glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &ready);
+        if (!ready) return false;
+    }
+    unsigned long long nanoseconds = 0;
+    glad_glGetQueryObjectui64v(query, GL_QUERY_RESULT, &nanoseconds);
+    *outTag = gpuTimer.tags[gpuTimer.oldest];
+    *outMs = nanoseconds / 1000000.0;
+    gpuTimer.oldest = (gpuTimer.oldest + 1) % GPU_TIMER_QUERIES;
+    gpuTimer.pendingCount--;
+    return true;
+}
@@ -0,0 +1,16 @@
+#ifndef GPUTIMER_H
+#define GPUTIMER_H
+#include <stdbool.h>
+// GL_TIME_ELAPSED queries over spans of the frame, read back a few frames later so the CPU never
+// waits on the GPU to time it. Needs the window's GL context; on a context without timer queries
+// InitGpuTimer returns false and every span is simply not timed.
+bool InitGpuTimer(void);
+void ShutdownGpuTimer(void);
+// Starts timing the GL commands issued from here to EndGpuTimer, labelled with tag. False when
+// nothing is being timed: no timer queries, a span already open, or every query still in flight.
+bool BeginGpuTimer(int tag);
+void EndGpuTimer(void);
+// The oldest finished span, in milliseconds. Without wait it returns false while that span's result
+// is not back yet; with wait it blocks for it, and returns false only once none are left in flight.
+bool PollGpuTimer(int* outTag, double* outMs, bool wait);
+#endif
@@ -0,0 +1,125 @@
+#include "memtrack.h"
+#include <stdio.h>
+#include <string.h>
+#include "../include/raylib.h"
+#include "../include/raymath.h"
+#include "drawstream.h"
+#include "heatmap.h"
+static const float HEATMAP_TILE_LIFT = 0.05f;
+static const unsigned char HEATMAP_TILE_ALPHA = 150;
+static const float HEATMAP_COLD_HUE = 240.0f;
+bool InitCollisionHeatmap(CollisionHeatmap* heatmap, BoundingBox bounds, float cellSize) {
+    *heatmap = (CollisionHeatmap){ .origin = { bounds.min.x, bounds.min.z }, .cellSize = cellSize };
+    heatmap->width = (int)ceilf((bounds.max.x - bounds.min.x) / cellSize);
+    heatmap->depth = (int)ceilf((bounds.max.z - bounds.min.z) / cellSize);
+    if (heatmap->width <= 0 || heatmap->depth <= 0) return false;
+    MemoryTag previousTag = PushMemoryTag(MEMORY_TAG_COLLISION);
+    heatmap->cells = RL_CALLOC((size_t)heatmap->width * heatmap->depth, sizeof(CollisionHeatCell));
+    PopMemoryTag(previousTag);
+    return heatmap->cells != NULL;
+}
+void FreeCollisionHeatmap(CollisionHeatmap* heatmap) {
+    RL_FREE(heatmap->cells);
+    *heatmap = (CollisionHeatmap){ 0 };
+}
+void ResetCollisionHeatmap(CollisionHeatmap* heatmap) {
+    if (heatmap->cells) memset(heatmap->cells, 0, sizeof(CollisionHeatCell) * heatmap->width * heatmap->depth);
+    heatmap->maxCost = 0;
+}
+bool CopyCollisionHeatmap(CollisionHeatmap* to, const CollisionHeatmap* from) {
+    if (!from->cells) {
+        FreeCollisionHeatmap(to);
+        return true;
+    }
+    CollisionHeatCell* cells = to->cells;
+    if (!cells || to->width != from->width || to->depth != from->depth) {
+        RL_FREE(cells);
+        MemoryTag previousTag = PushMemoryTag(MEMORY_TAG_COLLISION);
+        cells = RL_MALLOC(sizeof(CollisionHeatCell) * from->width * from->depth);
+        PopMemoryTag(previousTag);
+    }
+    *to = *from;
+    to->cells = cells;
+    if (!cells) return false;
+    memcpy(cells, from->cells, sizeof(CollisionHeatCell) * from->width * from->depth);
+    return true;
+}
+static long long GetCellCost(const CollisionHeatCell* cell) {
+    return cell->nodesVisited + cell->trianglesTested;
+}
+static Vector3 GetCellCenter(const CollisionHeatmap* heatmap, int index) {
+    const CollisionHeatCell* cell = &heatmap->cells[index];
+    return (Vector3){
+        heatmap->origin.x + ((float)(index % heatmap->width) + 0.5f) * heatmap->cellSize,
+        cell->queries ? (float)(cell->heightSum / cell->queries) : 0.0f,
+        heatmap->origin.y + ((float)(index / heatmap->width) + 0.5f) * heatmap->cellSize
+    };
+}
+void RecordCollisionHeat(CollisionHeatmap* heatmap, Vector3 position, CollisionQueryCost cost) {
+    if (!heatmap->cells) return;
+    float column = (position.x - heatmap->origin.x) / heatmap->cellSize;
+    float row = (position.z - heatmap->origin.y) / heatmap->cellSize;
+    if (column < 0.0f || row < 0.0f || column >= (float)heatmap->width || row >= (float)heatmap->depth) return;
+    CollisionHeatCell* cell = &heatmap->cells[(int)row * heatmap->width + (int)column];
+    cell->queries++;
+    cell->nodesVisited += cost.nodesVisited;
+    cell->trianglesTested += cost.trianglesTested;
+    cell->heightSum += position.y;
+    if (GetCellCost(cell) > heatmap->maxCost) heatmap->maxCost = GetCellCost(cell);
+}
+int GetCollisionHotspots(const CollisionHeatmap* heatmap, CollisionHotspot* outSpots, int count) {
+    int filled = 0;
+    int cellCount = heatmap->cells ? heatmap->width * heatmap->depth : 0;
+    // Insertion into a short sorted list: count is a handful, the grid is thousands of cells
+    for (int i = 0; i < cellCount; i++) {
+        long long cost = GetCellCost(&heatmap->cells[i]);
+        if (cost == 0 || (filled == count && cost <= GetCellCost(&outSpots[filled - 1].cell))) continue;
+        int slot = filled < count ? filled++ : filled - 1;
+        while (slot > 0 && GetCellCost(&outSpots[slot - 1].cell) < cost) {
+            outSpots[slot] = outSpots[slot - 1];
+            slot--;
+        }
+        outSpots[slot] = (CollisionHotspot){ GetCellCenter(heatmap, i), heatmap->cells[i] };
+    }
+    return filled;
+}
+bool ExportCollisionHeatmapCsv(const CollisionHeatmap* heatmap, const char* fileName) {
+    FILE* file = fopen(fileName, "w");
+    if (!file) {
+        TraceLog(LOG_WARNING, "HEATMAP: [%s] Failed to open file for writing", fileName);
+        return false;
+    }
+    fprintf(file, "x,z,height,queries,nodes,triangles,cost_per_query\n");
+    int rows = 0;
+    for (int i = 0; heatmap->cells && i < heatmap->width * heatmap->depth; i++) {
+        const CollisionHeatCell* cell = &heatmap->cells[i];
+        if (cell->queries == 0) continue;
+        Vector3 center = GetCellCenter(heatmap, i);
+        fprintf(file, "%.2f,%.2f,%.2f,%lld,%lld,%lld,%.1f\n", center.x, center.z, center.y, cell->queries, cell->nodesVisited,
+            cell->trianglesTested, (double)GetCellCost(cell) / cell->queries);
+        rows++;
+    }
+    fclose(file);
+    TraceLog(LOG_INFO, "HEATMAP: [%s] Exported %d cells", fileName, rows);
+    return true;
+}
+void DrawCollisionHeatmap(const CollisionHeatmap* heatmap) {
+    if (!heatmap->cells || heatmap->maxCost == 0) return;
+    for (int i = 0; i < heatmap->width * heatmap->depth; i++) {
+        const CollisionHeatCell* cell = &heatmap->cells[i];
+        if (cell->queries == 0) continue;
+        float heat = (float)GetCellCost(cell) / (float)heatmap->maxCost;
+        Color color = ColorFromHSV(HEATMAP_COLD_HUE * (1.0f - heat), 0.9f, 1.0f);
+        color.a = HEATMAP_TILE_ALPHA;
+        Vector3 center = GetCellCenter(heatmap, i);
+        center.y += HEATMAP_TILE_LIFT;
+        DrawPlane(center, (Vector2){ heatmap->cellSize, heatmap->cellSize }, color);
+        CapturePlaneDraw(center, (Vector2){ heatmap->cellSize, heatmap->cellSize }, color);
+    }
+    CollisionHotspot spots[COLLISION_HEATMAP_TOP_COUNT];
+    int spotCount = GetCollisionHotspots(heatmap, spots, COLLISION_HEATMAP_TOP_COUNT);
+    for (int i = 0; i < spotCount; i++) {
+        DrawCubeWires(spots[i].position, heatmap->cellSize, heatmap->cellSize, heatmap->cellSize, WHITE);
+        CaptureCubeDraw(spots[i].position, (Vector3){ heatmap->cellSize, heatmap->cellSize, heatmap->cellSize }, true, WHITE);
+    }
+}
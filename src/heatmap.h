@@ -0,0 +1,43 @@
+#ifndef HEATMAP_H
+#define HEATMAP_H
+#include "../include/raylib.h"
+#include "collision.h"
+#define COLLISION_HEATMAP_TOP_COUNT 10
+typedef struct {
+    long long queries;
+    long long nodesVisited;
+    long long trianglesTested;
+    double heightSum;
+} CollisionHeatCell;
+// Collision work accumulated over a world-space XZ grid: each recorded query adds its nodes and
+// triangles to the cell under it. A cell's cost is nodes plus triangles; heightSum keeps the
+// average height its queries were made at, which is where the overlay draws it.
+typedef struct {
+    Vector2 origin;
+    float cellSize;
+    int width;
+    int depth;
+    CollisionHeatCell* cells;
+    long long maxCost;
+} CollisionHeatmap;
+typedef struct {
+    Vector3 position;
+    CollisionHeatCell cell;
+} CollisionHotspot;
+// Covers bounds' XZ extent with square cells of cellSize; false when the grid can't be allocated
+bool InitCollisionHeatmap(CollisionHeatmap* heatmap, BoundingBox bounds, float cellSize);
+void FreeCollisionHeatmap(CollisionHeatmap* heatmap);
+void ResetCollisionHeatmap(CollisionHeatmap* heatmap);
+// Makes to a copy of from, reusing its cells when the grids match; false when they can't be allocated
+bool CopyCollisionHeatmap(CollisionHeatmap* to, const CollisionHeatmap* from);
+// Positions outside the grid are dropped
+void RecordCollisionHeat(CollisionHeatmap* heatmap, Vector3 position, CollisionQueryCost cost);
+// The most expensive cells by total cost, most expensive first; returns how many were filled
+int GetCollisionHotspots(const CollisionHeatmap* heatmap, CollisionHotspot* outSpots, int count);
+// One row per cell that recorded anything: center x and z, average height, queries, nodes,
+// triangles and cost per query
+bool ExportCollisionHeatmapCsv(const CollisionHeatmap* heatmap, const char* fileName);
+// Inside BeginMode3D: a translucent tile per visited cell, blue through red by cost relative to
+// the costliest cell, with the hotspots outlined
+void DrawCollisionHeatmap(const CollisionHeatmap* heatmap);
+#endif
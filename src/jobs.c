@@ -0,0 +1,338 @@
+#include "memtrack.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "jobs.h"
+#include "platform.h"
+#define MAX_JOB_WORKERS 32
+#define JOB_DEQUE_CAPACITY 1024
+#define JOB_MAIN_QUEUE_CAPACITY 256
+#define JOB_MAX_PARALLEL_BATCHES 256
+#define JOB_BATCHES_PER_THREAD 4
+#define JOB_IDLE_SPINS 64
+typedef struct {
+    JobFunction function;
+    void* data;
+    JobCounter* counter;
+} Job;
+struct JobContinuation {
+    Job job;
+    bool onMainThread;
+    JobContinuation* next;
+};
+// Changed only under the lock, but read without it to skip empty deques cheaply. top and bottom
+// only ever grow; unsigned wrap-around keeps bottom - top equal to the job count.
+typedef struct {
+    pthread_mutex_t lock;
+    Job jobs[JOB_DEQUE_CAPACITY];
+    unsigned int top;
+    unsigned int bottom;
+} JobDeque;
+typedef struct {
+    pthread_t workers[MAX_JOB_WORKERS];
+    int workerCount;
+    pthread_t mainThread;
+    // Deque 0 is shared by the main thread and any other thread that is not a worker
+    JobDeque deques[MAX_JOB_WORKERS + 1];
+    Job mainJobs[JOB_MAIN_QUEUE_CAPACITY];
+    int mainHead;
+    int mainCount;
+    pthread_mutex_t mainLock;
+    int queuedJobs;
+    int sleepers;
+    bool shuttingDown;
+    pthread_mutex_t wakeLock;
+    pthread_cond_t wake;
+} JobSystem;
+typedef struct {
+    JobRangeFunction function;
+    void* data;
+    int start;
+    int end;
+} JobRange;
+static JobSystem jobSystem;
+static __thread int jobThreadSlot = 0;
+static bool PushJob(JobDeque* deque, Job job) {
+    pthread_mutex_lock(&deque->lock);
+    bool pushed = deque->bottom - deque->top < JOB_DEQUE_CAPACITY;
+    if (pushed) {
+        deque->jobs[deque->bottom % JOB_DEQUE_CAPACITY] = job;
+        __atomic_store_n(&deque->bottom, deque->bottom + 1, __ATOMIC_RELAXED);
+    }
+    pthread_mutex_unlock(&deque->lock);
+    return pushed;
+}
+static bool IsDequeEmpty(JobDeque* deque) {
+    return __atomic_load_n(&deque->bottom, __ATOMIC_RELAXED) == __atomic_load_n(&deque->top, __ATOMIC_RELAXED);
+}
+// The owner takes its newest job, which is likely still in cache
+static bool PopJob(JobDeque* deque, Job* outJob) {
+    if (IsDequeEmpty(deque)) return false;
+    pthread_mutex_lock(&deque->lock);
+    bool popped = deque->bottom != deque->top;
+    if (popped) {
+        __atomic_store_n(&deque->bottom, deque->bottom - 1, __ATOMIC_RELAXED);
+        *outJob = deque->jobs[deque->bottom % JOB_DEQUE_CAPACITY];
+    }
+    pthread_mutex_unlock(&deque->lock);
+    return popped;
+}
+// Thieves take the oldest job, which tends to be the biggest remaining piece of work
+static bool StealJob(JobDeque* deque, Job* outJob) {
+    if (IsDequeEmpty(deque)) return false;
+    pthread_mutex_lock(&deque->lock);
+    bool stolen = deque->bottom != deque->top;
+    if (stolen) {
+        *outJob = deque->jobs[deque->top % JOB_DEQUE_CAPACITY];
+        __atomic_store_n(&deque->top, deque->top + 1, __ATOMIC_RELAXED);
+    }
+    pthread_mutex_unlock(&deque->lock);
+    return stolen;
+}
+static bool FindJob(Job* outJob) {
+    int dequeCount = __atomic_load_n(&jobSystem.workerCount, __ATOMIC_RELAXED) + 1;
+    int own = jobThreadSlot;
+    bool found = PopJob(&jobSystem.deques[own], outJob);
+    for (int i = 1; i < dequeCount && !found; i++) {
+        found = StealJob(&jobSystem.deques[(own + i) % dequeCount], outJob);
+    }
+    if (found) __atomic_sub_fetch(&jobSystem.queuedJobs, 1, __ATOMIC_SEQ_CST);
+    return found;
+}
+// Sleepers register under wakeLock before re-checking their condition, and wakers publish their
+// change before reading the sleeper count, so either the sleeper sees the change or gets woken
+static void WakeSleepers(bool all) {
+    if (__atomic_load_n(&jobSystem.sleepers, __ATOMIC_SEQ_CST) == 0) return;
+    pthread_mutex_lock(&jobSystem.wakeLock);
+    if (all) pthread_cond_broadcast(&jobSystem.wake);
+    else pthread_cond_signal(&jobSystem.wake);
+    pthread_mutex_unlock(&jobSystem.wakeLock);
+}
+static void LockCounter(JobCounter* counter) {
+    while (__atomic_exchange_n(&counter->lock, 1, __ATOMIC_ACQUIRE)) PlatformYield();
+}
+static void UnlockCounter(JobCounter* counter) {
+    __atomic_store_n(&counter->lock, 0, __ATOMIC_SEQ_CST);
+}
+// A waiter may return and drop a stack counter as soon as this is true, so the counter's lock
+// release has to be the last thing a finishing job touches
+bool IsJobCounterDone(JobCounter* counter) {
+    return __atomic_load_n(&counter->pending, __ATOMIC_SEQ_CST) == 0 && __atomic_load_n(&counter->lock, __ATOMIC_SEQ_CST) == 0;
+}
+static void RunJob(Job job);
+static void QueueMainJob(Job job);
+static void EnqueueJob(Job job) {
+    if (jobSystem.workerCount == 0 || !PushJob(&jobSystem.deques[jobThreadSlot], job)) {
+        // With no workers or a full deque the caller runs the job itself
+        RunJob(job);
+        return;
+    }
+    __atomic_add_fetch(&jobSystem.queuedJobs, 1, __ATOMIC_SEQ_CST);
+    WakeSleepers(false);
+}
+static void FinishCounterJob(JobCounter* counter) {
+    LockCounter(counter);
+    JobContinuation* continuations = NULL;
+    bool finished = __atomic_sub_fetch(&counter->pending, 1, __ATOMIC_SEQ_CST) == 0;
+    if (finished) {
+        continuations = counter->continuations;
+        counter->continuations = NULL;
+    }
+    UnlockCounter(counter);
+    while (continuations) {
+        JobContinuation* next = continuations->next;
+        if (continuations->onMainThread) QueueMainJob(continuations->job);
+        else EnqueueJob(continuations->job);
+        RL_FREE(continuations);
+        continuations = next;
+    }
+    if (finished) WakeSleepers(true);
+}
+static void RunJob(Job job) {
+    job.function(job.data);
+    if (job.counter) FinishCounterJob(job.counter);
+}
+// Queued even from the main thread: a continuation that fires while the main thread helps inside
+// JobWait must not run in the middle of whatever that wait interrupted. Only a full queue on the
+// main thread runs the job on the spot, since nothing else would ever drain it.
+static void QueueMainJob(Job job) {
+    for (;;) {
+        pthread_mutex_lock(&jobSystem.mainLock);
+        bool queued = jobSystem.mainCount < JOB_MAIN_QUEUE_CAPACITY;
+        if (queued) {
+            jobSystem.mainJobs[(jobSystem.mainHead + jobSystem.mainCount) % JOB_MAIN_QUEUE_CAPACITY] = job;
+            __atomic_add_fetch(&jobSystem.mainCount, 1, __ATOMIC_SEQ_CST);
+        }
+        pthread_mutex_unlock(&jobSystem.mainLock);
+        if (queued) break;
+        if (IsMainThread()) {
+            RunJob(job);
+            return;
+        }
+        PlatformYield();
+    }
+    WakeSleepers(true);
+}
+static bool RunMainThreadJob(void) {
+    if (__atomic_load_n(&jobSystem.mainCount, __ATOMIC_SEQ_CST) == 0) return false;
+    pthread_mutex_lock(&jobSystem.mainLock);
+    bool popped = jobSystem.mainCount > 0;
+    Job job = { 0 };
+    if (popped) {
+        job = jobSystem.mainJobs[jobSystem.mainHead];
+        jobSystem.mainHead = (jobSystem.mainHead + 1) % JOB_MAIN_QUEUE_CAPACITY;
+        __atomic_sub_fetch(&jobSystem.mainCount, 1, __ATOMIC_SEQ_CST);
+    }
+    pthread_mutex_unlock(&jobSystem.mainLock);
+    if (popped) RunJob(job);
+    return popped;
+}
+static void WaitForWork(JobCounter* counter) {
+    pthread_mutex_lock(&jobSystem.wakeLock);
+    __atomic_add_fetch(&jobSystem.sleepers, 1, __ATOMIC_SEQ_CST);
+    while (!__atomic_load_n(&jobSystem.shuttingDown, __ATOMIC_SEQ_CST) &&
+        __atomic_load_n(&jobSystem.queuedJobs, __ATOMIC_SEQ_CST) <= 0 &&
+        !(counter && IsJobCounterDone(counter))) {
+        pthread_cond_wait(&jobSystem.wake, &jobSystem.wakeLock);
+    }
+    __atomic_sub_fetch(&jobSystem.sleepers, 1, __ATOMIC_SEQ_CST);
+    pthread_mutex_unlock(&jobSystem.wakeLock);
+}
+static void* JobWorkerMain(void* arg) {
+    jobThreadSlot = (int)(intptr_t)arg;
+    int idleSpins = 0;
+    while (!__atomic_load_n(&jobSystem.shuttingDown, __ATOMIC_SEQ_CST)) {
+        Job job;
+        if (FindJob(&job)) {
+            RunJob(job);
+            idleSpins = 0;
+        } else if (idleSpins++ < JOB_IDLE_SPINS) {
+            PlatformYield();
+        } else {
+            WaitForWork(NULL);
+            idleSpins = 0;
+        }
+    }
+    return NULL;
+}
+void JobSystemInit(int workerCount) {
+    if (workerCount == JOB_WORKERS_AUTO) workerCount = PlatformCpuCount() - 1;
+    if (workerCount < 0) workerCount = 0;
+    if (workerCount > MAX_JOB_WORKERS) workerCount = MAX_JOB_WORKERS;
+    jobSystem.mainThread = pthread_self();
+    for (int i = 0; i <= MAX_JOB_WORKERS; i++) {
+        pthread_mutex_init(&jobSystem.deques[i].lock, NULL);
+        jobSystem.deques[i].top = 0;
+        jobSystem.deques[i].bottom = 0;
+    }
+    pthread_mutex_init(&jobSystem.mainLock, NULL);
+    pthread_mutex_init(&jobSystem.wakeLock, NULL);
+    pthread_cond_init(&jobSystem.wake, NULL);
+    jobSystem.mainHead = 0;
+    jobSystem.mainCount = 0;
+    jobSystem.queuedJobs = 0;
+    jobSystem.sleepers = 0;
+    jobSystem.shuttingDown = false;
+    // Workers are created with their slots already counted so they can steal from each other at once
+    __atomic_store_n(&jobSystem.workerCount, workerCount, __ATOMIC_RELAXED);
+    int started = 0;
+    for (int i = 0; i < workerCount; i++) {
+        if (pthread_create(&jobSystem.workers[i], NULL, JobWorkerMain, (void*)(intptr_t)(i + 1)) != 0) break;
+        started++;
+    }
+    __atomic_store_n(&jobSystem.workerCount, started, __ATOMIC_RELAXED);
+}
+void JobSystemShutdown(void) {
+    pthread_mutex_lock(&jobSystem.wakeLock);
+    __atomic_store_n(&jobSystem.shuttingDown, true, __ATOMIC_SEQ_CST);
+    pthread_cond_broadcast(&jobSystem.wake);
+    pthread_mutex_unlock(&jobSystem.wakeLock);
+    for (int i = 0; i < jobSystem.workerCount; i++) {
+        pthread_join(jobSystem.workers[i], NULL);
+    }
+    jobSystem.workerCount = 0;
+    pthread_cond_destroy(&jobSystem.wake);
+    pthread_mutex_destroy(&jobSystem.wakeLock);
+    pthread_mutex_destroy(&jobSystem.mainLock);
+    for (int i = 0; i <= MAX_JOB_WORKERS; i++) pthread_mutex_destroy(&jobSystem.deques[i].lock);
+}
+int JobWorkerCount(void) {
+    return jobSystem.workerCount;
+}
+bool IsMainThread(void) {
+    return pthread_equal(pthread_self(), jobSystem.mainThread) != 0;
+}
+void JobSubmit(JobFunction function, void* data, JobCounter* counter) {
+    Job job = { function, data, counter };
+    if (counter) __atomic_add_fetch(&counter->pending, 1, __ATOMIC_SEQ_CST);
+    EnqueueJob(job);
+}
+static void SubmitJobAfter(JobCounter* dependency, Job job, bool onMainThread) {
+    if (job.counter) __atomic_add_fetch(&job.counter->pending, 1, __ATOMIC_SEQ_CST);
+    if (dependency) {
+        JobContinuation* continuation = RL_MALLOC(sizeof(JobContinuation));
+        LockCounter(dependency);
+        bool deferred = continuation && __atomic_load_n(&dependency->pending, __ATOMIC_SEQ_CST) > 0;
+        if (deferred) {
+            *continuation = (JobContinuation){ job, onMainThread, dependency->continuations };
+            dependency->continuations = continuation;
+        }
+        UnlockCounter(dependency);
+        if (deferred) return;
+        RL_FREE(continuation);
+        if (__atomic_load_n(&dependency->pending, __ATOMIC_SEQ_CST) > 0) JobWait(dependency);
+    }
+    if (onMainThread) QueueMainJob(job);
+    else EnqueueJob(job);
+}
+void JobSubmitAfter(JobCounter* dependency, JobFunction function, void* data, JobCounter* counter) {
+    SubmitJobAfter(dependency, (Job){ function, data, counter }, false);
+}
+void JobSubmitMain(JobFunction function, void* data, JobCounter* counter) {
+    SubmitJobAfter(NULL, (Job){ function, data, counter }, true);
+}
+void JobSubmitMainAfter(JobCounter* dependency, JobFunction function, void* data, JobCounter* counter) {
+    SubmitJobAfter(dependency, (Job){ function, data, counter }, true);
+}
+void JobRunMainThreadJobs(void) {
+    while (RunMainThreadJob()) {}
+}
+void JobWait(JobCounter* counter) {
+    while (!IsJobCounterDone(counter)) {
+        Job job;
+        if (FindJob(&job)) {
+            RunJob(job);
+            continue;
+        }
+        WaitForWork(counter);
+    }
+}
+static void RunRangeJob(void* data) {
+    JobRange* range = data;
+    range->function(range->data, range->start, range->end);
+}
+void JobParallelFor(int count, int minBatchSize, JobRangeFunction function, void* data) {
+    if (count <= 0) return;
+    if (minBatchSize < 1) minBatchSize = 1;
+    int batchCount = (jobSystem.workerCount + 1) * JOB_BATCHES_PER_THREAD;
+    int maxBatches = count / minBatchSize + (count % minBatchSize != 0);
+    if (batchCount > maxBatches) batchCount = maxBatches;
+    if (batchCount > JOB_MAX_PARALLEL_BATCHES) batchCount = JOB_MAX_PARALLEL_BATCHES;
+    if (batchCount <= 1 || jobSystem.workerCount == 0) {
+        function(data, 0, count);
+        return;
+    }
+    JobRange ranges[JOB_MAX_PARALLEL_BATCHES];
+    JobCounter counter = { 0 };
+    for (int i = 0; i < batchCount; i++) {
+        ranges[i] = (JobRange){
+            function, data,
+            (int)((long long)count * i / batchCount),
+            (int)((long long)count * (i + 1) / batchCount)
+        };
+    }
+    // Push the tail first so thieves take the far end while the caller works from the front
+    for (int i = 1; i < batchCount; i++) JobSubmit(RunRangeJob, &ranges[batchCount - i], &counter);
+    RunRangeJob(&ranges[0]);
+    JobWait(&counter);
+}
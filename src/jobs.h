@@ -0,0 +1,38 @@
+#ifndef JOBS_H
+#define JOBS_H
+#include <stdbool.h>
+typedef void (*JobFunction)(void* data);
+typedef void (*JobRangeFunction)(void* data, int start, int end);
+typedef struct JobContinuation JobContinuation;
+// Zero-initialize before first use. Every job submitted with a counter adds one to pending until
+// it finishes; jobs queued with JobSubmitAfter start once their dependency's pending reaches zero.
+typedef struct {
+    int pending;
+    int lock;
+    JobContinuation* continuations;
+} JobCounter;
+// Each worker owns a deque: it pushes and pops its own work at the bottom while idle workers
+// steal from the top of the others. The main thread helps from inside JobWait. Jobs submitted with
+// JobSubmitMain, which is where raylib/GL calls belong, run only from JobRunMainThreadJobs, so they
+// never land inside a render pass or a locked section that happens to wait on other work.
+#define JOB_WORKERS_AUTO (-1)
+// JOB_WORKERS_AUTO starts one worker per core besides the main thread; 0 runs every job inline
+void JobSystemInit(int workerCount);
+void JobSystemShutdown(void);
+int JobWorkerCount(void);
+bool IsMainThread(void);
+void JobSubmit(JobFunction function, void* data, JobCounter* counter);
+void JobSubmitAfter(JobCounter* dependency, JobFunction function, void* data, JobCounter* counter);
+void JobSubmitMain(JobFunction function, void* data, JobCounter* counter);
+// Queues function for the main thread once dependency's pending reaches zero, e.g. the GL upload
+// of something a worker decodes
+void JobSubmitMainAfter(JobCounter* dependency, JobFunction function, void* data, JobCounter* counter);
+// Call once per frame on the main thread, outside any render pass: runs every main-thread job queued so far
+void JobRunMainThreadJobs(void);
+// Never waits for main-thread jobs to run, so waiting on a counter one of them holds deadlocks
+void JobWait(JobCounter* counter);
+bool IsJobCounterDone(JobCounter* counter);
+// Splits [0, count) into batches of at least minBatchSize, runs them across all workers plus the
+// caller and returns once every batch is done
+void JobParallelFor(int count, int minBatchSize, JobRangeFunction function, void* data);
+#endif
@@ -0,0 +1,154 @@
+#include "memtrack.h"
+#include <stdlib.h>
+#include <string.h>
+#include "json.h"
+typedef struct {
+    JsonDocument* document;
+    int length;
+    int cursor;
+    int depth;
+} JsonParser;
+static void SkipWhitespace(JsonParser* parser) {
+    const char* text = parser->document->text;
+    while (parser->cursor < parser->length) {
+        char c = text[parser->cursor];
+        if (c != ' ' && c != '\t' && c != '\n' && c != '\r') break;
+        parser->cursor++;
+    }
+}
+static int AddToken(JsonParser* parser, JsonType type) {
+    JsonDocument* document = parser->document;
+    if (document->tokenCount == document->tokenCapacity) {
+        int capacity = document->tokenCapacity ? document->tokenCapacity * 2 : 256;
+        JsonToken* tokens = RL_REALLOC(document->tokens, capacity * sizeof(JsonToken));
+        if (!tokens) return -1;
+        document->tokens = tokens;
+        document->tokenCapacity = capacity;
+    }
+    int index = document->tokenCount++;
+    document->tokens[index] = (JsonToken){ type, parser->cursor, parser->cursor, 0, index + 1 };
+    return index;
+}
+static bool ParseString(JsonParser* parser) {
+    const char* text = parser->document->text;
+    int index = AddToken(parser, JSON_STRING);
+    if (index < 0) return false;
+    parser->cursor++;
+    int start = parser->cursor;
+    while (parser->cursor < parser->length && text[parser->cursor] != '"') {
+        if (text[parser->cursor] == '\\') parser->cursor++;
+        parser->cursor++;
+    }
+    if (parser->cursor >= parser->length) return false;
+    parser->document->tokens[index].start = start;
+    parser->document->tokens[index].end = parser->cursor;
+    parser->cursor++;
+    return true;
+}
+static bool ParseValue(JsonParser* parser) {
+    const char* text = parser->document->text;
+    SkipWhitespace(parser);
+    if (parser->cursor >= parser->length || parser->depth > 64) return false;
+    char c = text[parser->cursor];
+    if (c == '"') return ParseString(parser);
+    if (c == '{' || c == '[') {
+        bool isObject = c == '{';
+        char close = isObject ? '}' : ']';
+        int index = AddToken(parser, isObject ? JSON_OBJECT : JSON_ARRAY);
+        if (index < 0) return false;
+        parser->cursor++;
+        parser->depth++;
+        int childCount = 0;
+        SkipWhitespace(parser);
+        while (parser->cursor < parser->length && text[parser->cursor] != close) {
+            if (isObject) {
+                SkipWhitespace(parser);
+                if (parser->cursor >= parser->length || text[parser->cursor] != '"') return false;
+                if (!ParseString(parser)) return false;
+                SkipWhitespace(parser);
+                if (parser->cursor >= parser->length || text[parser->cursor] != ':') return false;
+                parser->cursor++;
+            }
+            if (!ParseValue(parser)) return false;
+            childCount++;
+            SkipWhitespace(parser);
+            if (parser->cursor < parser->length && text[parser->cursor] == ',') {
+                parser->cursor++;
+                SkipWhitespace(parser);
+            }
+        }
+        if (parser->cursor >= parser->length) return false;
+        parser->cursor++;
+        parser->depth--;
+        JsonToken* token = &parser->document->tokens[index];
+        token->end = parser->cursor;
+        token->childCount = childCount;
+        token->next = parser->document->tokenCount;
+        return true;
+    }
+    JsonType type = JSON_NUMBER;
+    if (c == 't' || c == 'f') type = JSON_BOOL;
+    if (c == 'n') type = JSON_NULL;
+    int index = AddToken(parser, type);
+    if (index < 0) return false;
+    while (parser->cursor < parser->length && !strchr(",]} \t\r\n", text[parser->cursor])) {
+        parser->cursor++;
+    }
+    parser->document->tokens[index].end = parser->cursor;
+    return true;
+}
+bool JsonParse(const char* text, int length, JsonDocument* outDocument) {
+    *outDocument = (JsonDocument){ .text = text };
+    JsonParser parser = { outDocument, length, 0, 0 };
+    if (!ParseValue(&parser)) {
+        JsonFree(outDocument);
+        return false;
+    }
+    return true;
+}
+void JsonFree(JsonDocument* document) {
+    RL_FREE(document->tokens);
+    document->tokens = NULL;
+    document->tokenCount = 0;
+    document->tokenCapacity = 0;
+}
+static bool TokenEquals(const JsonDocument* document, int token, const char* text) {
+    const JsonToken* t = &document->tokens[token];
+    int length = (int)strlen(text);
+    return t->type == JSON_STRING && t->end - t->start == length &&
+        strncmp(document->text + t->start, text, length) == 0;
+}
+int JsonObjectGet(const JsonDocument* document, int objectToken, const char* key) {
+    if (objectToken < 0 || document->tokens[objectToken].type != JSON_OBJECT) return -1;
+    int child = objectToken + 1;
+    for (int i = 0; i < document->tokens[objectToken].childCount; i++) {
+        int value = child + 1;
+        if (TokenEquals(document, child, key)) return value;
+        child = document->tokens[value].next;
+    }
+    return -1;
+}
+int JsonArrayGet(const JsonDocument* document, int arrayToken, int element) {
+    if (arrayToken < 0 || document->tokens[arrayToken].type != JSON_ARRAY) return -1;
+    if (element < 0 || element >= document->tokens[arrayToken].childCount) return -1;
+    int child = arrayToken + 1;
+    for (int i = 0; i < element; i++) child = document->tokens[child].next;
+    return child;
+}
+int JsonGetInt(const JsonDocument* document, int token, int fallback) {
+    if (token < 0 || document->tokens[token].type != JSON_NUMBER) return fallback;
+    return (int)strtol(document->text + document->tokens[token].start, NULL, 10);
+}
+float JsonGetFloat(const JsonDocument* document, int token, float fallback) {
+    if (token < 0 || document->tokens[token].type != JSON_NUMBER) return fallback;
+    return strtof(document->text + document->tokens[token].start, NULL);
+}
+bool JsonGetString(const JsonDocument* document, int token, char* outText, int outSize) {
+    if (token < 0 || document->tokens[token].type != JSON_STRING || outSize <= 0) return false;
+    const JsonToken* t = &document->tokens[token];
+    int length = t->end - t->start;
+    if (length >= outSize) length = outSize - 1;
+    memcpy(outText, document->text + t->start, length);
+    outText[length] = '\0';
+    return true;
+}
@@ -0,0 +1,33 @@
+#ifndef JSON_H
+#define JSON_H
+#include <stdbool.h>
+typedef enum {
+    JSON_NULL,
+    JSON_BOOL,
+    JSON_NUMBER,
+    JSON_STRING,
+    JSON_ARRAY,
+    JSON_OBJECT
+} JsonType;
+typedef struct {
+    JsonType type;
+    int start;
+    int end;
+    int childCount;
+    int next;
+} JsonToken;
+// Flat pre-order token list; an object's children alternate key, value
+typedef struct {
+    const char* text;
+    JsonToken* tokens;
+    int tokenCount;
+    int tokenCapacity;
+} JsonDocument;
+bool JsonParse(const char* text, int length, JsonDocument* outDocument);
+void JsonFree(JsonDocument* document);
+int JsonObjectGet(const JsonDocument* document, int objectToken, const char* key);
+int JsonArrayGet(const JsonDocument* document, int arrayToken, int element);
+int JsonGetInt(const JsonDocument* document, int token, int fallback);
+float JsonGetFloat(const JsonDocument* document, int token, float fallback);
+bool JsonGetString(const JsonDocument* document, int token, char* outText, int outSize);
+#endif
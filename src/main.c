@@ -1,46 +1,85 @@
+#include <ctype.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "memtrack.h"
 #include "../include/raylib.h"
 #include "../include/raymath.h"
-typedef struct {
-    Vector3 position;
-    Vector3 velocity;
-    Vector3 lastSafePosition;
-    float radius;
-    float halfHeight;
-    bool isOnGround;
-} CollisionCapsule;
-typedef struct {
-    CollisionCapsule collisionCapsule;
-    Vector3 wishDirection;
-    float moveSpeed;
-} Player;
+#include "actors.h"
+#include "arena.h"
+#include "assets.h"
+#include "bench.h"
+#include "collision.h"
+#include "drawstream.h"
+#include "entity.h"
+#include "flythrough.h"
+#include "gputimer.h"
+#include "heatmap.h"
+#include "jobs.h"
+#include "overlay.h"
+#include "pipeline.h"
+#include "platform.h"
+#include "query.h"
+#include "stats.h"
+#include "world.h"
 typedef struct {
     Camera3D rawCamera;
     Vector3 forward;
     Vector3 right;
     Vector3 targetPosition;
+    float armLength;
 } PlayerCamera;
-typedef struct {
-    Vector3 v0, v1, v2;
-    Vector3 normal;
-} Triangle;
-const float GRAVITY = 9.81f;
-const float JUMP_POWER = 8.0f;
 const Color DEFUALT_PLAYER_COLOR = {255, 255, 255, 255};
 const Color LOVELY_COLOR = {62, 70, 55, 255}; 
 const float PLAYER_RADIUS = 1.5f;
 const float PLAYER_HEIGHT = 1.0f;
-Vector2 inputDirection;
+const float PLAYER_MOVE_SPEED = 5.0f;
+const float PLAYER_BOUNDS_RADIUS = 2.0f;
+const Vector3 CAMERA_ARM_OFFSET = {0.0f, 4.0f, 5.0f};
+const float CAMERA_PROBE_RADIUS = 0.3f;
+const float CAMERA_ARM_RETURN_SPEED = 3.0f;
+const float BEAR_RADIUS = 0.8f;
+const float BEAR_HEIGHT = 1.2f;
+const float BEAR_MOVE_SPEED = 2.0f;
+const float BEAR_BOUNDS_RADIUS = 1.5f;
+const float BEAR_SLOPE_LIMIT = 35.0f;
+const int MAX_ENTITIES = 16384;
+const double ASSET_UPLOAD_BUDGET_MS = 2.0;
+const size_t ASSET_CPU_BUDGET_BYTES = 128u * 1024u * 1024u;
+const size_t ASSET_GPU_BUDGET_BYTES = 256u * 1024u * 1024u;
+const size_t FRAME_ARENA_BYTES = 4u * 1024u * 1024u;
+const size_t SIM_FRAME_ARENA_BYTES = 4u * 1024u * 1024u;
+const char* DEFAULT_WORLD_FILE = "assets/worlds/arena.world";
+const float COLLISION_HEATMAP_CELL_SIZE = 1.0f;
+const char* COLLISION_HEATMAP_FILE = "collision_heatmap.csv";
+const char* DRAW_STREAM_FILE = "capture.drawstream";
+const int DRAW_STREAM_CAPTURE_FRAMES = 120;
+const float FLYTHROUGH_STEP = 1.0f / 60.0f;
+const unsigned int FLYTHROUGH_SEED = 1337;
+const int FLYTHROUGH_WARMUP_FRAMES = 30;
+const double FLYTHROUGH_WARMUP_TIMEOUT = 60.0;
+const WorldStreamingSettings WORLD_STREAMING = {
+    .loadDistance = 60.0f,
+    .unloadDistance = 90.0f,
+    .lookaheadSeconds = 1.5f,
+    .maxResidentCells = 4
+};
 int renderWidth = 320;
 int renderHeight = 240;
 int screenWidth = 1366;
 int screenHeight = 768;
 RenderTexture2D renderTarget;
-Player player;
+bool showStatsOverlay = false;
+bool showCollisionHeatmap = false;
+CollisionHeatmap collisionHeatmap;
+bool pipelineThreaded = true;
+const char* drawStreamFile = NULL;
+EntityStore entities;
+Entity player;
 PlayerCamera camera;
-Model playerModel;
-Model levelModel;
-Matrix levelTransform;
+ModelHandle playerModel;
+ModelHandle bearModel;
+World world;
 Vector2 GetInputDirection(void) {
     Vector2 direction = {
         IsKeyDown(KEY_D) - IsKeyDown(KEY_A),
@@ -48,14 +87,12 @@ Vector2 GetInputDirection(void) {
     };
     return direction;
 }
-float WrapAngle(float a) {
-    while (a > PI) a -= PI*2.0f;
-    while (a < -PI) a += PI*2.0f;
-    return a;
-}
-float LerpAngle(float a, float b, float t) {
-    float diff = WrapAngle(b - a);
-    return a + diff * t;
+InputSample SampleInput(void) {
+    InputSample input = {
+        .moveDirection = GetInputDirection(),
+        .jumpHeld = IsKeyDown(KEY_SPACE)
+    };
+    return input;
 }
 void ComputeRenderResolutionForWindowAspect(
     int windowPixelWidth,
@@ -68,134 +105,6 @@ void ComputeRenderResolutionForWindowAspect(
     *outRenderPixelHeight = fixedRenderPixelHeight;
     *outRenderPixelWidth = (int)((float)fixedRenderPixelHeight * windowAspectRatio);
 }
-Vector3 ClosestPointOnLineSegment(Vector3 a, Vector3 b, Vector3 point) {
-    Vector3 ab = Vector3Subtract(b, a);
-    float t = Vector3DotProduct(Vector3Subtract(point, a), ab) / Vector3DotProduct(ab, ab);
-    t = fmaxf(0.0f, fminf(1.0f, t));
-    return Vector3Add(a, Vector3Scale(ab, t));
-}
-bool IsPointInTriangle(Vector3 point, Triangle tri) {
-    Vector3 v0 = Vector3Subtract(tri.v2, tri.v0);
-    Vector3 v1 = Vector3Subtract(tri.v1, tri.v0);
-    Vector3 v2 = Vector3Subtract(point, tri.v0);
-    float dot00 = Vector3DotProduct(v0, v0);
-    float dot01 = Vector3DotProduct(v0, v1);
-    float dot02 = Vector3DotProduct(v0, v2);
-    float dot11 = Vector3DotProduct(v1, v1);
-    float dot12 = Vector3DotProduct(v1, v2);
-    float invDenom = 1.0f / (dot00 * dot11 - dot01 * dot01);
-    float u = (dot11 * dot02 - dot01 * dot12) * invDenom;
-    float v = (dot00 * dot12 - dot01 * dot02) * invDenom;
-    return (u >= 0) && (v >= 0) && (u + v <= 1);
-}
-Triangle GetTriangle(Mesh mesh, Matrix transform, int triIndex) {
-    Triangle tri = {0};
-    Vector3 v0, v1, v2;
-    if (mesh.indices) {
-        if (triIndex * 3 + 2 >= mesh.triangleCount * 3) {
-            return tri;
-        }
-        int i0 = mesh.indices[triIndex * 3 + 0];
-        int i1 = mesh.indices[triIndex * 3 + 1];
-        int i2 = mesh.indices[triIndex * 3 + 2];
-        v0 = (Vector3){ mesh.vertices[i0*3], mesh.vertices[i0*3+1], mesh.vertices[i0*3+2] };
-        v1 = (Vector3){ mesh.vertices[i1*3], mesh.vertices[i1*3+1], mesh.vertices[i1*3+2] };
-        v2 = (Vector3){ mesh.vertices[i2*3], mesh.vertices[i2*3+1], mesh.vertices[i2*3+2] };
-    } else {
-        if (triIndex * 9 + 8 >= mesh.vertexCount * 3) {
-            return tri;
-        }
-        int baseIdx = triIndex * 9; // 3 vertices * 3 floats each
-        v0 = (Vector3){ mesh.vertices[baseIdx], mesh.vertices[baseIdx+1], mesh.vertices[baseIdx+2] };
-        v1 = (Vector3){ mesh.vertices[baseIdx+3], mesh.vertices[baseIdx+4], mesh.vertices[baseIdx+5] };
-        v2 = (Vector3){ mesh.vertices[baseIdx+6], mesh.vertices[baseIdx+7], mesh.vertices[baseIdx+8] };
-    }
-    tri.v0 = Vector3Transform(v0, transform);
-    tri.v1 = Vector3Transform(v1, transform);
-    tri.v2 = Vector3Transform(v2, transform);
-    Vector3 edge1 = Vector3Subtract(tri.v1, tri.v0);
-    Vector3 edge2 = Vector3Subtract(tri.v2, tri.v0);
-    tri.normal = Vector3Normalize(Vector3CrossProduct(edge1, edge2));
-    return tri;
-}
-bool TestCapsuleTriangle(Vector3* position, Vector3 capsuleBase, Vector3 capsuleTop, float radius, Triangle tri, Vector3* pushOut) {
-    Vector3 closestOnCapsule = ClosestPointOnLineSegment(capsuleBase, capsuleTop, tri.v0);
-    float distanceToPlane = Vector3DotProduct(Vector3Subtract(closestOnCapsule, tri.v0), tri.normal);
-    if (fabsf(distanceToPlane) > radius) {
-        return false;
-    }
-    Vector3 pointOnPlane = Vector3Subtract(closestOnCapsule, Vector3Scale(tri.normal, distanceToPlane));
-    if (IsPointInTriangle(pointOnPlane, tri)) {
-        if (fabsf(distanceToPlane) < radius) {
-            float penetration = radius - fabsf(distanceToPlane);
-            float direction = distanceToPlane >= 0 ? 1.0f : -1.0f;
-            *pushOut = Vector3Scale(tri.normal, penetration * direction);
-            return true;
-        }
-    }
-    return false;
-}
-float FindFloor(Vector3 pos, Vector3* outNormal) {
-    float highestFloor = -10000.0f;
-    Vector3 floorNormal = {0, 1, 0};
-    bool foundFloor = false;
-    for (int meshIdx = 0; meshIdx < levelModel.meshCount; meshIdx++) {
-        Mesh mesh = levelModel.meshes[meshIdx];
-        int triangleCount = mesh.triangleCount;
-        if (triangleCount == 0) {
-            triangleCount = mesh.vertexCount / 3;
-        }
-        for (int i = 0; i < triangleCount; i++) {
-            Triangle tri = GetTriangle(mesh, levelTransform, i);
-            if (Vector3LengthSqr(tri.normal) < 0.001f) continue;
-            if (tri.normal.y <= 0.5f) continue;
-            Vector3 testPoint = pos;
-            testPoint.y = tri.v0.y;
-            if (IsPointInTriangle(testPoint, tri)) {
-                // Calculate exact height at this point
-                // Plane equation: n·(p - p0) = 0
-                // For floor: p.y = p0.y - (n.x*(p.x-p0.x) + n.z*(p.z-p0.z)) / n.y
-                float height = 
-                    tri.v0.y - 
-                    (tri.normal.x*(testPoint.x - tri.v0.x) + 
-                    tri.normal.z*(testPoint.z - tri.v0.z)) / 
-                    tri.normal.y;
-                if (height > highestFloor && height <= pos.y + 100.0f) {
-                    highestFloor = height;
-                    floorNormal = tri.normal;
-                    foundFloor = true;
-                }
-            }
-        }
-    }
-    *outNormal = floorNormal;
-    return foundFloor ? highestFloor : -10000.0f;
-}
-int ResolveCapsuleCollision(Vector3* position, float radius, float height) {
-    int collisionCount = 0;
-    Vector3 capsuleBase = *position;
-    Vector3 capsuleTop = Vector3Add(*position, (Vector3){0, height, 0});
-    for (int meshIdx = 0; meshIdx < levelModel.meshCount; meshIdx++) {
-        Mesh mesh = levelModel.meshes[meshIdx];
-        int triangleCount = mesh.triangleCount;
-        if (triangleCount == 0) { triangleCount = mesh.vertexCount / 3; }
-        for (int i = 0; i < triangleCount; i++) {
-            Triangle tri = GetTriangle(mesh, levelTransform, i);
-            if (Vector3LengthSqr(tri.normal) < 0.001f) continue;
-            if (tri.normal.y > 0.7f) continue;
-            Vector3 pushOut = {0, 0, 0};
-            if (TestCapsuleTriangle(position, capsuleBase, capsuleTop, radius, tri, &pushOut)) {
-                position->x += pushOut.x;
-                position->y += pushOut.y;
-                position->z += pushOut.z;
-                capsuleBase = *position;
-                capsuleTop = Vector3Add(*position, (Vector3){0, height, 0});
-                collisionCount++;
-            }
-        }
-    }
-    return collisionCount;
-}
 void PlayerInitialize(void) {
     camera = (PlayerCamera){
         .rawCamera = (Camera3D){
@@ -207,77 +116,299 @@ void PlayerInitialize(void) {
         },
         .forward = (Vector3){0.0f, 0.0f, 0.0f},
         .right = (Vector3){0.0f, 0.0f, 0.0f},
-        .targetPosition = (Vector3){0.0f, 0.0f, 0.0f}
-    };
-    player = (Player){
-        .collisionCapsule = (CollisionCapsule){
-            .position = {0.0f, 5.0f, 0.0f},
-            .velocity = {0.0f, 0.0f, 0.0f},
-            .lastSafePosition = {0.0f, 5.0f, 0.0f},
-            .radius = PLAYER_RADIUS,
-            .halfHeight = PLAYER_HEIGHT / 2.0f,
-            .isOnGround = false
-        },
-        .wishDirection = (Vector3){0.0f, 0.0f, 0.0f},
-        .moveSpeed = 5.0f
+        .targetPosition = (Vector3){0.0f, 0.0f, 0.0f},
+        .armLength = Vector3Length(CAMERA_ARM_OFFSET)
     };
-    playerModel = LoadModel("assets/ShadowSlink.gltf");
+    player = SpawnCharacter(&entities, (Vector3){0.0f, 5.0f, 0.0f}, PLAYER_RADIUS, PLAYER_HEIGHT, PLAYER_MOVE_SPEED);
+    playerModel = LoadModelAsync("assets/ShadowSlink.gltf");
+    RenderMesh* mesh = AddComponent(&entities, player, COMPONENT_RENDER_MESH);
+    if (mesh) { *mesh = (RenderMesh){ playerModel, WHITE, PLAYER_BOUNDS_RADIUS }; }
 }
-void PlayerUpdate(Player* player, PlayerCamera* camera, float delta) {
-    CollisionCapsule *pCollider = &player->collisionCapsule;
-    if (!pCollider->isOnGround) { pCollider->velocity.y -= GRAVITY * delta; }
-    if (pCollider->isOnGround && IsKeyDown(KEY_SPACE)) {
-        pCollider->velocity.y = JUMP_POWER;
-        pCollider->isOnGround = false;
+// A crowd of bears scattered over the first cell, each walking off in its own direction
+void SpawnActors(int count) {
+    if (world.cellCount == 0 || count <= 0) return;
+    bearModel = LoadModelAsync("assets/bear.gltf");
+    BoundingBox bounds = world.cells[0].bounds;
+    for (int i = 0; i < count; i++) {
+        Vector3 position = {
+            bounds.min.x + (bounds.max.x - bounds.min.x) * (float)GetRandomValue(0, 1000) / 1000.0f,
+            bounds.max.y + 2.0f,
+            bounds.min.z + (bounds.max.z - bounds.min.z) * (float)GetRandomValue(0, 1000) / 1000.0f
+        };
+        Entity actor = SpawnCharacter(&entities, position, BEAR_RADIUS, BEAR_HEIGHT, BEAR_MOVE_SPEED);
+        RenderMesh* mesh = AddComponent(&entities, actor, COMPONENT_RENDER_MESH);
+        if (mesh) { *mesh = (RenderMesh){ bearModel, WHITE, BEAR_BOUNDS_RADIUS }; }
+        CharacterController* controller = GetComponent(&entities, actor, COMPONENT_CONTROLLER);
+        float heading = (float)GetRandomValue(0, 359) * DEG2RAD;
+        if (controller) {
+            controller->wishDirection = (Vector3){ sinf(heading), 0.0f, cosf(heading) };
+            controller->slopeLimit = BEAR_SLOPE_LIMIT;
+        }
     }
-    Vector3 horizontalVelocity = {
-        player->wishDirection.x * player->moveSpeed,
-        0,
-        player->wishDirection.z * player->moveSpeed
-    };
-    pCollider->position.x += horizontalVelocity.x * delta;
-    pCollider->position.z += horizontalVelocity.z * delta;
-    for (int i = 0; i < 3; i++) {
-        int walls = ResolveCapsuleCollision(&pCollider->position, pCollider->radius, PLAYER_HEIGHT);
-        if (walls == 0) break;
+}
+// Spring arm: a sphere cast from the focus point out along the offset. The arm snaps in to the
+// first thing it touches so walls never sit between camera and player, and eases back out.
+void UpdateCameraArm(float delta) {
+    float fullLength = Vector3Length(CAMERA_ARM_OFFSET);
+    Vector3 direction = Vector3Scale(CAMERA_ARM_OFFSET, 1.0f / fullLength);
+    LockWorld(&world);
+    CollisionHit hit = SphereCastWorld(&world.collision, camera.targetPosition, CAMERA_PROBE_RADIUS, direction, fullLength);
+    UnlockWorld(&world);
+    float wantedLength = hit.hit ? hit.distance : fullLength;
+    if (wantedLength < camera.armLength) camera.armLength = wantedLength;
+    else camera.armLength = fminf(wantedLength, Lerp(camera.armLength, wantedLength, CAMERA_ARM_RETURN_SPEED * delta));
+    camera.rawCamera.position = Vector3Add(camera.targetPosition, Vector3Scale(direction, camera.armLength));
+}
+// F4 records and shows where character collision work piles up; the grid covers every cell of the
+// layout and is allocated the first time it is switched on
+void ToggleCollisionHeatmap(void) {
+    LockWorld(&world);
+    showCollisionHeatmap = !showCollisionHeatmap;
+    if (showCollisionHeatmap && !collisionHeatmap.cells && world.cellCount > 0) {
+        BoundingBox bounds = world.cells[0].bounds;
+        for (int i = 1; i < world.cellCount; i++) {
+            bounds.min = Vector3Min(bounds.min, world.cells[i].bounds.min);
+            bounds.max = Vector3Max(bounds.max, world.cells[i].bounds.max);
+        }
+        InitCollisionHeatmap(&collisionHeatmap, bounds, COLLISION_HEATMAP_CELL_SIZE);
     }
-    pCollider->position.y += pCollider->velocity.y * delta;
-    Vector3 floorNormal;
-    float floorHeight = FindFloor(pCollider->position, &floorNormal);
-    if (floorHeight > -9999.0f) {
-        float distToFloor = pCollider->position.y - floorHeight;
-        if (distToFloor <= 0.1f && pCollider->velocity.y <= 0) {
-            pCollider->position.y = floorHeight;
-            pCollider->velocity.y = 0;
-            pCollider->isOnGround = true;
-        } else {
-            pCollider->isOnGround = false;
+    SetCollisionHeatmap(showCollisionHeatmap ? &collisionHeatmap : NULL);
+    UnlockWorld(&world);
+}
+// Runs on the simulation thread when the pipeline is threaded; it owns the entity store and the
+// camera, and reaches the world only while holding the world lock. Everything drawn from the world
+// is copied into the snapshot under that lock, so the renderer never takes it.
+void SimulateFrame(void* data, InputSample input, float delta, FrameSnapshot* out) {
+    (void)data;
+    Transform* playerTransform = GetComponent(&entities, player, COMPONENT_TRANSFORM);
+    CollisionCapsule* playerCapsule = GetComponent(&entities, player, COMPONENT_CAPSULE);
+    CharacterController* playerController = GetComponent(&entities, player, COMPONENT_CONTROLLER);
+    Vector3* playerVelocity = GetComponent(&entities, player, COMPONENT_VELOCITY);
+    camera.targetPosition = Vector3Add(playerTransform->translation, (Vector3){0.0f, playerCapsule->halfHeight, 0.0f});
+    UpdateCameraArm(delta);
+    camera.rawCamera.target = Vector3Lerp(camera.rawCamera.target, playerTransform->translation, 2.01f * delta); 
+    camera.forward = Vector3Subtract(camera.rawCamera.position, camera.rawCamera.target);
+    camera.forward.y = 0;
+    camera.forward = Vector3Normalize(camera.forward);
+    camera.right = Vector3CrossProduct(camera.rawCamera.up, camera.forward);
+    camera.right = Vector3Normalize(camera.right);
+    playerController->wishDirection = Vector3Normalize(Vector3Add(
+        Vector3Scale(camera.forward, input.moveDirection.y), 
+        Vector3Scale(camera.right, input.moveDirection.x)
+    ));
+    playerController->wantsJump = input.jumpHeld;
+    LockWorld(&world);
+    UpdateWorldMovers(&world, delta);
+    UpdateCharacterControllers(&entities, &world, delta);
+    CaptureWorldDrawInstances(&world, out);
+    CopyCollisionHeatmap(&out->heatmap, showCollisionHeatmap ? &collisionHeatmap : &(CollisionHeatmap){ 0 });
+    UnlockWorld(&world);
+    IntegrateVelocities(&entities, delta);
+    UpdateAnimations(&entities, delta);
+    CaptureRenderInstances(&entities, out);
+    out->camera = camera.rawCamera;
+    out->focusPosition = playerTransform->translation;
+    out->focusVelocity = *playerVelocity;
+}
+// Draws the snapshot into the low-resolution target, scales it up to the window and adds the 2D
+// overlays. Leaves the frame open: the caller ends it with EndDrawing, so it can time everything up to
+// the swap on its own. Returns how many render instances survived culling.
+int DrawFrame(const FrameSnapshot* frame) {
+    int visibleCount;
+    BeginTextureMode(renderTarget);
+        ClearBackground(LOVELY_COLOR);
+        BeginDrawStreamFrame(frame->camera, renderWidth, renderHeight);
+        BeginMode3D(frame->camera);
+            DrawGrid(40, 4.0f);
+            CaptureGridDraw(40, 4.0f);
+            DrawCube(frame->focusPosition, 1, 1, 1, RED);
+            CaptureCubeDraw(frame->focusPosition, Vector3One(), false, RED);
+            DrawCube(frame->camera.target, 1, 1, 1, BLUE);
+            CaptureCubeDraw(frame->camera.target, Vector3One(), false, BLUE);
+            visibleCount = DrawRenderInstances(frame, (float)renderWidth / (float)renderHeight, true);
+            DrawWorldInstances(frame);
+            DrawCollisionHeatmap(&frame->heatmap);
+        EndMode3D();
+        EndDrawStreamFrame();
+    EndTextureMode();
+    BeginDrawing();
+        Rectangle sourceRenderTextureRect = {
+            0.0f, 0.0f,
+            (float)renderTarget.texture.width,
+            -(float)renderTarget.texture.height
+        };
+        float renderToWindowScale = fminf(
+            (float)screenWidth  / (float)renderWidth,
+            (float)screenHeight / (float)renderHeight
+        );
+        Rectangle destinationWindowRect = {
+            (screenWidth  - (renderWidth  * renderToWindowScale)) * 0.5f,
+            (screenHeight - (renderHeight * renderToWindowScale)) * 0.5f,
+            renderWidth  * renderToWindowScale,
+            renderHeight * renderToWindowScale
+        };
+        DrawTexturePro(
+            renderTarget.texture,
+            sourceRenderTextureRect,
+            destinationWindowRect,
+            (Vector2){ 0.0f, 0.0f },
+            0.0f,
+            WHITE
+        );
+        DrawFPS(10, 10);
+        if (showStatsOverlay) { DrawStatsOverlay(10, 35); }
+        if (frame->heatmap.cells) { DrawCollisionHotspotList(&frame->heatmap, screenWidth - 410, 10); }
+    return visibleCount;
+}
+void RunGame(void) {
+    while (!WindowShouldClose()) {
+        FrameArenaBeginFrame(FRAME_ARENA_RENDER);
+        PipelineSubmitInput(SampleInput());
+        const FrameSnapshot* frame = PipelineAcquireFrame();
+        JobRunMainThreadJobs();
+        AssetManagerUpdate(ASSET_UPLOAD_BUDGET_MS);
+        UpdateWorldStreaming(&world, frame->focusPosition, frame->focusVelocity);
+        if (IsKeyPressed(KEY_F3)) { showStatsOverlay = !showStatsOverlay; }
+        if (IsKeyPressed(KEY_F4)) { ToggleCollisionHeatmap(); }
+        if (IsKeyPressed(KEY_F5) && collisionHeatmap.cells) {
+            LockWorld(&world);
+            ExportCollisionHeatmapCsv(&collisionHeatmap, COLLISION_HEATMAP_FILE);
+            UnlockWorld(&world);
+        }
+        if (IsKeyPressed(KEY_F6) && !IsDrawStreamCapturing()) {
+            StartDrawStreamCapture(drawStreamFile ? drawStreamFile : DRAW_STREAM_FILE, DRAW_STREAM_CAPTURE_FRAMES);
         }
+        MemoryTag previousTag = PushMemoryTag(MEMORY_TAG_RENDER);
+        DrawFrame(frame);
+        EndDrawing();
+        EndStatsFrame();
+        PopMemoryTag(previousTag);
     }
-    if (pCollider->position.y < -20) { pCollider->position = (Vector3){0, 5, 0}; }
 }
-void DrawPlayer(Model playerModel, Vector3 position, Vector3 wishDirection) {
-    static float yaw = 0.0f;
-    static float targetYaw = 0.0f;
-    if (Vector3LengthSqr(wishDirection) > 0.0001f) {
-        wishDirection = Vector3Normalize(wishDirection);
-        targetYaw = atan2f(-wishDirection.x, -wishDirection.z);
+// Streams in what the path starts on and renders there, untimed and without simulating, until it
+// and the character models are resident and the driver has seen a few frames. With no simulation to
+// fill the snapshot, the world is captured into it here.
+void WarmUpFlythrough(const FlythroughPath* path, bool waitForActors) {
+    FrameSnapshot frame = { .camera = GetFlythroughCamera(path, 0.0f) };
+    frame.focusPosition = frame.camera.position;
+    double start = PlatformTime();
+    int warmFrames = 0;
+    while (!WindowShouldClose()) {
+        bool ready = IsWorldResidentAt(&world, frame.camera.position) && IsModelHandleReady(playerModel) &&
+            (!waitForActors || IsModelHandleReady(bearModel));
+        warmFrames = ready ? warmFrames + 1 : 0;
+        if (warmFrames > FLYTHROUGH_WARMUP_FRAMES) break;
+        if (PlatformTime() - start > FLYTHROUGH_WARMUP_TIMEOUT) {
+            TraceLog(LOG_WARNING, "FLYTHROUGH: Assets still loading after %.0f s, starting anyway", FLYTHROUGH_WARMUP_TIMEOUT);
+            break;
+        }
+        FrameArenaBeginFrame(FRAME_ARENA_RENDER);
+        JobRunMainThreadJobs();
+        AssetManagerUpdate(ASSET_UPLOAD_BUDGET_MS);
+        UpdateWorldStreaming(&world, frame.camera.position, Vector3Zero());
+        frame.worldInstances = FRAME_ALLOC_ARRAY(WorldDrawInstance, MAX_WORLD_DRAW_INSTANCES);
+        frame.worldInstanceCapacity = frame.worldInstances ? MAX_WORLD_DRAW_INSTANCES : 0;
+        LockWorld(&world);
+        CaptureWorldDrawInstances(&world, &frame);
+        UnlockWorld(&world);
+        DrawFrame(&frame);
+        EndDrawing();
+        EndStatsFrame();
     }
-    float turnSpeed = 8.0f * GetFrameTime();
-    yaw = LerpAngle(yaw, targetYaw, turnSpeed);
-    DrawModelEx(
-        playerModel,
-        position,
-        (Vector3){ 0, 1, 0 },
-        yaw * RAD2DEG,
-        (Vector3){ 1, 1, 1 },
-        WHITE
-    );
-    Vector3 bottom = Vector3Add(position, (Vector3){0, player.collisionCapsule.radius, 0});
-    Vector3 top = Vector3Add(bottom, (Vector3){0, player.collisionCapsule.halfHeight * 2.0f - player.collisionCapsule.radius*2.0f, 0});
-    DrawCapsuleWires(bottom, top, player.collisionCapsule.radius, 6, 4, WHITE);
 }
-int main(void) {
+// One flythrough frame up to the end of DrawFrame: the caller closes it with EndDrawing
+int DrawFlythroughFrame(const FlythroughPath* path, int index, FrameSnapshot* frame) {
+    FrameArenaBeginFrame(FRAME_ARENA_RENDER);
+    PipelineSubmitInput((InputSample){ 0 });
+    *frame = *PipelineAcquireFrame();
+    frame->camera = GetFlythroughCamera(path, index * FLYTHROUGH_STEP);
+    Vector3 ahead = GetFlythroughCamera(path, (index + 1) * FLYTHROUGH_STEP).position;
+    JobRunMainThreadJobs();
+    AssetManagerUpdate(ASSET_UPLOAD_BUDGET_MS);
+    UpdateWorldStreaming(&world, frame->camera.position, Vector3Scale(Vector3Subtract(ahead, frame->camera.position), 1.0f / FLYTHROUGH_STEP));
+    MemoryTag previousTag = PushMemoryTag(MEMORY_TAG_RENDER);
+    int visibleCount = DrawFrame(frame);
+    PopMemoryTag(previousTag);
+    return visibleCount;
+}
+// Render benchmark: the camera follows the path one fixed step per frame while the simulation ticks
+// at the same step, every frame is rendered and timed, and the process exits with a summary. With a
+// capture file the path is flown once more afterwards to record it, so writing the stream never
+// lands in the timed frames.
+int RunFlythrough(const char* pathFile, bool waitForActors) {
+    FlythroughPath path;
+    FlythroughRecording recording;
+    if (!LoadFlythroughPath(&path, pathFile)) return 1;
+    int frameCount = (int)ceilf(GetFlythroughDuration(&path) / FLYTHROUGH_STEP) + 1;
+    if (!InitFlythroughRecording(&recording, frameCount)) return 1;
+    InitGpuTimer();
+    WarmUpFlythrough(&path, waitForActors);
+    int tag;
+    double gpuMs;
+    for (int i = 0; i < frameCount && !WindowShouldClose(); i++) {
+        while (PollGpuTimer(&tag, &gpuMs, false)) recording.frames[tag].gpuMs = gpuMs;
+        double start = PlatformTime();
+        BeginGpuTimer(i);
+        FrameSnapshot frame;
+        int visibleCount = DrawFlythroughFrame(&path, i, &frame);
+        double submitted = PlatformTime();
+        EndDrawing();
+        EndGpuTimer();
+        EndStatsFrame();
+        FlythroughFrame* recorded = &recording.frames[i];
+        recorded->frameMs = (PlatformTime() - start) * 1000.0;
+        recorded->cpuMs = (submitted - start) * 1000.0;
+        recorded->drawCalls = (int)GetStatSummary(STAT_DRAW_CALLS).last;
+        recorded->textureBinds = (int)GetStatSummary(STAT_TEXTURE_BINDS).last;
+        recorded->instances = frame.instanceCount;
+        recorded->culledInstances = frame.instanceCount - visibleCount;
+        recording.recordedCount = i + 1;
+    }
+    while (PollGpuTimer(&tag, &gpuMs, true)) recording.frames[tag].gpuMs = gpuMs;
+    ShutdownGpuTimer();
+    LogFlythroughSummary(&recording, pathFile, FLYTHROUGH_STEP);
+    FreeFlythroughRecording(&recording);
+    if (drawStreamFile && StartDrawStreamCapture(drawStreamFile, frameCount)) {
+        for (int i = 0; i < frameCount && IsDrawStreamCapturing() && !WindowShouldClose(); i++) {
+            FrameSnapshot frame;
+            DrawFlythroughFrame(&path, i, &frame);
+            EndDrawing();
+            EndStatsFrame();
+        }
+    }
+    return 0;
+}
+int main(int argc, char** argv) {
+    const char* worldFile = DEFAULT_WORLD_FILE;
+    int actorCount = 0;
+    const char* statsCsvFile = NULL;
+    const char* flythroughFile = NULL;
+    const char* replayFile = NULL;
+    int replayIterations = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--world") == 0 && i + 1 < argc) { worldFile = argv[++i]; }
+        else if (strcmp(argv[i], "--actors") == 0 && i + 1 < argc) { actorCount = atoi(argv[++i]); }
+        else if (strcmp(argv[i], "--no-pipeline") == 0) { pipelineThreaded = false; }
+        else if (strcmp(argv[i], "--stats-csv") == 0 && i + 1 < argc) { statsCsvFile = argv[++i]; }
+        else if (strcmp(argv[i], "--flythrough") == 0 && i + 1 < argc) { flythroughFile = argv[++i]; }
+        else if (strcmp(argv[i], "--capture-draws") == 0 && i + 1 < argc) { drawStreamFile = argv[++i]; }
+        else if (strcmp(argv[i], "--replay-draws") == 0 && i + 1 < argc) {
+            replayFile = argv[++i];
+            // The iteration count is optional, so only a number is taken as one
+            if (i + 1 < argc && isdigit((unsigned char)argv[i + 1][0])) replayIterations = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--bench-jobs") == 0) { return RunJobScalingBenchmark(i + 1 < argc ? atoi(argv[i + 1]) : 0); }
+        else if (strcmp(argv[i], "--bench-crowd") == 0) { return RunCrowdBenchmark(i + 1 < argc ? atoi(argv[i + 1]) : 0); }
+        else if (strcmp(argv[i], "--bench-raycast") == 0) { return RunRaycastBenchmark(i + 1 < argc ? atoi(argv[i + 1]) : 0); }
+        else if (strcmp(argv[i], "--bench-rays") == 0) { return RunPacketRayBenchmark(worldFile); }
+        else if (strcmp(argv[i], "--bench-simplify") == 0) { return RunSimplifyBenchmark(worldFile); }
+        else if (strcmp(argv[i], "--bench-scaling") == 0) { return RunScalingBenchmark(i + 1 < argc ? atoi(argv[i + 1]) : 0); }
+        else if (strcmp(argv[i], "--verify-collision") == 0) { return RunCollisionVerification(worldFile, i + 1 < argc ? (unsigned int)strtoul(argv[i + 1], NULL, 10) : 0); }
+        else if (strcmp(argv[i], "--bench-heatmap") == 0) { return RunHeatmapBenchmark(worldFile, i + 1 < argc ? argv[i + 1] : NULL); }
+        else if (strcmp(argv[i], "--bench-props") == 0) { return RunPropBenchmark(i + 1 < argc ? atoi(argv[i + 1]) : 0); }
+        else if (strcmp(argv[i], "--bench-broadphase") == 0) { return RunBroadphaseBenchmark(i + 1 < argc ? atoi(argv[i + 1]) : 0); }
+    }
+    MemoryTag previousTag = PushMemoryTag(MEMORY_TAG_RENDER);
     InitWindow(screenWidth, screenHeight, "Coward 3D!");
     ComputeRenderResolutionForWindowAspect(
         screenWidth,
@@ -288,64 +419,50 @@ int main(void) {
     );
     renderTarget = LoadRenderTexture(renderWidth, renderHeight);
     SetTextureFilter(renderTarget.texture, TEXTURE_FILTER_POINT);
+    PopMemoryTag(previousTag);
+    // Replaying a captured draw stream needs the window and nothing else: no jobs, world or simulation
+    if (replayFile) {
+        int replayResult = ReplayDrawStream(replayFile, replayIterations);
+        UnloadRenderTexture(renderTarget);
+        CloseWindow();
+        return replayResult;
+    }
+    JobSystemInit(JOB_WORKERS_AUTO);
+    FrameArenaInit(FRAME_ARENA_RENDER, FRAME_ARENA_BYTES);
+    FrameArenaInit(FRAME_ARENA_SIMULATION, SIM_FRAME_ARENA_BYTES);
+    AssetManagerInit();
+    AssetCacheSetBudget(ASSET_CPU_BUDGET_BYTES, ASSET_GPU_BUDGET_BYTES);
+    EntityStoreInit(&entities, MAX_ENTITIES);
+    // Simplify collision for the thinnest capsule that walks the world
+    WorldStreamingSettings streaming = WORLD_STREAMING;
+    streaming.collisionRadius = fminf(PLAYER_RADIUS, BEAR_RADIUS);
+    LoadWorldLayout(&world, worldFile, streaming);
     PlayerInitialize();
-    levelModel = LoadModel("assets/Bogmire Arena/bogmire-arena.obj");
-    levelTransform = MatrixScale(2.0f, 2.0f, 2.0f);
-    SetTargetFPS(0);
-    while (!WindowShouldClose()) {
-        float delta = GetFrameTime();
-        inputDirection = GetInputDirection();
-        camera.targetPosition = Vector3Add(player.collisionCapsule.position, (Vector3){0.0f, player.collisionCapsule.halfHeight, 0.0f});
-        camera.rawCamera.position = Vector3Add(camera.targetPosition, (Vector3){0.0f, 4.0f, 5.0f});
-        camera.rawCamera.target = Vector3Lerp(camera.rawCamera.target, player.collisionCapsule.position, 2.01f * delta); 
-        camera.forward = Vector3Subtract(camera.rawCamera.position, camera.rawCamera.target);
-        camera.forward.y = 0;
-        camera.forward = Vector3Normalize(camera.forward);
-        camera.right = Vector3CrossProduct(camera.rawCamera.up, camera.forward);
-        camera.right = Vector3Normalize(camera.right);
-        player.wishDirection = Vector3Normalize(Vector3Add(
-            Vector3Scale(camera.forward, inputDirection.y), 
-            Vector3Scale(camera.right, inputDirection.x)
-        ));
-        PlayerUpdate(&player, &camera, delta);
-        BeginTextureMode(renderTarget);
-            ClearBackground(LOVELY_COLOR);
-            BeginMode3D(camera.rawCamera);
-                DrawGrid(40, 4.0f);
-                DrawCube(player.collisionCapsule.position, 1, 1, 1, RED);
-                DrawCube(camera.rawCamera.target, 1, 1, 1, BLUE);
-                DrawPlayer(playerModel, player.collisionCapsule.position, player.wishDirection);
-                DrawModel(levelModel, (Vector3){0.0f, 0.0f, 0.0f}, 2.0f, WHITE);
-            EndMode3D();
-        EndTextureMode();
-        BeginDrawing();
-            Rectangle sourceRenderTextureRect = {
-                0.0f, 0.0f,
-                (float)renderTarget.texture.width,
-                -(float)renderTarget.texture.height
-            };
-            float renderToWindowScale = fminf(
-                (float)screenWidth  / (float)renderWidth,
-                (float)screenHeight / (float)renderHeight
-            );
-            Rectangle destinationWindowRect = {
-                (screenWidth  - (renderWidth  * renderToWindowScale)) * 0.5f,
-                (screenHeight - (renderHeight * renderToWindowScale)) * 0.5f,
-                renderWidth  * renderToWindowScale,
-                renderHeight * renderToWindowScale
-            };
-            DrawTexturePro(
-                renderTarget.texture,
-                sourceRenderTextureRect,
-                destinationWindowRect,
-                (Vector2){ 0.0f, 0.0f },
-                0.0f,
-                WHITE
-            );
-            DrawFPS(10, 10);
-        EndDrawing();
+    // A flythrough simulates inline at a fixed step from a fixed seed, so every run sees the same crowd
+    if (flythroughFile) {
+        SetRandomSeed(FLYTHROUGH_SEED);
+        pipelineThreaded = false;
     }
+    SpawnActors(actorCount);
+    SetTargetFPS(0);
+    PipelineInit(MAX_ENTITIES, MAX_WORLD_DRAW_INSTANCES, SimulateFrame, NULL, pipelineThreaded);
+    if (flythroughFile) PipelineSetFixedDelta(FLYTHROUGH_STEP);
+    if (statsCsvFile) OpenStatsCsv(statsCsvFile);
+    int exitCode = flythroughFile ? RunFlythrough(flythroughFile, actorCount > 0) : 0;
+    if (!flythroughFile) RunGame();
+    PipelineShutdown();
+    EntityStoreDestroy(&entities);
+    ShutdownCharacterControllers();
+    FreeCollisionHeatmap(&collisionHeatmap);
+    CloseStatsCsv();
+    ReleaseModelHandle(playerModel);
+    ReleaseModelHandle(bearModel);
+    UnloadWorld(&world);
     UnloadRenderTexture(renderTarget);
+    AssetManagerShutdown();
+    FrameArenaShutdown();
+    JobSystemShutdown();
     CloseWindow();
-    return 0;
+    LogMemoryStats();
+    return exitCode;
 }
@@ -0,0 +1,171 @@
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "memtrack.h"
+#include "../include/raylib.h"
+// With MEMORY_WRAP_MALLOC the linker redirects every malloc/free in our objects and in libraylib.a
+// here (-Wl,--wrap), which is the only way to see raylib's internal allocations in a prebuilt library.
+#ifdef MEMORY_WRAP_MALLOC
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* pointer, size_t size);
+void __real_free(void* pointer);
+#define SYSTEM_MALLOC __real_malloc
+#define SYSTEM_CALLOC __real_calloc
+#define SYSTEM_REALLOC __real_realloc
+#define SYSTEM_FREE __real_free
+#else
+#define SYSTEM_MALLOC malloc
+#define SYSTEM_CALLOC calloc
+#define SYSTEM_REALLOC realloc
+#define SYSTEM_FREE free
+#endif
+typedef struct {
+    void* pointer;
+    size_t size;
+    MemoryTag tag;
+} AllocationRecord;
+// Sizes live in a side table rather than a header so blocks can cross into code that frees them
+// untracked (libc, GL drivers) without corrupting the heap; unknown pointers are simply not counted.
+typedef struct {
+    AllocationRecord* records;
+    size_t capacity;
+    size_t count;
+    MemoryTagStats stats[MEMORY_TAG_COUNT];
+    pthread_mutex_t lock;
+} AllocationTable;
+static AllocationTable allocationTable = { .lock = PTHREAD_MUTEX_INITIALIZER };
+static __thread MemoryTag currentTag = MEMORY_TAG_OTHER;
+static const char* MEMORY_TAG_NAMES[MEMORY_TAG_COUNT] = {
+    "other", "assets", "collision", "render", "audio", "animation", "frame-temp"
+};
+static size_t HashPointer(const void* pointer, size_t capacity) {
+    uint64_t value = (uint64_t)(uintptr_t)pointer >> 4;
+    return (size_t)(value * 0x9E3779B97F4A7C15ull) & (capacity - 1);
+}
+static void InsertRecord(AllocationRecord record) {
+    size_t slot = HashPointer(record.pointer, allocationTable.capacity);
+    while (allocationTable.records[slot].pointer) slot = (slot + 1) & (allocationTable.capacity - 1);
+    allocationTable.records[slot] = record;
+    allocationTable.count++;
+}
+static bool GrowTable(void) {
+    size_t oldCapacity = allocationTable.capacity;
+    AllocationRecord* oldRecords = allocationTable.records;
+    size_t capacity = oldCapacity ? oldCapacity * 2 : 4096;
+    AllocationRecord* records = SYSTEM_CALLOC(capacity, sizeof(AllocationRecord));
+    if (!records) return false;
+    allocationTable.records = records;
+    allocationTable.capacity = capacity;
+    allocationTable.count = 0;
+    for (size_t i = 0; i < oldCapacity; i++) {
+        if (oldRecords[i].pointer) InsertRecord(oldRecords[i]);
+    }
+    SYSTEM_FREE(oldRecords);
+    return true;
+}
+static void TrackAllocation(void* pointer, size_t size, MemoryTag tag) {
+    if (!pointer) return;
+    pthread_mutex_lock(&allocationTable.lock);
+    if ((allocationTable.count + 1) * 2 > allocationTable.capacity && !GrowTable()) {
+        pthread_mutex_unlock(&allocationTable.lock);
+        return;
+    }
+    InsertRecord((AllocationRecord){ pointer, size, tag });
+    MemoryTagStats* stats = &allocationTable.stats[tag];
+    stats->currentBytes += size;
+    stats->liveAllocations++;
+    stats->totalAllocations++;
+    if (stats->currentBytes > stats->peakBytes) stats->peakBytes = stats->currentBytes;
+    pthread_mutex_unlock(&allocationTable.lock);
+}
+// Linear probing with backward-shift deletion, so lookups never need tombstones
+static bool UntrackAllocation(void* pointer, AllocationRecord* outRecord) {
+    if (!pointer) return false;
+    pthread_mutex_lock(&allocationTable.lock);
+    bool found = false;
+    if (allocationTable.capacity > 0) {
+        size_t mask = allocationTable.capacity - 1;
+        size_t slot = HashPointer(pointer, allocationTable.capacity);
+        while (allocationTable.records[slot].pointer && allocationTable.records[slot].pointer != pointer) slot = (slot + 1) & mask;
+        if (allocationTable.records[slot].pointer) {
+            found = true;
+            *outRecord = allocationTable.records[slot];
+            MemoryTagStats* stats = &allocationTable.stats[outRecord->tag];
+            stats->currentBytes -= outRecord->size;
+            stats->liveAllocations--;
+            size_t hole = slot;
+            size_t next = (slot + 1) & mask;
+            while (allocationTable.records[next].pointer) {
+                size_t home = HashPointer(allocationTable.records[next].pointer, allocationTable.capacity);
+                if (((next - home) & mask) >= ((next - hole) & mask)) {
+                    allocationTable.records[hole] = allocationTable.records[next];
+                    hole = next;
+                }
+                next = (next + 1) & mask;
+            }
+            allocationTable.records[hole] = (AllocationRecord){ 0 };
+            allocationTable.count--;
+        }
+    }
+    pthread_mutex_unlock(&allocationTable.lock);
+    return found;
+}
+MemoryTag PushMemoryTag(MemoryTag tag) {
+    MemoryTag previous = currentTag;
+    currentTag = tag;
+    return previous;
+}
+void PopMemoryTag(MemoryTag previous) {
+    currentTag = previous;
+}
+void* TrackedAlloc(size_t size) {
+    void* pointer = SYSTEM_MALLOC(size);
+    TrackAllocation(pointer, size, currentTag);
+    return pointer;
+}
+void* TrackedCalloc(size_t count, size_t size) {
+    void* pointer = SYSTEM_CALLOC(count, size);
+    TrackAllocation(pointer, count * size, currentTag);
+    return pointer;
+}
+void* TrackedRealloc(void* pointer, size_t size) {
+    AllocationRecord record = { 0 };
+    bool tracked = UntrackAllocation(pointer, &record);
+    void* resized = SYSTEM_REALLOC(pointer, size);
+    if (resized) {
+        TrackAllocation(resized, size, tracked ? record.tag : currentTag);
+    } else if (tracked && size > 0) {
+        TrackAllocation(pointer, record.size, record.tag);
+    }
+    return resized;
+}
+void TrackedFree(void* pointer) {
+    AllocationRecord record;
+    UntrackAllocation(pointer, &record);
+    SYSTEM_FREE(pointer);
+}
+#ifdef MEMORY_WRAP_MALLOC
+void* __wrap_malloc(size_t size) { return TrackedAlloc(size); }
+void* __wrap_calloc(size_t count, size_t size) { return TrackedCalloc(count, size); }
+void* __wrap_realloc(void* pointer, size_t size) { return TrackedRealloc(pointer, size); }
+void __wrap_free(void* pointer) { TrackedFree(pointer); }
+#endif
+const char* GetMemoryTagName(MemoryTag tag) {
+    return (tag >= 0 && tag < MEMORY_TAG_COUNT) ? MEMORY_TAG_NAMES[tag] : "invalid";
+}
+MemoryTagStats GetMemoryTagStats(MemoryTag tag) {
+    pthread_mutex_lock(&allocationTable.lock);
+    MemoryTagStats stats = allocationTable.stats[tag];
+    pthread_mutex_unlock(&allocationTable.lock);
+    return stats;
+}
+void LogMemoryStats(void) {
+    for (int tag = 0; tag < MEMORY_TAG_COUNT; tag++) {
+        MemoryTagStats stats = GetMemoryTagStats((MemoryTag)tag);
+        TraceLog(LOG_INFO, "MEMORY: %-10s current %10.2f KB | peak %10.2f KB | live %6d | total allocations %lld",
+            GetMemoryTagName((MemoryTag)tag), stats.currentBytes / 1024.0, stats.peakBytes / 1024.0,
+            stats.liveAllocations, stats.totalAllocations);
+    }
+}
@@ -0,0 +1,36 @@
+#ifndef MEMTRACK_H
+#define MEMTRACK_H
+#include <stddef.h>
+typedef enum {
+    MEMORY_TAG_OTHER,
+    MEMORY_TAG_ASSETS,
+    MEMORY_TAG_COLLISION,
+    MEMORY_TAG_RENDER,
+    MEMORY_TAG_AUDIO,
+    MEMORY_TAG_ANIMATION,
+    MEMORY_TAG_FRAME_TEMP,
+    MEMORY_TAG_COUNT
+} MemoryTag;
+typedef struct {
+    size_t currentBytes;
+    size_t peakBytes;
+    int liveAllocations;
+    long long totalAllocations;
+} MemoryTagStats;
+// Allocations are charged to the calling thread's current tag. Push a tag around a subsystem's work
+// and pop back to the returned one when done. Frees credit whichever tag made the allocation.
+MemoryTag PushMemoryTag(MemoryTag tag);
+void PopMemoryTag(MemoryTag previous);
+void* TrackedAlloc(size_t size);
+void* TrackedCalloc(size_t count, size_t size);
+void* TrackedRealloc(void* pointer, size_t size);
+void TrackedFree(void* pointer);
+const char* GetMemoryTagName(MemoryTag tag);
+MemoryTagStats GetMemoryTagStats(MemoryTag tag);
+void LogMemoryStats(void);
+// Must come before raylib.h so its allocation macros resolve to the tracker
+#define RL_MALLOC(size) TrackedAlloc(size)
+#define RL_CALLOC(count, size) TrackedCalloc(count, size)
+#define RL_REALLOC(pointer, size) TrackedRealloc(pointer, size)
+#define RL_FREE(pointer) TrackedFree(pointer)
+#endif
@@ -0,0 +1,66 @@
+#include "memtrack.h"
+#include "../include/raylib.h"
+#include "arena.h"
+#include "assets.h"
+#include "controller.h"
+#include "overlay.h"
+#include "pipeline.h"
+#include "stats.h"
+const int OVERLAY_FONT_SIZE = 10;
+const int OVERLAY_LINE_HEIGHT = 12;
+const Color OVERLAY_BACKGROUND = {0, 0, 0, 160};
+static void DrawOverlayLine(int x, int* y, Color color, const char* text) {
+    DrawText(text, x, *y, OVERLAY_FONT_SIZE, color);
+    *y += OVERLAY_LINE_HEIGHT;
+}
+void DrawStatsOverlay(int x, int y) {
+    static const char* assetTypeNames[ASSET_TYPE_COUNT] = { "meshes", "materials", "textures" };
+    int lineCount = 6 + STAT_COUNTER_COUNT + MEMORY_TAG_COUNT + 1 + ASSET_TYPE_COUNT;
+    DrawRectangle(x - 4, y - 4, 400, lineCount * OVERLAY_LINE_HEIGHT + 8, OVERLAY_BACKGROUND);
+    FrameTimeSummary frameTime = GetFrameTimeSummary();
+    DrawOverlayLine(x, &y, YELLOW, TextFormat("frame %.2f ms | avg %.2f | p50 %.2f | p95 %.2f | p99 %.2f",
+        GetFrameTime() * 1000.0f, frameTime.average, frameTime.p50, frameTime.p95, frameTime.p99));
+    PipelineStats pipelineStats = GetPipelineStats();
+    DrawOverlayLine(x, &y, WHITE, TextFormat("sim %.2f ms (%s) | frame %llu | repeated %llu", pipelineStats.simulationMs,
+        pipelineStats.threaded ? "threaded" : "inline", pipelineStats.simulatedFrames, pipelineStats.repeatedFrames));
+    CharacterQueryStats queryStats = GetCharacterQueryStats();
+    DrawOverlayLine(x, &y, WHITE, TextFormat("characters idle %d | cached %d | refreshed %d | overflowed %d",
+        queryStats.idleSkips, queryStats.cacheHits, queryStats.cacheRefreshes, queryStats.cacheOverflows));
+    DrawOverlayLine(x, &y, YELLOW, TextFormat("per frame (%d)         last       min       avg       p99", STATS_WINDOW_FRAMES));
+    for (int counter = 0; counter < STAT_COUNTER_COUNT; counter++) {
+        StatSummary stat = GetStatSummary((StatCounter)counter);
+        DrawOverlayLine(x, &y, WHITE, TextFormat("%-16s %9lld %9lld %9.1f %9lld",
+            GetStatName((StatCounter)counter), stat.last, stat.min, stat.average, stat.p99));
+    }
+    DrawOverlayLine(x, &y, YELLOW, "memory       current        peak    live");
+    for (int tag = 0; tag < MEMORY_TAG_COUNT; tag++) {
+        MemoryTagStats stats = GetMemoryTagStats((MemoryTag)tag);
+        DrawOverlayLine(x, &y, WHITE, TextFormat("%-10s %8.1f KB %8.1f KB %7d",
+            GetMemoryTagName((MemoryTag)tag), stats.currentBytes / 1024.0, stats.peakBytes / 1024.0, stats.liveAllocations));
+    }
+    for (int kind = 0; kind < FRAME_ARENA_COUNT; kind++) {
+        FrameArenaStats arena = GetFrameArenaStats((FrameArenaKind)kind);
+        DrawOverlayLine(x, &y, arena.overflowCount > 0 ? RED : WHITE, TextFormat("%-6s arena %.1f / %.1f KB | high-water %.1f KB | overflows %lld",
+            GetFrameArenaName((FrameArenaKind)kind), arena.usedBytes / 1024.0, arena.capacity / 1024.0, arena.highWaterBytes / 1024.0,
+            arena.totalOverflows + arena.overflowCount));
+    }
+    AssetTypeStats assetStats[ASSET_TYPE_COUNT];
+    GetAssetCacheStats(assetStats);
+    DrawOverlayLine(x, &y, YELLOW, "assets     live   cpu        gpu        evicted");
+    for (int type = 0; type < ASSET_TYPE_COUNT; type++) {
+        DrawOverlayLine(x, &y, WHITE, TextFormat("%-10s %4d %8.1f KB %8.1f KB %8.1f KB",
+            assetTypeNames[type], assetStats[type].liveCount, assetStats[type].liveCpuBytes / 1024.0,
+            assetStats[type].liveGpuBytes / 1024.0, assetStats[type].evictedBytes / 1024.0));
+    }
+}
+void DrawCollisionHotspotList(const CollisionHeatmap* heatmap, int x, int y) {
+    CollisionHotspot spots[COLLISION_HEATMAP_TOP_COUNT];
+    int spotCount = GetCollisionHotspots(heatmap, spots, COLLISION_HEATMAP_TOP_COUNT);
+    DrawRectangle(x - 4, y - 4, 400, (spotCount + 1) * OVERLAY_LINE_HEIGHT + 8, OVERLAY_BACKGROUND);
+    DrawOverlayLine(x, &y, YELLOW, "collision hotspots      x       z   queries   nodes/q    tris/q");
+    for (int i = 0; i < spotCount; i++) {
+        const CollisionHeatCell* cell = &spots[i].cell;
+        DrawOverlayLine(x, &y, WHITE, TextFormat("%2d                 %7.1f %7.1f %9lld %9.1f %9.1f", i + 1, spots[i].position.x, spots[i].position.z,
+            cell->queries, (double)cell->nodesVisited / cell->queries, (double)cell->trianglesTested / cell->queries));
+    }
+}
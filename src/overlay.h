@@ -0,0 +1,7 @@
+#ifndef OVERLAY_H
+#define OVERLAY_H
+#include "heatmap.h"
+void DrawStatsOverlay(int x, int y);
+// The heatmap's hotspots, costliest first, with their cost per query
+void DrawCollisionHotspotList(const CollisionHeatmap* heatmap, int x, int y);
+#endif
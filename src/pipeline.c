@@ -0,0 +1,175 @@
+#include "memtrack.h"
+#include <pthread.h>
+#include "../include/raylib.h"
+#include "arena.h"
+#include "pipeline.h"
+#include "platform.h"
+#define TRIPLE_BUFFER_FRESH 4
+#define TRIPLE_BUFFER_INDEX 3
+static const float MAX_SIMULATION_DELTA = 0.1f;
+// Three slots: the writer fills back, the reader holds front, and middle is swapped atomically
+// between them with a flag saying whether it holds something the reader has not seen yet
+typedef struct {
+    int middle;
+    int front;
+    int back;
+} TripleBuffer;
+typedef struct {
+    bool threaded;
+    SimulationTickFunction tick;
+    void* tickData;
+    FrameSnapshot snapshots[3];
+    TripleBuffer snapshotBuffer;
+    InputSample inputs[3];
+    TripleBuffer inputBuffer;
+    double lastTickTime;
+    float fixedDelta;
+    unsigned long long simulatedFrames;
+    pthread_t thread;
+    pthread_mutex_t wakeLock;
+    pthread_cond_t wake;
+    unsigned long long requestedFrames;
+    int sleeping;
+    bool stopping;
+    double lastFrameTime;
+    PipelineStats stats;
+} Pipeline;
+static Pipeline pipeline;
+static void InitTripleBuffer(TripleBuffer* buffer) {
+    *buffer = (TripleBuffer){ .middle = 1, .front = 0, .back = 2 };
+}
+static void PublishTripleBuffer(TripleBuffer* buffer) {
+    buffer->back = __atomic_exchange_n(&buffer->middle, buffer->back | TRIPLE_BUFFER_FRESH, __ATOMIC_ACQ_REL) & TRIPLE_BUFFER_INDEX;
+}
+static bool AcquireTripleBuffer(TripleBuffer* buffer) {
+    if (!(__atomic_load_n(&buffer->middle, __ATOMIC_ACQUIRE) & TRIPLE_BUFFER_FRESH)) return false;
+    buffer->front = __atomic_exchange_n(&buffer->middle, buffer->front, __ATOMIC_ACQ_REL) & TRIPLE_BUFFER_INDEX;
+    return true;
+}
+static void RunSimulationFrame(void) {
+    // Input is picked up at the last moment before the tick, not when the frame was requested
+    AcquireTripleBuffer(&pipeline.inputBuffer);
+    InputSample input = pipeline.inputs[pipeline.inputBuffer.front];
+    double start = PlatformTime();
+    float delta = pipeline.lastTickTime > 0.0 ? (float)(start - pipeline.lastTickTime) : 0.0f;
+    if (delta > MAX_SIMULATION_DELTA) delta = MAX_SIMULATION_DELTA;
+    if (pipeline.fixedDelta > 0.0f) delta = pipeline.fixedDelta;
+    pipeline.lastTickTime = start;
+    FrameSnapshot* snapshot = &pipeline.snapshots[pipeline.snapshotBuffer.back];
+    // Tick scratch comes from the simulation's own frame arenas, which the render thread never resets
+    FrameArenaKind previousArena = PushFrameArena(FRAME_ARENA_SIMULATION);
+    FrameArenaBeginFrame(FRAME_ARENA_SIMULATION);
+    pipeline.tick(pipeline.tickData, input, delta, snapshot);
+    PopFrameArena(previousArena);
+    snapshot->frameIndex = ++pipeline.simulatedFrames;
+    snapshot->simulationMs = (PlatformTime() - start) * 1000.0;
+    PublishTripleBuffer(&pipeline.snapshotBuffer);
+}
+static void* SimulationThreadMain(void* arg) {
+    (void)arg;
+    unsigned long long servedFrames = 0;
+    for (;;) {
+        unsigned long long requested = __atomic_load_n(&pipeline.requestedFrames, __ATOMIC_SEQ_CST);
+        if (requested == servedFrames) {
+            pthread_mutex_lock(&pipeline.wakeLock);
+            __atomic_store_n(&pipeline.sleeping, 1, __ATOMIC_SEQ_CST);
+            while (!pipeline.stopping && __atomic_load_n(&pipeline.requestedFrames, __ATOMIC_SEQ_CST) == servedFrames) {
+                pthread_cond_wait(&pipeline.wake, &pipeline.wakeLock);
+            }
+            __atomic_store_n(&pipeline.sleeping, 0, __ATOMIC_SEQ_CST);
+            bool stopping = pipeline.stopping;
+            pthread_mutex_unlock(&pipeline.wakeLock);
+            if (stopping) break;
+            continue;
+        }
+        // Requests that piled up while a slow tick ran collapse into one frame
+        servedFrames = requested;
+        RunSimulationFrame();
+    }
+    return NULL;
+}
+static void RequestSimulationFrame(void) {
+    __atomic_add_fetch(&pipeline.requestedFrames, 1, __ATOMIC_SEQ_CST);
+    if (!__atomic_load_n(&pipeline.sleeping, __ATOMIC_SEQ_CST)) return;
+    pthread_mutex_lock(&pipeline.wakeLock);
+    pthread_cond_signal(&pipeline.wake);
+    pthread_mutex_unlock(&pipeline.wakeLock);
+}
+void PipelineInit(int instanceCapacity, int worldInstanceCapacity, SimulationTickFunction tick, void* data, bool threaded) {
+    pipeline = (Pipeline){ .threaded = threaded, .tick = tick, .tickData = data };
+    MemoryTag previousTag = PushMemoryTag(MEMORY_TAG_RENDER);
+    for (int i = 0; i < 3; i++) {
+        FrameSnapshot* snapshot = &pipeline.snapshots[i];
+        snapshot->instances = RL_CALLOC(instanceCapacity, sizeof(RenderInstance));
+        snapshot->instanceCapacity = snapshot->instances ? instanceCapacity : 0;
+        snapshot->worldInstances = RL_CALLOC(worldInstanceCapacity > 0 ? worldInstanceCapacity : 1, sizeof(WorldDrawInstance));
+        snapshot->worldInstanceCapacity = snapshot->worldInstances ? worldInstanceCapacity : 0;
+    }
+    PopMemoryTag(previousTag);
+    InitTripleBuffer(&pipeline.snapshotBuffer);
+    InitTripleBuffer(&pipeline.inputBuffer);
+    pipeline.stats.threaded = threaded;
+    if (!threaded) return;
+    pthread_mutex_init(&pipeline.wakeLock, NULL);
+    pthread_cond_init(&pipeline.wake, NULL);
+    if (pthread_create(&pipeline.thread, NULL, SimulationThreadMain, NULL) != 0) {
+        TraceLog(LOG_WARNING, "PIPELINE: Failed to start simulation thread, simulating on the main thread");
+        pthread_cond_destroy(&pipeline.wake);
+        pthread_mutex_destroy(&pipeline.wakeLock);
+        pipeline.threaded = false;
+        pipeline.stats.threaded = false;
+        return;
+    }
+    RequestSimulationFrame();
+}
+void PipelineShutdown(void) {
+    if (pipeline.threaded) {
+        pthread_mutex_lock(&pipeline.wakeLock);
+        pipeline.stopping = true;
+        pthread_cond_signal(&pipeline.wake);
+        pthread_mutex_unlock(&pipeline.wakeLock);
+        pthread_join(pipeline.thread, NULL);
+        pthread_cond_destroy(&pipeline.wake);
+        pthread_mutex_destroy(&pipeline.wakeLock);
+    }
+    for (int i = 0; i < 3; i++) {
+        RL_FREE(pipeline.snapshots[i].instances);
+        RL_FREE(pipeline.snapshots[i].worldInstances);
+        FreeCollisionHeatmap(&pipeline.snapshots[i].heatmap);
+        RL_FREE(pipeline.snapshots[i].poses);
+        RL_FREE(pipeline.snapshots[i].poseData);
+    }
+    pipeline = (Pipeline){ 0 };
+}
+void PipelineSetFixedDelta(float delta) {
+    pipeline.fixedDelta = delta;
+}
+void PipelineSubmitInput(InputSample input) {
+    pipeline.inputs[pipeline.inputBuffer.back] = input;
+    PublishTripleBuffer(&pipeline.inputBuffer);
+}
+const FrameSnapshot* PipelineAcquireFrame(void) {
+    double now = PlatformTime();
+    if (pipeline.lastFrameTime > 0.0) pipeline.stats.frameMs = (now - pipeline.lastFrameTime) * 1000.0;
+    pipeline.lastFrameTime = now;
+    if (!pipeline.threaded) {
+        RunSimulationFrame();
+        AcquireTripleBuffer(&pipeline.snapshotBuffer);
+    } else {
+        bool fresh = AcquireTripleBuffer(&pipeline.snapshotBuffer);
+        // Only the very first frame has nothing older to show, so only it waits for the simulation
+        while (!fresh && pipeline.snapshots[pipeline.snapshotBuffer.front].frameIndex == 0) {
+            PlatformYield();
+            fresh = AcquireTripleBuffer(&pipeline.snapshotBuffer);
+        }
+        if (!fresh) pipeline.stats.repeatedFrames++;
+        RequestSimulationFrame();
+    }
+    const FrameSnapshot* frame = &pipeline.snapshots[pipeline.snapshotBuffer.front];
+    pipeline.stats.simulatedFrames = frame->frameIndex;
+    pipeline.stats.simulationMs = frame->simulationMs;
+    return frame;
+}
+PipelineStats GetPipelineStats(void) {
+    return pipeline.stats;
+}
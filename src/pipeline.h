@@ -0,0 +1,84 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+#include "../include/raylib.h"
+#include "assets.h"
+#include "heatmap.h"
+typedef struct {
+    Vector2 moveDirection;
+    bool jumpHeld;
+} InputSample;
+typedef struct {
+    Transform transform;
+    ModelHandle model;
+    Color tint;
+    float boundsRadius;
+    float capsuleRadius;
+    float capsuleHalfHeight;
+    const ModelAnimation* animation;
+    int animationFrame;
+    int pose;
+} RenderInstance;
+// A skinned pose the simulation sampled once for every instance showing that model, animation and
+// frame. Its skinned meshes' vertices, each followed by its normals when it has them, sit in mesh
+// order in the snapshot's poseData from firstFloat on.
+typedef struct {
+    ModelHandle model;
+    const ModelAnimation* animation;
+    int frame;
+    int firstFloat;
+} AnimationPose;
+// A level cell, prop or mover where the world had placed it when the snapshot was taken.
+// hiddenMeshes is the world's own mask, which it keeps until it unloads.
+typedef struct {
+    ModelHandle model;
+    const bool* hiddenMeshes;
+    Vector3 position;
+    float scale;
+    float yaw;
+} WorldDrawInstance;
+// Everything the renderer needs from one simulated frame. Once published it is never written again
+// until the renderer has moved on to a newer one. heatmap is a copy of the collision heatmap while
+// its overlay is on, with no cells otherwise. An instance's pose indexes poses, or is -1 when it
+// draws unanimated.
+typedef struct {
+    RenderInstance* instances;
+    int instanceCount;
+    int instanceCapacity;
+    WorldDrawInstance* worldInstances;
+    int worldInstanceCount;
+    int worldInstanceCapacity;
+    CollisionHeatmap heatmap;
+    AnimationPose* poses;
+    int poseCount;
+    int poseCapacity;
+    float* poseData;
+    int poseDataCapacity;
+    Camera3D camera;
+    Vector3 focusPosition;
+    Vector3 focusVelocity;
+    unsigned long long frameIndex;
+    double simulationMs;
+} FrameSnapshot;
+typedef struct {
+    bool threaded;
+    double simulationMs;
+    double frameMs;
+    unsigned long long simulatedFrames;
+    unsigned long long repeatedFrames;
+} PipelineStats;
+// Fills out with the state after advancing the simulation by delta seconds
+typedef void (*SimulationTickFunction)(void* data, InputSample input, float delta, FrameSnapshot* out);
+// Threaded, the simulation runs on its own thread one frame ahead of the renderer: while the main
+// thread draws snapshot N the simulation thread produces N+1. Snapshots and input samples move
+// between the threads through lock-free triple buffers. Unthreaded, the tick runs inline.
+void PipelineInit(int instanceCapacity, int worldInstanceCapacity, SimulationTickFunction tick, void* data, bool threaded);
+void PipelineShutdown(void);
+// Every tick advances by exactly delta seconds whatever the wall clock did; zero goes back to measured
+// time. Benchmarks set it right after PipelineInit so a run simulates the same frames every time.
+void PipelineSetFixedDelta(float delta);
+// Publish input right after the window polled events so the next tick sees the freshest sample
+void PipelineSubmitInput(InputSample input);
+// Returns the newest snapshot and lets the simulation start on the next frame
+const FrameSnapshot* PipelineAcquireFrame(void);
+PipelineStats GetPipelineStats(void);
+#endif
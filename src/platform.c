@@ -0,0 +1,28 @@
+#define _POSIX_C_SOURCE 200809L
+#include "platform.h"
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+// GetTime() only ticks once the window exists; loaders and headless tools need a clock before that
+double PlatformTime(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+}
+int PlatformCpuCount(void) {
+#ifdef _WIN32
+    int count = pthread_num_processors_np();
+#else
+    int count = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    return count > 0 ? count : 1;
+}
+void PlatformYield(void) {
+    sched_yield();
+}
+bool PlatformWorkingDirectory(char* outPath, int size) {
+    if (getcwd(outPath, (size_t)size)) return true;
+    if (size > 0) outPath[0] = '\0';
+    return false;
+}
@@ -0,0 +1,9 @@
+#ifndef PLATFORM_H
+#define PLATFORM_H
+#include <stdbool.h>
+double PlatformTime(void);
+int PlatformCpuCount(void);
+void PlatformYield(void);
+// False, with outPath left empty, when the directory does not fit
+bool PlatformWorkingDirectory(char* outPath, int size);
+#endif
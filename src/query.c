@@ -0,0 +1,187 @@
+#include "memtrack.h"
+#include <float.h>
+#include "../include/raylib.h"
+#include "../include/raymath.h"
+#include "query.h"
+typedef struct {
+    Vector3 base;
+    Vector3 top;
+    float radius;
+    Vector3 direction;
+    Vector3 inverseDirection;
+    float maxDistance;
+    Vector3 growMin;
+    Vector3 growMax;
+} CastQuery;
+typedef struct {
+    int node;
+    float entry;
+} CastStackEntry;
+// Slab test of the cast's base point against box grown by the shape; FLT_MAX when it misses
+static float IntersectCastBox(const CastQuery* query, BoundingBox box, float maxDistance) {
+    Vector3 lower = Vector3Subtract(box.min, query->growMin);
+    Vector3 upper = Vector3Add(box.max, query->growMax);
+    Vector3 t1 = Vector3Multiply(Vector3Subtract(lower, query->base), query->inverseDirection);
+    Vector3 t2 = Vector3Multiply(Vector3Subtract(upper, query->base), query->inverseDirection);
+    Vector3 near = Vector3Min(t1, t2);
+    Vector3 far = Vector3Max(t1, t2);
+    float entry = fmaxf(0.0f, fmaxf(near.x, fmaxf(near.y, near.z)));
+    float exit = fminf(maxDistance, fminf(far.x, fminf(far.y, far.z)));
+    return entry <= exit ? entry : FLT_MAX;
+}
+// Möller-Trumbore, two-sided
+static float IntersectRayTriangle(Vector3 origin, Vector3 direction, const Triangle* tri) {
+    Vector3 edge1 = Vector3Subtract(tri->v1, tri->v0);
+    Vector3 edge2 = Vector3Subtract(tri->v2, tri->v0);
+    Vector3 p = Vector3CrossProduct(direction, edge2);
+    float determinant = Vector3DotProduct(edge1, p);
+    if (fabsf(determinant) < EPSILON) return FLT_MAX;
+    float inverseDeterminant = 1.0f / determinant;
+    Vector3 offset = Vector3Subtract(origin, tri->v0);
+    float u = Vector3DotProduct(offset, p) * inverseDeterminant;
+    if (u < 0.0f || u > 1.0f) return FLT_MAX;
+    Vector3 q = Vector3CrossProduct(offset, edge1);
+    float v = Vector3DotProduct(direction, q) * inverseDeterminant;
+    if (v < 0.0f || u + v > 1.0f) return FLT_MAX;
+    float distance = Vector3DotProduct(edge2, q) * inverseDeterminant;
+    return distance >= 0.0f ? distance : FLT_MAX;
+}
+static void CastTriangle(const CastQuery* query, const CollisionMesh* mesh, int index, CollisionHit* best) {
+    const Triangle* tri = &mesh->triangles[index];
+    float limit = best->hit ? best->distance : query->maxDistance;
+    float distance;
+    Vector3 normal, point;
+    if (query->radius <= 0.0f) {
+        distance = IntersectRayTriangle(query->base, query->direction, tri);
+        if (distance >= limit) return;
+        normal = Vector3DotProduct(tri->normal, query->direction) > 0.0f ? Vector3Negate(tri->normal) : tri->normal;
+        point = Vector3Add(query->base, Vector3Scale(query->direction, distance));
+    } else {
+        Vector3 motion = Vector3Scale(query->direction, query->maxDistance);
+        float time = CapsuleTriangleTimeOfImpact(query->base, query->top, query->radius, motion, *tri, limit / query->maxDistance, &normal, &point);
+        distance = time * query->maxDistance;
+        if (distance >= limit) return;
+    }
+    *best = (CollisionHit){ true, distance, point, normal, index, tri->materialId, mesh, NULL };
+}
+static void CastAgainstMesh(const CastQuery* query, const CollisionMesh* mesh, CollisionHit* best) {
+    if (!mesh->nodes) {
+        if (IntersectCastBox(query, mesh->bounds, query->maxDistance) == FLT_MAX) return;
+        for (int i = 0; i < mesh->triangleCount; i++) CastTriangle(query, mesh, i, best);
+        return;
+    }
+    CastStackEntry stack[COLLISION_BVH_MAX_DEPTH + 1];
+    CastStackEntry* top = stack;
+    float rootEntry = IntersectCastBox(query, mesh->nodes[0].bounds, query->maxDistance);
+    if (rootEntry != FLT_MAX) *top++ = (CastStackEntry){ 0, rootEntry };
+    while (top != stack) {
+        CastStackEntry entry = *--top;
+        float limit = best->hit ? best->distance : query->maxDistance;
+        if (entry.entry > limit) continue;
+        const CollisionBvhNode* node = &mesh->nodes[entry.node];
+        if (node->count > 0) {
+            for (int i = node->start; i != node->start + node->count; i++) CastTriangle(query, mesh, i, best);
+            continue;
+        }
+        // Push the farther child first so the nearer one is popped, and can shrink limit, first
+        CastStackEntry left = { node->start, IntersectCastBox(query, mesh->nodes[node->start].bounds, limit) };
+        CastStackEntry right = { node->start + 1, IntersectCastBox(query, mesh->nodes[node->start + 1].bounds, limit) };
+        if (left.entry > right.entry) {
+            CastStackEntry swap = left;
+            left = right;
+            right = swap;
+        }
+        if (right.entry != FLT_MAX) *top++ = right;
+        if (left.entry != FLT_MAX) *top++ = left;
+    }
+}
+// The cast is carried into the instance's frame, walked through its shared BVH like a static mesh
+// and the hit carried back out. Distances scale with the instance.
+static void CastAgainstInstance(const CastQuery* query, const CollisionInstance* instance, CollisionHit* best) {
+    float limit = best->hit ? best->distance : query->maxDistance;
+    if (IntersectCastBox(query, instance->bounds, limit) == FLT_MAX) return;
+    float toLocal = 1.0f / instance->scale;
+    Matrix inverse = instance->inverse;
+    Vector3 base = Vector3Transform(query->base, inverse);
+    Vector3 top = Vector3Transform(query->top, inverse);
+    Vector3 direction = Vector3Subtract(Vector3Transform(query->direction, inverse), (Vector3){ inverse.m12, inverse.m13, inverse.m14 });
+    direction = Vector3Normalize(direction);
+    float radius = query->radius * toLocal;
+    CastQuery local = {
+        .base = base,
+        .top = top,
+        .radius = radius,
+        .direction = direction,
+        .inverseDirection = { 1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z },
+        .maxDistance = query->maxDistance * toLocal,
+        .growMin = Vector3AddValue(Vector3Subtract(Vector3Max(base, top), base), radius),
+        .growMax = Vector3AddValue(Vector3Subtract(base, Vector3Min(base, top)), radius)
+    };
+    CollisionHit localHit = { .hit = best->hit, .distance = limit * toLocal, .triangleId = -1, .materialId = -1 };
+    CastAgainstMesh(&local, instance->mesh, &localHit);
+    if (localHit.triangleId < 0) return;
+    Matrix transform = instance->transform;
+    localHit.distance *= instance->scale;
+    localHit.point = Vector3Transform(localHit.point, transform);
+    localHit.normal = Vector3Normalize(Vector3Subtract(Vector3Transform(localHit.normal, transform), (Vector3){ transform.m12, transform.m13, transform.m14 }));
+    localHit.instance = instance;
+    *best = localHit;
+}
+// Front to back through the top-level tree, like CastAgainstMesh one level up
+static void CastAgainstInstances(const CastQuery* query, const CollisionWorld* world, CollisionHit* best) {
+    if (world->instanceTreeDirty || world->instanceNodeCount == 0) {
+        for (int i = 0; i < world->instanceCount; i++) CastAgainstInstance(query, world->instances[i], best);
+        return;
+    }
+    CastStackEntry stack[COLLISION_BVH_MAX_DEPTH + 1];
+    CastStackEntry* top = stack;
+    float rootEntry = IntersectCastBox(query, world->instanceNodes[0].bounds, query->maxDistance);
+    if (rootEntry != FLT_MAX) *top++ = (CastStackEntry){ 0, rootEntry };
+    while (top != stack) {
+        CastStackEntry entry = *--top;
+        float limit = best->hit ? best->distance : query->maxDistance;
+        if (entry.entry > limit) continue;
+        const CollisionBvhNode* node = &world->instanceNodes[entry.node];
+        if (node->count > 0) {
+            for (int i = node->start; i != node->start + node->count; i++) CastAgainstInstance(query, world->instances[i], best);
+            continue;
+        }
+        CastStackEntry left = { node->start, IntersectCastBox(query, world->instanceNodes[node->start].bounds, limit) };
+        CastStackEntry right = { node->start + 1, IntersectCastBox(query, world->instanceNodes[node->start + 1].bounds, limit) };
+        if (left.entry > right.entry) {
+            CastStackEntry swap = left;
+            left = right;
+            right = swap;
+        }
+        if (right.entry != FLT_MAX) *top++ = right;
+        if (left.entry != FLT_MAX) *top++ = left;
+    }
+}
+static CollisionHit CastShape(const CollisionWorld* world, Vector3 base, float height, float radius, Vector3 direction, float maxDistance) {
+    CollisionHit best = { .triangleId = -1, .materialId = -1 };
+    float length = Vector3Length(direction);
+    if (length < EPSILON || maxDistance <= 0.0f) return best;
+    direction = Vector3Scale(direction, 1.0f / length);
+    CastQuery query = {
+        .base = base,
+        .top = Vector3Add(base, (Vector3){ 0.0f, height, 0.0f }),
+        .radius = radius,
+        .direction = direction,
+        .inverseDirection = { 1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z },
+        .maxDistance = maxDistance,
+        .growMin = { radius, radius + height, radius },
+        .growMax = { radius, radius, radius }
+    };
+    for (int i = 0; i < world->meshCount; i++) CastAgainstMesh(&query, world->meshes[i], &best);
+    CastAgainstInstances(&query, world, &best);
+    return best;
+}
+CollisionHit RaycastWorld(const CollisionWorld* world, Ray ray, float maxDistance) {
+    return CastShape(world, ray.position, 0.0f, 0.0f, ray.direction, maxDistance);
+}
+CollisionHit SphereCastWorld(const CollisionWorld* world, Vector3 origin, float radius, Vector3 direction, float maxDistance) {
+    return CastShape(world, origin, 0.0f, radius, direction, maxDistance);
+}
+CollisionHit CapsuleCastWorld(const CollisionWorld* world, Vector3 base, float height, float radius, Vector3 direction, float maxDistance) {
+    return CastShape(world, base, height, radius, direction, maxDistance);
+}
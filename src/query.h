@@ -0,0 +1,23 @@
+#ifndef QUERY_H
+#define QUERY_H
+#include "../include/raylib.h"
+#include "collision.h"
+// Closest hit of a cast. normal faces back along the cast; triangleId indexes mesh->triangles, which
+// are in the local space of instance when the hit is on a moving collider and instance is non-NULL.
+typedef struct {
+    bool hit;
+    float distance;
+    Vector3 point;
+    Vector3 normal;
+    int triangleId;
+    int materialId;
+    const CollisionMesh* mesh;
+    const CollisionInstance* instance;
+} CollisionHit;
+// Casts walk each static mesh's and moving instance's BVH front to back and stop descending once a node starts beyond the
+// closest hit so far. direction need not be normalized; distances are along its unit vector.
+CollisionHit RaycastWorld(const CollisionWorld* world, Ray ray, float maxDistance);
+CollisionHit SphereCastWorld(const CollisionWorld* world, Vector3 origin, float radius, Vector3 direction, float maxDistance);
+// The capsule's segment runs from base up to base + height, like the character capsules
+CollisionHit CapsuleCastWorld(const CollisionWorld* world, Vector3 base, float height, float radius, Vector3 direction, float maxDistance);
+#endif
@@ -0,0 +1,221 @@
+#include "memtrack.h"
+#include <stdlib.h>
+#include "../include/raylib.h"
+#include "../include/raymath.h"
+#include "arena.h"
+#include "raypacket.h"
+#define RAY_GROUPS (RAY_PACKET_MAX / RAY_LANES)
+#define RAY_STREAM_MORTON_BITS 10
+typedef float FloatLanes __attribute__((vector_size(RAY_LANES * sizeof(float))));
+typedef int IntLanes __attribute__((vector_size(RAY_LANES * sizeof(int))));
+typedef struct {
+    FloatLanes ox, oy, oz;
+    FloatLanes dx, dy, dz;
+    FloatLanes ix, iy, iz;
+    FloatLanes best;
+    IntLanes triangle;
+    IntLanes mesh;
+} RayGroup;
+typedef struct {
+    RayGroup groups[RAY_GROUPS];
+    int groupCount;
+    Vector3 leadOrigin;
+    Vector3 leadDirection;
+} RayPacket;
+typedef struct {
+    unsigned long long key;
+    int index;
+} RayStreamKey;
+static FloatLanes SelectLanes(IntLanes mask, FloatLanes a, FloatLanes b) {
+    return (FloatLanes)((mask & (IntLanes)a) | (~mask & (IntLanes)b));
+}
+static FloatLanes MinLanes(FloatLanes a, FloatLanes b) {
+    return SelectLanes(a < b, a, b);
+}
+static FloatLanes MaxLanes(FloatLanes a, FloatLanes b) {
+    return SelectLanes(a > b, a, b);
+}
+static bool AnyLane(IntLanes mask) {
+    for (int i = 0; i < RAY_LANES; i++) {
+        if (mask[i]) return true;
+    }
+    return false;
+}
+// A zero direction component would make the slab test divide by zero; a tiny one gives the same answer
+static float SafeInverse(float d) {
+    return 1.0f / (fabsf(d) < 1e-12f ? (d < 0.0f ? -1e-12f : 1e-12f) : d);
+}
+static IntLanes IntersectGroupBox(const RayGroup* group, BoundingBox box) {
+    FloatLanes x1 = (box.min.x - group->ox) * group->ix, x2 = (box.max.x - group->ox) * group->ix;
+    FloatLanes y1 = (box.min.y - group->oy) * group->iy, y2 = (box.max.y - group->oy) * group->iy;
+    FloatLanes z1 = (box.min.z - group->oz) * group->iz, z2 = (box.max.z - group->oz) * group->iz;
+    FloatLanes entry = MaxLanes(MaxLanes(MinLanes(x1, x2), MinLanes(y1, y2)), MaxLanes(MinLanes(z1, z2), (FloatLanes){ 0 }));
+    FloatLanes exit = MinLanes(MinLanes(MaxLanes(x1, x2), MaxLanes(y1, y2)), MinLanes(MaxLanes(z1, z2), group->best));
+    return entry <= exit;
+}
+// Möller-Trumbore with the triangle broadcast across the lanes, two-sided like RaycastWorld
+static void IntersectGroupTriangle(RayGroup* group, const Triangle* tri, int triangle, int mesh) {
+    Vector3 e1 = Vector3Subtract(tri->v1, tri->v0);
+    Vector3 e2 = Vector3Subtract(tri->v2, tri->v0);
+    FloatLanes px = group->dy * e2.z - group->dz * e2.y;
+    FloatLanes py = group->dz * e2.x - group->dx * e2.z;
+    FloatLanes pz = group->dx * e2.y - group->dy * e2.x;
+    FloatLanes determinant = e1.x * px + e1.y * py + e1.z * pz;
+    FloatLanes inverse = 1.0f / determinant;
+    FloatLanes sx = group->ox - tri->v0.x, sy = group->oy - tri->v0.y, sz = group->oz - tri->v0.z;
+    FloatLanes u = (sx * px + sy * py + sz * pz) * inverse;
+    FloatLanes qx = sy * e1.z - sz * e1.y;
+    FloatLanes qy = sz * e1.x - sx * e1.z;
+    FloatLanes qz = sx * e1.y - sy * e1.x;
+    FloatLanes v = (group->dx * qx + group->dy * qy + group->dz * qz) * inverse;
+    FloatLanes t = (e2.x * qx + e2.y * qy + e2.z * qz) * inverse;
+    FloatLanes absDeterminant = SelectLanes(determinant < 0.0f, -determinant, determinant);
+    IntLanes hit = (absDeterminant >= EPSILON) & (u >= 0.0f) & (u <= 1.0f) & (v >= 0.0f) & (u + v <= 1.0f) &
+        (t >= 0.0f) & (t < group->best);
+    if (!AnyLane(hit)) return;
+    group->best = SelectLanes(hit, t, group->best);
+    group->triangle = (hit & triangle) | (~hit & group->triangle);
+    group->mesh = (hit & mesh) | (~hit & group->mesh);
+}
+static bool IntersectPacketBox(const RayPacket* packet, BoundingBox box) {
+    for (int g = 0; g < packet->groupCount; g++) {
+        if (AnyLane(IntersectGroupBox(&packet->groups[g], box))) return true;
+    }
+    return false;
+}
+static float GetNodeDepth(const RayPacket* packet, const CollisionBvhNode* node) {
+    Vector3 center = Vector3Scale(Vector3Add(node->bounds.min, node->bounds.max), 0.5f);
+    return Vector3DotProduct(Vector3Subtract(center, packet->leadOrigin), packet->leadDirection);
+}
+static void TracePacketMesh(RayPacket* packet, const CollisionMesh* mesh, int meshIndex) {
+    if (!mesh->nodes) {
+        if (!IntersectPacketBox(packet, mesh->bounds)) return;
+        for (int i = 0; i < mesh->triangleCount; i++) {
+            for (int g = 0; g < packet->groupCount; g++) IntersectGroupTriangle(&packet->groups[g], &mesh->triangles[i], i, meshIndex);
+        }
+        return;
+    }
+    int stack[COLLISION_BVH_MAX_DEPTH + 1];
+    int* top = stack;
+    *top++ = 0;
+    while (top != stack) {
+        const CollisionBvhNode* node = &mesh->nodes[*--top];
+        if (!IntersectPacketBox(packet, node->bounds)) continue;
+        if (node->count > 0) {
+            for (int i = node->start; i != node->start + node->count; i++) {
+                for (int g = 0; g < packet->groupCount; g++) IntersectGroupTriangle(&packet->groups[g], &mesh->triangles[i], i, meshIndex);
+            }
+            continue;
+        }
+        // Coherent rays share a front-to-back order; the lead ray's is good enough for all of them
+        int near = node->start, far = node->start + 1;
+        if (GetNodeDepth(packet, &mesh->nodes[far]) < GetNodeDepth(packet, &mesh->nodes[near])) {
+            near = far;
+            far = node->start;
+        }
+        *top++ = far;
+        *top++ = near;
+    }
+}
+void RaycastPacket(const CollisionWorld* world, const Ray* rays, int count, float maxDistance, CollisionHit* hits) {
+    if (count <= 0) return;
+    if (count > RAY_PACKET_MAX) count = RAY_PACKET_MAX;
+    RayPacket packet = { .groupCount = (count + RAY_LANES - 1) / RAY_LANES };
+    packet.leadOrigin = rays[0].position;
+    packet.leadDirection = Vector3Normalize(rays[0].direction);
+    for (int i = 0; i < packet.groupCount * RAY_LANES; i++) {
+        RayGroup* group = &packet.groups[i / RAY_LANES];
+        int lane = i % RAY_LANES;
+        // Padding lanes repeat the first ray with a negative range so no test can ever accept them
+        const Ray* ray = &rays[i < count ? i : 0];
+        Vector3 direction = Vector3Normalize(ray->direction);
+        group->ox[lane] = ray->position.x;
+        group->oy[lane] = ray->position.y;
+        group->oz[lane] = ray->position.z;
+        group->dx[lane] = direction.x;
+        group->dy[lane] = direction.y;
+        group->dz[lane] = direction.z;
+        group->ix[lane] = SafeInverse(direction.x);
+        group->iy[lane] = SafeInverse(direction.y);
+        group->iz[lane] = SafeInverse(direction.z);
+        group->best[lane] = i < count ? maxDistance : -1.0f;
+        group->triangle[lane] = -1;
+        group->mesh[lane] = -1;
+    }
+    for (int m = 0; m < world->meshCount; m++) TracePacketMesh(&packet, world->meshes[m], m);
+    for (int i = 0; i < count; i++) {
+        const RayGroup* group = &packet.groups[i / RAY_LANES];
+        int lane = i % RAY_LANES;
+        hits[i] = (CollisionHit){ .triangleId = -1, .materialId = -1 };
+        if (group->triangle[lane] < 0) continue;
+        const CollisionMesh* mesh = world->meshes[group->mesh[lane]];
+        const Triangle* tri = &mesh->triangles[group->triangle[lane]];
+        Vector3 direction = { group->dx[lane], group->dy[lane], group->dz[lane] };
+        float distance = group->best[lane];
+        hits[i] = (CollisionHit){
+            .hit = true,
+            .distance = distance,
+            .point = Vector3Add(rays[i].position, Vector3Scale(direction, distance)),
+            .normal = Vector3DotProduct(tri->normal, direction) > 0.0f ? Vector3Negate(tri->normal) : tri->normal,
+            .triangleId = group->triangle[lane],
+            .materialId = tri->materialId,
+            .mesh = mesh
+        };
+    }
+    // Moving colliders are few and each sits in its own frame, so their rays go one at a time
+    // against whatever the packet already found
+    if (world->instanceCount == 0) return;
+    CollisionWorld instances = *world;
+    instances.meshCount = 0;
+    for (int i = 0; i < count; i++) {
+        CollisionHit hit = RaycastWorld(&instances, rays[i], hits[i].hit ? hits[i].distance : maxDistance);
+        if (hit.hit) hits[i] = hit;
+    }
+}
+static unsigned int SpreadMortonBits(unsigned int x) {
+    x &= 0x3ff;
+    x = (x | (x << 16)) & 0x030000ff;
+    x = (x | (x << 8)) & 0x0300f00f;
+    x = (x | (x << 4)) & 0x030c30c3;
+    x = (x | (x << 2)) & 0x09249249;
+    return x;
+}
+static unsigned int QuantizeAxis(float value, float min, float max) {
+    float range = max - min;
+    float t = range > 0.0f ? Clamp((value - min) / range, 0.0f, 1.0f) : 0.0f;
+    return (unsigned int)(t * (float)((1 << RAY_STREAM_MORTON_BITS) - 1));
+}
+static int CompareStreamKeys(const void* a, const void* b) {
+    unsigned long long keyA = ((const RayStreamKey*)a)->key;
+    unsigned long long keyB = ((const RayStreamKey*)b)->key;
+    return (keyA > keyB) - (keyA < keyB);
+}
+void RaycastStream(const CollisionWorld* world, const Ray* rays, int count, float maxDistance, CollisionHit* hits) {
+    if (count <= 0) return;
+    RayStreamKey* keys = FRAME_ALLOC_ARRAY(RayStreamKey, count);
+    if (!keys) return;
+    BoundingBox bounds = { rays[0].position, rays[0].position };
+    for (int i = 1; i < count; i++) {
+        bounds.min = Vector3Min(bounds.min, rays[i].position);
+        bounds.max = Vector3Max(bounds.max, rays[i].position);
+    }
+    // Direction octant first so a packet never mixes rays heading opposite ways, then a Morton
+    // code of the origin so its rays start near one another
+    for (int i = 0; i < count; i++) {
+        Vector3 o = rays[i].position, d = rays[i].direction;
+        unsigned int octant = (d.x < 0.0f) | ((d.y < 0.0f) << 1) | ((d.z < 0.0f) << 2);
+        unsigned int morton = SpreadMortonBits(QuantizeAxis(o.x, bounds.min.x, bounds.max.x)) |
+            (SpreadMortonBits(QuantizeAxis(o.y, bounds.min.y, bounds.max.y)) << 1) |
+            (SpreadMortonBits(QuantizeAxis(o.z, bounds.min.z, bounds.max.z)) << 2);
+        keys[i] = (RayStreamKey){ ((unsigned long long)octant << 32) | morton, i };
+    }
+    qsort(keys, count, sizeof(RayStreamKey), CompareStreamKeys);
+    for (int start = 0; start < count; start += RAY_PACKET_MAX) {
+        int packetCount = count - start < RAY_PACKET_MAX ? count - start : RAY_PACKET_MAX;
+        Ray packetRays[RAY_PACKET_MAX];
+        CollisionHit packetHits[RAY_PACKET_MAX];
+        for (int i = 0; i < packetCount; i++) packetRays[i] = rays[keys[start + i].index];
+        RaycastPacket(world, packetRays, packetCount, maxDistance, packetHits);
+        for (int i = 0; i < packetCount; i++) hits[keys[start + i].index] = packetHits[i];
+    }
+}
@@ -0,0 +1,22 @@
+#ifndef RAYPACKET_H
+#define RAYPACKET_H
+#include "../include/raylib.h"
+#include "collision.h"
+#include "query.h"
+#define RAY_PACKET_MAX 16
+// GCC vector extensions: SSE or NEON with four lanes, AVX with eight when the build enables it
+#if defined(__AVX__)
+#define RAY_LANES 8
+#else
+#define RAY_LANES 4
+#endif
+// Traces up to RAY_PACKET_MAX rays through each static mesh's BVH together: a node is opened once for
+// the whole packet and its slab and triangle tests run across SIMD lanes. Moving instances are then
+// traced ray by ray. Works best when the rays
+// start close together and point the same way (a tile of camera rays, one NPC's probes).
+void RaycastPacket(const CollisionWorld* world, const Ray* rays, int count, float maxDistance, CollisionHit* hits);
+// Any number of unrelated rays: sorted by direction octant and origin so neighbours in the sorted
+// order form coherent packets, traced, and scattered back into hits in the caller's order. The sort
+// keys come from the calling thread's frame arena.
+void RaycastStream(const CollisionWorld* world, const Ray* rays, int count, float maxDistance, CollisionHit* hits);
+#endif
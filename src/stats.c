@@ -0,0 +1,140 @@
+#include "memtrack.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include "../include/raylib.h"
+#include "platform.h"
+#include "stats.h"
+#define MATERIAL_MAP_SLOTS 12 // raylib's MAX_MATERIAL_MAPS, which lives in its private config.h
+typedef struct {
+    long long counts[STAT_COUNTER_COUNT];
+    long long samples[STAT_COUNTER_COUNT][STATS_WINDOW_FRAMES];
+    double frameMs[STATS_WINDOW_FRAMES];
+    int sampleCount;
+    int next;
+    double lastFrameTime;
+    unsigned long long frameIndex;
+    FILE* csv;
+    bool csvHeaderWritten;
+} StatsRegistry;
+static StatsRegistry stats = { 0 };
+static const char* STAT_NAMES[STAT_COUNTER_COUNT] = {
+    "collision nodes",
+    "collision tris",
+    "floor candidates",
+    "wall pushes",
+    "draw calls",
+    "meshes culled",
+    "texture binds",
+    "bytes uploaded"
+};
+void AddStat(StatCounter counter, long long amount) {
+    __atomic_fetch_add(&stats.counts[counter], amount, __ATOMIC_RELAXED);
+}
+const char* GetStatName(StatCounter counter) {
+    return STAT_NAMES[counter];
+}
+static void WriteStatsCsvRow(int slot) {
+    if (!stats.csvHeaderWritten) {
+        fprintf(stats.csv, "frame,frame_ms");
+        for (int i = 0; i < STAT_COUNTER_COUNT; i++) {
+            fputc(',', stats.csv);
+            for (const char* c = STAT_NAMES[i]; *c; c++) fputc(*c == ' ' ? '_' : *c, stats.csv);
+        }
+        fputc('\n', stats.csv);
+        stats.csvHeaderWritten = true;
+    }
+    fprintf(stats.csv, "%llu,%.3f", stats.frameIndex, stats.frameMs[slot]);
+    for (int i = 0; i < STAT_COUNTER_COUNT; i++) fprintf(stats.csv, ",%lld", stats.samples[i][slot]);
+    fputc('\n', stats.csv);
+}
+void EndStatsFrame(void) {
+    double now = PlatformTime();
+    int slot = stats.next;
+    stats.frameMs[slot] = stats.lastFrameTime > 0.0 ? (now - stats.lastFrameTime) * 1000.0 : 0.0;
+    stats.lastFrameTime = now;
+    for (int i = 0; i < STAT_COUNTER_COUNT; i++) stats.samples[i][slot] = __atomic_exchange_n(&stats.counts[i], 0, __ATOMIC_RELAXED);
+    stats.next = (slot + 1) % STATS_WINDOW_FRAMES;
+    if (stats.sampleCount < STATS_WINDOW_FRAMES) stats.sampleCount++;
+    if (stats.csv) WriteStatsCsvRow(slot);
+    stats.frameIndex++;
+}
+static int CompareLongLong(const void* a, const void* b) {
+    long long x = *(const long long*)a, y = *(const long long*)b;
+    return (x > y) - (x < y);
+}
+static int CompareDouble(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+// Nearest rank over a sorted window
+static int GetPercentileIndex(int count, double percentile) {
+    int index = (int)(percentile * count + 0.999999) - 1;
+    return index < 0 ? 0 : (index >= count ? count - 1 : index);
+}
+static int GetLastSlot(void) {
+    return (stats.next + STATS_WINDOW_FRAMES - 1) % STATS_WINDOW_FRAMES;
+}
+StatSummary GetStatSummary(StatCounter counter) {
+    StatSummary summary = { 0 };
+    int count = stats.sampleCount;
+    if (count == 0) return summary;
+    long long sorted[STATS_WINDOW_FRAMES];
+    long long total = 0;
+    for (int i = 0; i < count; i++) {
+        sorted[i] = stats.samples[counter][i];
+        total += sorted[i];
+    }
+    qsort(sorted, count, sizeof(long long), CompareLongLong);
+    summary.last = stats.samples[counter][GetLastSlot()];
+    summary.min = sorted[0];
+    summary.average = (double)total / count;
+    summary.p99 = sorted[GetPercentileIndex(count, 0.99)];
+    return summary;
+}
+FrameTimeSummary SummarizeFrameTimes(double* times, int count) {
+    FrameTimeSummary summary = { 0 };
+    if (count == 0) return summary;
+    double total = 0.0;
+    for (int i = 0; i < count; i++) total += times[i];
+    qsort(times, count, sizeof(double), CompareDouble);
+    summary.average = total / count;
+    summary.p50 = times[GetPercentileIndex(count, 0.50)];
+    summary.p95 = times[GetPercentileIndex(count, 0.95)];
+    summary.p99 = times[GetPercentileIndex(count, 0.99)];
+    summary.max = times[count - 1];
+    return summary;
+}
+void LogFrameTimeSummary(const char* name, FrameTimeSummary summary) {
+    TraceLog(LOG_INFO, "BENCH: %-8s %8.3f %8.3f %8.3f %8.3f %8.3f", name, summary.average, summary.p50, summary.p95, summary.p99, summary.max);
+}
+FrameTimeSummary GetFrameTimeSummary(void) {
+    double sorted[STATS_WINDOW_FRAMES];
+    for (int i = 0; i < stats.sampleCount; i++) sorted[i] = stats.frameMs[i];
+    FrameTimeSummary summary = SummarizeFrameTimes(sorted, stats.sampleCount);
+    if (stats.sampleCount > 0) summary.last = stats.frameMs[GetLastSlot()];
+    return summary;
+}
+void AddModelDrawStats(Model model) {
+    for (int i = 0; i < model.meshCount; i++) AddMeshDrawStats(&model.materials[model.meshMaterial[i]]);
+}
+void AddMeshDrawStats(const Material* material) {
+    int binds = 0;
+    for (int map = 0; map < MATERIAL_MAP_SLOTS; map++) binds += material->maps[map].texture.id > 0;
+    AddStat(STAT_DRAW_CALLS, 1);
+    AddStat(STAT_TEXTURE_BINDS, binds);
+}
+bool OpenStatsCsv(const char* fileName) {
+    CloseStatsCsv();
+    stats.csv = fopen(fileName, "w");
+    if (!stats.csv) {
+        TraceLog(LOG_WARNING, "STATS: [%s] Failed to open file for writing", fileName);
+        return false;
+    }
+    stats.csvHeaderWritten = false;
+    TraceLog(LOG_INFO, "STATS: [%s] Streaming per-frame counters", fileName);
+    return true;
+}
+void CloseStatsCsv(void) {
+    if (stats.csv) fclose(stats.csv);
+    stats.csv = NULL;
+}
@@ -0,0 +1,52 @@
+#ifndef STATS_H
+#define STATS_H
+#include "../include/raylib.h"
+#define STATS_WINDOW_FRAMES 240
+typedef enum {
+    STAT_COLLISION_NODES,
+    STAT_COLLISION_TRIANGLES,
+    STAT_FLOOR_CANDIDATES,
+    STAT_WALL_PUSHES,
+    STAT_DRAW_CALLS,
+    STAT_MESHES_CULLED,
+    STAT_TEXTURE_BINDS,
+    STAT_BYTES_UPLOADED,
+    STAT_COUNTER_COUNT
+} StatCounter;
+typedef struct {
+    long long last;
+    long long min;
+    double average;
+    long long p99;
+} StatSummary;
+typedef struct {
+    double last;
+    double average;
+    double p50;
+    double p95;
+    double p99;
+    double max;
+} FrameTimeSummary;
+// Counters may be added to from any thread. Each EndStatsFrame closes the frame on the main thread:
+// the totals since the last one become that frame's sample in a sliding window of
+// STATS_WINDOW_FRAMES, alongside the time between the two calls. Work the simulation thread does
+// lands in whichever frame the renderer is on when it happens.
+void AddStat(StatCounter counter, long long amount);
+void EndStatsFrame(void);
+const char* GetStatName(StatCounter counter);
+StatSummary GetStatSummary(StatCounter counter);
+// In milliseconds
+FrameTimeSummary GetFrameTimeSummary(void);
+// The same summary over any set of times; sorts them in place and leaves last at zero
+FrameTimeSummary SummarizeFrameTimes(double* times, int count);
+// One "BENCH:" row under a "time       avg ms   p50 ms   p95 ms   p99 ms   max ms" header
+void LogFrameTimeSummary(const char* name, FrameTimeSummary summary);
+// One DrawModel or DrawModelEx: a draw call per mesh and a bind per texture its material uses
+void AddModelDrawStats(Model model);
+// One DrawMesh with material
+void AddMeshDrawStats(const Material* material);
+// Streams every frame from the next EndStatsFrame on, one row of frame time and counters each,
+// until CloseStatsCsv
+bool OpenStatsCsv(const char* fileName);
+void CloseStatsCsv(void);
+#endif
@@ -0,0 +1,259 @@
+#include "memtrack.h"
+#include <math.h>
+#include "../include/raylib.h"
+#include "../include/raymath.h"
+#include "stresslevel.h"
+#define STRESS_PILLAR_SHARE 0.2f
+#define STRESS_PILLAR_TRIANGLES 10
+#define STRESS_CRATE_TRIANGLES 10
+#define STRESS_NOISE_OCTAVES 4
+#define STRESS_MATERIAL_FLOOR 0
+#define STRESS_MATERIAL_PILLAR 1
+#define STRESS_MATERIAL_WALL 2
+static const float STRESS_FLOOR_AMPLITUDE = 1.5f;
+static const float STRESS_FLOOR_WAVELENGTH = 12.0f;
+static const float STRESS_ROOM_SIZE = 8.0f;
+static const float STRESS_ROOM_HEIGHT = 3.0f;
+static const float STRESS_DOOR_WIDTH = 1.6f;
+static const float STRESS_DOOR_HEIGHT = 2.2f;
+static const float STRESS_NOISE_WAVELENGTH = 24.0f;
+static const float STRESS_NOISE_AMPLITUDE = 6.0f;
+static const float STRESS_CLUTTER_FLOOR_CELL = 4.0f;
+static const char* STRESS_LEVEL_KIND_NAMES[STRESS_LEVEL_KIND_COUNT] = { "pillars", "rooms", "heightfield", "clutter" };
+// xorshift32: tiny, seedable and independent of raylib's global random state
+unsigned int StressRandom(unsigned int* state) {
+    unsigned int x = *state ? *state : 0x9e3779b9u;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+float StressRandomFloat(unsigned int* state, float min, float max) {
+    return min + (max - min) * (float)(StressRandom(state) >> 8) / (float)(1u << 24);
+}
+static float StressFloorHeight(float x, float z) {
+    float k = 2.0f * PI / STRESS_FLOOR_WAVELENGTH;
+    return STRESS_FLOOR_AMPLITUDE * sinf(x * k) * cosf(z * k * 0.7f);
+}
+static void PushStressTriangle(CollisionMesh* mesh, Vector3 v0, Vector3 v1, Vector3 v2, int materialId) {
+    Triangle tri = { v0, v1, v2, Vector3Normalize(Vector3CrossProduct(Vector3Subtract(v1, v0), Vector3Subtract(v2, v0))), materialId };
+    if (Vector3LengthSqr(tri.normal) < 0.001f) return;
+    mesh->triangles[mesh->triangleCount++] = tri;
+    mesh->bounds.min = Vector3Min(mesh->bounds.min, Vector3Min(v0, Vector3Min(v1, v2)));
+    mesh->bounds.max = Vector3Max(mesh->bounds.max, Vector3Max(v0, Vector3Max(v1, v2)));
+}
+static void PushStressQuad(CollisionMesh* mesh, Vector3 a, Vector3 b, Vector3 c, Vector3 d, int materialId) {
+    PushStressTriangle(mesh, a, b, c, materialId);
+    PushStressTriangle(mesh, a, c, d, materialId);
+}
+// Four walls and a lid; the base is buried in the floor so it is left out
+static void PushStressPillar(CollisionMesh* mesh, Vector3 center, float halfWidth, float height) {
+    float base = center.y - STRESS_FLOOR_AMPLITUDE;
+    float top = center.y + height;
+    Vector3 b[4] = {
+        { center.x - halfWidth, base, center.z - halfWidth }, { center.x + halfWidth, base, center.z - halfWidth },
+        { center.x + halfWidth, base, center.z + halfWidth }, { center.x - halfWidth, base, center.z + halfWidth }
+    };
+    Vector3 t[4];
+    for (int i = 0; i < 4; i++) t[i] = (Vector3){ b[i].x, top, b[i].z };
+    for (int i = 0; i < 4; i++) {
+        int j = (i + 1) % 4;
+        PushStressQuad(mesh, b[i], t[i], t[j], b[j], STRESS_MATERIAL_PILLAR);
+    }
+    PushStressQuad(mesh, t[0], t[3], t[2], t[1], STRESS_MATERIAL_PILLAR);
+}
+static bool BeginStressLevel(CollisionMesh* mesh, size_t capacity) {
+    *mesh = (CollisionMesh){ .slopes = GetCollisionSlopeSettings(COLLISION_FLOOR_SLOPE_DEGREES, COLLISION_CEILING_SLOPE_DEGREES) };
+    MemoryTag previousTag = PushMemoryTag(MEMORY_TAG_COLLISION);
+    mesh->triangles = RL_MALLOC(capacity * sizeof(Triangle));
+    PopMemoryTag(previousTag);
+    mesh->bounds = (BoundingBox){ { 1e30f, 1e30f, 1e30f }, { -1e30f, -1e30f, -1e30f } };
+    return mesh->triangles != NULL;
+}
+CollisionMesh GenerateStressLevel(int targetTriangles, float size, unsigned int seed) {
+    CollisionMesh mesh;
+    int pillarCount = (int)((float)targetTriangles * STRESS_PILLAR_SHARE) / STRESS_PILLAR_TRIANGLES;
+    int gridCells = (int)sqrtf((float)(targetTriangles - pillarCount * STRESS_PILLAR_TRIANGLES) / 2.0f);
+    if (gridCells < 1) gridCells = 1;
+    if (!BeginStressLevel(&mesh, (size_t)gridCells * gridCells * 2 + (size_t)pillarCount * STRESS_PILLAR_TRIANGLES)) return mesh;
+    float cellSize = size / (float)gridCells;
+    float origin = -size * 0.5f;
+    for (int z = 0; z < gridCells; z++) {
+        for (int x = 0; x < gridCells; x++) {
+            float x0 = origin + (float)x * cellSize, x1 = x0 + cellSize;
+            float z0 = origin + (float)z * cellSize, z1 = z0 + cellSize;
+            Vector3 a = { x0, StressFloorHeight(x0, z0), z0 };
+            Vector3 b = { x0, StressFloorHeight(x0, z1), z1 };
+            Vector3 c = { x1, StressFloorHeight(x1, z1), z1 };
+            Vector3 d = { x1, StressFloorHeight(x1, z0), z0 };
+            PushStressQuad(&mesh, a, b, c, d, STRESS_MATERIAL_FLOOR);
+        }
+    }
+    unsigned int state = seed;
+    for (int i = 0; i < pillarCount; i++) {
+        Vector3 center = { StressRandomFloat(&state, origin, -origin), 0.0f, StressRandomFloat(&state, origin, -origin) };
+        center.y = StressFloorHeight(center.x, center.z);
+        PushStressPillar(&mesh, center, StressRandomFloat(&state, 0.5f, 2.0f), StressRandomFloat(&state, 2.0f, 8.0f));
+    }
+    BuildCollisionBvh(&mesh);
+    return mesh;
+}
+// A horizontal tile grid over one room, facing up for floors and down for ceilings
+static void PushStressTiles(CollisionMesh* mesh, float x0, float z0, float y, float roomSize, int tiles, bool ceiling) {
+    float tileSize = roomSize / (float)tiles;
+    for (int z = 0; z < tiles; z++) {
+        for (int x = 0; x < tiles; x++) {
+            Vector3 a = { x0 + (float)x * tileSize, y, z0 + (float)z * tileSize };
+            Vector3 b = { a.x, y, a.z + tileSize };
+            Vector3 c = { a.x + tileSize, y, a.z + tileSize };
+            Vector3 d = { a.x + tileSize, y, a.z };
+            if (ceiling) PushStressQuad(mesh, a, d, c, b, STRESS_MATERIAL_WALL);
+            else PushStressQuad(mesh, a, b, c, d, STRESS_MATERIAL_FLOOR);
+        }
+    }
+}
+// One upright panel from start to end, split into columns
+static void PushStressPanel(CollisionMesh* mesh, Vector3 start, Vector3 end, float bottom, float top, int columns) {
+    for (int i = 0; i < columns; i++) {
+        Vector3 from = Vector3Lerp(start, end, (float)i / (float)columns);
+        Vector3 to = Vector3Lerp(start, end, (float)(i + 1) / (float)columns);
+        PushStressQuad(mesh, (Vector3){ from.x, bottom, from.z }, (Vector3){ from.x, top, from.z }, (Vector3){ to.x, top, to.z },
+            (Vector3){ to.x, bottom, to.z }, STRESS_MATERIAL_WALL);
+    }
+}
+// A wall along one room edge: either solid or two panels either side of a centred doorway and a lintel
+static void PushStressWall(CollisionMesh* mesh, Vector3 start, Vector3 end, int columns, bool doorway) {
+    if (!doorway) {
+        PushStressPanel(mesh, start, end, 0.0f, STRESS_ROOM_HEIGHT, columns * 2);
+        return;
+    }
+    float doorStart = 0.5f - 0.5f * STRESS_DOOR_WIDTH / STRESS_ROOM_SIZE;
+    Vector3 doorFrom = Vector3Lerp(start, end, doorStart);
+    Vector3 doorTo = Vector3Lerp(start, end, 1.0f - doorStart);
+    PushStressPanel(mesh, start, doorFrom, 0.0f, STRESS_ROOM_HEIGHT, columns);
+    PushStressPanel(mesh, doorTo, end, 0.0f, STRESS_ROOM_HEIGHT, columns);
+    PushStressPanel(mesh, doorFrom, doorTo, STRESS_DOOR_HEIGHT, STRESS_ROOM_HEIGHT, 1);
+}
+// Every room owns its west and south walls, with a doorway into the neighbour; the east and north
+// edges of the grid are closed off. Floor and ceiling tiling takes up the triangle budget.
+static CollisionMesh GenerateStressRooms(int targetTriangles, float size) {
+    CollisionMesh mesh;
+    int rooms = (int)(size / STRESS_ROOM_SIZE);
+    if (rooms < 1) rooms = 1;
+    int tiles = (int)sqrtf((float)targetTriangles / (float)(rooms * rooms) / 4.0f);
+    if (tiles < 1) tiles = 1;
+    int columns = tiles / 2 > 0 ? tiles / 2 : 1;
+    size_t perRoom = (size_t)tiles * tiles * 4 + 2 * ((size_t)columns * 4 + 2);
+    size_t edges = (size_t)rooms * 2 * ((size_t)columns * 4);
+    if (!BeginStressLevel(&mesh, perRoom * rooms * rooms + edges)) return mesh;
+    float origin = -(float)rooms * STRESS_ROOM_SIZE * 0.5f;
+    for (int z = 0; z < rooms; z++) {
+        for (int x = 0; x < rooms; x++) {
+            float x0 = origin + (float)x * STRESS_ROOM_SIZE, z0 = origin + (float)z * STRESS_ROOM_SIZE;
+            float x1 = x0 + STRESS_ROOM_SIZE, z1 = z0 + STRESS_ROOM_SIZE;
+            PushStressTiles(&mesh, x0, z0, 0.0f, STRESS_ROOM_SIZE, tiles, false);
+            PushStressTiles(&mesh, x0, z0, STRESS_ROOM_HEIGHT, STRESS_ROOM_SIZE, tiles, true);
+            PushStressWall(&mesh, (Vector3){ x0, 0.0f, z0 }, (Vector3){ x0, 0.0f, z1 }, columns, x > 0);
+            PushStressWall(&mesh, (Vector3){ x0, 0.0f, z0 }, (Vector3){ x1, 0.0f, z0 }, columns, z > 0);
+            if (x == rooms - 1) PushStressWall(&mesh, (Vector3){ x1, 0.0f, z0 }, (Vector3){ x1, 0.0f, z1 }, columns, false);
+            if (z == rooms - 1) PushStressWall(&mesh, (Vector3){ x0, 0.0f, z1 }, (Vector3){ x1, 0.0f, z1 }, columns, false);
+        }
+    }
+    BuildCollisionBvh(&mesh);
+    return mesh;
+}
+static float StressLatticeValue(int x, int z, unsigned int seed) {
+    unsigned int state = seed ^ ((unsigned int)x * 73856093u) ^ ((unsigned int)z * 19349663u);
+    StressRandom(&state);
+    return StressRandomFloat(&state, -1.0f, 1.0f);
+}
+// Smoothly interpolated lattice noise, octaves halving in size and amplitude
+static float StressNoiseHeight(float x, float z, unsigned int seed) {
+    float height = 0.0f, amplitude = STRESS_NOISE_AMPLITUDE, frequency = 1.0f / STRESS_NOISE_WAVELENGTH;
+    for (int octave = 0; octave < STRESS_NOISE_OCTAVES; octave++) {
+        float fx = x * frequency, fz = z * frequency;
+        int ix = (int)floorf(fx), iz = (int)floorf(fz);
+        float tx = fx - (float)ix, tz = fz - (float)iz;
+        tx = tx * tx * (3.0f - 2.0f * tx);
+        tz = tz * tz * (3.0f - 2.0f * tz);
+        unsigned int octaveSeed = seed + (unsigned int)octave * 101u;
+        float near = Lerp(StressLatticeValue(ix, iz, octaveSeed), StressLatticeValue(ix + 1, iz, octaveSeed), tx);
+        float far = Lerp(StressLatticeValue(ix, iz + 1, octaveSeed), StressLatticeValue(ix + 1, iz + 1, octaveSeed), tx);
+        height += Lerp(near, far, tz) * amplitude;
+        amplitude *= 0.5f;
+        frequency *= 2.0f;
+    }
+    return height;
+}
+static CollisionMesh GenerateStressHeightfield(int targetTriangles, float size, unsigned int seed) {
+    CollisionMesh mesh;
+    int gridCells = (int)sqrtf((float)targetTriangles / 2.0f);
+    if (gridCells < 1) gridCells = 1;
+    if (!BeginStressLevel(&mesh, (size_t)gridCells * gridCells * 2)) return mesh;
+    float cellSize = size / (float)gridCells;
+    float origin = -size * 0.5f;
+    // One row of heights ahead so each vertex is sampled once
+    float* heights = RL_MALLOC(sizeof(float) * (gridCells + 1) * 2);
+    if (!heights) return mesh;
+    for (int z = 0; z <= gridCells; z++) {
+        float* row = heights + (z % 2) * (gridCells + 1);
+        float* previous = heights + ((z + 1) % 2) * (gridCells + 1);
+        for (int x = 0; x <= gridCells; x++) row[x] = StressNoiseHeight(origin + (float)x * cellSize, origin + (float)z * cellSize, seed);
+        if (z == 0) continue;
+        float z0 = origin + (float)(z - 1) * cellSize, z1 = z0 + cellSize;
+        for (int x = 0; x < gridCells; x++) {
+            float x0 = origin + (float)x * cellSize, x1 = x0 + cellSize;
+            PushStressQuad(&mesh, (Vector3){ x0, previous[x], z0 }, (Vector3){ x0, row[x], z1 }, (Vector3){ x1, row[x + 1], z1 },
+                (Vector3){ x1, previous[x + 1], z0 }, STRESS_MATERIAL_FLOOR);
+        }
+    }
+    RL_FREE(heights);
+    BuildCollisionBvh(&mesh);
+    return mesh;
+}
+// Four sides and a lid turned by yaw about center, which sits on the floor
+static void PushStressCrate(CollisionMesh* mesh, Vector3 center, float halfWidth, float halfDepth, float height, float yaw) {
+    Vector3 axisX = { cosf(yaw) * halfWidth, 0.0f, -sinf(yaw) * halfWidth };
+    Vector3 axisZ = { sinf(yaw) * halfDepth, 0.0f, cosf(yaw) * halfDepth };
+    Vector3 b[4] = {
+        Vector3Subtract(Vector3Subtract(center, axisX), axisZ), Vector3Subtract(Vector3Add(center, axisX), axisZ),
+        Vector3Add(Vector3Add(center, axisX), axisZ), Vector3Add(Vector3Subtract(center, axisX), axisZ)
+    };
+    Vector3 t[4];
+    for (int i = 0; i < 4; i++) t[i] = (Vector3){ b[i].x, b[i].y + height, b[i].z };
+    for (int i = 0; i < 4; i++) {
+        int j = (i + 1) % 4;
+        PushStressQuad(mesh, b[i], t[i], t[j], b[j], STRESS_MATERIAL_PILLAR);
+    }
+    PushStressQuad(mesh, t[0], t[3], t[2], t[1], STRESS_MATERIAL_PILLAR);
+}
+static CollisionMesh GenerateStressClutter(int targetTriangles, float size, unsigned int seed) {
+    CollisionMesh mesh;
+    int gridCells = (int)(size / STRESS_CLUTTER_FLOOR_CELL);
+    if (gridCells < 1) gridCells = 1;
+    int crateCount = (targetTriangles - gridCells * gridCells * 2) / STRESS_CRATE_TRIANGLES;
+    if (crateCount < 0) crateCount = 0;
+    if (!BeginStressLevel(&mesh, (size_t)gridCells * gridCells * 2 + (size_t)crateCount * STRESS_CRATE_TRIANGLES)) return mesh;
+    float origin = -size * 0.5f;
+    PushStressTiles(&mesh, origin, origin, 0.0f, size, gridCells, false);
+    unsigned int state = seed;
+    for (int i = 0; i < crateCount; i++) {
+        Vector3 center = { StressRandomFloat(&state, origin, -origin), 0.0f, StressRandomFloat(&state, origin, -origin) };
+        PushStressCrate(&mesh, center, StressRandomFloat(&state, 0.15f, 0.6f), StressRandomFloat(&state, 0.15f, 0.6f),
+            StressRandomFloat(&state, 0.3f, 1.2f), StressRandomFloat(&state, 0.0f, 2.0f * PI));
+    }
+    BuildCollisionBvh(&mesh);
+    return mesh;
+}
+CollisionMesh GenerateStressLevelOfKind(StressLevelKind kind, int targetTriangles, float size, unsigned int seed) {
+    switch (kind) {
+        case STRESS_LEVEL_ROOMS: return GenerateStressRooms(targetTriangles, size);
+        case STRESS_LEVEL_HEIGHTFIELD: return GenerateStressHeightfield(targetTriangles, size, seed);
+        case STRESS_LEVEL_CLUTTER: return GenerateStressClutter(targetTriangles, size, seed);
+        default: return GenerateStressLevel(targetTriangles, size, seed);
+    }
+}
+const char* GetStressLevelKindName(StressLevelKind kind) {
+    return kind >= 0 && kind < STRESS_LEVEL_KIND_COUNT ? STRESS_LEVEL_KIND_NAMES[kind] : "unknown";
+}
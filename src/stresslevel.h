@@ -0,0 +1,22 @@
+#ifndef STRESSLEVEL_H
+#define STRESSLEVEL_H
+#include "collision.h"
+typedef enum {
+    STRESS_LEVEL_PILLARS = 0,
+    STRESS_LEVEL_ROOMS,
+    STRESS_LEVEL_HEIGHTFIELD,
+    STRESS_LEVEL_CLUTTER,
+    STRESS_LEVEL_KIND_COUNT
+} StressLevelKind;
+// Procedural collision geometry for headless benchmarks: a rolling heightfield floor scattered with
+// box pillars, about targetTriangles in total over a size x size square centered on the origin.
+// The same seed always produces the same level.
+CollisionMesh GenerateStressLevel(int targetTriangles, float size, unsigned int seed);
+// The same contract for every kind. Rooms tiles a grid of dungeon rooms with tiled floors and
+// ceilings and a doorway in each wall; heightfield is layered value noise steep enough to have walls;
+// clutter is a flat floor dense with small crates at random turns.
+CollisionMesh GenerateStressLevelOfKind(StressLevelKind kind, int targetTriangles, float size, unsigned int seed);
+const char* GetStressLevelKindName(StressLevelKind kind);
+unsigned int StressRandom(unsigned int* state);
+float StressRandomFloat(unsigned int* state, float min, float max);
+#endif
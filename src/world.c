@@ -0,0 +1,454 @@
+#include <stdio.h>
+#include <string.h>
+#include "memtrack.h"
+#include "../include/raylib.h"
+#include "../include/raymath.h"
+#include "collisionbuild.h"
+#include "drawstream.h"
+#include "jobs.h"
+#include "platform.h"
+#include "stats.h"
+#include "world.h"
+static int FindOrAddPropMesh(World* world, const char* path, int pathLength) {
+    for (int i = 0; i < world->propMeshCount; i++) {
+        const char* known = world->propMeshes[i].modelPath;
+        if ((int)strlen(known) == pathLength && strncmp(known, path, pathLength) == 0) return i;
+    }
+    if (world->propMeshCount == MAX_WORLD_PROP_MESHES) return -1;
+    WorldPropMesh* mesh = &world->propMeshes[world->propMeshCount];
+    snprintf(mesh->modelPath, WORLD_CELL_PATH_LENGTH, "%.*s", pathLength, path);
+    mesh->state = CELL_UNLOADED;
+    return world->propMeshCount++;
+}
+static void ParseProp(World* world, const char* line) {
+    WorldProp* prop = &world->props[world->propCount];
+    int pathStart = 0;
+    int parsed = sscanf(line, "prop %f %f %f %f %f %n",
+        &prop->position.x, &prop->position.y, &prop->position.z, &prop->scale, &prop->yaw, &pathStart);
+    if (parsed < 5 || pathStart == 0) return;
+    const char* path = line + pathStart;
+    prop->mesh = FindOrAddPropMesh(world, path, (int)strcspn(path, "\r\n"));
+    if (prop->mesh >= 0) world->propCount++;
+}
+static void ParseMover(World* world, const char* line) {
+    WorldMover* mover = &world->movers[world->moverCount];
+    int pathStart = 0;
+    int parsed = sscanf(line, "mover %f %f %f %f %f %f %f %f %f %n",
+        &mover->position.x, &mover->position.y, &mover->position.z, &mover->scale, &mover->yaw,
+        &mover->travel.x, &mover->travel.y, &mover->travel.z, &mover->period, &pathStart);
+    if (parsed < 9 || pathStart == 0 || mover->period <= 0.0f) return;
+    const char* path = line + pathStart;
+    mover->mesh = FindOrAddPropMesh(world, path, (int)strcspn(path, "\r\n"));
+    mover->currentPosition = mover->position;
+    if (mover->mesh >= 0) world->moverCount++;
+}
+// The first cell whose footprint holds the position, or -1 for a placement outside every cell
+static int FindContainingCell(const World* world, Vector3 position) {
+    for (int i = 0; i < world->cellCount; i++) {
+        BoundingBox bounds = world->cells[i].bounds;
+        if (position.x >= bounds.min.x && position.x <= bounds.max.x && position.z >= bounds.min.z && position.z <= bounds.max.z) return i;
+    }
+    return -1;
+}
+bool LoadWorldLayout(World* world, const char* fileName, WorldStreamingSettings settings) {
+    *world = (World){
+        .settings = settings,
+        .slopes = GetCollisionSlopeSettings(COLLISION_FLOOR_SLOPE_DEGREES, COLLISION_CEILING_SLOPE_DEGREES)
+    };
+    pthread_mutex_init(&world->lock, NULL);
+    FILE* file = fopen(fileName, "r");
+    if (!file) {
+        TraceLog(LOG_WARNING, "WORLD: [%s] Failed to open world layout", fileName);
+        return false;
+    }
+    char line[512];
+    while (fgets(line, sizeof(line), file)) {
+        if (strncmp(line, "prop ", 5) == 0) {
+            if (world->propCount < MAX_WORLD_PROPS) ParseProp(world, line);
+            continue;
+        }
+        if (strncmp(line, "mover ", 6) == 0) {
+            if (world->moverCount < MAX_WORLD_MOVERS) ParseMover(world, line);
+            continue;
+        }
+        float floorDegrees, ceilingDegrees;
+        if (sscanf(line, "slopes %f %f", &floorDegrees, &ceilingDegrees) == 2) {
+            world->slopes = GetCollisionSlopeSettings(floorDegrees, ceilingDegrees);
+            continue;
+        }
+        if (world->cellCount == MAX_WORLD_CELLS) continue;
+        WorldCell* cell = &world->cells[world->cellCount];
+        Vector3 localMin, localMax;
+        int pathStart = 0;
+        int parsed = sscanf(line, "cell %f %f %f %f %f %f %f %f %f %f %n",
+            &cell->position.x, &cell->position.y, &cell->position.z, &cell->scale,
+            &localMin.x, &localMin.y, &localMin.z, &localMax.x, &localMax.y, &localMax.z, &pathStart);
+        if (parsed < 10 || pathStart == 0) continue;
+        char* path = line + pathStart;
+        path[strcspn(path, "\r\n")] = '\0';
+        snprintf(cell->modelPath, WORLD_CELL_PATH_LENGTH, "%s", path);
+        cell->bounds.min = Vector3Add(cell->position, Vector3Scale(localMin, cell->scale));
+        cell->bounds.max = Vector3Add(cell->position, Vector3Scale(localMax, cell->scale));
+        cell->state = CELL_UNLOADED;
+        world->cellCount++;
+    }
+    fclose(file);
+    for (int i = 0; i < world->propCount; i++) world->props[i].cell = FindContainingCell(world, world->props[i].position);
+    for (int i = 0; i < world->moverCount; i++) world->movers[i].cell = FindContainingCell(world, world->movers[i].position);
+    TraceLog(LOG_INFO, "WORLD: [%s] Loaded layout with %d cell(s), %d prop(s) and %d mover(s) over %d prop model(s)",
+        fileName, world->cellCount, world->propCount, world->moverCount, world->propMeshCount);
+    return world->cellCount > 0;
+}
+static float DistanceToBounds(BoundingBox bounds, Vector3 point) {
+    Vector3 clamped = Vector3Clamp(point, bounds.min, bounds.max);
+    return Vector3Distance(point, clamped);
+}
+static void StreamCellIn(World* world, int index) {
+    WorldCell* cell = &world->cells[index];
+    cell->model = LoadModelAsync(cell->modelPath);
+    LockWorld(world);
+    cell->state = CELL_LOADING;
+    UnlockWorld(world);
+    TraceLog(LOG_INFO, "WORLD: Cell %d [%s] streaming in", index, cell->modelPath);
+}
+static Matrix GetPlacementTransform(Vector3 position, float scale, float yaw) {
+    Matrix transform = MatrixMultiply(MatrixScale(scale, scale, scale), MatrixRotateY(yaw * DEG2RAD));
+    return MatrixMultiply(transform, MatrixTranslate(position.x, position.y, position.z));
+}
+static bool PlaceInstance(World* world, CollisionInstance* instance, const CollisionMesh* mesh, Matrix transform) {
+    *instance = (CollisionInstance){ .mesh = mesh };
+    SetCollisionInstanceTransform(instance, transform);
+    return AddCollisionInstance(&world->collision, instance);
+}
+static bool ShouldPlace(const World* world, int cell, int mesh) {
+    return world->propMeshes[mesh].state == CELL_RESIDENT && (cell < 0 || world->cells[cell].state == CELL_RESIDENT);
+}
+// A prop or mover is placed while both its cell and its model are resident. Run after either
+// changes state, with the world lock held; returns how many instances were added.
+static int UpdatePropPlacement(World* world) {
+    int placedCount = 0;
+    bool changed = false;
+    for (int i = 0; i < world->propCount; i++) {
+        WorldProp* prop = &world->props[i];
+        bool place = ShouldPlace(world, prop->cell, prop->mesh);
+        if (place == prop->placed) continue;
+        if (place) {
+            prop->placed = PlaceInstance(world, &prop->instance, &world->propMeshes[prop->mesh].collision,
+                GetPlacementTransform(prop->position, prop->scale, prop->yaw));
+            placedCount += prop->placed;
+        } else {
+            RemoveCollisionInstance(&world->collision, &prop->instance);
+            prop->placed = false;
+        }
+        changed = true;
+    }
+    for (int i = 0; i < world->moverCount; i++) {
+        WorldMover* mover = &world->movers[i];
+        bool place = ShouldPlace(world, mover->cell, mover->mesh);
+        if (place == mover->placed) continue;
+        if (place) {
+            mover->placed = PlaceInstance(world, &mover->instance, &world->propMeshes[mover->mesh].collision,
+                GetPlacementTransform(mover->currentPosition, mover->scale, mover->yaw));
+            placedCount += mover->placed;
+        } else {
+            RemoveCollisionInstance(&world->collision, &mover->instance);
+            mover->placed = false;
+        }
+        changed = true;
+    }
+    if (changed) UpdateCollisionInstanceTree(&world->collision);
+    return placedCount;
+}
+static void StreamCellOut(World* world, int index) {
+    WorldCell* cell = &world->cells[index];
+    LockWorld(world);
+    if (cell->state == CELL_RESIDENT) RemoveCollisionMesh(&world->collision, &cell->collision);
+    cell->state = CELL_UNLOADED;
+    cell->generation++;
+    UpdatePropPlacement(world);
+    UnlockWorld(world);
+    UnloadCollisionMesh(&cell->collision);
+    ReleaseModelHandle(cell->model);
+    cell->model = (ModelHandle){ 0 };
+    TraceLog(LOG_INFO, "WORLD: Cell %d [%s] streamed out", index, cell->modelPath);
+}
+// A collision build for one cell or prop model, run on a worker and attached on the main thread.
+// The job holds its own reference to the model so the mesh data it reads stays loaded even if the
+// cell streams out meanwhile, and reads it through the model's canonical path because raylib's OBJ
+// loader changes the working directory on the main thread. A target whose generation moved on by
+// the time the build finishes drops the result.
+typedef struct {
+    World* world;
+    int index;
+    unsigned int generation;
+    ModelHandle model;
+    const char* fileName;
+    Model source;
+    Matrix transform;
+    CollisionSimplifySettings simplify;
+    const bool* knownHiddenMeshes;
+    bool* foundHiddenMeshes;
+    CollisionMesh collision;
+    JobCounter built;
+} CollisionBuildJob;
+static void BuildCollisionJob(void* data) {
+    CollisionBuildJob* job = data;
+    const bool* hiddenMeshes = job->knownHiddenMeshes;
+    if (!hiddenMeshes) hiddenMeshes = job->foundHiddenMeshes = LoadAuthoredCollisionMask(job->fileName, job->source.meshCount);
+    job->collision = BuildLevelCollisionMesh(job->source, job->fileName, hiddenMeshes, job->transform, job->world->slopes, job->simplify);
+}
+static void SubmitCollisionBuild(World* world, int index, unsigned int generation, const char* modelPath, ModelHandle model,
+    const bool* hiddenMeshes, Matrix transform, JobFunction attach) {
+    CollisionBuildJob* job = RL_CALLOC(1, sizeof(CollisionBuildJob));
+    job->world = world;
+    job->index = index;
+    job->generation = generation;
+    job->model = LoadModelAsync(modelPath);
+    job->fileName = GetModelHandlePath(job->model);
+    job->source = GetModelFromHandle(model);
+    job->transform = transform;
+    job->simplify = GetCollisionSimplifySettings(world->settings.collisionRadius);
+    job->knownHiddenMeshes = hiddenMeshes;
+    JobSubmit(BuildCollisionJob, job, &job->built);
+    JobSubmitMainAfter(&job->built, attach, job, &world->collisionBuilds);
+}
+// Hands the mask the job found to a target that has none yet; FinishCollisionBuild frees it otherwise
+static void AdoptHiddenMeshes(CollisionBuildJob* job, bool** hiddenMeshes) {
+    if (!*hiddenMeshes) {
+        *hiddenMeshes = job->foundHiddenMeshes;
+        job->foundHiddenMeshes = NULL;
+    }
+}
+static void FinishCollisionBuild(CollisionBuildJob* job) {
+    UnloadCollisionMesh(&job->collision);
+    RL_FREE(job->foundHiddenMeshes);
+    ReleaseModelHandle(job->model);
+    RL_FREE(job);
+}
+static void AttachCellCollisionJob(void* data) {
+    CollisionBuildJob* job = data;
+    World* world = job->world;
+    WorldCell* cell = &world->cells[job->index];
+    if (cell->state != CELL_BUILDING || cell->generation != job->generation) {
+        FinishCollisionBuild(job);
+        return;
+    }
+    cell->collision = job->collision;
+    job->collision = (CollisionMesh){ 0 };
+    LockWorld(world);
+    AdoptHiddenMeshes(job, &cell->hiddenMeshes);
+    bool added = AddCollisionMesh(&world->collision, &cell->collision);
+    cell->state = CELL_RESIDENT;
+    int propCount = UpdatePropPlacement(world);
+    UnlockWorld(world);
+    if (!added) TraceLog(LOG_WARNING, "WORLD: Cell %d [%s] exceeds the collision mesh limit", job->index, cell->modelPath);
+    TraceLog(LOG_INFO, "WORLD: Cell %d [%s] resident with %d collision triangles and %d prop instance(s)", job->index, cell->modelPath,
+        cell->collision.triangleCount, propCount);
+    FinishCollisionBuild(job);
+}
+// Each prop model's collision is built once, in model space, then every prop and mover using it
+// whose cell is resident is placed as an instance of that one mesh
+static void AttachPropCollisionJob(void* data) {
+    CollisionBuildJob* job = data;
+    World* world = job->world;
+    WorldPropMesh* mesh = &world->propMeshes[job->index];
+    if (mesh->state != CELL_BUILDING || mesh->generation != job->generation) {
+        FinishCollisionBuild(job);
+        return;
+    }
+    mesh->collision = job->collision;
+    job->collision = (CollisionMesh){ 0 };
+    LockWorld(world);
+    AdoptHiddenMeshes(job, &mesh->hiddenMeshes);
+    mesh->state = CELL_RESIDENT;
+    int instanceCount = UpdatePropPlacement(world);
+    UnlockWorld(world);
+    TraceLog(LOG_INFO, "WORLD: Prop model %d [%s] resident with %d collision triangles shared by %d instance(s)",
+        job->index, mesh->modelPath, mesh->collision.triangleCount, instanceCount);
+    FinishCollisionBuild(job);
+}
+static void StreamPropMeshOut(World* world, int index) {
+    WorldPropMesh* mesh = &world->propMeshes[index];
+    LockWorld(world);
+    mesh->state = CELL_UNLOADED;
+    mesh->generation++;
+    UpdatePropPlacement(world);
+    UnlockWorld(world);
+    UnloadCollisionMesh(&mesh->collision);
+    ReleaseModelHandle(mesh->model);
+    mesh->model = (ModelHandle){ 0 };
+    TraceLog(LOG_INFO, "WORLD: Prop model %d [%s] streamed out", index, mesh->modelPath);
+}
+// A prop model is wanted while any cell holding one of its props or movers is streamed in, and
+// always for placements outside every cell
+static void UpdatePropLoading(World* world) {
+    bool wanted[MAX_WORLD_PROP_MESHES] = { 0 };
+    for (int i = 0; i < world->propCount; i++) {
+        const WorldProp* prop = &world->props[i];
+        if (prop->cell < 0 || world->cells[prop->cell].state != CELL_UNLOADED) wanted[prop->mesh] = true;
+    }
+    for (int i = 0; i < world->moverCount; i++) {
+        const WorldMover* mover = &world->movers[i];
+        if (mover->cell < 0 || world->cells[mover->cell].state != CELL_UNLOADED) wanted[mover->mesh] = true;
+    }
+    for (int i = 0; i < world->propMeshCount; i++) {
+        WorldPropMesh* mesh = &world->propMeshes[i];
+        if (!wanted[i]) {
+            if (mesh->state != CELL_UNLOADED) StreamPropMeshOut(world, i);
+            continue;
+        }
+        if (mesh->state == CELL_UNLOADED) {
+            mesh->model = LoadModelAsync(mesh->modelPath);
+            mesh->state = CELL_LOADING;
+        }
+        if (mesh->state != CELL_LOADING || !IsModelHandleReady(mesh->model)) continue;
+        mesh->state = CELL_BUILDING;
+        SubmitCollisionBuild(world, i, mesh->generation, mesh->modelPath, mesh->model, mesh->hiddenMeshes, MatrixIdentity(), AttachPropCollisionJob);
+    }
+}
+void UpdateWorldStreaming(World* world, Vector3 position, Vector3 velocity) {
+    Vector3 predicted = Vector3Add(position, Vector3Scale(velocity, world->settings.lookaheadSeconds));
+    float distances[MAX_WORLD_CELLS];
+    int residentCount = 0;
+    for (int i = 0; i < world->cellCount; i++) {
+        WorldCell* cell = &world->cells[i];
+        distances[i] = fminf(DistanceToBounds(cell->bounds, position), DistanceToBounds(cell->bounds, predicted));
+        if (cell->state != CELL_UNLOADED && distances[i] > world->settings.unloadDistance) StreamCellOut(world, i);
+        if (cell->state != CELL_UNLOADED) residentCount++;
+    }
+    // Nearest wanted cell first; at the resident cap the farthest resident cell makes room for a nearer one
+    for (;;) {
+        int nearest = -1;
+        for (int i = 0; i < world->cellCount; i++) {
+            if (world->cells[i].state != CELL_UNLOADED || distances[i] > world->settings.loadDistance) continue;
+            if (nearest < 0 || distances[i] < distances[nearest]) nearest = i;
+        }
+        if (nearest < 0) break;
+        if (residentCount >= world->settings.maxResidentCells) {
+            int farthest = -1;
+            for (int i = 0; i < world->cellCount; i++) {
+                if (world->cells[i].state == CELL_UNLOADED || distances[i] <= distances[nearest]) continue;
+                if (farthest < 0 || distances[i] > distances[farthest]) farthest = i;
+            }
+            if (farthest < 0) break;
+            StreamCellOut(world, farthest);
+            residentCount--;
+        }
+        StreamCellIn(world, nearest);
+        residentCount++;
+    }
+    for (int i = 0; i < world->cellCount; i++) {
+        WorldCell* cell = &world->cells[i];
+        if (cell->state != CELL_LOADING || !IsModelHandleReady(cell->model)) continue;
+        Matrix transform = MatrixMultiply(MatrixScale(cell->scale, cell->scale, cell->scale), MatrixTranslate(cell->position.x, cell->position.y, cell->position.z));
+        LockWorld(world);
+        cell->state = CELL_BUILDING;
+        UnlockWorld(world);
+        SubmitCollisionBuild(world, i, cell->generation, cell->modelPath, cell->model, cell->hiddenMeshes, transform, AttachCellCollisionJob);
+    }
+    UpdatePropLoading(world);
+}
+// Eased back and forth so doors and lifts slow down at either end instead of bouncing off them
+void UpdateWorldMovers(World* world, float delta) {
+    for (int i = 0; i < world->moverCount; i++) {
+        WorldMover* mover = &world->movers[i];
+        if (!mover->placed) continue;
+        mover->time = fmodf(mover->time + delta, mover->period);
+        float phase = mover->time / mover->period;
+        float t = phase < 0.5f ? phase * 2.0f : 2.0f - phase * 2.0f;
+        t = t * t * (3.0f - 2.0f * t);
+        mover->currentPosition = Vector3Add(mover->position, Vector3Scale(mover->travel, t));
+        SetCollisionInstanceTransform(&mover->instance, GetPlacementTransform(mover->currentPosition, mover->scale, mover->yaw));
+    }
+    UpdateCollisionInstanceTree(&world->collision);
+}
+void LockWorld(World* world) {
+    pthread_mutex_lock(&world->lock);
+}
+void UnlockWorld(World* world) {
+    pthread_mutex_unlock(&world->lock);
+}
+// False while any cell under the position is still loading, so nothing falls through missing floors
+bool IsWorldResidentAt(const World* world, Vector3 position) {
+    for (int i = 0; i < world->cellCount; i++) {
+        const WorldCell* cell = &world->cells[i];
+        bool inside = position.x >= cell->bounds.min.x && position.x <= cell->bounds.max.x &&
+            position.z >= cell->bounds.min.z && position.z <= cell->bounds.max.z;
+        if (inside && cell->state != CELL_RESIDENT) return false;
+    }
+    return true;
+}
+// DrawModelEx with WHITE, a mesh at a time when hiddenMeshes leaves some out
+static void DrawPlacedModel(ModelHandle handle, const bool* hiddenMeshes, Vector3 position, float scale, float yaw) {
+    Model model = GetModelFromHandle(handle);
+    CaptureModelDraw(handle, hiddenMeshes, position, (Vector3){ 0.0f, 1.0f, 0.0f }, yaw, (Vector3){ scale, scale, scale }, WHITE);
+    if (!hiddenMeshes) {
+        DrawModelEx(model, position, (Vector3){ 0.0f, 1.0f, 0.0f }, yaw, (Vector3){ scale, scale, scale }, WHITE);
+        AddModelDrawStats(model);
+        return;
+    }
+    Matrix transform = MatrixMultiply(model.transform, GetPlacementTransform(position, scale, yaw));
+    for (int i = 0; i < model.meshCount; i++) {
+        if (hiddenMeshes[i]) continue;
+        DrawMesh(model.meshes[i], model.materials[model.meshMaterial[i]], transform);
+        AddMeshDrawStats(&model.materials[model.meshMaterial[i]]);
+    }
+}
+static void AddWorldDrawInstance(FrameSnapshot* out, ModelHandle model, const bool* hiddenMeshes, Vector3 position, float scale, float yaw) {
+    if (out->worldInstanceCount == out->worldInstanceCapacity) return;
+    out->worldInstances[out->worldInstanceCount++] = (WorldDrawInstance){ model, hiddenMeshes, position, scale, yaw };
+}
+void CaptureWorldDrawInstances(const World* world, FrameSnapshot* out) {
+    out->worldInstanceCount = 0;
+    for (int i = 0; i < world->cellCount; i++) {
+        const WorldCell* cell = &world->cells[i];
+        if (cell->state == CELL_RESIDENT) AddWorldDrawInstance(out, cell->model, cell->hiddenMeshes, cell->position, cell->scale, 0.0f);
+    }
+    for (int i = 0; i < world->propCount; i++) {
+        const WorldProp* prop = &world->props[i];
+        const WorldPropMesh* mesh = &world->propMeshes[prop->mesh];
+        if (prop->placed) AddWorldDrawInstance(out, mesh->model, mesh->hiddenMeshes, prop->position, prop->scale, prop->yaw);
+    }
+    for (int i = 0; i < world->moverCount; i++) {
+        const WorldMover* mover = &world->movers[i];
+        const WorldPropMesh* mesh = &world->propMeshes[mover->mesh];
+        if (mover->placed) AddWorldDrawInstance(out, mesh->model, mesh->hiddenMeshes, mover->currentPosition, mover->scale, mover->yaw);
+    }
+}
+void DrawWorldInstances(const FrameSnapshot* frame) {
+    for (int i = 0; i < frame->worldInstanceCount; i++) {
+        const WorldDrawInstance* instance = &frame->worldInstances[i];
+        if (!IsModelHandleReady(instance->model)) continue;
+        DrawPlacedModel(instance->model, instance->hiddenMeshes, instance->position, instance->scale, instance->yaw);
+    }
+}
+void UnloadWorld(World* world) {
+    for (int i = 0; i < world->cellCount; i++) {
+        if (world->cells[i].state != CELL_UNLOADED) StreamCellOut(world, i);
+    }
+    for (int i = 0; i < world->propMeshCount; i++) {
+        if (world->propMeshes[i].state != CELL_UNLOADED) StreamPropMeshOut(world, i);
+    }
+    // Builds still in flight read the world and attach on the main thread, where they now find
+    // everything streamed out and drop their results
+    while (!IsJobCounterDone(&world->collisionBuilds)) {
+        JobRunMainThreadJobs();
+        PlatformYield();
+    }
+    for (int i = 0; i < world->cellCount; i++) {
+        RL_FREE(world->cells[i].hiddenMeshes);
+        world->cells[i].hiddenMeshes = NULL;
+    }
+    for (int i = 0; i < world->propMeshCount; i++) {
+        RL_FREE(world->propMeshes[i].hiddenMeshes);
+        world->propMeshes[i].hiddenMeshes = NULL;
+    }
+    LockWorld(world);
+    FreeCollisionWorld(&world->collision);
+    UnlockWorld(world);
+    world->propCount = 0;
+    world->propMeshCount = 0;
+    world->moverCount = 0;
+    world->cellCount = 0;
+    pthread_mutex_destroy(&world->lock);
+}
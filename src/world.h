@@ -0,0 +1,118 @@
+#ifndef WORLD_H
+#define WORLD_H
+#include <pthread.h>
+#include "../include/raylib.h"
+#include "assets.h"
+#include "collision.h"
+#include "jobs.h"
+#include "pipeline.h"
+#define MAX_WORLD_CELLS 64
+#define MAX_WORLD_PROP_MESHES 32
+#define MAX_WORLD_PROPS 1024
+#define MAX_WORLD_MOVERS 16
+#define MAX_WORLD_DRAW_INSTANCES (MAX_WORLD_CELLS + MAX_WORLD_PROPS + MAX_WORLD_MOVERS)
+#define WORLD_CELL_PATH_LENGTH 256
+// A cell or prop model goes from loading its model to building its collision on a worker, and is
+// resident once the main thread has added that collision to the world
+typedef enum {
+    CELL_UNLOADED,
+    CELL_LOADING,
+    CELL_BUILDING,
+    CELL_RESIDENT
+} WorldCellState;
+typedef struct {
+    char modelPath[WORLD_CELL_PATH_LENGTH];
+    Vector3 position;
+    float scale;
+    BoundingBox bounds;
+    WorldCellState state;
+    ModelHandle model;
+    bool* hiddenMeshes;
+    CollisionMesh collision;
+    unsigned int generation;
+} WorldCell;
+// One collision mesh per unique prop model, built once in model space and shared by every prop and
+// mover placed from it, so collision memory grows with unique models rather than placements.
+// hiddenMeshes, here and on a cell, flags the authored collision proxies that are never drawn; it is
+// NULL when the model has none. Once found it is kept until the world unloads, so snapshots can
+// point at it. generation, on both, moves on every time the model streams out, so a collision build
+// started for an earlier residency is dropped when it finishes.
+typedef struct {
+    char modelPath[WORLD_CELL_PATH_LENGTH];
+    WorldCellState state;
+    ModelHandle model;
+    bool* hiddenMeshes;
+    CollisionMesh collision;
+    unsigned int generation;
+} WorldPropMesh;
+// A placed model that never moves: beds, sinks, pots, ladders. cell is the cell whose footprint
+// holds it, or -1 when none does.
+typedef struct {
+    int mesh;
+    int cell;
+    Vector3 position;
+    float scale;
+    float yaw;
+    bool placed;
+    CollisionInstance instance;
+} WorldProp;
+// Doors, lifts and platforms: travels back and forth between position and position + travel once
+// every period seconds, so moving it only updates its instance. Props and movers stream in and out
+// with the cell their starting position lies in, and a prop model stays loaded only while one of
+// its placements is wanted.
+typedef struct {
+    int mesh;
+    int cell;
+    Vector3 position;
+    float scale;
+    float yaw;
+    Vector3 travel;
+    float period;
+    float time;
+    Vector3 currentPosition;
+    bool placed;
+    CollisionInstance instance;
+} WorldMover;
+// Cells stream in inside loadDistance and out beyond unloadDistance; the gap between the two keeps
+// a player walking along a border from thrashing. Distances are measured from both the current
+// position and the position predicted lookaheadSeconds ahead along the velocity. Collision meshes are
+// simplified for capsules no thinner than collisionRadius; zero keeps the render triangles as they are.
+typedef struct {
+    float loadDistance;
+    float unloadDistance;
+    float lookaheadSeconds;
+    int maxResidentCells;
+    float collisionRadius;
+} WorldStreamingSettings;
+typedef struct {
+    WorldCell cells[MAX_WORLD_CELLS];
+    int cellCount;
+    WorldPropMesh propMeshes[MAX_WORLD_PROP_MESHES];
+    int propMeshCount;
+    WorldProp props[MAX_WORLD_PROPS];
+    int propCount;
+    WorldMover movers[MAX_WORLD_MOVERS];
+    int moverCount;
+    WorldStreamingSettings settings;
+    CollisionSlopeSettings slopes;
+    CollisionWorld collision;
+    JobCounter collisionBuilds;
+    pthread_mutex_t lock;
+} World;
+bool LoadWorldLayout(World* world, const char* fileName, WorldStreamingSettings settings);
+void UpdateWorldStreaming(World* world, Vector3 position, Vector3 velocity);
+// Streaming changes cell states and the collision world under the world lock; a simulation running
+// on another thread holds it for the duration of its collision queries
+void LockWorld(World* world);
+void UnlockWorld(World* world);
+// Advances every placed mover and refits the instance tree; the caller holds the world lock
+void UpdateWorldMovers(World* world, float delta);
+bool IsWorldResidentAt(const World* world, Vector3 position);
+// Fills out's world instances with the resident cells and the placed props and movers; the caller
+// holds the world lock
+void CaptureWorldDrawInstances(const World* world, FrameSnapshot* out);
+// Draws the world instances of frame without touching the world. Instances whose model was released
+// since the snapshot are skipped.
+void DrawWorldInstances(const FrameSnapshot* frame);
+void UnloadWorld(World* world);
+#endif